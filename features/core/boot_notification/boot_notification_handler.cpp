@@ -1,5 +1,7 @@
 #include "boot_notification_handler.h"
 #include <Arduino.h>
+#include "LogClock.h"
+#include "ocpp_validator.h"
 
 BootNotificationHandler::BootNotificationHandler() {
     // Constructeur - initialisation si nécessaire
@@ -42,11 +44,11 @@ BootNotificationHandler::BootNotificationResponse
 BootNotificationHandler::parseResponse(const DynamicJsonDocument& response) {
     BootNotificationResponse result;
     
-    // Parse du statut
-    String statusStr = response["status"];
-    if (statusStr == "Accepted") {
+    // Parse du statut (lu sur place, sans copie)
+    const char* status = response["status"] | "";
+    if (strcmp(status, "Accepted") == 0) {
         result.status = BootNotificationStatus::ACCEPTED;
-    } else if (statusStr == "Pending") {
+    } else if (strcmp(status, "Pending") == 0) {
         result.status = BootNotificationStatus::PENDING;
     } else {
         result.status = BootNotificationStatus::REJECTED;
@@ -54,58 +56,21 @@ BootNotificationHandler::parseResponse(const DynamicJsonDocument& response) {
     
     result.currentTime = response["currentTime"].as<String>();
     result.interval = response["interval"];
+
+    // Heure du serveur : horodatage UTC des logs (quel que soit le statut)
+    LogClock::setFromIso8601(result.currentTime.c_str());
     
     return result;
 }
 
 bool BootNotificationHandler::validateRequest(const DynamicJsonDocument& request) {
-    // Vérification des champs obligatoires
-    if (!request.containsKey("chargePointVendor") || 
-        !request.containsKey("chargePointModel")) {
-        return false;
-    }
-    
-    // Vérification des longueurs
-    if (request["chargePointVendor"].as<String>().length() > 20 ||
-        request["chargePointModel"].as<String>().length() > 20) {
-        return false;
-    }
-    
-    return validateStringLengths(request);
+    // Schéma BootNotification.req : champs obligatoires, longueurs, types, sans propriété inconnue
+    return OcppValidator::validate(OCPP_ACTION_BOOT_NOTIFICATION, OCPP_SCHEMA_REQUEST,
+                                   request.as<JsonVariantConst>()).error == OCPP_VALID;
 }
 
 bool BootNotificationHandler::validateResponse(const DynamicJsonDocument& response) {
-    // Vérification des champs obligatoires
-    if (!response.containsKey("status") || 
-        !response.containsKey("currentTime") ||
-        !response.containsKey("interval")) {
-        return false;
-    }
-    
-    // Vérification du statut
-    String status = response["status"];
-    if (status != "Accepted" && status != "Pending" && status != "Rejected") {
-        return false;
-    }
-    
-    return true;
-}
-
-bool BootNotificationHandler::validateStringLengths(const DynamicJsonDocument& doc) {
-    // Vérification des longueurs selon OCPP 1.6
-    const char* fields[] = {
-        "chargePointSerialNumber", "chargeBoxSerialNumber", 
-        "iccid", "imsi", "meterType", "meterSerialNumber"
-    };
-    const int maxLengths[] = {25, 25, 20, 20, 25, 25};
-    
-    for (int i = 0; i < 6; i++) {
-        if (doc.containsKey(fields[i])) {
-            if (doc[fields[i]].as<String>().length() > maxLengths[i]) {
-                return false;
-            }
-        }
-    }
-    
-    return true;
+    // Schéma BootNotification.conf : status (enum), currentTime (date-time), interval
+    return OcppValidator::validate(OCPP_ACTION_BOOT_NOTIFICATION, OCPP_SCHEMA_RESPONSE,
+                                   response.as<JsonVariantConst>()).error == OCPP_VALID;
 }
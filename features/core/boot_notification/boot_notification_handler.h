@@ -67,7 +67,7 @@ public:
     BootNotificationResponse parseResponse(const DynamicJsonDocument& response);
 
     /**
-     * @brief Valide une requête BootNotification
+     * @brief Valide une requête BootNotification (tables générées, ocpp_validator.h)
      * @param request JSON à valider
      * @return true si valide, false sinon
      */
@@ -79,17 +79,6 @@ public:
      * @return true si valide, false sinon
      */
     bool validateResponse(const DynamicJsonDocument& response);
-
-private:
-    /**
-     * @brief Valide les champs obligatoires
-     */
-    bool validateRequiredFields(const DynamicJsonDocument& doc);
-    
-    /**
-     * @brief Valide les longueurs de chaînes
-     */
-    bool validateStringLengths(const DynamicJsonDocument& doc);
 };
 
 #endif // BOOT_NOTIFICATION_HANDLER_H
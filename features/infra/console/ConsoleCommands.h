@@ -0,0 +1,38 @@
+#pragma once
+#include "SerialConsole.h"
+
+class HardwareManager;
+class PowerManager;
+class WatchdogManager;
+class SystemRuntime;
+class OCPPWrapper;
+
+/**
+ * @file ConsoleCommands.h
+ * @brief Standard commands of the serial console.
+ *
+ *   help                                  command list
+ *   log <fichier>                         dumps a SPIFFS file (`.lz` archives decompressed on the fly)
+ *   logq <début_s> <fin_s> [LEVEL]        indexed query over the log files (Logger::queryStep)
+ *   history [n]                           last n records of the Logger history (all by default)
+ *   hw / power / wdt                      HardwareManager / PowerManager / WatchdogManager reports
+ *   tasks                                 SystemRuntime tasks: CPU usage, stack high-water marks, queues
+ *   ocpp                                  OCPPWrapper outbound queue: depth, in-flight CALLs, RTT, retries
+ *
+ * `log`, `logq`, `history` and `ocpp` are streamed as ConsoleJobs. `logq` resumes a LogQueryCursor one
+ * chunk per step and holds the Logger consumer role only while that chunk is read; `ocpp` prints a
+ * snapshot taken by the ocpp task (OCPPWrapper::requestStats()), never the live wrapper state.
+ */
+
+// help, log, logq, history
+void registerCoreCommands(SerialConsole& console);
+
+// hw, power, wdt: one per non-null manager (the objects must outlive the console)
+void registerSystemCommands(SerialConsole& console, HardwareManager* hardware, PowerManager* power,
+                            WatchdogManager* watchdog);
+
+// tasks (the runtime must outlive the console)
+void registerRuntimeCommands(SerialConsole& console, SystemRuntime& runtime);
+
+// ocpp (the wrapper must outlive the console)
+void registerOcppCommands(SerialConsole& console, OCPPWrapper& ocpp);
@@ -0,0 +1,137 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @file SerialConsole.h
+ * @brief Non-blocking, line-buffered command console on a Stream (Serial).
+ *
+ * poll() is called from loop() and never waits:
+ * - input bytes go into a fixed ring (CONSOLE_INPUT_SIZE), lines are assembled in a fixed buffer
+ *   (CONSOLE_LINE_SIZE), no String and no heap;
+ * - commands are looked up in an open-addressing hash table (FNV-1a of the name), O(1);
+ * - output goes into a ring (CONSOLE_OUTPUT_SIZE) sent only as fast as the UART accepts it
+ *   (availableForWrite()), a few hundred bytes per poll at 115200 baud;
+ * - long outputs (file dumps, log history) are ConsoleJobs, resumed on each poll() while the output
+ *   ring has room, so a dump never stalls metering or the watchdog. Ctrl-C cancels the job.
+ *
+ * Short replies are written directly (the console is a Print); if they overflow the output ring, the
+ * oldest bytes are sent synchronously (counted in ConsoleStats::outputStalls).
+ */
+
+#ifndef CONSOLE_INPUT_SIZE
+#define CONSOLE_INPUT_SIZE 256        // bytes, power of two: type-ahead kept while a job runs
+#endif
+#ifndef CONSOLE_OUTPUT_SIZE
+#define CONSOLE_OUTPUT_SIZE 1024      // bytes, power of two
+#endif
+#ifndef CONSOLE_LINE_SIZE
+#define CONSOLE_LINE_SIZE 96          // longest command line, '\0' included
+#endif
+#ifndef CONSOLE_MAX_COMMANDS
+#define CONSOLE_MAX_COMMANDS 16
+#endif
+#ifndef CONSOLE_MAX_JOB_STEPS
+#define CONSOLE_MAX_JOB_STEPS 8       // job steps per poll(), bounds the time spent in the console
+#endif
+
+// Largest output of one ConsoleJob::step(); a step only runs when that much room is free
+static constexpr size_t CONSOLE_JOB_CHUNK = 512;
+static_assert(CONSOLE_OUTPUT_SIZE >= 2 * CONSOLE_JOB_CHUNK, "CONSOLE_OUTPUT_SIZE too small for job steps");
+
+class SerialConsole;
+
+/**
+ * @brief Long-running command output, produced piece by piece across poll() calls.
+ */
+class ConsoleJob {
+public:
+    virtual ~ConsoleJob() {}
+
+    // Writes at most CONSOLE_JOB_CHUNK bytes to `out`; returns false once the job is done
+    virtual bool step(Print& out) = 0;
+
+    // Called instead of the next step when the job is interrupted (Ctrl-C)
+    virtual void cancel() {}
+};
+
+// `args`: rest of the line after the command name, trimmed (may be empty, never null)
+typedef void (*ConsoleHandler)(SerialConsole& console, char* args, void* ctx);
+
+struct ConsoleCommand {
+    const char* name;
+    const char* help;
+    ConsoleHandler handler;
+    void* ctx;
+};
+
+struct ConsoleStats {
+    uint32_t lines;            // Lines dispatched (known or not)
+    uint32_t unknown;          // Unknown commands
+    uint32_t inputOverflows;   // Lines longer than CONSOLE_LINE_SIZE, discarded
+    uint32_t outputStalls;     // Synchronous writes because the output ring was full
+    uint32_t jobsCancelled;
+};
+
+class SerialConsole : public Print {
+public:
+    explicit SerialConsole(Stream& io);
+
+    /**
+     * @brief Adds a command. `name` and `help` must be literals (kept as pointers).
+     * @return false if the table is full or the name is already taken
+     */
+    bool registerCommand(const char* name, const char* help, ConsoleHandler handler, void* ctx = nullptr);
+    const ConsoleCommand* findCommand(const char* name, size_t len) const;
+    size_t getCommandCount() const { return commandCount; }
+    const ConsoleCommand& getCommand(size_t i) const { return commands[i]; }
+
+    // Reads input, dispatches complete lines, advances the job and sends pending output; never blocks
+    void poll();
+
+    /**
+     * @brief Runs `job` from the next poll() on. The job object must outlive it (usually a static of
+     * the command). Returns false if another job is still running.
+     */
+    bool startJob(ConsoleJob& job);
+    bool isBusy() const { return job != nullptr; }
+
+    size_t getOutputPending() const { return outTail - outHead; }
+    const ConsoleStats& getStats() const { return stats; }
+
+    // Print: replies go into the output ring
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t len) override;
+    using Print::write;
+
+private:
+    Stream& io;
+
+    ConsoleCommand commands[CONSOLE_MAX_COMMANDS];
+    size_t commandCount = 0;
+    static constexpr size_t HASH_SIZE = 2 * CONSOLE_MAX_COMMANDS;   // Load factor <= 1/2
+    uint8_t hashSlots[HASH_SIZE] = {};                               // Command index + 1, 0 = empty
+
+    // Input: raw bytes, then the line being assembled
+    uint8_t input[CONSOLE_INPUT_SIZE];
+    size_t inHead = 0;
+    size_t inTail = 0;
+    char line[CONSOLE_LINE_SIZE];
+    size_t lineLength = 0;
+    bool lineOverflow = false;
+
+    // Output ring: free-running indices, masked on access
+    uint8_t output[CONSOLE_OUTPUT_SIZE];
+    size_t outHead = 0;
+    size_t outTail = 0;
+
+    ConsoleJob* job = nullptr;
+    ConsoleStats stats = {};
+
+    static uint32_t hashName(const char* name, size_t len);
+    void readInput();
+    void processInput();
+    void dispatch(char* text);
+    void runJob();
+    void sendOutput(bool blocking);
+    size_t outputFree() const { return CONSOLE_OUTPUT_SIZE - (outTail - outHead); }
+};
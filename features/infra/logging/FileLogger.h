@@ -4,32 +4,202 @@
 #include <Arduino.h>
 #include <FS.h>
 #include <SPIFFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "LogClock.h"
+
+// Write-behind block: one SPIFFS logical page, committed in a single write + flush
+#ifndef LOG_FILE_BLOCK_SIZE
+#define LOG_FILE_BLOCK_SIZE 256
+#endif
+#ifndef LOG_FILE_COMMIT_INTERVAL_MS
+#define LOG_FILE_COMMIT_INTERVAL_MS 1000    // max age of buffered data before commitIfDue() writes it
+#endif
+
+// Sparse index: one LogIndexEntry per LOG_INDEX_INTERVAL records, in /log_N.idx next to each log file
+#ifndef LOG_INDEX_INTERVAL
+#define LOG_INDEX_INTERVAL 16
+#endif
+#ifndef LOG_INDEX_BUFFER_ENTRIES
+#define LOG_INDEX_BUFFER_ENTRIES 4          // entries kept in RAM before being appended to the .idx
+#endif
+
+// Compressed retention: closed log files are compressed in the background into /logz_<seq><suffix>.lz
+// (see LogCompressor.h); the oldest archives are deleted once their total size exceeds the budget
+#ifndef LOG_FILE_COMPRESSION
+#define LOG_FILE_COMPRESSION 1
+#endif
+#ifndef LOG_ARCHIVE_BUDGET
+#define LOG_ARCHIVE_BUDGET 32768            // compressed bytes, same SPIFFS footprint as 4 plain log files
+#endif
+#ifndef LOG_COMPRESS_TASK_STACK_SIZE
+#define LOG_COMPRESS_TASK_STACK_SIZE 5120
+#endif
+#ifndef LOG_COMPRESS_TASK_PRIORITY
+#define LOG_COMPRESS_TASK_PRIORITY 1
+#endif
+
+// Boot marker: starts every log file and brackets the records replayed from an earlier boot, so that a
+// query keeps to the uptimes of one boot. Text "[boot 1a2b3c4d]", JSON {"boot":"1a2b3c4d"}, binary
+// LOG_FORMAT_ID_BOOT record (LogFormat.h)
+static constexpr size_t LOG_BOOT_MARKER_SIZE = 24;
+
+class LogQueryCursor;
+
+/**
+ * @brief Index entry of a group of consecutive records (16 bytes, little-endian on disk)
+ */
+struct LogIndexEntry {
+    uint32_t firstTimestamp;   // Uptime (ms) of the first record of the group
+    uint32_t lastTimestamp;    // Uptime (ms) of the last record of the group
+    uint32_t offset;           // Byte offset of the first record in the log file
+    uint8_t levelMask;         // Bit n set: the group holds at least one record of LogLevel n
+    uint8_t count;             // Records in the group
+    uint16_t length;           // Bytes covered by the group
+};
+static_assert(sizeof(LogIndexEntry) == 16, "LogIndexEntry is stored as is");
+
+/**
+ * @brief Counters of the write-behind buffer and of the compressed retention
+ */
+struct FileLoggerStats {
+    uint32_t bytes;      // Bytes accepted by write()/log()
+    uint32_t commits;    // Block writes issued to the filesystem (one write + flush each)
+    uint32_t rotations;  // Log file rotations
+    uint32_t archives;       // Closed files compressed into an archive
+    uint32_t archiveBytes;   // Current total size of the archives (compressed bytes)
+    uint32_t archivedBytes;  // Plain bytes compressed since begin()
+};
 
 class FileLogger {
 public:
-    FileLogger();
+    /**
+     * @param compressRotated Compress closed files in a background task and budget the retention
+     * in compressed bytes (LOG_ARCHIVE_BUDGET) instead of MAX_LOG_FILES plain files
+     */
+    explicit FileLogger(const char* suffix = LOG_FILE_SUFFIX, fs::FS& filesystem = SPIFFS,
+                        bool compressRotated = false);
     ~FileLogger();
 
     bool begin();
-    void end();
+    void end();       // Commits the pending block, then closes the file
     void log(const char* message);
 
+    /**
+     * @brief Appends raw bytes to the write-behind block. The block is committed when it reaches
+     * the next LOG_FILE_BLOCK_SIZE boundary of the file; a record never spans two log files.
+     */
+    void write(const char* data, size_t len);
+
+    /**
+     * @brief Same as write() for one complete log record; also feeds the sparse index.
+     * `timestamp` is the record uptime in ms, `level` its LogLevel.
+     */
+    void writeRecord(const char* data, size_t len, uint32_t timestamp, uint8_t level);
+
+    /**
+     * @brief Writes a boot marker outside the index groups: a query reads it even when it skips
+     * the groups around it
+     */
+    void writeMarker(const char* data, size_t len);
+
+    /**
+     * @brief Rotates now if `len` more bytes would not fit in the current file, then returns the
+     * generation of the current file (changes each time a file is opened). Lets a caller know
+     * whether its next write lands in the file it wrote to before.
+     */
+    uint32_t reserve(size_t len);
+
+    /**
+     * @brief Streams the records with timestamp in [fromMs, toMs] and level >= minLevel, oldest
+     * file first (archives, then plain files). Indexed groups outside the range are skipped with
+     * a seek; archives are decompressed on the fly. `bootId` keeps the records of one boot
+     * (LogClock::getBootId()). Returns the number of matching records. See LogQuery.h.
+     */
+    size_t query(uint32_t fromMs, uint32_t toMs, uint8_t minLevel, Print& out, uint32_t bootId = LOG_BOOT_ANY);
+
+    /**
+     * @brief Resumable form of query(): reads at most one chunk of one file per call and leaves
+     * the matches in the cursor (LogQueryCursor::finish() writes them out). Returns false once
+     * every file has been read. Files rotated, compressed or deleted between two steps are
+     * skipped, together with their records not read yet.
+     */
+    bool queryStep(LogQueryCursor& cursor);
+
+    // Commits the pending block if it is older than LOG_FILE_COMMIT_INTERVAL_MS
+    void commitIfDue();
+    // Commits the pending block now (ERROR level, shutdown)
+    void flushNow();
+
+    /**
+     * @brief Compresses the closed files waiting for compression, then enforces LOG_ARCHIVE_BUDGET.
+     * Runs in the compression task; may also be called directly (tests, shutdown).
+     */
+    void compressPending();
+    bool isCompressing() const { return compressMask != 0 || compressRunning; }
+
+    // Archive name of sequence number `seq` ("/logz_<seq><suffix>.lz")
+    String getArchiveFileName(uint32_t seq) const;
+    uint32_t getFirstArchive() const { return archiveFirst; }
+    uint32_t getNextArchive() const { return archiveNext; }
+
+    size_t getPendingBytes() const { return blockUsed; }
+    FileLoggerStats getStats() const { return stats; }
+
 private:
+    fs::FS& fs;
     File currentLogFile;
     int currentLogIndex;
+    const char* fileSuffix;
+
+    // Write-behind state (file size tracked in memory, no File::size() per line)
+    char block[LOG_FILE_BLOCK_SIZE];
+    size_t blockUsed = 0;
+    size_t fileSize = 0;
+    uint32_t fileGeneration = 0;
+    unsigned long blockStartMs = 0;
+    FileLoggerStats stats = {};
+
+    // Sparse index state
+    File indexFile;
+    LogIndexEntry indexPending[LOG_INDEX_BUFFER_ENTRIES];
+    size_t indexPendingCount = 0;
+    LogIndexEntry indexGroup = {};   // Group being filled (count == 0: none)
+
+    // Compressed archives [archiveFirst, archiveNext), written by the compression task only
+    bool compressRotated;
+    volatile uint32_t compressMask = 0;      // Bit n: /log_n waits for compression
+    volatile bool compressRunning = false;
+    portMUX_TYPE compressMux = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t archiveFirst = 0;
+    uint32_t archiveNext = 0;
 
     // Internal helpers
+    void prepareWrite(size_t len);
+    void appendBlock(const char* data, size_t len);
+    void closeIndexGroup();
+    void persistIndex();
+    void openFiles(int index);
+    void commitBlock();
     void openLatestLogFile();
     void rotateLogFileIfNeeded();
     void deleteOldestLogFileIfNeeded();
+    void scheduleCompression(int index);
+    void compressFile(int index);
+    void enforceArchiveBudget();
+    void scanArchives();
+    static void compressTaskEntry(void* param);
     String getLogFileName(int index) const;
-    size_t getLogFileSize(File& file) const;
+    String getIndexFileName(int index) const;
 
     // Constants
     static constexpr size_t MAX_LOG_FILE_SIZE = 8192;         // bytes
     static constexpr int MAX_LOG_FILES = 5;
     static constexpr const char* LOG_FILE_PREFIX = "/log_";
     static constexpr const char* LOG_FILE_SUFFIX = ".txt";
+    static constexpr const char* LOG_INDEX_SUFFIX = ".idx";
+    static constexpr const char* LOG_ARCHIVE_PREFIX = "/logz_";
+    static constexpr const char* LOG_ARCHIVE_SUFFIX = ".lz";
 };
 
 #endif // FILE_LOGGER_H
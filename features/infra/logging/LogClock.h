@@ -0,0 +1,81 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+/**
+ * @file LogClock.h
+ * @brief UTC wall clock of the logger and cached ISO 8601 timestamp formatter.
+ *
+ * LogClock is an offset between millis() and Unix time, set from the OCPP server time
+ * (`currentTime` of BootNotification.conf, `currentTime` of Heartbeat.conf). Until it is set,
+ * timestamps stay uptime based: "0000-00-00THH:MM:SS.mmmZ" with HH not wrapped at 24.
+ *
+ * LogTimestampFormatter keeps the "YYYY-MM-DDTHH:MM:" prefix of the current minute and only
+ * rewrites the "SS.mmm" digits: one subtraction, one compare and six digit stores per call.
+ * The date conversion (64-bit arithmetic + snprintf) runs once per minute, or when the clock is set.
+ */
+
+// "YYYY-MM-DDTHH:MM:SS.mmmZ" + NUL; the uptime form can reach 4 hour digits ("0000-00-00T1193:...")
+static constexpr size_t LOG_CLOCK_TEXT_SIZE = 28;
+
+// Boot IDs (LogClock::getBootId()); uptime timestamps only compare within one boot
+static constexpr uint32_t LOG_BOOT_ANY = 0;               // queries: records of every boot
+static constexpr uint32_t LOG_BOOT_EARLIER = 0xFFFFFFFF;  // records replayed from an earlier boot
+
+class LogClock {
+public:
+    // `unixMs` (UTC, ms since 1970-01-01) is the current time at uptime `uptimeMs`
+    static void setUnixTimeMs(uint64_t unixMs, uint32_t uptimeMs);
+
+    // OCPP dateTime ("2025-01-31T12:34:56Z", optional fraction, "Z" or "+hh:mm"/"-hh:mm")
+    static bool setFromIso8601(const char* text, uint32_t uptimeMs);
+    static bool setFromIso8601(const char* text) { return setFromIso8601(text, millis()); }
+    static bool parseIso8601(const char* text, uint64_t& unixMs);
+
+    // Back to uptime timestamps (tests)
+    static void reset();
+
+    // Random ID of this boot, never LOG_BOOT_ANY or LOG_BOOT_EARLIER; written at the start of each log file
+    static uint32_t getBootId();
+
+    static bool isSet() { return generation != 0; }
+    // 0 while unset, incremented by every set: formatter caches compare it to detect a new offset
+    static uint32_t getGeneration() { return generation; }
+
+    // 0 if the clock is not set
+    static uint64_t toUnixMs(uint32_t uptimeMs);
+    // false if the clock is not set or `unixMs` falls outside the current boot
+    static bool toUptimeMs(uint64_t unixMs, uint32_t& uptimeMs);
+
+    // Proleptic Gregorian calendar helpers (days since 1970-01-01)
+    static int32_t daysFromCivil(int32_t year, uint32_t month, uint32_t day);
+    static void civilFromDays(int32_t days, int32_t& year, uint32_t& month, uint32_t& day);
+
+private:
+    static volatile uint32_t generation;
+    static int64_t offsetMs;   // Unix ms at uptime 0
+};
+
+/**
+ * @brief ISO 8601 formatter with a per-minute cache; safe to share between tasks (short critical section)
+ */
+class LogTimestampFormatter {
+public:
+    // Writes the timestamp of `uptimeMs`, NUL terminated; returns the length (without NUL)
+    size_t format(char* buf, size_t size, uint32_t uptimeMs);
+
+    // Uncached uptime form ("0000-00-00THH:MM:SS.mmmZ"), for records of a previous boot
+    static size_t formatUptime(char* buf, size_t size, uint32_t uptimeMs);
+
+private:
+    char text[LOG_CLOCK_TEXT_SIZE] = {};
+    size_t length = 0;
+    size_t secondsPos = 0;           // Index of the "SS" digits in `text`
+    uint32_t minuteStartMs = 0;      // Uptime of second 0 of the cached minute
+    uint32_t cachedGeneration = UINT32_MAX;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+    // "YYYY-MM-DDTHH:MM:" of the minute holding `uptimeMs`; returns its length
+    static size_t buildPrefix(char* out, size_t size, uint32_t uptimeMs, uint32_t generation,
+                              uint32_t& minuteStartMs);
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+
+/**
+ * @file LogCompressor.h
+ * @brief Streaming LZSS codec for closed log segments (heatshrink-like, bounded RAM, no heap).
+ *
+ * Stream format:
+ *   "LZS1" | uint32 original size (little-endian, 0 if unknown) | token groups
+ * Each group starts with a flag byte followed by up to 8 tokens; bit i of the flag byte
+ * describes token i: 1 = literal byte, 0 = 2-byte match (big-endian)
+ *   (distance - 1) << LOG_LZ_LENGTH_BITS | (length - LOG_LZ_MIN_MATCH)
+ * The stream ends with the input; a partial last group is allowed.
+ *
+ * RAM: encoder ~2.6 KB (window + lookahead + output chunk), decoder ~2.3 KB (window + output chunk).
+ * Typical ratio on text logs: 4-8x (repeated timestamps, levels, file names and formats).
+ */
+
+static constexpr uint8_t LOG_LZ_WINDOW_BITS = 11;
+static constexpr uint8_t LOG_LZ_LENGTH_BITS = 5;
+static constexpr size_t LOG_LZ_WINDOW_SIZE = 1u << LOG_LZ_WINDOW_BITS;               // 2048
+static constexpr size_t LOG_LZ_MIN_MATCH = 3;
+static constexpr size_t LOG_LZ_MAX_MATCH = LOG_LZ_MIN_MATCH + (1u << LOG_LZ_LENGTH_BITS) - 1;   // 34
+static constexpr size_t LOG_LZ_HEADER_SIZE = 8;
+static constexpr size_t LOG_LZ_CHUNK_SIZE = 256;
+static constexpr const char* LOG_LZ_MAGIC = "LZS1";
+
+/**
+ * @brief Streaming encoder: write() the plain bytes, finish() once, compressed data goes to `out`
+ */
+class LogLzEncoder {
+public:
+    LogLzEncoder(Print& out, uint32_t originalSize = 0);
+
+    void write(const uint8_t* data, size_t len);
+    void finish();
+
+    uint32_t getInputSize() const { return inputSize; }
+    uint32_t getOutputSize() const { return outputSize; }
+
+private:
+    Print& out;
+    uint8_t buffer[LOG_LZ_WINDOW_SIZE + LOG_LZ_CHUNK_SIZE];   // history + lookahead
+    size_t pos = 0;       // Next byte to encode
+    size_t end = 0;       // End of buffered input
+    uint8_t group[1 + 2 * 8] = {};   // Flag byte + up to 8 tokens
+    size_t groupLen = 1;
+    uint8_t groupTokens = 0;
+    uint8_t outBuffer[LOG_LZ_CHUNK_SIZE];
+    size_t outUsed = 0;
+    uint32_t inputSize = 0;
+    uint32_t outputSize = 0;
+
+    void encode(bool final);
+    void emitLiteral(uint8_t value);
+    void emitMatch(size_t distance, size_t length);
+    void endToken();
+    void flushGroup();
+    void put(const uint8_t* data, size_t len);
+    void flushOutput();
+};
+
+/**
+ * @brief Streaming decoder: write() compressed bytes in any chunking, plain bytes go to `out`
+ */
+class LogLzDecoder {
+public:
+    explicit LogLzDecoder(Print& out);
+
+    void write(const uint8_t* data, size_t len);
+    void finish();
+
+    bool isValid() const { return valid; }
+    uint32_t getOriginalSize() const { return originalSize; }
+    uint32_t getOutputSize() const { return outputSize; }
+
+private:
+    Print& out;
+    uint8_t window[LOG_LZ_WINDOW_SIZE];
+    uint8_t outBuffer[LOG_LZ_CHUNK_SIZE];
+    size_t outUsed = 0;
+    uint8_t header[LOG_LZ_HEADER_SIZE];
+    size_t headerUsed = 0;
+    uint8_t flags = 0;
+    uint8_t flagsLeft = 0;
+    bool haveHighByte = false;
+    uint8_t highByte = 0;
+    bool valid = true;
+    uint32_t originalSize = 0;
+    uint32_t outputSize = 0;
+
+    void put(uint8_t value);
+};
+
+class LogCompressor {
+public:
+    /**
+     * @brief Compresses `src` into `dst` (overwritten). Returns false on I/O error, `dst` is then removed.
+     */
+    static bool compressFile(fs::FS& fs, const char* src, const char* dst, uint32_t* compressedSize = nullptr);
+
+    // Streams the decompressed content of `in` to `out` in LOG_LZ_CHUNK_SIZE chunks
+    static bool decompress(fs::File& in, Print& out);
+};
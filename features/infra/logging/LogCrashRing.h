@@ -0,0 +1,68 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include "LogFormat.h"
+
+/**
+ * @file LogCrashRing.h
+ * @brief Small WARN/ERROR log ring kept in RTC slow memory (RTC_NOINIT_ATTR), so that the last
+ * records survive esp_restart(), watchdog and panic resets. Logger::begin() replays it into the
+ * history, Serial and the SPIFFS log set together with esp_reset_reason(), then clears it.
+ *
+ * Each slot ends with a binary record laid out like LogBinaryRecord (timestamp | format ID |
+ * 0xA0|level | length | payload), so deferred-format records are replayed byte for byte.
+ * Text records use LOG_FORMAT_ID_TEXT with the message as payload.
+ *
+ * Footprint: LOG_CRASH_RING_SLOTS x 128 bytes of RTC slow memory (2 KB by default, no DRAM).
+ */
+
+#ifndef LOG_CRASH_RING_SLOTS
+#define LOG_CRASH_RING_SLOTS 16
+#endif
+#ifndef LOG_CRASH_RING_MIN_LEVEL
+#define LOG_CRASH_RING_MIN_LEVEL 2          // LOG_LEVEL_WARNING
+#endif
+
+static constexpr size_t LOG_CRASH_PAYLOAD_SIZE = 112;
+
+struct LogCrashSlot {
+    uint32_t sequence;          // 0 = empty or being written
+    uint32_t checksum;          // Over sequence + record, rejects torn writes
+    // --- Binary record (same layout as LogBinaryRecord) ---
+    uint32_t timestamp;
+    uint16_t formatId;
+    uint8_t level;              // LOG_BINARY_SYNC | LogLevel
+    uint8_t length;
+    uint8_t payload[LOG_CRASH_PAYLOAD_SIZE];
+
+    const uint8_t* record() const { return reinterpret_cast<const uint8_t*>(&timestamp); }
+    size_t recordSize() const { return LOG_BINARY_HEADER_SIZE + length; }
+};
+static_assert(sizeof(LogCrashSlot) == 128, "LogCrashSlot must stay 128 bytes");
+
+class LogCrashRing {
+public:
+    /**
+     * @brief Copies one record into the ring (critical section, ~128 byte copy).
+     * Safe to call before begin(): the ring validates itself on first use.
+     */
+    static void record(uint8_t level, uint32_t timestamp, uint16_t formatId, const void* payload, size_t length);
+
+    /**
+     * @brief Calls `fn` for every valid slot left by the previous run, oldest first.
+     * Returns the number of records visited.
+     */
+    static size_t forEach(void (*fn)(const LogCrashSlot& slot, void* ctx), void* ctx);
+
+    static size_t pending();   // Records of the previous run
+    static void clear();       // Forgets the previous run, keeps the records of this boot
+
+    // Number of boots seen since the RTC memory was last initialized (power-on)
+    static uint32_t getBootCount();
+
+    static const char* resetReasonToString(esp_reset_reason_t reason);
+
+    // --- Test support: forgets the RAM state as a reset would (RTC content is kept) ---
+    static void simulateReboot();
+};
@@ -0,0 +1,245 @@
+#pragma once
+#include <Arduino.h>
+#include <type_traits>
+
+/**
+ * @file LogFormat.h
+ * @brief Deferred-format (binary) logging: format string registry and argument packing.
+ *
+ * With LOG_DEFERRED_FORMAT=1 the LOG_* macros register their format string once and
+ * only record a 16-bit format ID, a timestamp and the raw arguments. Records are written
+ * to `/log_N.bin`. Text is produced off the hot path (drain task) or offline with
+ * `scripts/log_decode.py`.
+ *
+ * The format ID is the hash of the format string, so it does not depend on the boot, the
+ * registration order or the build. Each data file carries its own dictionary: the first record
+ * of a format in a file is preceded by a definition record (level nibble LOG_BINARY_DEFINITION,
+ * same format ID, payload `level \t file:line \t format`). Definitions are rotated, compressed
+ * and deleted together with the records they describe. Boot markers (FileLogger.h) use the same
+ * level nibble with LOG_FORMAT_ID_BOOT.
+ *
+ * Binary record layout (little-endian):
+ *   uint32 timestamp_ms | uint16 format_id | uint8 0xA0|level | uint8 length | payload[length]
+ * Payload: sequence of tagged arguments, see LogArgTag.
+ * Structured records (LOG_FORMAT_ID_FIELDS, see Logger::logFields) use the same encoding:
+ *   's' event, then ('s' key, tagged value) pairs
+ */
+
+#ifndef LOG_DEFERRED_FORMAT
+#define LOG_DEFERRED_FORMAT 0
+#endif
+#ifndef LOG_BINARY_PAYLOAD_SIZE
+#define LOG_BINARY_PAYLOAD_SIZE 56
+#endif
+#ifndef LOG_FORMAT_REGISTRY_SIZE
+#define LOG_FORMAT_REGISTRY_SIZE 256
+#endif
+
+static constexpr uint8_t LOG_BINARY_SYNC = 0xA0;                  // high nibble of the level byte
+static constexpr uint16_t LOG_FORMAT_ID_TEXT = 0;                 // payload = preformatted text
+static constexpr uint16_t LOG_FORMAT_ID_UNKNOWN = 0xFFFF;         // registry full or collision: arguments only
+static constexpr uint16_t LOG_FORMAT_ID_FIELDS = 0xFFFE;          // payload = event string + key/value pairs
+static constexpr uint16_t LOG_FORMAT_ID_BOOT = 0xFFFD;            // boot marker, payload = uint32 boot ID
+static constexpr size_t LOG_BINARY_HEADER_SIZE = 8;
+static constexpr size_t LOG_BINARY_MAX_STRING = 32;               // longer %s arguments are truncated
+static constexpr uint8_t LOG_BINARY_DEFINITION = 0x0F;           // level nibble of a format definition
+static constexpr size_t LOG_FORMAT_DEFINITION_MAX_SIZE = LOG_BINARY_HEADER_SIZE + 255;
+
+/**
+ * @brief Argument type tags of the packed payload
+ */
+enum LogArgTag : uint8_t {
+    LOG_ARG_INT32 = 'i',
+    LOG_ARG_UINT32 = 'u',
+    LOG_ARG_INT64 = 'l',
+    LOG_ARG_UINT64 = 'L',
+    LOG_ARG_DOUBLE = 'd',
+    LOG_ARG_STRING = 's',     // uint8 length + bytes (no terminator)
+    LOG_ARG_POINTER = 'p'
+};
+
+/**
+ * @brief One binary record; the first LOG_BINARY_HEADER_SIZE + length bytes are what is persisted
+ */
+struct LogBinaryRecord {
+    uint32_t timestamp;
+    uint16_t formatId;
+    uint8_t level;            // LOG_BINARY_SYNC | LogLevel
+    uint8_t length;
+    uint8_t payload[LOG_BINARY_PAYLOAD_SIZE];
+
+    size_t storedSize() const { return LOG_BINARY_HEADER_SIZE + length; }
+};
+static_assert(offsetof(LogBinaryRecord, payload) == LOG_BINARY_HEADER_SIZE, "LogBinaryRecord must stay packed");
+
+/**
+ * @brief Packs printf arguments as tagged raw values. Arguments that do not fit in the
+ * payload are dropped; the renderer prints "<?>" in their place.
+ */
+class LogArgPacker {
+public:
+    LogArgPacker(uint8_t* buffer, size_t capacity) : buf(buffer), cap(capacity), len(0) {}
+
+    size_t length() const { return len; }
+
+    void pack() {}
+
+    template <typename T, typename... Rest>
+    void pack(const T& value, const Rest&... rest) {
+        packOne(value);
+        pack(rest...);
+    }
+
+    // Key/value pairs: each key is packed as a string argument followed by its typed value
+    void packFields() {}
+
+    template <typename T, typename... Rest>
+    void packFields(const char* key, const T& value, const Rest&... rest) {
+        static_assert(sizeof...(Rest) % 2 == 0, "fields are key/value pairs");
+        packString(key);
+        packOne(value);
+        packFields(rest...);
+    }
+
+private:
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+
+    void put(uint8_t tag, const void* data, size_t size) {
+        if (len + 1 + size > cap) {
+            len = cap;   // Stop packing: the renderer shows the missing arguments
+            return;
+        }
+        buf[len++] = tag;
+        memcpy(buf + len, data, size);
+        len += size;
+    }
+
+    void packString(const char* s) {
+        if (!s) s = "(null)";
+        if (len + 2 > cap) {
+            len = cap;
+            return;
+        }
+        size_t n = strnlen(s, LOG_BINARY_MAX_STRING);
+        if (n > cap - len - 2) n = cap - len - 2;
+        buf[len++] = LOG_ARG_STRING;
+        buf[len++] = static_cast<uint8_t>(n);
+        memcpy(buf + len, s, n);
+        len += n;
+    }
+
+    void packOne(const char* s) { packString(s); }
+    void packOne(char* s) { packString(s); }
+    void packOne(const String& s) { packString(s.c_str()); }
+    void packOne(float v) { double d = v; put(LOG_ARG_DOUBLE, &d, sizeof(d)); }
+    void packOne(double v) { put(LOG_ARG_DOUBLE, &v, sizeof(v)); }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+    packOne(T v) {
+        if (sizeof(T) > 4) {
+            if (std::is_signed<T>::value) {
+                int64_t x = static_cast<int64_t>(v);
+                put(LOG_ARG_INT64, &x, sizeof(x));
+            } else {
+                uint64_t x = static_cast<uint64_t>(v);
+                put(LOG_ARG_UINT64, &x, sizeof(x));
+            }
+        } else if (std::is_signed<T>::value || std::is_enum<T>::value) {
+            int32_t x = static_cast<int32_t>(v);
+            put(LOG_ARG_INT32, &x, sizeof(x));
+        } else {
+            uint32_t x = static_cast<uint32_t>(v);
+            put(LOG_ARG_UINT32, &x, sizeof(x));
+        }
+    }
+
+    template <typename T>
+    void packOne(const T* p) {
+        uint32_t x = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p));
+        put(LOG_ARG_POINTER, &x, sizeof(x));
+    }
+};
+
+/**
+ * @brief Sequential reader over a packed payload
+ */
+struct LogArgReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    // Returns the tag of the next argument (0 if none) and points `data` at its value
+    uint8_t next(const uint8_t*& data, size_t& size) {
+        if (p >= end) return 0;
+        uint8_t tag = *p++;
+        switch (tag) {
+            case LOG_ARG_INT32:
+            case LOG_ARG_UINT32:
+            case LOG_ARG_POINTER: size = 4; break;
+            case LOG_ARG_INT64:
+            case LOG_ARG_UINT64:
+            case LOG_ARG_DOUBLE:  size = 8; break;
+            case LOG_ARG_STRING:
+                if (p >= end) return 0;
+                size = *p++;
+                break;
+            default: return 0;
+        }
+        if (p + size > end) return 0;
+        data = p;
+        p += size;
+        return tag;
+    }
+
+    bool nextInt(int& value) {
+        const uint8_t* data;
+        size_t size;
+        uint8_t tag = next(data, size);
+        if (tag != LOG_ARG_INT32 && tag != LOG_ARG_UINT32) return false;
+        int32_t v;
+        memcpy(&v, data, sizeof(v));
+        value = v;
+        return true;
+    }
+};
+
+/**
+ * @brief Registry of deferred format strings (one entry per call site)
+ */
+class LogFormatRegistry {
+public:
+    /**
+     * @brief Registers a format string and returns its ID: the hash of the format string, the
+     * same in every boot and every build. A format whose hash is already held by another format
+     * gets LOG_FORMAT_ID_UNKNOWN (arguments only, never decoded with the wrong format);
+     * `scripts/check_log_formats.py` rejects such collisions at build time. Called once per call site.
+     */
+    static uint16_t registerFormat(uint8_t level, const char* file, int line, const char* format);
+
+    // Looks up a registered format and its call site (nullptr if unknown)
+    static const char* getFormat(uint16_t formatId, const char** file = nullptr, int* line = nullptr);
+
+    // Registry slot of a format ID in [0, LOG_FORMAT_REGISTRY_SIZE), -1 if not registered
+    static int getSlot(uint16_t formatId);
+
+    /**
+     * @brief Writes the definition record of `formatId` to `out` (at most
+     * LOG_FORMAT_DEFINITION_MAX_SIZE bytes, long formats are truncated). Returns its size,
+     * 0 if the format is not registered.
+     */
+    static size_t writeDefinition(uint16_t formatId, uint32_t timestamp, uint8_t* out, size_t size);
+
+    // Renders a record to text (message only, no timestamp/level prefix)
+    static size_t render(const LogBinaryRecord& record, char* out, size_t size);
+
+    // Renders packed key/value pairs as " key=value ...", returns the length
+    static size_t renderFields(const uint8_t* fields, size_t length, char* out, size_t size);
+
+    // Renders one tagged value with its default conversion (%d, %u, %g, %s...)
+    static int renderValue(char* out, size_t size, uint8_t tag, const uint8_t* data, size_t dataSize);
+
+    static size_t getCount();
+    static size_t getCollisions();   // Registrations refused because another format holds the ID
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+#include "FileLogger.h"
+#include "LogCompressor.h"
+
+/**
+ * @file LogQuery.h
+ * @brief Time-range / level queries over the rotated log files, driven by the sparse `.idx` index
+ * written by FileLogger.
+ *
+ * Index groups whose time range or level mask cannot match are skipped with a seek; matching
+ * ranges are read in LOG_QUERY_CHUNK_SIZE chunks and matching records are written out in chunks
+ * of the same size. Records after the last index entry (group still open, or a reset before the
+ * index was appended) are always scanned.
+ *
+ * Text records are filtered on the `[...THH:MM:SS.mmmZ] [LEVEL]` prefix (UTC times mapped back to uptime
+ * with LogClock, older second-resolution lines accepted);
+ * binary records (LOG_DEFERRED_FORMAT) on their header and rendered to text.
+ * Compressed archives (`.lz`, see LogCompressor.h) have no index and are decompressed and
+ * scanned as a stream.
+ *
+ * Uptimes restart at every boot: with a `bootId`, only the records after a boot marker of that boot
+ * (FileLogger.h) match; with LOG_BOOT_ANY every boot matches and each marker is written out as a
+ * "[boot 1a2b3c4d]" separator line.
+ *
+ * LogQueryCursor is the resumable form (console `logq`): FileLogger::queryStep() advances it by
+ * one chunk of input at most and never buffers more than LOG_QUERY_CHUNK_SIZE bytes of output,
+ * so that the files are only held for short steps and the output fits one console job step.
+ */
+
+#ifndef LOG_QUERY_CHUNK_SIZE
+#define LOG_QUERY_CHUNK_SIZE 512
+#endif
+#ifndef LOG_QUERY_ARCHIVE_STEP
+#define LOG_QUERY_ARCHIVE_STEP 64           // compressed bytes read per LogQueryCursor step, at most
+#endif
+
+struct LogQueryStats {
+    uint32_t filesScanned;
+    uint32_t groupsScanned;    // Index groups read from flash
+    uint32_t groupsSkipped;    // Index groups skipped without reading
+    uint32_t bytesRead;        // Log bytes read (index excluded)
+    uint32_t recordsMatched;
+};
+
+class LogQuery {
+public:
+    LogQuery(uint32_t fromMs, uint32_t toMs, uint8_t minLevel, bool binary, Print& out,
+             uint32_t bootId = LOG_BOOT_ANY);
+    ~LogQuery();
+
+    // Scans one log file; `index` may be an invalid File (no index: full scan)
+    void scanFile(fs::File& data, fs::File& index);
+
+    // Scans one compressed archive (full scan)
+    void scanCompressed(fs::File& archive);
+
+    // Writes out the buffered matches
+    void finish();
+
+    const LogQueryStats& getStats() const { return stats; }
+
+protected:
+    uint32_t fromMs;
+    uint32_t toMs;
+    uint8_t minLevel;
+    bool binary;
+    Print& out;
+    uint32_t bootId;
+    uint32_t fileBoot = LOG_BOOT_ANY;   // Boot of the last marker read in the current source (ANY: none yet)
+    LogQueryStats stats = {};
+
+    // Records are cut at LOG_QUERY_CHUNK_SIZE; the extra room takes one decoder flush (LogQueryCursor)
+    uint8_t chunk[LOG_QUERY_CHUNK_SIZE + LOG_LZ_CHUNK_SIZE];
+    size_t chunkUsed = 0;
+    char outBuffer[LOG_QUERY_CHUNK_SIZE];
+    size_t outUsed = 0;
+    bool bounded = false;   // Stop extracting instead of writing out when outBuffer is full
+
+    bool groupMayMatch(const LogIndexEntry& entry) const;
+    void scanRange(fs::File& data, uint32_t start, uint32_t end);
+    // Returns false if records were held back in `chunk` because outBuffer is full (bounded only)
+    bool extract(bool endOfRange);
+    size_t recordLength(const uint8_t* data, size_t available, bool endOfRange) const;
+    void processRecord(const uint8_t* record, size_t len);
+    void enterBoot(uint32_t boot);
+    void emit(const char* data, size_t len);
+};
+
+enum LogQueryPhase : uint8_t {
+    LOG_QUERY_START,
+    LOG_QUERY_ARCHIVES,
+    LOG_QUERY_FILES,
+    LOG_QUERY_DONE
+};
+
+/**
+ * @brief Resumable LogQuery, see FileLogger::queryStep(). Holds its own decoder (~2.3 KB):
+ * keep it in static storage rather than on a task stack.
+ */
+class LogQueryCursor : public LogQuery {
+public:
+    LogQueryCursor(uint32_t fromMs, uint32_t toMs, uint8_t minLevel, bool binary, Print& out,
+                   uint32_t bootId = LOG_BOOT_ANY);
+    ~LogQueryCursor();
+
+    // One bounded step over a log file; false once the file is done
+    bool stepFile(fs::File& data, fs::File& index);
+
+    // One bounded step over a compressed archive; false once the archive is done
+    bool stepCompressed(fs::File& archive);
+
+    // Forgets the position in the current file before moving to the next one
+    void nextSource();
+
+    // Source being read, advanced by FileLogger::queryStep()
+    LogQueryPhase phase = LOG_QUERY_START;
+    uint32_t archiveSeq = 0;
+    int fileIndex = 0;
+    uint8_t filesLeft = 0;
+
+private:
+    // Decompressed bytes go to `chunk`; the caller keeps room for one decoder flush
+    struct Feeder : Print {
+        LogQueryCursor& cursor;
+        explicit Feeder(LogQueryCursor& cursor) : cursor(cursor) {}
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buf, size_t size) override;
+    } feeder;
+
+    uint32_t pos = 0;        // Next byte of the current file (plain file or archive)
+    uint32_t rangeEnd = 0;   // Plain files: end of the range being read
+    uint32_t indexPos = 0;   // Plain files: next .idx byte
+    uint32_t covered = 0;    // Plain files: bytes already scanned or skipped
+    bool started = false;
+    bool tail = false;       // Plain files: range past the last index entry reached
+    bool draining = false;   // End of the range or archive read: the bytes left in `chunk` are final
+    LogLzDecoder* decoder = nullptr;
+    alignas(LogLzDecoder) uint8_t decoderStorage[sizeof(LogLzDecoder)];
+
+    bool resume();
+    void nextRange(fs::File& index, uint32_t size);
+    void closeDecoder();
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Token bucket of one rate-limited call site (LOG_*_RATE macros).
+ *
+ * One token every `intervalMs`, at most `burst` tokens saved up. The bucket is a static
+ * of the call site, constant-initialized (no guard, no heap). Calls from two tasks at
+ * the same site may race; the worst case is one token spent twice.
+ */
+class LogRateLimiter {
+public:
+    constexpr LogRateLimiter(uint32_t intervalMs, uint16_t burst)
+        : intervalMs(intervalMs ? intervalMs : 1), burst(burst ? burst : 1), credit(0), lastMs(0),
+          dropped(0), started(false) {}
+
+    /**
+     * @brief Spends a token if one is available.
+     * On success `suppressed` is the number of calls dropped since the previous success.
+     */
+    bool allow(uint32_t nowMs, uint32_t& suppressed) {
+        uint32_t capacity = intervalMs * burst;
+        if (!started) {
+            credit = capacity;   // Full bucket on the first call
+            started = true;
+        } else {
+            uint32_t elapsed = nowMs - lastMs;
+            credit = (elapsed >= capacity - credit) ? capacity : credit + elapsed;
+        }
+        lastMs = nowMs;
+
+        if (credit < intervalMs) {
+            dropped++;
+            return false;
+        }
+        credit -= intervalMs;
+        suppressed = dropped;
+        dropped = 0;
+        return true;
+    }
+
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    uint32_t intervalMs;
+    uint16_t burst;
+    uint32_t credit;     // Milliseconds of refill saved up (capacity = intervalMs * burst)
+    uint32_t lastMs;
+    uint32_t dropped;    // Calls dropped since the last success
+    bool started;
+};
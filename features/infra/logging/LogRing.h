@@ -0,0 +1,180 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Overflow policy of the async log ring
+ */
+enum LogOverflowPolicy {
+    LOG_OVERFLOW_DROP_NEWEST = 0,  // Reject the incoming record, keep the backlog
+    LOG_OVERFLOW_DROP_OLDEST       // Discard the oldest queued record to make room
+};
+
+/**
+ * @brief Lock-free single-producer / single-consumer ring of fixed-size records.
+ *
+ * The producer owns `head`, the consumer owns `tail`. With LOG_OVERFLOW_DROP_OLDEST
+ * the producer may also advance `tail` when the ring is full; the consumer therefore
+ * copies a slot first and only commits it with a CAS on `tail`. If the producer stole
+ * that slot in the meantime the CAS fails and the (possibly torn) copy is discarded.
+ *
+ * N must be a power of two.
+ */
+template <typename T, size_t N>
+class LogRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "LogRing size must be a power of two");
+
+public:
+    LogRing() : head(0), tail(0), droppedNewest(0), droppedOldest(0) {}
+
+    // --- Producer side ---
+    bool push(const T& item, LogOverflowPolicy policy) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= N) {
+            if (policy == LOG_OVERFLOW_DROP_NEWEST) {
+                droppedNewest.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // A failed CAS means the consumer just freed the slot: room is available either way
+            if (tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel)) {
+                droppedOldest.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // --- Consumer side ---
+    bool pop(T& out) {
+        size_t t = tail.load(std::memory_order_acquire);
+        for (;;) {
+            if (t == head.load(std::memory_order_acquire)) return false;
+            out = slots[t & (N - 1)];
+            if (tail.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel)) return true;
+            // Slot stolen by the producer (or spurious failure): t has been reloaded, retry
+        }
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() { return N; }
+
+    uint32_t getDroppedNewest() const { return droppedNewest.load(std::memory_order_relaxed); }
+    uint32_t getDroppedOldest() const { return droppedOldest.load(std::memory_order_relaxed); }
+
+private:
+    T slots[N];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<uint32_t> droppedNewest;
+    std::atomic<uint32_t> droppedOldest;
+};
+
+/**
+ * @brief Bounded lock-free multi-producer / single-consumer ring (D. Vyukov's bounded queue).
+ *
+ * Each slot carries a sequence number: a producer claims the slot at `enqueuePos` with a CAS,
+ * copies the record and publishes it by storing `pos + 1`; the consumer frees it by storing
+ * `pos + N`. Producers never wait on each other or on the consumer; a full ring rejects the
+ * record (counted as droppedNewest). Only one task at a time may use the consumer side, so
+ * LOG_OVERFLOW_DROP_OLDEST frees a slot with discardOldest() only when the producer can take
+ * that role; otherwise the caller rejects the record and counts it with countBusyDrop().
+ *
+ * N must be a power of two.
+ */
+template <typename T, size_t N>
+class LogMpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "LogMpscRing size must be a power of two");
+
+public:
+    LogMpscRing() : enqueuePos(0), dequeuePos(0), droppedNewest(0), droppedOldest(0), droppedBusy(0) {
+        for (size_t i = 0; i < N; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // --- Producer side (any task, any core) ---
+    // `countDrop` = false when the caller retries a rejected record (LOG_OVERFLOW_DROP_OLDEST)
+    bool push(const T& item, bool countDrop = true) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & (N - 1)];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                if (countDrop) droppedNewest.fetch_add(1, std::memory_order_relaxed);
+                return false;   // Full: the consumer has not freed this slot yet
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);   // Claimed by another producer
+            }
+        }
+        slot->item = item;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // --- Consumer side ---
+    // Oldest published record, or nullptr (a claimed but unpublished slot also stops here)
+    const T* peek() const {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        const Slot& slot = slots[pos & (N - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) return nullptr;
+        return &slot.item;
+    }
+
+    // Frees the record returned by peek()
+    void release() {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        slots[pos & (N - 1)].sequence.store(pos + N, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_release);
+    }
+
+    bool pop(T& out) {
+        const T* item = peek();
+        if (!item) return false;
+        out = *item;
+        release();
+        return true;
+    }
+
+    // LOG_OVERFLOW_DROP_OLDEST, done by the consumer: frees the oldest record unread
+    bool discardOldest() {
+        if (!peek()) return false;
+        release();
+        droppedOldest.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // LOG_OVERFLOW_DROP_OLDEST fallback: the incoming record was rejected, no slot could be freed
+    void countBusyDrop() { droppedBusy.fetch_add(1, std::memory_order_relaxed); }
+
+    size_t size() const {
+        size_t consumed = dequeuePos.load(std::memory_order_acquire);
+        size_t claimed = enqueuePos.load(std::memory_order_acquire);
+        return claimed - consumed;
+    }
+    static constexpr size_t capacity() { return N; }
+
+    uint32_t getDroppedNewest() const { return droppedNewest.load(std::memory_order_relaxed); }
+    uint32_t getDroppedOldest() const { return droppedOldest.load(std::memory_order_relaxed); }
+    uint32_t getDroppedBusy() const { return droppedBusy.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+    Slot slots[N];
+    std::atomic<size_t> enqueuePos;
+    std::atomic<size_t> dequeuePos;       // Written by the consumer only
+    std::atomic<uint32_t> droppedNewest;
+    std::atomic<uint32_t> droppedOldest;
+    std::atomic<uint32_t> droppedBusy;
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+#include "Logger.h"
+#include "LogRing.h"
+
+/**
+ * @file LogSink.h
+ * @brief Pluggable outputs of the logger (Logger::addSink).
+ *
+ * Every record that reaches Serial/SPIFFS is also handed to the registered sinks, from the
+ * LOG_* caller in sync mode or from the drain task in async mode. Sinks must not log.
+ *
+ * Encodings:
+ *   - LogTextSink: the Serial text line, fields appended as " key=value"
+ *   - LogJsonSink: one JSON object per line, fields as top-level members with their JSON type
+ *     (the SPIFFS files use the same encoding, see LOG_FILE_JSON)
+ *   - LogBinaryRingSink: LogBinaryRecord in a lock-free ring for an uploader task; fields stay
+ *     packed (LOG_FORMAT_ID_FIELDS), nothing is formatted
+ */
+
+class LogSink {
+public:
+    virtual ~LogSink() {}
+    virtual void write(const LogEntry& entry) = 0;
+    // Called after each record (sync mode) or batch (async mode); `urgent` after an ERROR
+    virtual void commit(bool urgent) { (void)urgent; }
+};
+
+class LogTextSink : public LogSink {
+public:
+    explicit LogTextSink(Print& out) : out(out) {}
+    void write(const LogEntry& entry) override;
+
+private:
+    Print& out;
+};
+
+class LogJsonSink : public LogSink {
+public:
+    explicit LogJsonSink(Print& out) : out(out) {}
+    void write(const LogEntry& entry) override;
+
+    /**
+     * @brief {"ts":"...","up":12345,"lvl":"INFO","src":"file.cpp:12","fn":"loop","msg":"...",<fields>}\n
+     * Always produces a complete line: the message is cut first, then the fields that do not fit.
+     */
+    static size_t format(const LogEntry& entry, char* buffer, size_t size);
+
+private:
+    Print& out;
+};
+
+// LOG_FORMAT_ID_FIELDS record ('s' event + pairs) for entries with fields, LOG_FORMAT_ID_TEXT otherwise
+void logEntryToBinary(const LogEntry& entry, LogBinaryRecord& record);
+
+template <size_t N>
+class LogBinaryRingSink : public LogSink {
+public:
+    explicit LogBinaryRingSink(LogOverflowPolicy policy = LOG_OVERFLOW_DROP_OLDEST) : policy(policy) {}
+
+    void write(const LogEntry& entry) override {
+        LogBinaryRecord record;
+        logEntryToBinary(entry, record);
+        ring.push(record, policy);
+    }
+
+    // Consumer side (one task)
+    bool pop(LogBinaryRecord& record) { return ring.pop(record); }
+    size_t size() const { return ring.size(); }
+    uint32_t getDropped() const { return ring.getDroppedNewest() + ring.getDroppedOldest(); }
+
+private:
+    LogRing<LogBinaryRecord, N> ring;
+    LogOverflowPolicy policy;
+};
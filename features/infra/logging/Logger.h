@@ -1,21 +1,135 @@
 #pragma once
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
 #include "FileLogger.h"
+#include "LogRing.h"
+#include "LogFormat.h"
+#include "LogCrashRing.h"
+#include "LogClock.h"
+#include "LogRateLimit.h"
 
 
 enum LogLevel { LOG_LEVEL_DEBUG = 0, LOG_LEVEL_INFO, LOG_LEVEL_WARNING, LOG_LEVEL_ERROR, LOG_LEVEL_NONE };
 
 const char* logLevelToString(LogLevel level);
 
+// Fixed-size storage for a history entry (override with -D to tune RAM usage)
+#ifndef LOG_TIMESTAMP_SIZE
+#define LOG_TIMESTAMP_SIZE LOG_CLOCK_TEXT_SIZE   // "YYYY-MM-DDTHH:MM:SS.mmmZ", see LogClock.h
+#endif
+#ifndef LOG_MESSAGE_SIZE
+#define LOG_MESSAGE_SIZE 128
+#endif
+
+// Async pipeline tuning
+#ifndef LOG_ASYNC_RING_SIZE
+#define LOG_ASYNC_RING_SIZE 32              // records per core, power of two
+#endif
+#ifndef LOG_ASYNC_FLUSH_INTERVAL_MS
+#define LOG_ASYNC_FLUSH_INTERVAL_MS 50      // max latency before the drain task wakes up
+#endif
+#ifndef LOG_ASYNC_TASK_STACK_SIZE
+#define LOG_ASYNC_TASK_STACK_SIZE 4096
+#endif
+
+// SPIFFS text files as JSON lines (/log_N.jsonl, see LogJsonSink) instead of the Serial text line
+#ifndef LOG_FILE_JSON
+#define LOG_FILE_JSON (!LOG_DEFERRED_FORMAT)
+#endif
+
+// Maximum number of sinks registered with addSink()
+#ifndef LOG_MAX_SINKS
+#define LOG_MAX_SINKS 4
+#endif
+
+// One producer ring per core (see Logger: "Concurrency")
+#ifndef LOG_CORE_COUNT
+#define LOG_CORE_COUNT portNUM_PROCESSORS
+#endif
+
+// Identical consecutive records (same site, level and text) are counted instead of written,
+// then summarized as "last message repeated N times" (see Logger::flushRepeats)
+#ifndef LOG_COALESCE_REPEATS
+#define LOG_COALESCE_REPEATS 1
+#endif
+#ifndef LOG_REPEAT_SUMMARY_MS
+#define LOG_REPEAT_SUMMARY_MS 10000         // a storm that does not stop still reports itself this often
+#endif
+
+// Longest line produced by formatEntry() / LogJsonSink::format()
+static constexpr size_t LOG_LINE_SIZE = 320;
+
+// Consumer output buffer: several lines are grouped into a single Serial write
+static constexpr size_t LOG_ASYNC_BATCH_SIZE = 1024;
+
+// Maximum number of per-tag runtime level overrides (see setTagLevel)
+#ifndef LOG_MAX_TAG_LEVELS
+#define LOG_MAX_TAG_LEVELS 8
+#endif
+
+/**
+ * @brief One log record, stored inline so that logging never touches the heap.
+ *
+ * `file` and `function` point to the `__FILE__` / `__FUNCTION__` literals of the
+ * call site (static storage), they are never copied.
+ *
+ * Structured records (logFields) keep their key/value pairs packed, unformatted, right after
+ * the NUL of `message` (LogArgPacker encoding, `fieldsLength` bytes).
+ */
 struct LogEntry {
-    String timestamp;
+    char timestamp[LOG_TIMESTAMP_SIZE];
+    uint32_t uptimeMs;                    // Same instant as `timestamp`, for the file index
     LogLevel level;
-    String file;
-    String function;
+    const char* file;
+    const char* function;
     int line;
-    String message;
+    char message[LOG_MESSAGE_SIZE];
+    uint8_t fieldsLength;                 // 0: plain record
+
+    const uint8_t* fields() const {
+        return reinterpret_cast<const uint8_t*>(message) + strnlen(message, sizeof(message)) + 1;
+    }
 };
 
+class LogSink;
+
+/**
+ * @brief Records dropped by the storm protections
+ */
+struct LogSuppressionStats {
+    uint32_t rateLimited;    // Calls dropped by a LOG_*_RATE token bucket
+    uint32_t coalesced;      // Repeats folded into a "last message repeated" summary
+    uint32_t summaries;      // Summary records written (repeats + rate-limit notices)
+};
+
+/**
+ * @brief Counters of the async pipeline
+ */
+struct LogAsyncStats {
+    uint32_t enqueued;       // Records accepted by the per-core rings
+    uint32_t droppedNewest;  // Records rejected (LOG_OVERFLOW_DROP_NEWEST)
+    uint32_t droppedOldest;  // Queued records discarded (LOG_OVERFLOW_DROP_OLDEST)
+    uint32_t droppedBusy;    // LOG_OVERFLOW_DROP_OLDEST fallback: incoming record rejected, the drain
+                             // task held the consumer role so no queued record could be discarded
+    uint32_t written;        // Records written out by the drain task
+    uint32_t batches;        // Drain cycles that wrote at least one record
+    size_t depth;            // Records currently queued
+    uint64_t busyUs;         // Time the drain task spent writing (CPU usage)
+};
+
+// Called by the drain task after each cycle (at least every LOG_ASYNC_FLUSH_INTERVAL_MS)
+typedef void (*LogTaskHook)(void* ctx);
+
+/**
+ * Concurrency: any task on any core may log. A LOG_* call formats on its own stack and pushes
+ * the record into the lock-free ring of its core (LogMpscRing); it never waits for another
+ * producer. The history, Serial, SPIFFS and the sinks have a single writer at a time, the
+ * "consumer": the drain task in async mode, otherwise the logging task itself when the consumer
+ * role is free (if it is taken, the current holder writes the record before letting it go).
+ * The consumer merges the per-core rings by timestamp, so the history stays in time order.
+ */
 class Logger {
 public:
     static Logger& getInstance();
@@ -25,10 +139,130 @@ public:
     void end();
 
     LogLevel getLevel() const;
+
+    /**
+     * @brief Runtime level override for one module tag (LOG_TAG of the calling file).
+     * LOG_LEVEL_NONE silences the tag; clearTagLevel() falls back to the global level.
+     */
+    bool setTagLevel(const char* tag, LogLevel level);
+    void clearTagLevel(const char* tag);
+
+    // Level check used by the LOG_* macros: tag override if any, global level otherwise
+    bool isEnabled(LogLevel level, const char* tag = nullptr) const {
+        if (level < lowestLevel) return false;   // Fast path, no override can enable it
+        if (tag && tagLevelCount > 0) {
+            for (size_t i = 0; i < tagLevelCount; ++i) {
+                if (tagLevels[i].tag == tag || strcmp(tagLevels[i].tag, tag) == 0) {
+                    return level >= tagLevels[i].level;
+                }
+            }
+        }
+        return level >= currentLevel;
+    }
+
     void log(LogLevel level, const char* file, const char* function, int line, const char* format, ...);
 
-    // Historique circulaire/logging API
-    void printLogHistory(Stream& out, size_t maxEntries = 0) const;
+    /**
+     * @brief Deferred-format logging (LOG_DEFERRED_FORMAT): records the format ID and the raw
+     * arguments only, formatting happens in the drain task or offline (see LogFormat.h).
+     */
+    template <typename... Args>
+    void logDeferred(LogLevel level, uint16_t formatId, const Args&... args) {
+        if (level < lowestLevel) return;
+        LogBinaryRecord record;
+        record.timestamp = millis();
+        record.formatId = formatId;
+        record.level = LOG_BINARY_SYNC | static_cast<uint8_t>(level);
+        LogArgPacker packer(record.payload, sizeof(record.payload));
+        packer.pack(args...);
+        record.length = static_cast<uint8_t>(packer.length());
+        submitBinary(record);
+    }
+    void submitBinary(const LogBinaryRecord& record);
+
+    /**
+     * @brief Structured record: `event` plus typed key/value pairs, kept packed (not formatted)
+     * until a sink renders them: " key=value" on Serial, JSON members in the SPIFFS files.
+     *   logFields(LOG_LEVEL_INFO, __FILE__, __FUNCTION__, __LINE__, "tx_start", "connectorId", 1, "power", 7.4);
+     * Keys must be literals; pairs that do not fit LOG_BINARY_PAYLOAD_SIZE are dropped.
+     */
+    template <typename... Args>
+    void logFields(LogLevel level, const char* file, const char* function, int line, const char* event,
+                   const Args&... fields) {
+        if (level < lowestLevel) return;
+        uint8_t packed[LOG_BINARY_PAYLOAD_SIZE];
+        LogArgPacker packer(packed, sizeof(packed));
+        packer.packFields(fields...);
+        submitFields(level, file, function, line, event, packed, packer.length());
+    }
+    void submitFields(LogLevel level, const char* file, const char* function, int line, const char* event,
+                      const uint8_t* fields, size_t fieldsLength);
+
+    /**
+     * @brief Additional outputs, called with every record written to Serial/SPIFFS
+     * (drain task in async mode). The sink must outlive its registration.
+     */
+    bool addSink(LogSink& sink);
+    void removeSink(LogSink& sink);
+
+    /**
+     * @brief Streams the SPIFFS records of boot `bootId` (LOG_BOOT_ANY: every boot) with uptime in
+     * [fromMs, toMs] and level >= minLevel (sparse index, see LogQuery.h). Returns the number of
+     * records written to `out`.
+     */
+    size_t queryLogs(uint32_t fromMs, uint32_t toMs, LogLevel minLevel, Print& out,
+                     uint32_t bootId = LogClock::getBootId());
+
+    /**
+     * @brief One step of a resumable query (console `logq`, see FileLogger::queryStep()): the
+     * consumer role is only held while one chunk is read, the matches are written out after it.
+     * A step is skipped while the role is busy. Returns false once the query is complete.
+     */
+    bool queryStep(LogQueryCursor& cursor);
+
+    /**
+     * @brief Gate of the LOG_*_RATE macros: spends a token of the call-site bucket.
+     * The first call allowed after drops logs "N messages suppressed (rate limit)" for the site.
+     */
+    bool rateLimitPass(LogRateLimiter& limiter, LogLevel level, const char* file, const char* function, int line);
+
+    // Writes the pending "last message repeated N times" summary, if any
+    void flushRepeats();
+    LogSuppressionStats getSuppressionStats() const {
+        return { rateLimited.load(std::memory_order_relaxed), coalesced.load(std::memory_order_relaxed),
+                 summaries.load(std::memory_order_relaxed) };
+    }
+
+    // Enables/disables the Serial echo (history is always recorded)
+    void setSerialEnabled(bool enabled) { serialEnabled = enabled; }
+
+    // --- Async pipeline ---
+    // log() only enqueues; a FreeRTOS task fills the history and writes Serial/SPIFFS in batches.
+    bool startAsync(LogOverflowPolicy policy = LOG_OVERFLOW_DROP_NEWEST,
+                    UBaseType_t priority = 1, BaseType_t core = tskNO_AFFINITY);
+    void stopAsync();   // Drains the backlog, then stops the task
+    bool isAsync() const { return asyncTask != nullptr; }
+    LogAsyncStats getAsyncStats() const;
+    TaskHandle_t getAsyncTask() const { return asyncTask; }
+    // E.g. to feed a task watchdog; set before startAsync(), nullptr to remove
+    void setAsyncTaskHook(LogTaskHook hook, void* ctx) {
+        asyncHookCtx = ctx;
+        asyncHook = hook;
+    }
+
+    // Historique circulaire/logging API (writes the pending records first, then prints in time order)
+    void printLogHistory(Stream& out, size_t maxEntries = 0);
+
+    /**
+     * @brief Incremental history reader (serial console). Records are numbered from boot:
+     * getHistorySequence() writes the pending records, then returns the number of the next one;
+     * readHistory() copies record `seq`, false if it is not (or no longer) in the history.
+     */
+    uint32_t getHistorySequence();
+    bool readHistory(uint32_t seq, LogEntry& out);
+
+    // Formats an entry as a single text line (with trailing '\n'), returns its length
+    static size_t formatEntry(const LogEntry& entry, char* buffer, size_t size);
 
     // --- Test support (getters for buffer inspection) ---
     static const size_t LOG_HISTORY_SIZE = 64; // <-- public constant
@@ -45,9 +279,104 @@ public:
 private:
     Logger();
     LogLevel currentLevel;
+    LogLevel lowestLevel;      // min(currentLevel, tag overrides): cheap pre-filter for log()
+
+    struct TagLevel {
+        const char* tag;
+        LogLevel level;
+    };
+    TagLevel tagLevels[LOG_MAX_TAG_LEVELS];
+    size_t tagLevelCount = 0;
+    void updateLowestLevel();
+    bool serialEnabled = true;
+    bool fileEnabled = false;
+
+    // --- Producer rings (one per core) and consumer role ---
+    LogMpscRing<LogEntry, LOG_ASYNC_RING_SIZE> entryRings[LOG_CORE_COUNT];
+    LogMpscRing<LogBinaryRecord, LOG_ASYNC_RING_SIZE> binaryRings[LOG_CORE_COUNT];
+    std::atomic<bool> consumerBusy{false};
+    std::atomic<TaskHandle_t> consumerOwner{nullptr};   // Detects a sink (or the file layer) logging from the consumer
+    char serialBatch[LOG_ASYNC_BATCH_SIZE];   // Consumer only: lines grouped into one Serial write
+    size_t serialBatchUsed = 0;
+    // Consumer only: state of the current log file
+    uint32_t definedFormats[LOG_FORMAT_REGISTRY_SIZE / 32] = {};   // Registry slots defined in the file
+    uint32_t fileGeneration = 0;      // FileLogger generation the state belongs to (0: marker not written)
+    uint32_t fileBootId = LogClock::getBootId();   // Boot of the records written now
+
+    // --- Async pipeline members ---
+    LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_DROP_NEWEST;
+    TaskHandle_t asyncTask = nullptr;
+    volatile bool asyncStopRequested = false;
+    std::atomic<uint32_t> asyncEnqueued{0};
+    uint32_t asyncWritten = 0;
+    uint32_t asyncBatches = 0;
+    uint64_t asyncBusyUs = 0;
+    volatile LogTaskHook asyncHook = nullptr;
+    void* volatile asyncHookCtx = nullptr;
+
+    LogSink* sinks[LOG_MAX_SINKS] = {};
+    size_t sinkCount = 0;
+
+    // --- Storm protection (rate limit at the call site, coalescing in the consumer) ---
+    struct RepeatState {
+        uint32_t hash;           // Text + fields (or format ID + payload) of the last record
+        const char* file;        // nullptr for deferred-format records (`line` = format ID)
+        const char* function;
+        int line;
+        uint8_t level;
+        uint32_t count;          // Repeats held back
+        uint32_t sinceMs;        // First held-back repeat
+    };
+    RepeatState repeat = { 0, nullptr, nullptr, 0, 0xFF, 0, 0 };   // Consumer only; 0xFF: no record yet
+    std::atomic<uint32_t> rateLimited{0};
+    std::atomic<uint32_t> coalesced{0};
+    std::atomic<uint32_t> summaries{0};
+    uint32_t lastCrashHash[LOG_CORE_COUNT] = {};                     // Repeats skip the RTC ring too
+    bool isRepeat(uint32_t hash, const char* file, const char* function, int line, uint8_t level, uint32_t nowMs);
+    void flushRepeatsLocked();
+
+    static void asyncTaskEntry(void* arg);
+    bool tryAcquireConsumer() {
+        if (consumerBusy.exchange(true, std::memory_order_seq_cst)) return false;
+        consumerOwner.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+        return true;
+    }
+    void acquireConsumer();
+    // Releases the role, then drains what was pushed meanwhile (sync mode)
+    void releaseConsumer();
+    void unlockConsumer() {
+        consumerOwner.store(nullptr, std::memory_order_relaxed);
+        consumerBusy.store(false, std::memory_order_seq_cst);
+    }
+    bool ownsConsumer() const {
+        return consumerBusy.load(std::memory_order_relaxed) &&
+               consumerOwner.load(std::memory_order_relaxed) == xTaskGetCurrentTaskHandle();
+    }
+    bool hasPending() const;
+    void drainFromProducer();
+    uint32_t drainLocked();
+    template <typename Ring, typename Record>
+    void enqueue(Ring& ring, const Record& record, bool urgent);
+    void recordCrash(uint8_t level, uint32_t timestamp, uint16_t formatId, const void* payload, size_t length);
+    LogEntry& reserveHistorySlot();
+    void dispatch(LogEntry& entry);
+    void writeEntry(const LogEntry& entry);
+    void flushSerialBatch();
+    void writeFile(const LogEntry& entry, const char* text, size_t len);
+    void writeSinks(const LogEntry& entry);
+    void emit(const LogEntry& entry);
+    void processBinary(const LogBinaryRecord& record);
+    void writeBinaryFile(const LogBinaryRecord& record);
+    void prepareFile(size_t len);
+    void setFileBoot(uint32_t bootId);
+    void writeSerial(const char* text, size_t len);
+    void commitFile(bool urgent);
+    void recoverCrashLog();
+    static void replayCrashSlot(const LogCrashSlot& slot, void* ctx);
 
     // --- Circular buffer members ---
     LogEntry history[LOG_HISTORY_SIZE];
     size_t historyHead = 0;    // Points to oldest
     size_t historyCount = 0;   // Number of stored entries (<= LOG_HISTORY_SIZE)
+    uint32_t historySequence = 0;   // Entries written since boot (number of the next one)
 };
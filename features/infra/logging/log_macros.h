@@ -1,7 +1,105 @@
 #pragma once
 #include "Logger.h"
 
-#define LOG_DEBUG(fmt, ...) Logger::getInstance().log(LOG_LEVEL_DEBUG, __FILE__, __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__)
-#define LOG_INFO(fmt, ...)  Logger::getInstance().log(LOG_LEVEL_INFO,  __FILE__, __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__)
-#define LOG_WARN(fmt, ...)  Logger::getInstance().log(LOG_LEVEL_WARNING, __FILE__, __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__)
-#define LOG_ERROR(fmt, ...) Logger::getInstance().log(LOG_LEVEL_ERROR, __FILE__, __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__)
+/*
+ * Level filtering happens in two stages:
+ *
+ * 1. Compile time: calls below the module floor (LOG_MODULE_LEVEL, defaults to LOG_COMPILE_LEVEL)
+ *    sit behind a constant-false condition. Arguments are never evaluated, and the format string
+ *    and __FILE__ are dropped from flash by the optimizer.
+ *    LOG_COMPILE_LEVEL follows the `-D LOG_LEVEL=N` build flag (0=ERROR, 1=WARN, 2=INFO,
+ *    3+=DEBUG/VERBOSE). Without the flag nothing is removed.
+ *
+ * 2. Run time: Logger::setLevel() and, per module, Logger::setTagLevel(LOG_TAG, level).
+ *
+ * Per-module usage, before including this header:
+ *   #define LOG_TAG "hardware"
+ *   #define LOG_MODULE_LEVEL LOG_LEVEL_DEBUG   // optional compile-time override
+ */
+
+#ifndef LOG_COMPILE_LEVEL
+#  if !defined(LOG_LEVEL)
+#    define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#  elif LOG_LEVEL >= 3
+#    define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#  elif LOG_LEVEL == 2
+#    define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#  elif LOG_LEVEL == 1
+#    define LOG_COMPILE_LEVEL LOG_LEVEL_WARNING
+#  else
+#    define LOG_COMPILE_LEVEL LOG_LEVEL_ERROR
+#  endif
+#endif
+
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_COMPILE_LEVEL
+#endif
+
+#ifndef LOG_TAG
+#define LOG_TAG nullptr   // Global level only
+#endif
+
+// Constant-folded first: disabled levels never reach the runtime check
+#define LOG_ENABLED(level) \
+    ((level) >= LOG_MODULE_LEVEL && Logger::getInstance().isEnabled(level, LOG_TAG))
+
+#if LOG_DEFERRED_FORMAT
+
+// Compile-time printf format check only (never called): deferred macros keep -Wformat warnings
+static inline void logFormatCheck(const char*, ...) __attribute__((format(printf, 1, 2)));
+static inline void logFormatCheck(const char*, ...) {}
+
+// Registers the format string once per call site, then records ID + raw arguments only
+#define LOG_AT(level, fmt, ...) do { \
+        if (LOG_ENABLED(level)) { \
+            if (false) logFormatCheck(fmt, ##__VA_ARGS__); \
+            static const uint16_t logFormatId_ = LogFormatRegistry::registerFormat(level, __FILE__, __LINE__, fmt); \
+            Logger::getInstance().logDeferred(level, logFormatId_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#else
+
+#define LOG_AT(level, fmt, ...) do { \
+        if (LOG_ENABLED(level)) { \
+            Logger::getInstance().log(level, __FILE__, __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#endif
+
+#define LOG_DEBUG(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT(LOG_LEVEL_WARNING, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+
+// Rate-limited call sites (hot loops): token bucket of `burst` records, one more every `intervalMs`.
+// Dropped calls cost one bucket update (arguments are not evaluated) and are reported by the next
+// record that passes. Identical consecutive records are also coalesced (LOG_COALESCE_REPEATS).
+//   LOG_WARN_RATE(1000, 3, "Watchdog %s en warning", name);
+#define LOG_AT_RATE(level, intervalMs, burst, fmt, ...) do { \
+        if (LOG_ENABLED(level)) { \
+            static LogRateLimiter logLimiter_(intervalMs, burst); \
+            if (Logger::getInstance().rateLimitPass(logLimiter_, level, __FILE__, __FUNCTION__, __LINE__)) { \
+                LOG_AT(level, fmt, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_DEBUG_RATE(intervalMs, burst, fmt, ...) LOG_AT_RATE(LOG_LEVEL_DEBUG, intervalMs, burst, fmt, ##__VA_ARGS__)
+#define LOG_INFO_RATE(intervalMs, burst, fmt, ...)  LOG_AT_RATE(LOG_LEVEL_INFO, intervalMs, burst, fmt, ##__VA_ARGS__)
+#define LOG_WARN_RATE(intervalMs, burst, fmt, ...)  LOG_AT_RATE(LOG_LEVEL_WARNING, intervalMs, burst, fmt, ##__VA_ARGS__)
+#define LOG_ERROR_RATE(intervalMs, burst, fmt, ...) LOG_AT_RATE(LOG_LEVEL_ERROR, intervalMs, burst, fmt, ##__VA_ARGS__)
+
+// Structured records: event + key/value pairs, packed unformatted (Logger::logFields)
+//   LOG_INFO_KV("tx_start", "connectorId", 1, "power", 7.4f);
+#define LOG_KV_AT(level, event, ...) do { \
+        if (LOG_ENABLED(level)) { \
+            Logger::getInstance().logFields(level, __FILE__, __FUNCTION__, __LINE__, event, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG_KV(event, ...) LOG_KV_AT(LOG_LEVEL_DEBUG, event, __VA_ARGS__)
+#define LOG_INFO_KV(event, ...)  LOG_KV_AT(LOG_LEVEL_INFO, event, __VA_ARGS__)
+#define LOG_WARN_KV(event, ...)  LOG_KV_AT(LOG_LEVEL_WARNING, event, __VA_ARGS__)
+#define LOG_ERROR_KV(event, ...) LOG_KV_AT(LOG_LEVEL_ERROR, event, __VA_ARGS__)
@@ -0,0 +1,150 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "hardware_manager.h"
+
+class WatchdogManager;
+
+/**
+ * @file SystemRuntime.h
+ * @brief FreeRTOS task topology: OCPP on core 0, metering on core 1, logging/flash in the background.
+ *
+ *   task       core  prio  role
+ *   ocpp       0     3     network + OCPP processing (ocppLoop hook), consumes the meter samples
+ *   metering   1     5     HardwareManager::updateMeasurements() every interval or on request
+ *   logger     0     1     Logger drain task: history, Serial and SPIFFS writes (Logger::startAsync)
+ *   loopTask   1     1     Arduino loop(): TaskScheduler jobs and the console (unchanged)
+ *
+ * The tasks only talk through two bounded queues: samples metering -> ocpp (oldest dropped when
+ * the OCPP side falls behind) and requests any task -> metering (immediate sample, new interval).
+ * Each task registers a WatchdogManager task watchdog and feeds it every cycle.
+ *
+ * CPU usage is measured by each task around its own work (esp_timer), so it works without
+ * configGENERATE_RUN_TIME_STATS; stack high-water marks come from uxTaskGetStackHighWaterMark().
+ */
+
+#ifndef RUNTIME_OCPP_CORE
+#define RUNTIME_OCPP_CORE 0
+#endif
+#ifndef RUNTIME_OCPP_PRIORITY
+#define RUNTIME_OCPP_PRIORITY 3
+#endif
+#ifndef RUNTIME_OCPP_STACK_SIZE
+#define RUNTIME_OCPP_STACK_SIZE 8192
+#endif
+#ifndef RUNTIME_OCPP_PERIOD_MS
+#define RUNTIME_OCPP_PERIOD_MS 10          // ocppLoop cadence when no sample arrives
+#endif
+#ifndef RUNTIME_METERING_CORE
+#define RUNTIME_METERING_CORE 1
+#endif
+#ifndef RUNTIME_METERING_PRIORITY
+#define RUNTIME_METERING_PRIORITY 5        // above loopTask (1): sampling is not delayed by the UI
+#endif
+#ifndef RUNTIME_METERING_STACK_SIZE
+#define RUNTIME_METERING_STACK_SIZE 4096
+#endif
+#ifndef RUNTIME_LOGGER_CORE
+#define RUNTIME_LOGGER_CORE 0
+#endif
+#ifndef RUNTIME_LOGGER_PRIORITY
+#define RUNTIME_LOGGER_PRIORITY 1
+#endif
+#ifndef RUNTIME_SAMPLE_QUEUE_LENGTH
+#define RUNTIME_SAMPLE_QUEUE_LENGTH 8
+#endif
+#ifndef RUNTIME_REQUEST_QUEUE_LENGTH
+#define RUNTIME_REQUEST_QUEUE_LENGTH 4
+#endif
+#ifndef RUNTIME_TASK_WDT_TIMEOUT_MS
+#define RUNTIME_TASK_WDT_TIMEOUT_MS 10000
+#endif
+
+enum RuntimeTaskId { RUNTIME_TASK_OCPP = 0, RUNTIME_TASK_METERING, RUNTIME_TASK_LOGGER, RUNTIME_TASK_COUNT };
+
+struct RuntimeTaskStats {
+    const char* name;
+    int core;
+    UBaseType_t priority;
+    bool running;
+    uint32_t stackFree;      // High-water mark: least free stack seen (bytes on ESP-IDF)
+    uint32_t cycles;
+    float cpuPercent;        // Busy time / wall time since begin(), of one core
+};
+
+struct RuntimeQueueStats {
+    uint32_t samplesSent;
+    uint32_t samplesDropped;     // Oldest samples overwritten because the OCPP task fell behind
+    uint32_t requestsDropped;    // requestSample()/setMeteringInterval() refused, queue full
+};
+
+class SystemRuntime {
+public:
+    // Runs in the ocpp task every cycle (e.g. OCPPWrapper::loop)
+    typedef void (*OcppLoopHook)(void* ctx);
+    // Runs in the metering task; false when no sample could be taken
+    typedef bool (*MeasureHook)(void* ctx, hardware_measurements_t& out);
+    // Runs in the ocpp task for each sample, in production order
+    typedef void (*SampleHook)(void* ctx, const hardware_measurements_t& sample);
+
+    struct Hooks {
+        OcppLoopHook ocppLoop;
+        MeasureHook measure;
+        SampleHook onSample;
+        void* ctx;
+    };
+
+    SystemRuntime();
+
+    /**
+     * @brief Creates the queues, registers the task watchdogs and starts the three tasks.
+     * @param watchdog nullptr to run without task watchdogs
+     */
+    bool begin(const Hooks& hooks, uint32_t meteringIntervalMs, WatchdogManager* watchdog = nullptr);
+
+    // Stops the ocpp and metering tasks and the async logger (pending samples are dropped)
+    void end();
+
+    // Any task: the metering task samples now and restarts its interval
+    bool requestSample();
+    bool setMeteringInterval(uint32_t intervalMs);
+
+    bool getTaskStats(RuntimeTaskId id, RuntimeTaskStats& out) const;
+    RuntimeQueueStats getQueueStats() const { return { samplesSent, samplesDropped, requestsDropped }; }
+    void printTaskStats(Print& out) const;
+
+private:
+    enum RequestType : uint8_t { REQUEST_SAMPLE, REQUEST_INTERVAL };
+    struct Request {
+        RequestType type;
+        uint32_t value;
+    };
+
+    struct TaskState {
+        TaskHandle_t handle;
+        int watchdogId;
+        volatile uint32_t cycles;
+        volatile uint64_t busyUs;
+    };
+
+    Hooks hooks;
+    WatchdogManager* watchdog;
+    QueueHandle_t sampleQueue;
+    QueueHandle_t requestQueue;
+    TaskState tasks[RUNTIME_TASK_COUNT];
+    uint32_t meteringIntervalMs;
+    int64_t startUs;
+    volatile bool stopRequested;
+    volatile uint32_t samplesSent;
+    volatile uint32_t samplesDropped;
+    volatile uint32_t requestsDropped;
+
+    static void ocppTaskEntry(void* arg);
+    static void meteringTaskEntry(void* arg);
+    static void loggerHook(void* ctx);
+    void publishSample(const hardware_measurements_t& sample);
+    void endCycle(RuntimeTaskId id, int64_t startUs);
+    bool sendRequest(RequestType type, uint32_t value);
+};
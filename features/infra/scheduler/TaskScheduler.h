@@ -0,0 +1,116 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/**
+ * @file TaskScheduler.h
+ * @brief Cooperative scheduler for the periodic jobs of loop() (blink, heartbeat, measurements,
+ * watchdog checks).
+ *
+ * Jobs sit in a fixed binary min-heap ordered by deadline, so runDue() only looks at the jobs that
+ * are due and returns the time left until the next one; idle() then sleeps exactly that long instead
+ * of a fixed delay(). wake() cuts the sleep short when something else needs loop() (serial input).
+ *
+ * - Drift-free: the next deadline is the previous deadline + period, not the time the job ran. A job
+ *   late by more than one period skips the missed runs (counted) and keeps its phase.
+ * - Same deadline: jobs run in the order they were (re)armed.
+ * - A job may call setPeriod()/runIn()/setEnabled() on itself or on others from its callback.
+ * - Single-threaded: all calls except wake() come from the task that calls runDue().
+ *
+ * The clock is injected (millis() by default) so tests drive it with a virtual clock.
+ */
+
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 16
+#endif
+#ifndef SCHEDULER_IDLE_MAX_MS
+#define SCHEDULER_IDLE_MAX_MS 1000    // longest sleep when no job is armed
+#endif
+
+static_assert(SCHEDULER_MAX_TASKS <= 127, "heap positions are stored on 8 bits");
+
+static const int SCHEDULER_INVALID_TASK = -1;
+
+typedef void (*ScheduledCallback)(void* ctx);
+typedef uint32_t (*SchedulerClock)();
+
+struct ScheduledTaskStats {
+    const char* name;
+    uint32_t periodMs;     // 0: one-shot
+    bool armed;
+    uint32_t runs;
+    uint32_t missed;       // Periods skipped because the job ran more than one period late
+    uint32_t maxLateMs;    // Worst delay between deadline and run
+};
+
+class TaskScheduler {
+public:
+    explicit TaskScheduler(SchedulerClock clock = millisClock);
+
+    /**
+     * @brief Registers a job, first run `firstDelayMs` from now.
+     * @param periodMs 0 for a one-shot job (re-armed with runIn())
+     * @return task id, SCHEDULER_INVALID_TASK when the table is full
+     */
+    int addTask(const char* name, uint32_t periodMs, ScheduledCallback callback, void* ctx = nullptr,
+                uint32_t firstDelayMs = 0);
+
+    // New period, next run one period from now (arms the job)
+    bool setPeriod(int id, uint32_t periodMs);
+
+    // Next run `delayMs` from now (arms the job), the period is kept
+    bool runIn(int id, uint32_t delayMs);
+
+    // Disarmed jobs keep their slot and statistics
+    bool setEnabled(int id, bool enabled);
+
+    /**
+     * @brief Runs every job whose deadline has passed, earliest first.
+     * @return milliseconds until the next deadline (SCHEDULER_IDLE_MAX_MS when nothing is armed)
+     */
+    uint32_t runDue();
+
+    uint32_t msUntilNext() const;
+
+    // Sleeps until the next deadline, at most `maxMs`, or until wake()
+    void idle(uint32_t maxMs = SCHEDULER_IDLE_MAX_MS);
+
+    // Ends the current idle() early; callable from any task (not from an ISR)
+    void wake();
+
+    size_t getTaskCount() const { return taskCount; }
+    bool getTaskStats(int id, ScheduledTaskStats& out) const;
+
+    static uint32_t millisClock() { return millis(); }
+
+private:
+    struct Task {
+        const char* name;
+        ScheduledCallback callback;
+        void* ctx;
+        uint32_t periodMs;
+        uint32_t deadline;
+        uint32_t order;         // Arming order, breaks deadline ties
+        int8_t heapPos;         // -1 when disarmed
+        uint32_t runs;
+        uint32_t missed;
+        uint32_t maxLateMs;
+    };
+
+    SchedulerClock clock;
+    Task tasks[SCHEDULER_MAX_TASKS];
+    uint8_t heap[SCHEDULER_MAX_TASKS];   // Task indices, earliest deadline at heap[0]
+    size_t taskCount = 0;
+    size_t heapSize = 0;
+    uint32_t nextOrder = 0;
+    volatile TaskHandle_t idleTask = nullptr;
+
+    bool validId(int id) const { return id >= 0 && static_cast<size_t>(id) < taskCount; }
+    bool before(uint8_t a, uint8_t b) const;
+    void arm(uint8_t index, uint32_t deadline);
+    void disarm(uint8_t index);
+    void place(size_t pos, uint8_t index);
+    void siftUp(size_t pos);
+    void siftDown(size_t pos);
+};
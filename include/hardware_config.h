@@ -103,6 +103,8 @@
 #define BLINK_INTERVAL_NORMAL   1000    // Clignotement normal (ms)
 #define BLINK_INTERVAL_FAST     200     // Clignotement rapide (ms)
 #define BLINK_INTERVAL_ERROR    100     // Clignotement erreur (ms)
+#define BUTTON_POLL_INTERVAL    20      // Scrutation du bouton (ms), < anti-rebond de 50 ms
+#define WDT_CHECK_INTERVAL      100     // Vérification des watchdogs logiciels (ms)
 
 // ============================================================================
 // SEUILS ET LIMITES
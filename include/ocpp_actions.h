@@ -0,0 +1,163 @@
+#ifndef OCPP_ACTIONS_H
+#define OCPP_ACTIONS_H
+
+/**
+ * @file ocpp_actions.h
+ * @brief Table des actions OCPP 1.6 : nom -> identifiant, Feature Profile, sens
+ *
+ * GÉNÉRÉ par scripts/gen_ocpp_actions.py depuis schemas/json : ne pas modifier à la main.
+ *
+ * ocppActionFind() : un hachage FNV-1a (graine choisie sans collision) et une comparaison,
+ * utilisable en constexpr. La table est vérifiée à la compilation (static_assert en fin de
+ * fichier).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "feature_profiles.h"
+
+typedef enum {
+    OCPP_ACTION_AUTHORIZE = 0,
+    OCPP_ACTION_BOOT_NOTIFICATION = 1,
+    OCPP_ACTION_CANCEL_RESERVATION = 2,
+    OCPP_ACTION_CHANGE_AVAILABILITY = 3,
+    OCPP_ACTION_CHANGE_CONFIGURATION = 4,
+    OCPP_ACTION_CLEAR_CACHE = 5,
+    OCPP_ACTION_CLEAR_CHARGING_PROFILE = 6,
+    OCPP_ACTION_DATA_TRANSFER = 7,
+    OCPP_ACTION_DIAGNOSTICS_STATUS_NOTIFICATION = 8,
+    OCPP_ACTION_FIRMWARE_STATUS_NOTIFICATION = 9,
+    OCPP_ACTION_GET_COMPOSITE_SCHEDULE = 10,
+    OCPP_ACTION_GET_CONFIGURATION = 11,
+    OCPP_ACTION_GET_DIAGNOSTICS = 12,
+    OCPP_ACTION_GET_LOCAL_LIST_VERSION = 13,
+    OCPP_ACTION_HEARTBEAT = 14,
+    OCPP_ACTION_METER_VALUES = 15,
+    OCPP_ACTION_REMOTE_START_TRANSACTION = 16,
+    OCPP_ACTION_REMOTE_STOP_TRANSACTION = 17,
+    OCPP_ACTION_RESERVE_NOW = 18,
+    OCPP_ACTION_RESET = 19,
+    OCPP_ACTION_SEND_LOCAL_LIST = 20,
+    OCPP_ACTION_SET_CHARGING_PROFILE = 21,
+    OCPP_ACTION_START_TRANSACTION = 22,
+    OCPP_ACTION_STATUS_NOTIFICATION = 23,
+    OCPP_ACTION_STOP_TRANSACTION = 24,
+    OCPP_ACTION_TRIGGER_MESSAGE = 25,
+    OCPP_ACTION_UNLOCK_CONNECTOR = 26,
+    OCPP_ACTION_UPDATE_FIRMWARE = 27,
+    OCPP_ACTION_COUNT = 28,
+    OCPP_ACTION_UNKNOWN = OCPP_ACTION_COUNT
+} ocpp_action_t;
+
+#define OCPP_ACTION_CP_TO_CS  0x01   // Émise par le point de charge
+#define OCPP_ACTION_CS_TO_CP  0x02   // Émise par le système central
+
+typedef struct {
+    const char* name;
+    uint8_t len;
+    feature_profile_id_t profile;
+    uint8_t message;                 // Valeur de l'énumération du profil (core_message_t, ...)
+    uint8_t direction;               // OCPP_ACTION_CP_TO_CS | OCPP_ACTION_CS_TO_CP
+} ocpp_action_info_t;
+
+// Triée par nom : indice = ocpp_action_t
+static constexpr ocpp_action_info_t OCPP_ACTIONS[OCPP_ACTION_COUNT] = {
+    { "Authorize", 9, FEATURE_PROFILE_CORE_ID, CORE_MSG_AUTHORIZE, OCPP_ACTION_CP_TO_CS },
+    { "BootNotification", 16, FEATURE_PROFILE_CORE_ID, CORE_MSG_BOOT_NOTIFICATION, OCPP_ACTION_CP_TO_CS },
+    { "CancelReservation", 17, FEATURE_PROFILE_RESERVATION_ID, RESERVATION_MSG_CANCEL_RESERVATION, OCPP_ACTION_CS_TO_CP },
+    { "ChangeAvailability", 18, FEATURE_PROFILE_CORE_ID, CORE_MSG_CHANGE_AVAILABILITY, OCPP_ACTION_CS_TO_CP },
+    { "ChangeConfiguration", 19, FEATURE_PROFILE_CORE_ID, CORE_MSG_CHANGE_CONFIGURATION, OCPP_ACTION_CS_TO_CP },
+    { "ClearCache", 10, FEATURE_PROFILE_CORE_ID, CORE_MSG_CLEAR_CACHE, OCPP_ACTION_CS_TO_CP },
+    { "ClearChargingProfile", 20, FEATURE_PROFILE_SMART_CHARGING_ID, SMART_CHARGING_MSG_CLEAR_CHARGING_PROFILE, OCPP_ACTION_CS_TO_CP },
+    { "DataTransfer", 12, FEATURE_PROFILE_CORE_ID, CORE_MSG_DATA_TRANSFER_CS, OCPP_ACTION_CP_TO_CS | OCPP_ACTION_CS_TO_CP },
+    { "DiagnosticsStatusNotification", 29, FEATURE_PROFILE_FIRMWARE_MANAGEMENT_ID, FIRMWARE_MSG_DIAGNOSTICS_STATUS_NOTIFICATION, OCPP_ACTION_CP_TO_CS },
+    { "FirmwareStatusNotification", 26, FEATURE_PROFILE_FIRMWARE_MANAGEMENT_ID, FIRMWARE_MSG_FIRMWARE_STATUS_NOTIFICATION, OCPP_ACTION_CP_TO_CS },
+    { "GetCompositeSchedule", 20, FEATURE_PROFILE_SMART_CHARGING_ID, SMART_CHARGING_MSG_GET_COMPOSITE_SCHEDULE, OCPP_ACTION_CS_TO_CP },
+    { "GetConfiguration", 16, FEATURE_PROFILE_CORE_ID, CORE_MSG_GET_CONFIGURATION, OCPP_ACTION_CS_TO_CP },
+    { "GetDiagnostics", 14, FEATURE_PROFILE_FIRMWARE_MANAGEMENT_ID, FIRMWARE_MSG_GET_DIAGNOSTICS, OCPP_ACTION_CS_TO_CP },
+    { "GetLocalListVersion", 19, FEATURE_PROFILE_LOCAL_AUTH_LIST_ID, LOCAL_AUTH_MSG_GET_LOCAL_LIST_VERSION, OCPP_ACTION_CS_TO_CP },
+    { "Heartbeat", 9, FEATURE_PROFILE_CORE_ID, CORE_MSG_HEARTBEAT, OCPP_ACTION_CP_TO_CS },
+    { "MeterValues", 11, FEATURE_PROFILE_CORE_ID, CORE_MSG_METER_VALUES, OCPP_ACTION_CP_TO_CS },
+    { "RemoteStartTransaction", 22, FEATURE_PROFILE_CORE_ID, CORE_MSG_REMOTE_START_TRANSACTION, OCPP_ACTION_CS_TO_CP },
+    { "RemoteStopTransaction", 21, FEATURE_PROFILE_CORE_ID, CORE_MSG_REMOTE_STOP_TRANSACTION, OCPP_ACTION_CS_TO_CP },
+    { "ReserveNow", 10, FEATURE_PROFILE_RESERVATION_ID, RESERVATION_MSG_RESERVE_NOW, OCPP_ACTION_CS_TO_CP },
+    { "Reset", 5, FEATURE_PROFILE_CORE_ID, CORE_MSG_RESET, OCPP_ACTION_CS_TO_CP },
+    { "SendLocalList", 13, FEATURE_PROFILE_LOCAL_AUTH_LIST_ID, LOCAL_AUTH_MSG_SEND_LOCAL_LIST, OCPP_ACTION_CS_TO_CP },
+    { "SetChargingProfile", 18, FEATURE_PROFILE_SMART_CHARGING_ID, SMART_CHARGING_MSG_SET_CHARGING_PROFILE, OCPP_ACTION_CS_TO_CP },
+    { "StartTransaction", 16, FEATURE_PROFILE_CORE_ID, CORE_MSG_START_TRANSACTION, OCPP_ACTION_CP_TO_CS },
+    { "StatusNotification", 18, FEATURE_PROFILE_CORE_ID, CORE_MSG_STATUS_NOTIFICATION, OCPP_ACTION_CP_TO_CS },
+    { "StopTransaction", 15, FEATURE_PROFILE_CORE_ID, CORE_MSG_STOP_TRANSACTION, OCPP_ACTION_CP_TO_CS },
+    { "TriggerMessage", 14, FEATURE_PROFILE_REMOTE_TRIGGER_ID, REMOTE_TRIGGER_MSG_TRIGGER_MESSAGE, OCPP_ACTION_CS_TO_CP },
+    { "UnlockConnector", 15, FEATURE_PROFILE_CORE_ID, CORE_MSG_UNLOCK_CONNECTOR, OCPP_ACTION_CS_TO_CP },
+    { "UpdateFirmware", 14, FEATURE_PROFILE_FIRMWARE_MANAGEMENT_ID, FIRMWARE_MSG_UPDATE_FIRMWARE, OCPP_ACTION_CS_TO_CP },
+};
+
+static constexpr uint32_t OCPP_ACTION_HASH_SEED = 687u;
+static constexpr size_t OCPP_ACTION_HASH_SIZE = 64;
+
+// Case du hachage -> indice dans OCPP_ACTIONS (0xFF : vide)
+static constexpr uint8_t OCPP_ACTION_SLOTS[OCPP_ACTION_HASH_SIZE] = {
+    0xFF, 0xFF, 0x07, 0x18, 0xFF, 0xFF, 0xFF, 0xFF, 0x19, 0x0F, 0x00, 0x01, 0xFF, 0x02, 0xFF, 0x04,
+    0xFF, 0x1A, 0xFF, 0x12, 0x0A, 0xFF, 0xFF, 0x06, 0xFF, 0xFF, 0x15, 0x0E, 0xFF, 0xFF, 0x0C, 0x09,
+    0xFF, 0x11, 0x1B, 0x10, 0xFF, 0xFF, 0xFF, 0x0D, 0xFF, 0xFF, 0x14, 0xFF, 0xFF, 0x13, 0x05, 0xFF,
+    0x17, 0xFF, 0xFF, 0xFF, 0x16, 0xFF, 0xFF, 0xFF, 0xFF, 0x0B, 0x03, 0xFF, 0xFF, 0x08, 0xFF, 0xFF,
+};
+
+// Fonctions constexpr C++11 (une seule expression) : récursion terminale, boucle une fois compilée
+constexpr uint32_t ocppActionHash(const char* name, size_t len, uint32_t hash) {
+    return len == 0 ? hash : ocppActionHash(name + 1, len - 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u);
+}
+
+constexpr bool ocppActionNameEquals(const char* a, const char* b, size_t len) {
+    return len == 0 || (*a == *b && ocppActionNameEquals(a + 1, b + 1, len - 1));
+}
+
+constexpr ocpp_action_t ocppActionAt(uint8_t index, const char* name, size_t len) {
+    return index < OCPP_ACTION_COUNT && OCPP_ACTIONS[index].len == len &&
+                   ocppActionNameEquals(OCPP_ACTIONS[index].name, name, len)
+               ? static_cast<ocpp_action_t>(index)
+               : OCPP_ACTION_UNKNOWN;
+}
+
+constexpr uint8_t ocppActionSlot(uint32_t hash) {
+    return OCPP_ACTION_SLOTS[(hash ^ (hash >> 16)) & (OCPP_ACTION_HASH_SIZE - 1)];
+}
+
+/**
+ * @brief Identifiant d'une action d'après son nom (non terminé par '\0')
+ * @return OCPP_ACTION_UNKNOWN si le nom n'est pas une action OCPP 1.6
+ */
+constexpr ocpp_action_t ocppActionFind(const char* name, size_t len) {
+    return ocppActionAt(ocppActionSlot(ocppActionHash(name, len, 2166136261u ^ OCPP_ACTION_HASH_SEED)), name, len);
+}
+
+static_assert(ocppActionFind("Authorize", 9) == OCPP_ACTION_AUTHORIZE, "Authorize");
+static_assert(ocppActionFind("BootNotification", 16) == OCPP_ACTION_BOOT_NOTIFICATION, "BootNotification");
+static_assert(ocppActionFind("CancelReservation", 17) == OCPP_ACTION_CANCEL_RESERVATION, "CancelReservation");
+static_assert(ocppActionFind("ChangeAvailability", 18) == OCPP_ACTION_CHANGE_AVAILABILITY, "ChangeAvailability");
+static_assert(ocppActionFind("ChangeConfiguration", 19) == OCPP_ACTION_CHANGE_CONFIGURATION, "ChangeConfiguration");
+static_assert(ocppActionFind("ClearCache", 10) == OCPP_ACTION_CLEAR_CACHE, "ClearCache");
+static_assert(ocppActionFind("ClearChargingProfile", 20) == OCPP_ACTION_CLEAR_CHARGING_PROFILE, "ClearChargingProfile");
+static_assert(ocppActionFind("DataTransfer", 12) == OCPP_ACTION_DATA_TRANSFER, "DataTransfer");
+static_assert(ocppActionFind("DiagnosticsStatusNotification", 29) == OCPP_ACTION_DIAGNOSTICS_STATUS_NOTIFICATION, "DiagnosticsStatusNotification");
+static_assert(ocppActionFind("FirmwareStatusNotification", 26) == OCPP_ACTION_FIRMWARE_STATUS_NOTIFICATION, "FirmwareStatusNotification");
+static_assert(ocppActionFind("GetCompositeSchedule", 20) == OCPP_ACTION_GET_COMPOSITE_SCHEDULE, "GetCompositeSchedule");
+static_assert(ocppActionFind("GetConfiguration", 16) == OCPP_ACTION_GET_CONFIGURATION, "GetConfiguration");
+static_assert(ocppActionFind("GetDiagnostics", 14) == OCPP_ACTION_GET_DIAGNOSTICS, "GetDiagnostics");
+static_assert(ocppActionFind("GetLocalListVersion", 19) == OCPP_ACTION_GET_LOCAL_LIST_VERSION, "GetLocalListVersion");
+static_assert(ocppActionFind("Heartbeat", 9) == OCPP_ACTION_HEARTBEAT, "Heartbeat");
+static_assert(ocppActionFind("MeterValues", 11) == OCPP_ACTION_METER_VALUES, "MeterValues");
+static_assert(ocppActionFind("RemoteStartTransaction", 22) == OCPP_ACTION_REMOTE_START_TRANSACTION, "RemoteStartTransaction");
+static_assert(ocppActionFind("RemoteStopTransaction", 21) == OCPP_ACTION_REMOTE_STOP_TRANSACTION, "RemoteStopTransaction");
+static_assert(ocppActionFind("ReserveNow", 10) == OCPP_ACTION_RESERVE_NOW, "ReserveNow");
+static_assert(ocppActionFind("Reset", 5) == OCPP_ACTION_RESET, "Reset");
+static_assert(ocppActionFind("SendLocalList", 13) == OCPP_ACTION_SEND_LOCAL_LIST, "SendLocalList");
+static_assert(ocppActionFind("SetChargingProfile", 18) == OCPP_ACTION_SET_CHARGING_PROFILE, "SetChargingProfile");
+static_assert(ocppActionFind("StartTransaction", 16) == OCPP_ACTION_START_TRANSACTION, "StartTransaction");
+static_assert(ocppActionFind("StatusNotification", 18) == OCPP_ACTION_STATUS_NOTIFICATION, "StatusNotification");
+static_assert(ocppActionFind("StopTransaction", 15) == OCPP_ACTION_STOP_TRANSACTION, "StopTransaction");
+static_assert(ocppActionFind("TriggerMessage", 14) == OCPP_ACTION_TRIGGER_MESSAGE, "TriggerMessage");
+static_assert(ocppActionFind("UnlockConnector", 15) == OCPP_ACTION_UNLOCK_CONNECTOR, "UnlockConnector");
+static_assert(ocppActionFind("UpdateFirmware", 14) == OCPP_ACTION_UPDATE_FIRMWARE, "UpdateFirmware");
+
+#endif // OCPP_ACTIONS_H
@@ -59,6 +59,7 @@
 #define OCPP_RECONNECT_DELAY_MS         5000    // 5 secondes
 #define OCPP_MAX_MESSAGE_SIZE           2048    // Bytes
 #define OCPP_MESSAGE_QUEUE_SIZE         10      // Nombre de messages
+#define OCPP_MAX_IN_FLIGHT              1       // CALL sans réponse simultanés (OCPP-J : 1)
 
 // Configuration des identifiants
 #define CHARGE_POINT_ID_MAX_LENGTH      20
@@ -76,15 +77,7 @@
 // ============================================================================
 // CONFIGURATION LOGGING
 // ============================================================================
-typedef enum {
-    LOG_LEVEL_ERROR = 0,
-    LOG_LEVEL_WARNING = 1,
-    LOG_LEVEL_INFO = 2,
-    LOG_LEVEL_DEBUG = 3,
-    LOG_LEVEL_VERBOSE = 4
-} log_level_t;
-
-#define LOG_LEVEL                       LOG_LEVEL_INFO
+// Niveaux : LogLevel (Logger.h) ; plancher de compilation : -D LOG_LEVEL=0..4, 0=ERROR, 4=VERBOSE (log_macros.h)
 #define LOG_BUFFER_SIZE                 512
 #define LOG_TIMESTAMP_ENABLED           1
 
@@ -94,7 +87,7 @@ typedef enum {
 #define STORAGE_PARTITION_SIZE          1048576  // 1MB
 #define STORAGE_MAX_FILES               100
 #define STORAGE_CONFIG_FILE             "/config.json"
-#define STORAGE_AUTH_CACHE_FILE         "/auth_cache.json"
+#define STORAGE_AUTH_CACHE_FILE         "/auth_cache.bin"
 #define STORAGE_TRANSACTION_FILE        "/transactions.json"
 
 // ============================================================================
@@ -102,8 +95,14 @@ typedef enum {
 // ============================================================================
 #define MAX_CONNECTORS                  2       // Nombre de connecteurs
 #define CONNECTOR_ID_CHARGE_POINT       0       // ID du Charge Point
+#define CONNECTOR_ENERGY_FLOW_MIN_W     50      // En dessous, pendant une transaction : SuspendedEV
 #define METER_VALUES_INTERVAL           60      // Secondes
 #define CLOCK_ALIGNED_DATA_INTERVAL     900     // 15 minutes
+#ifndef METER_VALUES_BATCHING_ENABLED
+#define METER_VALUES_BATCHING_ENABLED   0       // 1 : relevés regroupés par lots (-D METER_VALUES_BATCHING_ENABLED=1)
+#endif
+#define METER_VALUES_BATCH_MAX          4       // Relevés par MeterValues quand le regroupement est actif
+#define METER_VALUES_BATCH_WINDOW_MS    300000  // Attente maximale d'un relevé avant envoi (5 minutes)
 
 // ============================================================================
 // CONFIGURATION SMART CHARGING
@@ -117,6 +116,7 @@ typedef enum {
 // ============================================================================
 #define BOOT_NOTIFICATION_RETRY_INTERVAL 60000  // 1 minute
 #define TRANSACTION_MESSAGE_RETRY_INTERVAL 30000 // 30 secondes
+#define TRANSACTION_MESSAGE_ATTEMPTS    3       // Envois d'un message de transaction avant abandon
 #define STATUS_NOTIFICATION_DEBOUNCE    1000    // 1 seconde
 
 // ============================================================================
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""
+Vérifie que les formats des LOG_* n'entrent pas en collision (mode LOG_DEFERRED_FORMAT=1).
+
+L'ID d'un format est le hachage de la chaîne (FNV-1a 32 bits replié sur 16 bits, cf.
+src/LogFormat.cpp) : il ne dépend ni du boot ni de l'ordre d'enregistrement. Deux formats
+différents avec le même ID ne peuvent pas être décodés sans ambiguïté ; le second enregistré
+recevrait LOG_FORMAT_ID_UNKNOWN. Ce script calcule l'ID de chaque format littéral des sources et
+échoue si deux formats différents partagent un ID : il suffit alors de reformuler l'un des deux.
+
+Usage:
+    python3 scripts/check_log_formats.py            # échoue (code 1) en cas de collision
+    python3 scripts/check_log_formats.py --list     # affiche aussi l'ID de chaque format
+
+Également exécuté par PlatformIO avant chaque compilation (extra_scripts = pre:...).
+"""
+
+import argparse
+import os
+import re
+import sys
+
+SOURCE_DIRS = ["src", "include", "features", "lib"]
+EXTENSIONS = (".cpp", ".c", ".h", ".hpp", ".ino")
+SKIPPED = {"log_macros.h"}
+
+# IDs réservés (LogFormat.h) : LOG_FORMAT_ID_TEXT, LOG_FORMAT_ID_BOOT, LOG_FORMAT_ID_FIELDS, LOG_FORMAT_ID_UNKNOWN
+RESERVED = {0x0000, 0xFFFD, 0xFFFE, 0xFFFF}
+
+CALL_RE = re.compile(r"\bLOG_(?:DEBUG|INFO|WARN|ERROR)(_RATE)?\s*\(")
+ESCAPES = {"n": 10, "t": 9, "r": 13, "0": 0, "\\": 92, "\"": 34, "'": 39, "a": 7, "b": 8, "f": 12, "v": 11, "?": 63}
+
+
+def format_id(data):
+    """Même calcul que hashFormat() + remplacement des IDs réservés dans registerFormat()."""
+    h = 2166136261
+    for byte in data:
+        h ^= byte
+        h = (h * 16777619) & 0xFFFFFFFF
+    fmt_id = (h >> 16) ^ (h & 0xFFFF)
+    return 1 if fmt_id in RESERVED else fmt_id
+
+
+def strip_comments(text):
+    """Retire les commentaires ; les chaînes et les numéros de ligne sont conservés."""
+    out, i, n = [], 0, len(text)
+    while i < n:
+        c = text[i]
+        if c == '"' or c == "'":
+            j = i + 1
+            while j < n and text[j] != c:
+                j += 2 if text[j] == "\\" else 1
+            out.append(text[i:j + 1])
+            i = j + 1
+        elif text.startswith("//", i):
+            j = text.find("\n", i)
+            i = n if j < 0 else j
+        elif text.startswith("/*", i):
+            j = text.find("*/", i + 2)
+            j = n if j < 0 else j + 2
+            out.append("\n" * text.count("\n", i, j))
+            i = j
+        else:
+            out.append(c)
+            i += 1
+    return "".join(out)
+
+
+def skip_argument(text, i):
+    """Avance après un argument (jusqu'à la virgule de même niveau), ou None."""
+    depth = 0
+    while i < len(text):
+        c = text[i]
+        if c == '"' or c == "'":
+            i += 1
+            while i < len(text) and text[i] != c:
+                i += 2 if text[i] == "\\" else 1
+        elif c in "([{":
+            depth += 1
+        elif c in ")]}":
+            if depth == 0:
+                return None
+            depth -= 1
+        elif c == "," and depth == 0:
+            return i + 1
+        i += 1
+    return None
+
+
+def read_literal(text, i):
+    """Concatène les littéraux adjacents à partir de i ; None si l'argument n'est pas un littéral pur."""
+    data = bytearray()
+    found = False
+    while True:
+        while i < len(text) and text[i].isspace():
+            i += 1
+        if i >= len(text) or text[i] != '"':
+            break
+        found = True
+        i += 1
+        while i < len(text) and text[i] != '"':
+            c = text[i]
+            if c != "\\":
+                data += c.encode("utf-8")
+                i += 1
+                continue
+            e = text[i + 1]
+            if e == "x":
+                m = re.match(r"[0-9a-fA-F]+", text[i + 2:])
+                data.append(int(m.group(0), 16) & 0xFF)
+                i += 2 + len(m.group(0))
+            elif e in "01234567":
+                m = re.match(r"[0-7]{1,3}", text[i + 1:])
+                data.append(int(m.group(0), 8) & 0xFF)
+                i += 1 + len(m.group(0))
+            else:
+                data.append(ESCAPES.get(e, ord(e)))
+                i += 2
+        i += 1
+    if not found or i >= len(text) or text[i] not in ",)":
+        return None
+    return bytes(data)
+
+
+def scan(root):
+    """Retourne [(format, site)] pour chaque appel LOG_* dont le format est un littéral."""
+    formats = []
+    for directory in SOURCE_DIRS:
+        for base, _dirs, files in os.walk(os.path.join(root, directory)):
+            for name in sorted(files):
+                if not name.endswith(EXTENSIONS) or name in SKIPPED:
+                    continue
+                path = os.path.join(base, name)
+                with open(path, encoding="utf-8", errors="replace") as f:
+                    text = strip_comments(f.read())
+                for m in CALL_RE.finditer(text):
+                    i = m.end()
+                    if m.group(1):  # _RATE : intervalMs, burst, puis le format
+                        i = skip_argument(text, i)
+                        i = skip_argument(text, i) if i is not None else None
+                    fmt = read_literal(text, i) if i is not None else None
+                    if fmt is None:
+                        continue
+                    line = text.count("\n", 0, m.start()) + 1
+                    formats.append((fmt, "%s:%d" % (os.path.relpath(path, root), line)))
+    return formats
+
+
+def check(root, listing=False, out=sys.stdout):
+    by_id = {}
+    for fmt, site in scan(root):
+        by_id.setdefault(format_id(fmt), {}).setdefault(fmt, []).append(site)
+    collisions = 0
+    for fmt_id in sorted(by_id):
+        entries = by_id[fmt_id]
+        if listing:
+            for fmt, sites in entries.items():
+                out.write("%5d\t%s\t%s\n" % (fmt_id, sites[0], fmt.decode("utf-8", errors="replace")))
+        if len(entries) > 1:
+            collisions += 1
+            sys.stderr.write("collision d'ID de format %d :\n" % fmt_id)
+            for fmt, sites in entries.items():
+                sys.stderr.write("    %s  %r\n" % (", ".join(sites), fmt.decode("utf-8", errors="replace")))
+    return collisions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Vérifie l'unicité des IDs de format des LOG_*")
+    parser.add_argument("--list", action="store_true", help="affiche l'ID de chaque format")
+    args = parser.parse_args()
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    sys.exit(1 if check(root, args.list) else 0)
+
+
+if __name__ == "__main__":
+    main()
+elif "Import" in globals():
+    # Script PlatformIO : arrête la compilation en cas de collision
+    Import("env")  # noqa: F821
+    if check(env.subst("$PROJECT_DIR")):  # noqa: F821
+        env.Exit(1)  # noqa: F821
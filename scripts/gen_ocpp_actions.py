@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+Génère include/ocpp_actions.h depuis les schémas OCPP 1.6 (schemas/json).
+
+Une action par schéma de requête (<Action>.json, titre "<Action>Request", avec son
+<Action>Response.json). Le Feature Profile et le sens de chaque action viennent de
+FEATURE_PROFILES_MAPPING.md (table PROFILES ci-dessous) ; une action sans profil, ou un profil
+sans schéma, arrête la génération.
+
+L'en-tête contient une table constexpr triée par nom et un hachage parfait : FNV-1a 32 bits
+initialisé par une graine, cherchée ici pour que chaque action tombe dans une case distincte
+d'une table de HASH_SIZE cases. La recherche d'une action coûte donc un hachage et une
+comparaison ; des static_assert vérifient la table à la compilation.
+
+Usage:
+    python3 scripts/gen_ocpp_actions.py            # écrit include/ocpp_actions.h
+    python3 scripts/gen_ocpp_actions.py --check    # échoue si l'en-tête n'est pas à jour
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SCHEMA_DIR = os.path.join(ROOT, "schemas", "json")
+OUTPUT = os.path.join(ROOT, "include", "ocpp_actions.h")
+
+CP_TO_CS, CS_TO_CP = 1, 2
+
+# Profil (feature_profile_id_t, préfixe de l'énumération de feature_profiles.h) -> actions et sens
+PROFILES = [
+    ("FEATURE_PROFILE_CORE_ID", "CORE_MSG_", {
+        "Authorize": CP_TO_CS, "BootNotification": CP_TO_CS, "DataTransfer": CP_TO_CS | CS_TO_CP,
+        "Heartbeat": CP_TO_CS, "MeterValues": CP_TO_CS, "StartTransaction": CP_TO_CS,
+        "StatusNotification": CP_TO_CS, "StopTransaction": CP_TO_CS, "ChangeAvailability": CS_TO_CP,
+        "ChangeConfiguration": CS_TO_CP, "ClearCache": CS_TO_CP, "GetConfiguration": CS_TO_CP,
+        "RemoteStartTransaction": CS_TO_CP, "RemoteStopTransaction": CS_TO_CP, "Reset": CS_TO_CP,
+        "UnlockConnector": CS_TO_CP,
+    }),
+    ("FEATURE_PROFILE_FIRMWARE_MANAGEMENT_ID", "FIRMWARE_MSG_", {
+        "UpdateFirmware": CS_TO_CP, "GetDiagnostics": CS_TO_CP,
+        "FirmwareStatusNotification": CP_TO_CS, "DiagnosticsStatusNotification": CP_TO_CS,
+    }),
+    ("FEATURE_PROFILE_LOCAL_AUTH_LIST_ID", "LOCAL_AUTH_MSG_", {
+        "GetLocalListVersion": CS_TO_CP, "SendLocalList": CS_TO_CP,
+    }),
+    ("FEATURE_PROFILE_REMOTE_TRIGGER_ID", "REMOTE_TRIGGER_MSG_", {
+        "TriggerMessage": CS_TO_CP,
+    }),
+    ("FEATURE_PROFILE_RESERVATION_ID", "RESERVATION_MSG_", {
+        "ReserveNow": CS_TO_CP, "CancelReservation": CS_TO_CP,
+    }),
+    ("FEATURE_PROFILE_SMART_CHARGING_ID", "SMART_CHARGING_MSG_", {
+        "SetChargingProfile": CS_TO_CP, "ClearChargingProfile": CS_TO_CP, "GetCompositeSchedule": CS_TO_CP,
+    }),
+]
+
+# DataTransfer existe dans les deux sens ; la table garde l'identifiant du sens reçu (CS -> CP)
+MESSAGE_OVERRIDES = {"DataTransfer": "CORE_MSG_DATA_TRANSFER_CS"}
+
+HASH_SIZE = 64
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+
+def snake(name):
+    return re.sub(r"(?<=[a-z])(?=[A-Z])", "_", name).upper()
+
+
+def fnv1a(name, seed):
+    h = (FNV_OFFSET ^ seed) & 0xFFFFFFFF
+    for c in name.encode("ascii"):
+        h = ((h ^ c) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+# Les bits de poids faible d'un FNV ne dépendent que des bits de poids faible : repli des 16 bits hauts
+def slot_of(name, seed):
+    h = fnv1a(name, seed)
+    return (h ^ (h >> 16)) % HASH_SIZE
+
+
+def find_seed(names):
+    for seed in range(1 << 20):
+        slots = {slot_of(n, seed) for n in names}
+        if len(slots) == len(names):
+            return seed
+    raise SystemExit("aucune graine sans collision : augmenter HASH_SIZE")
+
+
+def load_actions():
+    actions = []
+    for path in sorted(glob.glob(os.path.join(SCHEMA_DIR, "*.json"))):
+        stem = os.path.splitext(os.path.basename(path))[0]
+        if stem.endswith("Response"):
+            continue
+        with open(path, encoding="utf-8") as f:
+            title = json.load(f).get("title")
+        if title != stem + "Request":
+            raise SystemExit(f"{path}: titre {title!r}, attendu {stem}Request")
+        if not os.path.exists(os.path.join(SCHEMA_DIR, stem + "Response.json")):
+            raise SystemExit(f"{stem}: schéma de réponse manquant")
+        actions.append(stem)
+
+    known = {}
+    for profile, prefix, entries in PROFILES:
+        for name, direction in entries.items():
+            message = MESSAGE_OVERRIDES.get(name, prefix + snake(name))
+            known[name] = (profile, message, direction)
+    missing = sorted(set(actions) - set(known))
+    extra = sorted(set(known) - set(actions))
+    if missing or extra:
+        raise SystemExit(f"schémas sans profil : {missing}, profils sans schéma : {extra}")
+    return [(name,) + known[name] for name in sorted(actions)]
+
+
+def render(actions):
+    names = [a[0] for a in actions]
+    seed = find_seed(names)
+    slots = [0xFF] * HASH_SIZE
+    for index, name in enumerate(names):
+        slots[slot_of(name, seed)] = index
+
+    out = []
+    w = out.append
+    w("#ifndef OCPP_ACTIONS_H")
+    w("#define OCPP_ACTIONS_H")
+    w("")
+    w("/**")
+    w(" * @file ocpp_actions.h")
+    w(" * @brief Table des actions OCPP 1.6 : nom -> identifiant, Feature Profile, sens")
+    w(" *")
+    w(" * GÉNÉRÉ par scripts/gen_ocpp_actions.py depuis schemas/json : ne pas modifier à la main.")
+    w(" *")
+    w(" * ocppActionFind() : un hachage FNV-1a (graine choisie sans collision) et une comparaison,")
+    w(" * utilisable en constexpr. La table est vérifiée à la compilation (static_assert en fin de")
+    w(" * fichier).")
+    w(" */")
+    w("")
+    w("#include <stddef.h>")
+    w("#include <stdint.h>")
+    w('#include "feature_profiles.h"')
+    w("")
+    w("typedef enum {")
+    for index, name in enumerate(names):
+        w(f"    OCPP_ACTION_{snake(name)} = {index},")
+    w(f"    OCPP_ACTION_COUNT = {len(names)},")
+    w("    OCPP_ACTION_UNKNOWN = OCPP_ACTION_COUNT")
+    w("} ocpp_action_t;")
+    w("")
+    w("#define OCPP_ACTION_CP_TO_CS  0x01   // Émise par le point de charge")
+    w("#define OCPP_ACTION_CS_TO_CP  0x02   // Émise par le système central")
+    w("")
+    w("typedef struct {")
+    w("    const char* name;")
+    w("    uint8_t len;")
+    w("    feature_profile_id_t profile;")
+    w("    uint8_t message;                 // Valeur de l'énumération du profil (core_message_t, ...)")
+    w("    uint8_t direction;               // OCPP_ACTION_CP_TO_CS | OCPP_ACTION_CS_TO_CP")
+    w("} ocpp_action_info_t;")
+    w("")
+    w("// Triée par nom : indice = ocpp_action_t")
+    w("static constexpr ocpp_action_info_t OCPP_ACTIONS[OCPP_ACTION_COUNT] = {")
+    for name, profile, message, direction in actions:
+        flags = " | ".join(f for bit, f in ((CP_TO_CS, "OCPP_ACTION_CP_TO_CS"), (CS_TO_CP, "OCPP_ACTION_CS_TO_CP"))
+                           if direction & bit)
+        w(f'    {{ "{name}", {len(name)}, {profile}, {message}, {flags} }},')
+    w("};")
+    w("")
+    w(f"static constexpr uint32_t OCPP_ACTION_HASH_SEED = {seed}u;")
+    w(f"static constexpr size_t OCPP_ACTION_HASH_SIZE = {HASH_SIZE};")
+    w("")
+    w("// Case du hachage -> indice dans OCPP_ACTIONS (0xFF : vide)")
+    w("static constexpr uint8_t OCPP_ACTION_SLOTS[OCPP_ACTION_HASH_SIZE] = {")
+    for i in range(0, HASH_SIZE, 16):
+        w("    " + ", ".join(f"0x{s:02X}" for s in slots[i:i + 16]) + ",")
+    w("};")
+    w("")
+    w("// Fonctions constexpr C++11 (une seule expression) : récursion terminale, boucle une fois compilée")
+    w("constexpr uint32_t ocppActionHash(const char* name, size_t len, uint32_t hash) {")
+    w(f"    return len == 0 ? hash : ocppActionHash(name + 1, len - 1, (hash ^ static_cast<uint8_t>(*name)) * {FNV_PRIME}u);")
+    w("}")
+    w("")
+    w("constexpr bool ocppActionNameEquals(const char* a, const char* b, size_t len) {")
+    w("    return len == 0 || (*a == *b && ocppActionNameEquals(a + 1, b + 1, len - 1));")
+    w("}")
+    w("")
+    w("constexpr ocpp_action_t ocppActionAt(uint8_t index, const char* name, size_t len) {")
+    w("    return index < OCPP_ACTION_COUNT && OCPP_ACTIONS[index].len == len &&")
+    w("                   ocppActionNameEquals(OCPP_ACTIONS[index].name, name, len)")
+    w("               ? static_cast<ocpp_action_t>(index)")
+    w("               : OCPP_ACTION_UNKNOWN;")
+    w("}")
+    w("")
+    w("constexpr uint8_t ocppActionSlot(uint32_t hash) {")
+    w("    return OCPP_ACTION_SLOTS[(hash ^ (hash >> 16)) & (OCPP_ACTION_HASH_SIZE - 1)];")
+    w("}")
+    w("")
+    w("/**")
+    w(" * @brief Identifiant d'une action d'après son nom (non terminé par '\\0')")
+    w(" * @return OCPP_ACTION_UNKNOWN si le nom n'est pas une action OCPP 1.6")
+    w(" */")
+    w("constexpr ocpp_action_t ocppActionFind(const char* name, size_t len) {")
+    w(f"    return ocppActionAt(ocppActionSlot(ocppActionHash(name, len, {FNV_OFFSET}u ^ OCPP_ACTION_HASH_SEED)), name, len);")
+    w("}")
+    w("")
+    for name in names:
+        w(f'static_assert(ocppActionFind("{name}", {len(name)}) == OCPP_ACTION_{snake(name)}, "{name}");')
+    w("")
+    w("#endif // OCPP_ACTIONS_H")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Génère include/ocpp_actions.h depuis schemas/json")
+    parser.add_argument("--check", action="store_true", help="vérifie que l'en-tête est à jour")
+    args = parser.parse_args()
+
+    actions = load_actions()
+    text = render(actions)
+    if args.check:
+        with open(OUTPUT, encoding="utf-8") as f:
+            if f.read() != text:
+                sys.exit(f"{OUTPUT} n'est pas à jour : relancer scripts/gen_ocpp_actions.py")
+        return
+    with open(OUTPUT, "w", encoding="utf-8") as f:
+        f.write(text)
+    print(f"{OUTPUT}: {len(actions)} actions")
+
+
+if __name__ == "__main__":
+    main()
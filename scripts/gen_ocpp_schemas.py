@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+Génère src/ocpp_wrapper/ocpp_schemas.cpp depuis les schémas OCPP 1.6 (schemas/json).
+
+Chaque schéma (requête <Action>.json, réponse <Action>Response.json) devient une suite de nœuds
+ocpp_schema_node_t (ocpp_validator.h) : type, obligatoire, additionalProperties, maxLength,
+valeurs d'enum, format date-time/uri, multipleOf 0.1. Les enfants d'un objet sont contigus ; les
+listes d'enum identiques sont partagées. OcppValidator parcourt ces tables sur un JsonDocument.
+
+Un mot-clé de schéma non pris en charge arrête la génération : le validateur ne doit pas
+accepter en silence une contrainte qu'il ne vérifie pas.
+
+Usage:
+    python3 scripts/gen_ocpp_schemas.py            # écrit src/ocpp_wrapper/ocpp_schemas.cpp
+    python3 scripts/gen_ocpp_schemas.py --check    # échoue si le fichier n'est pas à jour
+"""
+
+import argparse
+import json
+import os
+import sys
+
+from gen_ocpp_actions import ROOT, SCHEMA_DIR, load_actions, snake
+
+OUTPUT = os.path.join(ROOT, "src", "ocpp_wrapper", "ocpp_schemas.cpp")
+
+SUPPORTED_KEYWORDS = {"$schema", "id", "title", "type", "properties", "additionalProperties", "required",
+                      "enum", "maxLength", "format", "items", "multipleOf"}
+TYPES = {"object": "OCPP_SCHEMA_OBJECT", "array": "OCPP_SCHEMA_ARRAY", "string": "OCPP_SCHEMA_STRING",
+         "integer": "OCPP_SCHEMA_INTEGER", "number": "OCPP_SCHEMA_NUMBER", "boolean": "OCPP_SCHEMA_BOOLEAN"}
+FORMATS = {"date-time": "OCPP_SCHEMA_DATE_TIME", "uri": "OCPP_SCHEMA_URI"}
+
+
+class Tables:
+    def __init__(self):
+        self.nodes = []          # (name, type, flags, maxLength, first, count, comment)
+        self.enums = []          # valeurs, listes partagées bout à bout
+        self.enum_lists = {}     # tuple(valeurs) -> indice de la première
+
+    def enum_index(self, values):
+        key = tuple(values)
+        if key not in self.enum_lists:
+            self.enum_lists[key] = len(self.enums)
+            self.enums.extend(values)
+        return self.enum_lists[key]
+
+    def add_root(self, schema, where):
+        index = len(self.nodes)
+        self.nodes.append(None)
+        self.fill(index, None, schema, False, where)
+        return index
+
+    def fill(self, index, name, schema, required, where):
+        unknown = set(schema) - SUPPORTED_KEYWORDS
+        if unknown:
+            raise SystemExit(f"{where}: mots-clés non pris en charge {sorted(unknown)}")
+        kind = schema.get("type")
+        if kind not in TYPES:
+            raise SystemExit(f"{where}: type {kind!r} non pris en charge")
+
+        flags = []
+        if required:
+            flags.append("OCPP_SCHEMA_REQUIRED")
+        if "format" in schema:
+            if schema["format"] not in FORMATS:
+                raise SystemExit(f"{where}: format {schema['format']!r} non pris en charge")
+            flags.append(FORMATS[schema["format"]])
+        if "multipleOf" in schema:
+            if schema["multipleOf"] != 0.1:
+                raise SystemExit(f"{where}: multipleOf {schema['multipleOf']} non pris en charge")
+            flags.append("OCPP_SCHEMA_DECIMAL")
+
+        first = count = 0
+        if kind == "object":
+            if schema.get("additionalProperties", True) is False:
+                flags.append("OCPP_SCHEMA_CLOSED")
+            props = list(schema.get("properties", {}).items())
+            needed = schema.get("required", [])
+            missing = set(needed) - {k for k, _ in props}
+            if missing:
+                raise SystemExit(f"{where}: required sans propriété {sorted(missing)}")
+            if len(props) > 255:
+                raise SystemExit(f"{where}: trop de propriétés")
+            first, count = len(self.nodes), len(props)
+            self.nodes.extend([None] * count)
+            for i, (key, child) in enumerate(props):
+                self.fill(first + i, key, child, key in needed, f"{where}.{key}")
+        elif kind == "array":
+            first, count = len(self.nodes), 1
+            self.nodes.append(None)
+            self.fill(first, None, schema["items"], False, where + "[]")
+        elif "enum" in schema:
+            if kind != "string" or len(schema["enum"]) > 255:
+                raise SystemExit(f"{where}: enum non pris en charge")
+            first, count = self.enum_index(schema["enum"]), len(schema["enum"])
+
+        max_length = schema.get("maxLength", 0)
+        if max_length > 0xFFFF or first > 0xFFFF:
+            raise SystemExit(f"{where}: valeur hors des champs 16 bits")
+        self.nodes[index] = (name, TYPES[kind], " | ".join(flags) or "0", max_length, first, count, where)
+
+
+def render(actions):
+    tables = Tables()
+    roots = []
+    for name, *_ in actions:
+        pair = []
+        for suffix in ("", "Response"):
+            with open(os.path.join(SCHEMA_DIR, name + suffix + ".json"), encoding="utf-8") as f:
+                pair.append(tables.add_root(json.load(f), name + suffix))
+        roots.append((name, pair))
+
+    out = []
+    w = out.append
+    w("/**")
+    w(" * @file ocpp_schemas.cpp")
+    w(" * @brief Tables de validation des charges utiles OCPP 1.6")
+    w(" *")
+    w(" * GÉNÉRÉ par scripts/gen_ocpp_schemas.py depuis schemas/json : ne pas modifier à la main.")
+    w(" */")
+    w("")
+    w('#include "ocpp_validator.h"')
+    w("")
+    w(f"const char* const OCPP_SCHEMA_ENUMS[{len(tables.enums)}] = {{")
+    for start in sorted(tables.enum_lists.values()):
+        values = next(k for k, v in tables.enum_lists.items() if v == start)
+        line = f"    /* {start:3} */"
+        for value in values:
+            if len(line) + len(value) + 4 > 110:
+                w(line)
+                line = " " * 13
+            line += f' "{value}",'
+        w(line)
+    w("};")
+    w("")
+    w(f"const ocpp_schema_node_t OCPP_SCHEMA_NODES[{len(tables.nodes)}] = {{")
+    for index, (name, kind, flags, max_length, first, count, where) in enumerate(tables.nodes):
+        label = f'"{name}"' if name else "nullptr"
+        w(f"    /* {index:3} */ {{ {label}, {kind}, {flags}, {max_length}, {first}, {count} }},   // {where}")
+    w("};")
+    w("")
+    w("const uint16_t OCPP_SCHEMA_ROOTS[OCPP_ACTION_COUNT][OCPP_SCHEMA_KIND_COUNT] = {")
+    for name, (request, response) in roots:
+        w(f"    {{ {request}, {response} }},   // OCPP_ACTION_{snake(name)}")
+    w("};")
+    return "\n".join(out) + "\n", len(tables.nodes), len(tables.enums)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Génère src/ocpp_wrapper/ocpp_schemas.cpp depuis schemas/json")
+    parser.add_argument("--check", action="store_true", help="vérifie que le fichier est à jour")
+    args = parser.parse_args()
+
+    text, nodes, enums = render(load_actions())
+    if args.check:
+        with open(OUTPUT, encoding="utf-8") as f:
+            if f.read() != text:
+                sys.exit(f"{OUTPUT} n'est pas à jour : relancer scripts/gen_ocpp_schemas.py")
+        return
+    with open(OUTPUT, "w", encoding="utf-8") as f:
+        f.write(text)
+    print(f"{OUTPUT}: {nodes} nœuds, {enums} valeurs d'enum")
+
+
+if __name__ == "__main__":
+    main()
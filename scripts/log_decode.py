@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+Décodeur hors-ligne des logs binaires (mode LOG_DEFERRED_FORMAT=1).
+
+Lit les fichiers /log_N.bin récupérés depuis le SPIFFS de l'ESP32 et reformate chaque
+enregistrement. Chaque fichier contient ses propres définitions de formats (enregistrement de
+niveau 0xF placé avant le premier usage d'un format dans le fichier) ; une définition absente du
+fichier est cherchée dans les autres fichiers, puis dans le dictionnaire --dict des anciens
+firmwares (/log_fmt.txt). Les archives compressées /logz_<seq>.bin.lz sont décompressées à la
+volée (cf. log_unpack.py).
+
+Usage:
+    python3 scripts/log_decode.py log_0.bin log_1.bin ...
+    python3 scripts/log_decode.py --dir ./spiffs_dump      # logz_*.bin.lz puis log_*.bin du dossier
+    python3 scripts/log_decode.py --dict log_fmt.txt log_0.bin    # anciens fichiers sans définitions
+
+Format d'un enregistrement (little-endian), cf. features/infra/logging/LogFormat.h :
+    uint32 timestamp_ms | uint16 format_id | uint8 0xA0|level | uint8 length | payload[length]
+Définition : niveau DEFINITION, payload "level\tfichier:ligne\tformat".
+Marqueur de boot (début de chaque fichier, FORMAT_ID_BOOT) : affiché "[boot 1a2b3c4d]", les temps
+repartent de zéro après lui ; "[boot ffffffff]" précède les enregistrements rejoués d'un boot antérieur.
+"""
+
+import argparse
+import glob
+import os
+import re
+import struct
+import sys
+
+from log_unpack import archive_sequence, read_log
+
+LEVELS = ["DEBUG", "INFO", "WARN", "ERROR", "NONE"]
+SYNC = 0xA0
+FORMAT_ID_TEXT = 0
+FORMAT_ID_FIELDS = 0xFFFE
+FORMAT_ID_BOOT = 0xFFFD
+DEFINITION = 0x0F
+HEADER = struct.Struct("<IHBB")
+
+SPEC_RE = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(?:hh|h|ll|l|L|q|j|z|t)?([diouxXeEfFgGaAcsp%])")
+
+
+def unescape(text):
+    out, i = [], 0
+    while i < len(text):
+        c = text[i]
+        if c == "\\" and i + 1 < len(text):
+            out.append({"n": "\n", "r": "\r", "t": "\t", "\\": "\\"}.get(text[i + 1], text[i + 1]))
+            i += 2
+        else:
+            out.append(c)
+            i += 1
+    return "".join(out)
+
+
+def load_dictionary(path):
+    """id -> [(format, site)] ; plusieurs entrées possibles si l'ID a changé entre deux firmwares."""
+    formats = {}
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            parts = line.rstrip("\n").split("\t", 3)
+            if len(parts) != 4:
+                continue
+            fmt_id, _level, site, fmt = parts
+            fmt = unescape(fmt)
+            entries = formats.setdefault(int(fmt_id), [])
+            if (fmt, site) not in entries:
+                entries.append((fmt, site))
+    return formats
+
+
+def unpack_args(payload):
+    args, i = [], 0
+    while i < len(payload):
+        tag = chr(payload[i])
+        i += 1
+        if tag in "iup":
+            fmt = {"i": "<i", "u": "<I", "p": "<I"}[tag]
+            if i + 4 > len(payload):
+                break
+            args.append((tag, struct.unpack_from(fmt, payload, i)[0]))
+            i += 4
+        elif tag in "lLd":
+            fmt = {"l": "<q", "L": "<Q", "d": "<d"}[tag]
+            if i + 8 > len(payload):
+                break
+            args.append((tag, struct.unpack_from(fmt, payload, i)[0]))
+            i += 8
+        elif tag == "s":
+            if i >= len(payload):
+                break
+            n = payload[i]
+            args.append((tag, payload[i + 1:i + 1 + n].decode("utf-8", errors="replace")))
+            i += 1 + n
+        else:
+            break
+    return args
+
+
+def render(fmt, args):
+    args = list(args)
+
+    def take():
+        return args.pop(0) if args else None
+
+    def repl(m):
+        flags, width, precision, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if width == "*":
+            arg = take()
+            width = str(arg[1]) if arg else ""
+        if precision == "*":
+            arg = take()
+            precision = str(arg[1]) if arg else ""
+        arg = take()
+        if arg is None:
+            return "<?>"
+        tag, value = arg
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+        if tag == "p" or conv == "p":
+            return "0x%08x" % value
+        if tag == "s":
+            return (spec + "s") % value
+        if tag == "d":
+            return (spec + (conv if conv in "eEfFgG" else "g")) % value
+        if conv in "di":
+            return (spec + "d") % value
+        if conv == "u":
+            return (spec + "d") % (value & 0xFFFFFFFFFFFFFFFF if tag in "lL" else value & 0xFFFFFFFF)
+        if conv == "c":
+            return chr(value & 0xFF)
+        if conv in "oxX":
+            mask = 0xFFFFFFFFFFFFFFFF if tag in "lL" else 0xFFFFFFFF
+            return (spec + conv) % (value & mask)
+        return (spec + "d") % value
+
+    return SPEC_RE.sub(repl, fmt)
+
+
+def render_fields(args):
+    """'s' événement puis paires ('s' clé, valeur) -> "événement clé=valeur ..." (comme Logger::formatEntry)."""
+    if not args or args[0][0] != "s":
+        return ""
+    parts = [args[0][1]]
+    for (_, key), (tag, value) in zip(args[1::2], args[2::2]):
+        if tag == "d":
+            value = "%g" % value
+        elif tag == "p":
+            value = "0x%08x" % value
+        parts.append("%s=%s" % (key, value))
+    return " ".join(parts)
+
+
+def read_records(path):
+    """(timestamp, fmt_id, niveau, payload) de chaque enregistrement valide du fichier."""
+    try:
+        data = read_log(path)
+    except ValueError as e:
+        sys.stderr.write("%s: %s\n" % (path, e))
+        return
+    pos, skipped = 0, 0
+    while pos + HEADER.size <= len(data):
+        timestamp, fmt_id, level_byte, length = HEADER.unpack_from(data, pos)
+        if (level_byte & 0xF0) != SYNC or pos + HEADER.size + length > len(data):
+            pos += 1  # Resynchronisation après un enregistrement corrompu
+            skipped += 1
+            continue
+        yield timestamp, fmt_id, level_byte & 0x0F, data[pos + HEADER.size:pos + HEADER.size + length]
+        pos += HEADER.size + length
+    if skipped:
+        sys.stderr.write("%s: %d octets ignorés (resynchronisation)\n" % (path, skipped))
+
+
+def parse_definition(payload):
+    """(format, site) d'un enregistrement de définition, ou None."""
+    parts = payload.decode("utf-8", errors="replace").split("\t", 2)
+    return (parts[2], parts[1]) if len(parts) == 3 else None
+
+
+def load_definitions(paths, formats):
+    """Ajoute à formats les définitions de tous les fichiers (repli pour les enregistrements
+    dont le fichier ne contient pas la définition, p. ex. rejoués depuis le crash ring)."""
+    for path in paths:
+        for _timestamp, fmt_id, level, payload in read_records(path):
+            definition = parse_definition(payload) if level == DEFINITION and fmt_id != FORMAT_ID_BOOT else None
+            if definition:
+                entries = formats.setdefault(fmt_id, [])
+                if definition not in entries:
+                    entries.append(definition)
+
+
+def decode_file(path, formats, out):
+    local = {}  # Définitions de ce fichier : prioritaires
+    for timestamp, fmt_id, level_nibble, payload in read_records(path):
+        if level_nibble == DEFINITION and fmt_id == FORMAT_ID_BOOT and len(payload) == 4:
+            out.write("[boot %08x]\n" % struct.unpack("<I", payload)[0])
+            continue
+        if level_nibble == DEFINITION:
+            definition = parse_definition(payload)
+            if definition:
+                local[fmt_id] = definition
+            continue
+        level = LEVELS[level_nibble] if level_nibble < len(LEVELS) else "UNK"
+        seconds, ms = divmod(timestamp, 1000)
+        minutes, seconds = divmod(seconds, 60)
+        hours, minutes = divmod(minutes, 60)
+        stamp = "%02d:%02d:%02d.%03d" % (hours, minutes, seconds, ms)
+
+        if fmt_id == FORMAT_ID_TEXT:
+            site, message = "-", payload.decode("utf-8", errors="replace")
+        elif fmt_id == FORMAT_ID_FIELDS:
+            site, message = "-", render_fields(unpack_args(payload))
+        elif fmt_id in local:
+            fmt, site = local[fmt_id]
+            message = render(fmt, unpack_args(payload))
+        elif fmt_id in formats:
+            candidates = formats[fmt_id]
+            fmt, site = candidates[-1]
+            message = render(fmt, unpack_args(payload))
+            if len(set(f for f, _ in candidates)) > 1:
+                site += " (ambiguous id %d)" % fmt_id
+        else:
+            site = "?"
+            message = "<fmt#%d> %s" % (fmt_id, " ".join(str(v) for _, v in unpack_args(payload)))
+        out.write("[%s] [%s] %s: %s\n" % (stamp, level, site, message))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Décode les logs binaires /log_N.bin")
+    parser.add_argument("files", nargs="*", help="fichiers log_N.bin / logz_N.bin.lz (ordre conservé)")
+    parser.add_argument("--dict", help="dictionnaire des anciens firmwares (log_fmt.txt), facultatif")
+    parser.add_argument("--dir", help="dossier contenant logz_*.bin.lz et log_*.bin (et log_fmt.txt s'il existe)")
+    args = parser.parse_args()
+
+    files = list(args.files)
+    dict_path = args.dict
+    if args.dir:
+        files += sorted(glob.glob(os.path.join(args.dir, "logz_*.bin.lz")), key=archive_sequence)
+        files += sorted(glob.glob(os.path.join(args.dir, "log_*.bin")))
+        legacy = os.path.join(args.dir, "log_fmt.txt")
+        if not dict_path and os.path.exists(legacy):
+            dict_path = legacy
+    if not files:
+        parser.error("préciser des fichiers, ou --dir")
+
+    formats = load_dictionary(dict_path) if dict_path else {}
+    load_definitions(files, formats)
+    for path in files:
+        decode_file(path, formats, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
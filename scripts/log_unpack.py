@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Décompression hors-ligne des archives de logs (/logz_<seq>.txt.lz, /logz_<seq>.bin.lz).
+
+Les fichiers de log fermés sont compressés par l'ESP32 (LZSS, cf.
+features/infra/logging/LogCompressor.h). Ce script restitue le texte original,
+ou le flux binaire pour les archives .bin.lz (à passer ensuite à log_decode.py,
+qui accepte aussi directement les .lz).
+
+Usage:
+    python3 scripts/log_unpack.py logz_12.txt.lz logz_13.txt.lz      # sur stdout
+    python3 scripts/log_unpack.py --dir ./spiffs_dump                # archives puis log_*.jsonl / .txt, dans l'ordre
+    python3 scripts/log_unpack.py --extract ./spiffs_dump/*.lz       # écrit logz_12.txt à côté de chaque archive
+
+Format : "LZS1" | uint32 taille originale | groupes de 8 jetons précédés d'un octet de drapeaux
+(bit i = 1 : littéral d'un octet ; 0 : référence big-endian (distance - 1) << 5 | (longueur - 3)).
+"""
+
+import argparse
+import glob
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"LZS1"
+LENGTH_BITS = 5
+MIN_MATCH = 3
+
+
+def decompress(data):
+    """Retourne les octets décompressés ; lève ValueError si l'archive est invalide ou tronquée."""
+    if len(data) < 8 or data[:4] != MAGIC:
+        raise ValueError("en-tête LZS1 absent")
+    (original_size,) = struct.unpack_from("<I", data, 4)
+    out = bytearray()
+    pos = 8
+    while pos < len(data):
+        flags = data[pos]
+        pos += 1
+        for bit in range(8):
+            if pos >= len(data):
+                break
+            if flags & (1 << bit):
+                out.append(data[pos])
+                pos += 1
+                continue
+            if pos + 2 > len(data):
+                raise ValueError("référence tronquée")
+            token = (data[pos] << 8) | data[pos + 1]
+            pos += 2
+            distance = (token >> LENGTH_BITS) + 1
+            length = (token & ((1 << LENGTH_BITS) - 1)) + MIN_MATCH
+            if distance > len(out):
+                raise ValueError("référence hors du flux")
+            for _ in range(length):
+                out.append(out[-distance])
+    if original_size and len(out) != original_size:
+        raise ValueError("taille %d au lieu de %d" % (len(out), original_size))
+    return bytes(out)
+
+
+def read_log(path):
+    """Contenu d'un fichier de log, décompressé si c'est une archive .lz."""
+    with open(path, "rb") as f:
+        data = f.read()
+    return decompress(data) if path.endswith(".lz") else data
+
+
+def archive_sequence(path):
+    m = re.search(r"logz_(\d+)\.", os.path.basename(path))
+    return int(m.group(1)) if m else -1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Décompresse les archives de logs /logz_<seq>.*.lz")
+    parser.add_argument("files", nargs="*", help="archives .lz (ou fichiers en clair, recopiés tels quels)")
+    parser.add_argument("--dir", help="dossier : archives dans l'ordre des séquences, puis log_*.jsonl / log_*.txt")
+    parser.add_argument("--extract", action="store_true", help="écrit <archive sans .lz> au lieu de stdout")
+    args = parser.parse_args()
+
+    files = list(args.files)
+    if args.dir:
+        for suffix in (".jsonl", ".txt"):
+            files += sorted(glob.glob(os.path.join(args.dir, "logz_*%s.lz" % suffix)), key=archive_sequence)
+            files += sorted(glob.glob(os.path.join(args.dir, "log_*%s" % suffix)))
+    if not files:
+        parser.error("préciser des fichiers ou --dir")
+
+    status = 0
+    for path in files:
+        try:
+            data = read_log(path)
+        except ValueError as e:
+            sys.stderr.write("%s: %s\n" % (path, e))
+            status = 1
+            continue
+        if args.extract and path.endswith(".lz"):
+            with open(path[:-3], "wb") as f:
+                f.write(data)
+        else:
+            sys.stdout.buffer.write(data)
+    sys.exit(status)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,300 @@
+#include "ConsoleCommands.h"
+#include <FS.h>
+#include <SPIFFS.h>
+#include <new>
+#include "Logger.h"
+#include "LogCompressor.h"
+#include "LogQuery.h"
+#include "hardware_manager.h"
+#include "power_manager.h"
+#include "watchdog_manager.h"
+#include "SystemRuntime.h"
+#include "ocpp_wrapper.h"
+
+// Compressed bytes decoded per step: a few match tokens plus what the decoder still buffers
+static const size_t CONSOLE_LZ_STEP = 8;
+static_assert((CONSOLE_LZ_STEP / 2 + 1) * LOG_LZ_MAX_MATCH + LOG_LZ_CHUNK_SIZE <= CONSOLE_JOB_CHUNK,
+              "CONSOLE_LZ_STEP too large for one console job step");
+// A query step writes out at most one output buffer, plus the final count
+static_assert(LOG_QUERY_CHUNK_SIZE <= CONSOLE_JOB_CHUNK, "LOG_QUERY_CHUNK_SIZE too large for one console job step");
+// Wait for the ocpp task to take its statistics snapshot (ocppLoop runs every RUNTIME_OCPP_PERIOD_MS)
+static const uint32_t CONSOLE_OCPP_STATS_TIMEOUT_MS = 1000;
+
+namespace {
+
+// "help": one command per step
+class HelpJob : public ConsoleJob {
+public:
+    void start(const SerialConsole& console) {
+        commands = &console;
+        next = 0;
+    }
+
+    bool step(Print& out) override {
+        if (next >= commands->getCommandCount()) return false;
+        const ConsoleCommand& command = commands->getCommand(next++);
+        char buffer[128];   // Print::printf() would allocate past 64 bytes
+        int len = snprintf(buffer, sizeof(buffer), "  %-8s %s\n", command.name, command.help);
+        out.write(reinterpret_cast<const uint8_t*>(buffer), len < static_cast<int>(sizeof(buffer)) ? len : sizeof(buffer) - 1);
+        return next < commands->getCommandCount();
+    }
+
+private:
+    const SerialConsole* commands = nullptr;
+    size_t next = 0;
+};
+
+// "log <fichier>": plain files in chunks, `.lz` archives through a streaming decoder
+class FileDumpJob : public ConsoleJob {
+public:
+    bool start(const char* filename, Print& out) {
+        file = SPIFFS.open(filename, FILE_READ);
+        if (!file) {
+            out.printf("❌ Unable to open %s\n", filename);
+            return false;
+        }
+        size_t nameLen = strlen(filename);
+        compressed = nameLen > 3 && strcmp(filename + nameLen - 3, ".lz") == 0;
+        if (compressed) {
+            // Constructed per dump: the decoder writes straight into the console
+            decoder = new (decoderStorage) LogLzDecoder(out);
+            out.printf("\n📄 Contenu de %s (décompressé) :\n", filename);
+        } else {
+            out.printf("\n📄 Contenu de %s :\n", filename);
+        }
+        return true;
+    }
+
+    bool step(Print& out) override {
+        if (compressed) {
+            uint8_t chunk[CONSOLE_LZ_STEP];
+            size_t n = file.read(chunk, sizeof(chunk));
+            if (n > 0) {
+                decoder->write(chunk, n);
+                if (decoder->isValid()) return true;
+            }
+            decoder->finish();
+            if (!decoder->isValid()) {
+                out.println("\n❌ Archive corrompue ou tronquée");
+            }
+            close();
+            return false;
+        }
+
+        uint8_t chunk[CONSOLE_JOB_CHUNK];
+        size_t n = file.read(chunk, sizeof(chunk));
+        if (n > 0) {
+            out.write(chunk, n);
+            return true;
+        }
+        close();
+        return false;
+    }
+
+    void cancel() override { close(); }
+
+private:
+    File file;
+    bool compressed = false;
+    LogLzDecoder* decoder = nullptr;
+    alignas(LogLzDecoder) uint8_t decoderStorage[sizeof(LogLzDecoder)];
+
+    void close() {
+        file.close();
+        if (decoder) {
+            decoder->~LogLzDecoder();
+            decoder = nullptr;
+        }
+    }
+};
+
+// "history [n]": one record per step, read by sequence number so that new records do not shift it
+class HistoryJob : public ConsoleJob {
+public:
+    void start(size_t maxEntries) {
+        Logger& logger = Logger::getInstance();
+        end = logger.getHistorySequence();
+        size_t count = logger.getHistoryCount();
+        if (maxEntries > 0 && maxEntries < count) count = maxEntries;
+        next = end - static_cast<uint32_t>(count);
+        lost = 0;
+    }
+
+    bool step(Print& out) override {
+        Logger& logger = Logger::getInstance();
+        LogEntry entry;
+        while (next != end && !logger.readHistory(next, entry)) {
+            next++;   // Overwritten by newer records while the dump was running
+            lost++;
+        }
+        if (next == end) {
+            if (lost > 0) {
+                out.printf("⚠️ %lu entrée(s) écrasée(s) pendant l'affichage\n", static_cast<unsigned long>(lost));
+            }
+            return false;
+        }
+        char buffer[LOG_LINE_SIZE];
+        out.write(reinterpret_cast<const uint8_t*>(buffer), Logger::formatEntry(entry, buffer, sizeof(buffer)));
+        next++;
+        return true;
+    }
+
+private:
+    uint32_t next = 0;
+    uint32_t end = 0;
+    uint32_t lost = 0;
+};
+
+// "logq <début_s> <fin_s> [LEVEL] [all]": one chunk of one log file per step, the Logger files are
+// only held by the console while that chunk is read
+class QueryJob : public ConsoleJob {
+public:
+    void start(uint32_t fromMs, uint32_t toMs, LogLevel minLevel, uint32_t bootId, Print& out) {
+        cursor = new (cursorStorage) LogQueryCursor(fromMs, toMs, minLevel, LOG_DEFERRED_FORMAT, out, bootId);
+    }
+
+    bool step(Print& out) override {
+        if (Logger::getInstance().queryStep(*cursor)) return true;
+        out.printf("🔎 %lu enregistrement(s)\n", static_cast<unsigned long>(cursor->getStats().recordsMatched));
+        close();
+        return false;
+    }
+
+    void cancel() override { close(); }
+
+private:
+    LogQueryCursor* cursor = nullptr;
+    alignas(LogQueryCursor) uint8_t cursorStorage[sizeof(LogQueryCursor)];
+
+    void close() {
+        if (cursor) {
+            cursor->~LogQueryCursor();
+            cursor = nullptr;
+        }
+    }
+};
+
+// "ocpp": instantané pris par la tâche OCPP (la console ne lit pas son état), une ligne par pas
+class OcppStatsJob : public ConsoleJob {
+public:
+    void start(OCPPWrapper& wrapper) {
+        ocpp = &wrapper;
+        ready = false;
+        line = 0;
+        startMs = millis();
+        wrapper.requestStats();
+    }
+
+    bool step(Print& out) override {
+        if (!ready) {
+            ready = ocpp->takeStats(stats);
+            if (!ready) {
+                if (millis() - startMs < CONSOLE_OCPP_STATS_TIMEOUT_MS) return true;
+                out.println("❌ Tâche OCPP sans réponse");
+                return false;
+            }
+        }
+        return OCPPWrapper::printStatsLine(stats, line++, out);
+    }
+
+private:
+    OCPPWrapper* ocpp = nullptr;
+    ocpp_wrapper_stats_t stats;
+    bool ready = false;
+    uint8_t line = 0;
+    uint32_t startMs = 0;
+};
+
+HelpJob helpJob;
+FileDumpJob fileDumpJob;
+HistoryJob historyJob;
+QueryJob queryJob;
+OcppStatsJob ocppStatsJob;
+
+// Handlers only run between jobs (the console holds the next lines back), startJob() cannot fail
+void cmdHelp(SerialConsole& console, char*, void*) {
+    console.println("Commandes :");
+    helpJob.start(console);
+    console.startJob(helpJob);
+}
+
+void cmdLog(SerialConsole& console, char* args, void*) {
+    if (*args == '\0') {
+        console.println("❌ Veuillez spécifier un nom de fichier.");
+        return;
+    }
+    if (fileDumpJob.start(args, console)) {
+        console.startJob(fileDumpJob);
+    }
+}
+
+void cmdQuery(SerialConsole& console, char* args, void*) {
+    unsigned long fromS = 0, toS = 0;
+    char level[8] = "DEBUG";
+    char scope[8] = "";
+    if (sscanf(args, "%lu %lu %7s %7s", &fromS, &toS, level, scope) < 2 || toS < fromS) {
+        console.println("❌ Usage: logq <début_s> <fin_s> [DEBUG|INFO|WARN|ERROR] [all]");
+        return;
+    }
+    LogLevel minLevel = LOG_LEVEL_DEBUG;
+    for (int l = LOG_LEVEL_DEBUG; l <= LOG_LEVEL_ERROR; ++l) {
+        if (strcmp(level, logLevelToString(static_cast<LogLevel>(l))) == 0) {
+            minLevel = static_cast<LogLevel>(l);
+        }
+    }
+    // Uptimes restart at each boot: the current boot only, unless "all" (one "[boot ...]" line per boot)
+    bool allBoots = strcmp(level, "all") == 0 || strcmp(scope, "all") == 0;
+    uint32_t bootId = allBoots ? LOG_BOOT_ANY : LogClock::getBootId();
+    queryJob.start(fromS * 1000, toS * 1000 + 999, minLevel, bootId, console);
+    console.startJob(queryJob);
+}
+
+void cmdHistory(SerialConsole& console, char* args, void*) {
+    historyJob.start(static_cast<size_t>(strtoul(args, nullptr, 10)));
+    console.startJob(historyJob);
+}
+
+void cmdHardware(SerialConsole& console, char*, void* ctx) {
+    static_cast<HardwareManager*>(ctx)->printDiagnostics(console);
+}
+
+void cmdPower(SerialConsole& console, char*, void* ctx) {
+    static_cast<PowerManager*>(ctx)->printPowerStats(console);
+}
+
+void cmdWatchdog(SerialConsole& console, char*, void* ctx) {
+    static_cast<WatchdogManager*>(ctx)->printWatchdogStatus(console);
+}
+
+void cmdTasks(SerialConsole& console, char*, void* ctx) {
+    static_cast<SystemRuntime*>(ctx)->printTaskStats(console);
+}
+
+void cmdOcpp(SerialConsole& console, char*, void* ctx) {
+    ocppStatsJob.start(*static_cast<OCPPWrapper*>(ctx));
+    console.startJob(ocppStatsJob);
+}
+
+} // namespace
+
+void registerCoreCommands(SerialConsole& console) {
+    console.registerCommand("help", "liste des commandes", cmdHelp);
+    console.registerCommand("log", "<fichier> : contenu d'un fichier SPIFFS (.lz décompressé)", cmdLog);
+    console.registerCommand("logq", "<début_s> <fin_s> [LEVEL] [all] : requête indexée, boot courant", cmdQuery);
+    console.registerCommand("history", "[n] : historique du Logger", cmdHistory);
+}
+
+void registerSystemCommands(SerialConsole& console, HardwareManager* hardware, PowerManager* power,
+                            WatchdogManager* watchdog) {
+    if (hardware) console.registerCommand("hw", "diagnostic matériel", cmdHardware, hardware);
+    if (power) console.registerCommand("power", "statistiques d'alimentation", cmdPower, power);
+    if (watchdog) console.registerCommand("wdt", "état des watchdogs", cmdWatchdog, watchdog);
+}
+
+void registerRuntimeCommands(SerialConsole& console, SystemRuntime& runtime) {
+    console.registerCommand("tasks", "tâches : CPU, pile libre, files", cmdTasks, &runtime);
+}
+
+void registerOcppCommands(SerialConsole& console, OCPPWrapper& ocpp) {
+    console.registerCommand("ocpp", "file OCPP : profondeur, CALL en vol, RTT, renvois", cmdOcpp, &ocpp);
+}
@@ -2,75 +2,429 @@
 #include <SPIFFS.h>
 #include <Arduino.h>
 #include "Logger.h"
+#include "LogQuery.h"
+#include "LogCompressor.h"
 
-FileLogger::FileLogger() : currentLogIndex(0) {}
+FileLogger::FileLogger(const char* suffix, fs::FS& filesystem, bool compressRotated)
+    : fs(filesystem), currentLogIndex(0), fileSuffix(suffix), compressRotated(compressRotated) {}
 
 FileLogger::~FileLogger() {
     end();
 }
 
 bool FileLogger::begin() {
-    if (!SPIFFS.exists("/")) { // Check if the filesystem is mounted
+    if (!fs.exists("/")) { // Check if the filesystem is mounted
         Serial.println("[FileLogger] SPIFFS not mounted. Please call SPIFFS.begin() at startup.");
         return false;
     }
 
     openLatestLogFile();
+    if (compressRotated) {
+        scanArchives();
+        // Plain files left by the previous run are closed: compress them too
+        for (int i = 0; i < MAX_LOG_FILES; ++i) {
+            if (i != currentLogIndex && fs.exists(getLogFileName(i))) {
+                scheduleCompression(i);
+            }
+        }
+    }
     return true;
 }
 
 void FileLogger::end() {
     if (currentLogFile) {
-        currentLogFile.flush();
+        commitBlock();
         currentLogFile.close();
     }
+    closeIndexGroup();
+    persistIndex();
+    if (indexFile) {
+        indexFile.close();
+    }
 }
 
 void FileLogger::log(const char* message) {
-    if (!currentLogFile || getLogFileSize(currentLogFile) > MAX_LOG_FILE_SIZE) {
+    write(message, strlen(message));
+    write("\n", 1);
+}
+
+void FileLogger::write(const char* data, size_t len) {
+    prepareWrite(len);
+    appendBlock(data, len);
+}
+
+void FileLogger::writeRecord(const char* data, size_t len, uint32_t timestamp, uint8_t level) {
+    prepareWrite(len);
+    if (!currentLogFile) return;
+
+    uint32_t offset = static_cast<uint32_t>(fileSize + blockUsed);
+    appendBlock(data, len);
+
+    if (indexGroup.count == 0) {
+        indexGroup.firstTimestamp = timestamp;
+        indexGroup.offset = offset;
+        indexGroup.levelMask = 0;
+    }
+    indexGroup.lastTimestamp = timestamp;
+    indexGroup.levelMask |= static_cast<uint8_t>(1u << (level & 0x07));
+    if (++indexGroup.count >= LOG_INDEX_INTERVAL) {
+        closeIndexGroup();
+    }
+}
+
+void FileLogger::writeMarker(const char* data, size_t len) {
+    prepareWrite(len);
+    // The group before the marker ends here: a skipped group never hides it
+    closeIndexGroup();
+    appendBlock(data, len);
+}
+
+uint32_t FileLogger::reserve(size_t len) {
+    prepareWrite(len);
+    return fileGeneration;
+}
+
+void FileLogger::prepareWrite(size_t len) {
+    // Rotation is decided on the in-memory size, before the record is buffered
+    size_t current = fileSize + blockUsed;
+    if (!currentLogFile || (current > 0 && current + len > MAX_LOG_FILE_SIZE)) {
         rotateLogFileIfNeeded();
     }
+}
 
-    currentLogFile.println(message);
+void FileLogger::appendBlock(const char* data, size_t len) {
+    if (!currentLogFile) return;
+
+    stats.bytes += len;
+    while (len > 0) {
+        if (blockUsed == 0) {
+            blockStartMs = millis();
+        }
+        // Fill up to the next block boundary of the file so that commits stay page aligned
+        size_t room = LOG_FILE_BLOCK_SIZE - (fileSize % LOG_FILE_BLOCK_SIZE) - blockUsed;
+        size_t n = len < room ? len : room;
+        memcpy(block + blockUsed, data, n);
+        blockUsed += n;
+        data += n;
+        len -= n;
+        if (n == room) {
+            commitBlock();
+        }
+    }
+}
+
+void FileLogger::closeIndexGroup() {
+    if (indexGroup.count == 0) return;
+    indexGroup.length = static_cast<uint16_t>(fileSize + blockUsed - indexGroup.offset);
+    indexPending[indexPendingCount++] = indexGroup;
+    indexGroup.count = 0;
+    if (indexPendingCount >= LOG_INDEX_BUFFER_ENTRIES) {
+        persistIndex();
+    }
+}
+
+void FileLogger::persistIndex() {
+    if (indexPendingCount == 0) return;
+    if (indexFile) {
+        // Entries may point into the pending block: readers clamp offsets to the file size
+        indexFile.write(reinterpret_cast<const uint8_t*>(indexPending), indexPendingCount * sizeof(LogIndexEntry));
+        indexFile.flush();
+    }
+    indexPendingCount = 0;
+}
+
+size_t FileLogger::query(uint32_t fromMs, uint32_t toMs, uint8_t minLevel, Print& out, uint32_t bootId) {
+    // Pending data and complete index groups become visible to the reader
+    commitBlock();
+    persistIndex();
+
+    LogQuery query(fromMs, toMs, minLevel, LOG_DEFERRED_FORMAT, out, bootId);
+    for (uint32_t seq = archiveFirst; seq < archiveNext; ++seq) {
+        File archive = fs.open(getArchiveFileName(seq), FILE_READ);   // May have been deleted meanwhile
+        if (archive) {
+            query.scanCompressed(archive);
+            archive.close();
+        }
+    }
+    for (int i = 1; i <= MAX_LOG_FILES; ++i) {
+        int index = (currentLogIndex + i) % MAX_LOG_FILES;   // Oldest first, current file last
+        String filename = getLogFileName(index);
+        if (!fs.exists(filename)) continue;
+
+        File data = fs.open(filename, FILE_READ);
+        String indexName = getIndexFileName(index);
+        File indexData = fs.exists(indexName) ? fs.open(indexName, FILE_READ) : File();
+        if (data) {
+            query.scanFile(data, indexData);
+            data.close();
+        }
+        if (indexData) {
+            indexData.close();
+        }
+    }
+    query.finish();
+    return query.getStats().recordsMatched;
+}
+
+bool FileLogger::queryStep(LogQueryCursor& cursor) {
+    switch (cursor.phase) {
+        case LOG_QUERY_START:
+            // Pending data and complete index groups become visible to the reader
+            commitBlock();
+            persistIndex();
+            cursor.archiveSeq = archiveFirst;
+            cursor.phase = LOG_QUERY_ARCHIVES;
+            return true;
+
+        case LOG_QUERY_ARCHIVES:
+            if (cursor.archiveSeq < archiveFirst) {
+                cursor.archiveSeq = archiveFirst;   // Deleted by the archive budget meanwhile
+                cursor.nextSource();
+            }
+            if (cursor.archiveSeq < archiveNext) {
+                File archive = fs.open(getArchiveFileName(cursor.archiveSeq), FILE_READ);
+                bool more = archive && cursor.stepCompressed(archive);
+                if (archive) {
+                    archive.close();
+                }
+                if (!more) {
+                    cursor.archiveSeq++;
+                    cursor.nextSource();
+                }
+                return true;
+            }
+            cursor.phase = LOG_QUERY_FILES;
+            cursor.fileIndex = (currentLogIndex + 1) % MAX_LOG_FILES;   // Oldest first, current file last
+            cursor.filesLeft = MAX_LOG_FILES;
+            cursor.nextSource();
+            return true;
+
+        case LOG_QUERY_FILES: {
+            if (cursor.filesLeft == 0) {
+                cursor.phase = LOG_QUERY_DONE;
+                return false;
+            }
+            String filename = getLogFileName(cursor.fileIndex);
+            File data = fs.exists(filename) ? fs.open(filename, FILE_READ) : File();
+            bool more = false;
+            if (data) {
+                String indexName = getIndexFileName(cursor.fileIndex);
+                File indexData = fs.exists(indexName) ? fs.open(indexName, FILE_READ) : File();
+                more = cursor.stepFile(data, indexData);
+                data.close();
+                if (indexData) {
+                    indexData.close();
+                }
+            }
+            if (!more) {
+                cursor.fileIndex = (cursor.fileIndex + 1) % MAX_LOG_FILES;
+                cursor.filesLeft--;
+                cursor.nextSource();
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+void FileLogger::commitIfDue() {
+    if (blockUsed > 0 && millis() - blockStartMs >= LOG_FILE_COMMIT_INTERVAL_MS) {
+        commitBlock();
+    }
+}
+
+void FileLogger::flushNow() {
+    commitBlock();
+}
+
+void FileLogger::commitBlock() {
+    if (blockUsed == 0 || !currentLogFile) return;
+
+    currentLogFile.write(reinterpret_cast<const uint8_t*>(block), blockUsed);
     currentLogFile.flush();
+    fileSize += blockUsed;
+    blockUsed = 0;
+    stats.commits++;
 }
 
 void FileLogger::openLatestLogFile() {
     for (int i = 0; i < MAX_LOG_FILES; ++i) {
-        String filename = getLogFileName(i);
-        if (!SPIFFS.exists(filename)) {
-            currentLogIndex = i;
-            currentLogFile = SPIFFS.open(filename, FILE_WRITE);
+        if (!fs.exists(getLogFileName(i))) {
+            openFiles(i);
             return;
         }
     }
 
-    currentLogIndex = 0;
-    currentLogFile = SPIFFS.open(getLogFileName(currentLogIndex), FILE_WRITE);
+    openFiles(0);
 }
 
 void FileLogger::rotateLogFileIfNeeded() {
-    if (currentLogFile) {
+    bool closing = currentLogFile;
+    if (closing) {
+        commitBlock();
         currentLogFile.close();
     }
+    // The index of the closed file is complete once its last group is written
+    closeIndexGroup();
+    persistIndex();
+    if (indexFile) {
+        indexFile.close();
+    }
 
+    if (compressRotated && closing) {
+        scheduleCompression(currentLogIndex);
+    }
     currentLogIndex = (currentLogIndex + 1) % MAX_LOG_FILES;
     deleteOldestLogFileIfNeeded();
-    currentLogFile = SPIFFS.open(getLogFileName(currentLogIndex), FILE_WRITE);
+    openFiles(currentLogIndex);
+    stats.rotations++;
+}
+
+void FileLogger::openFiles(int index) {
+    currentLogIndex = index;
+    currentLogFile = fs.open(getLogFileName(index), FILE_WRITE);
+    indexFile = fs.open(getIndexFileName(index), FILE_WRITE);
+    fileSize = 0;
+    fileGeneration++;
+    indexGroup.count = 0;
 }
 
 void FileLogger::deleteOldestLogFileIfNeeded() {
     int oldestIndex = (currentLogIndex + 1) % MAX_LOG_FILES;
     String filename = getLogFileName(oldestIndex);
-    if (SPIFFS.exists(filename)) {
-        SPIFFS.remove(filename);
+    if (fs.exists(filename)) {
+        fs.remove(filename);
+    }
+    String indexName = getIndexFileName(oldestIndex);
+    if (fs.exists(indexName)) {
+        fs.remove(indexName);
+    }
+}
+
+void FileLogger::scheduleCompression(int index) {
+    portENTER_CRITICAL(&compressMux);
+    compressMask |= 1u << index;
+    bool start = !compressRunning;
+    compressRunning = true;
+    portEXIT_CRITICAL(&compressMux);
+
+    if (start && xTaskCreate(compressTaskEntry, "logzip", LOG_COMPRESS_TASK_STACK_SIZE, this,
+                             LOG_COMPRESS_TASK_PRIORITY, nullptr) != pdPASS) {
+        compressRunning = false;   // Retried at the next rotation
+    }
+}
+
+void FileLogger::compressTaskEntry(void* param) {
+    FileLogger* self = static_cast<FileLogger*>(param);
+    for (;;) {
+        self->compressPending();
+        // Exit only if no rotation queued a file after compressPending() took the mask
+        portENTER_CRITICAL(&self->compressMux);
+        bool done = self->compressMask == 0;
+        if (done) {
+            self->compressRunning = false;
+        }
+        portEXIT_CRITICAL(&self->compressMux);
+        if (done) break;
+    }
+    vTaskDelete(nullptr);
+}
+
+void FileLogger::compressPending() {
+    portENTER_CRITICAL(&compressMux);
+    uint32_t mask = compressMask;
+    compressMask = 0;
+    portEXIT_CRITICAL(&compressMux);
+
+    // Oldest file first so that archive sequence numbers follow the rotation order
+    for (int i = 1; i <= MAX_LOG_FILES; ++i) {
+        int index = (currentLogIndex + i) % MAX_LOG_FILES;
+        if (mask & (1u << index)) {
+            compressFile(index);
+        }
+    }
+    enforceArchiveBudget();
+}
+
+void FileLogger::compressFile(int index) {
+    String filename = getLogFileName(index);
+    String archiveName = getArchiveFileName(archiveNext);
+    File plain = fs.open(filename, FILE_READ);
+    if (!plain) return;
+    uint32_t plainSize = static_cast<uint32_t>(plain.size());
+    plain.close();
+
+    uint32_t compressedSize = 0;
+    if (plainSize == 0 || !LogCompressor::compressFile(fs, filename.c_str(), archiveName.c_str(), &compressedSize)) {
+        return;   // Left as a plain file, deleted by the rotation
+    }
+    archiveNext++;
+    stats.archives++;
+    stats.archiveBytes += compressedSize;
+    stats.archivedBytes += plainSize;
+
+    // Archives have no index: the plain file and its .idx go away together
+    fs.remove(filename);
+    String indexName = getIndexFileName(index);
+    if (fs.exists(indexName)) {
+        fs.remove(indexName);
+    }
+}
+
+void FileLogger::enforceArchiveBudget() {
+    // The newest archive is always kept, even if it alone exceeds the budget
+    while (stats.archiveBytes > LOG_ARCHIVE_BUDGET && archiveNext - archiveFirst > 1) {
+        String name = getArchiveFileName(archiveFirst);
+        File archive = fs.open(name, FILE_READ);
+        uint32_t size = archive ? static_cast<uint32_t>(archive.size()) : 0;
+        if (archive) {
+            archive.close();
+        }
+        fs.remove(name);
+        stats.archiveBytes -= size < stats.archiveBytes ? size : stats.archiveBytes;
+        archiveFirst++;
     }
 }
 
+void FileLogger::scanArchives() {
+    // Archive sequence numbers are contiguous: only the range and the total size are kept in RAM
+    bool found = false;
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t total = 0;
+    size_t prefixLen = strlen(LOG_ARCHIVE_PREFIX) - 1;   // Without the leading '/'
+
+    File root = fs.open("/");
+    File entry = root ? root.openNextFile() : File();
+    while (entry) {
+        const char* name = entry.name();
+        if (name[0] == '/') name++;   // Full path on older cores, base name on newer ones
+        if (strncmp(name, LOG_ARCHIVE_PREFIX + 1, prefixLen) == 0) {
+            uint32_t seq = strtoul(name + prefixLen, nullptr, 10);
+            if (!found || seq < first) first = seq;
+            if (!found || seq > last) last = seq;
+            found = true;
+            total += static_cast<uint32_t>(entry.size());
+        }
+        entry.close();
+        entry = root.openNextFile();
+    }
+
+    archiveFirst = found ? first : 0;
+    archiveNext = found ? last + 1 : 0;
+    stats.archiveBytes = total;
+}
+
+String FileLogger::getArchiveFileName(uint32_t seq) const {
+    return String(LOG_ARCHIVE_PREFIX) + String(seq) + fileSuffix + LOG_ARCHIVE_SUFFIX;
+}
+
 String FileLogger::getLogFileName(int index) const {
-    return String(LOG_FILE_PREFIX) + String(index) + LOG_FILE_SUFFIX;
+    return String(LOG_FILE_PREFIX) + String(index) + fileSuffix;
 }
 
-size_t FileLogger::getLogFileSize(File& file) const {
-    return file.size();
+String FileLogger::getIndexFileName(int index) const {
+    return String(LOG_FILE_PREFIX) + String(index) + LOG_INDEX_SUFFIX;
 }
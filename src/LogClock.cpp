@@ -0,0 +1,222 @@
+#include "LogClock.h"
+#include <esp_system.h>
+
+volatile uint32_t LogClock::generation = 0;
+int64_t LogClock::offsetMs = 0;
+
+static portMUX_TYPE clockMux = portMUX_INITIALIZER_UNLOCKED;
+
+namespace {
+
+// Reads exactly `digits` decimal digits
+bool readNumber(const char*& p, int digits, uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < digits; ++i) {
+        if (p[i] < '0' || p[i] > '9') return false;
+        value = value * 10 + static_cast<uint32_t>(p[i] - '0');
+    }
+    p += digits;
+    return true;
+}
+
+// Writes `value` on `digits` characters, zero padded
+inline void putDigits(char* p, uint32_t value, int digits) {
+    for (int i = digits - 1; i >= 0; --i) {
+        p[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+void LogClock::setUnixTimeMs(uint64_t unixMs, uint32_t uptimeMs) {
+    portENTER_CRITICAL(&clockMux);
+    offsetMs = static_cast<int64_t>(unixMs) - static_cast<int64_t>(uptimeMs);
+    uint32_t next = generation + 1;
+    generation = next != 0 ? next : 1;
+    portEXIT_CRITICAL(&clockMux);
+}
+
+bool LogClock::setFromIso8601(const char* text, uint32_t uptimeMs) {
+    uint64_t unixMs;
+    if (!parseIso8601(text, unixMs)) return false;
+    setUnixTimeMs(unixMs, uptimeMs);
+    return true;
+}
+
+bool LogClock::parseIso8601(const char* text, uint64_t& unixMs) {
+    if (!text) return false;
+    const char* p = text;
+    uint32_t year, month, day, hour, minute, second;
+    if (!readNumber(p, 4, year) || *p++ != '-' || !readNumber(p, 2, month) || *p++ != '-' ||
+        !readNumber(p, 2, day) || (*p != 'T' && *p != 't' && *p != ' ')) {
+        return false;
+    }
+    p++;
+    if (!readNumber(p, 2, hour) || *p++ != ':' || !readNumber(p, 2, minute) || *p++ != ':' ||
+        !readNumber(p, 2, second)) {
+        return false;
+    }
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    uint32_t millisPart = 0;
+    if (*p == '.' || *p == ',') {
+        p++;
+        uint32_t scale = 100;
+        while (*p >= '0' && *p <= '9') {
+            millisPart += static_cast<uint32_t>(*p - '0') * scale;
+            scale /= 10;
+            p++;
+        }
+    }
+
+    int32_t zoneMinutes = 0;
+    if (*p == '+' || *p == '-') {
+        int sign = *p++ == '-' ? -1 : 1;
+        uint32_t zoneHour, zoneMinute = 0;
+        if (!readNumber(p, 2, zoneHour)) return false;
+        if (*p == ':') p++;
+        readNumber(p, 2, zoneMinute);
+        zoneMinutes = sign * static_cast<int32_t>(zoneHour * 60 + zoneMinute);
+    }
+
+    int64_t seconds = static_cast<int64_t>(daysFromCivil(static_cast<int32_t>(year), month, day)) * 86400 +
+                      hour * 3600 + minute * 60 + second - zoneMinutes * 60;
+    if (seconds < 0) return false;
+    unixMs = static_cast<uint64_t>(seconds) * 1000 + millisPart;
+    return true;
+}
+
+void LogClock::reset() {
+    portENTER_CRITICAL(&clockMux);
+    offsetMs = 0;
+    generation = 0;
+    portEXIT_CRITICAL(&clockMux);
+}
+
+uint32_t LogClock::getBootId() {
+    static const uint32_t bootId = [] {
+        uint32_t id;
+        do { id = esp_random(); } while (id == LOG_BOOT_ANY || id == LOG_BOOT_EARLIER);
+        return id;
+    }();
+    return bootId;
+}
+
+uint64_t LogClock::toUnixMs(uint32_t uptimeMs) {
+    portENTER_CRITICAL(&clockMux);
+    int64_t offset = offsetMs;
+    bool set = generation != 0;
+    portEXIT_CRITICAL(&clockMux);
+    return set ? static_cast<uint64_t>(offset + uptimeMs) : 0;
+}
+
+bool LogClock::toUptimeMs(uint64_t unixMs, uint32_t& uptimeMs) {
+    portENTER_CRITICAL(&clockMux);
+    int64_t offset = offsetMs;
+    bool set = generation != 0;
+    portEXIT_CRITICAL(&clockMux);
+
+    int64_t uptime = static_cast<int64_t>(unixMs) - offset;
+    if (!set || uptime < 0 || uptime > static_cast<int64_t>(UINT32_MAX)) return false;
+    uptimeMs = static_cast<uint32_t>(uptime);
+    return true;
+}
+
+// H. Hinnant, "chrono-Compatible Low-Level Date Algorithms"
+int32_t LogClock::daysFromCivil(int32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = static_cast<uint32_t>(year - era * 400);
+    uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int32_t>(doe) - 719468;
+}
+
+void LogClock::civilFromDays(int32_t days, int32_t& year, uint32_t& month, uint32_t& day) {
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t doe = static_cast<uint32_t>(days - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int32_t>(yoe) + era * 400 + (month <= 2);
+}
+
+// ============================================================================
+// FORMATTER
+// ============================================================================
+
+size_t LogTimestampFormatter::format(char* buf, size_t size, uint32_t uptimeMs) {
+    if (size == 0) return 0;
+    uint32_t generation = LogClock::getGeneration();
+
+    // New minute or new clock: the prefix is built outside the critical section (64-bit math,
+    // snprintf), then published with a short copy. Another task may publish in between, hence the loop.
+    char prefix[LOG_CLOCK_TEXT_SIZE];
+    size_t prefixLength = 0;
+    uint32_t prefixStartMs = 0;
+    bool built = false;
+    for (;;) {
+        portENTER_CRITICAL(&mux);
+        if (built) {
+            memcpy(text, prefix, prefixLength);
+            memcpy(text + prefixLength, "00.000Z", 8);
+            secondsPos = prefixLength;
+            length = prefixLength + 7;
+            minuteStartMs = prefixStartMs;
+            cachedGeneration = generation;
+        }
+        uint32_t inMinute = uptimeMs - minuteStartMs;   // Wraps (>= 60000) for an earlier minute
+        if (generation == cachedGeneration && inMinute < 60000) {
+            uint32_t seconds = inMinute / 1000;
+            putDigits(text + secondsPos, seconds, 2);
+            putDigits(text + secondsPos + 3, inMinute - seconds * 1000, 3);
+            size_t n = length < size - 1 ? length : size - 1;
+            memcpy(buf, text, n);
+            portEXIT_CRITICAL(&mux);
+            buf[n] = '\0';
+            return n;
+        }
+        portEXIT_CRITICAL(&mux);
+        prefixLength = buildPrefix(prefix, sizeof(prefix), uptimeMs, generation, prefixStartMs);
+        built = true;
+    }
+}
+
+size_t LogTimestampFormatter::formatUptime(char* buf, size_t size, uint32_t uptimeMs) {
+    uint32_t seconds = uptimeMs / 1000;
+    int n = snprintf(buf, size, "0000-00-00T%02lu:%02lu:%02lu.%03luZ", static_cast<unsigned long>(seconds / 3600),
+                     static_cast<unsigned long>(seconds / 60 % 60), static_cast<unsigned long>(seconds % 60),
+                     static_cast<unsigned long>(uptimeMs % 1000));
+    return n < 0 ? 0 : (static_cast<size_t>(n) < size ? static_cast<size_t>(n) : size - 1);
+}
+
+size_t LogTimestampFormatter::buildPrefix(char* out, size_t size, uint32_t uptimeMs, uint32_t generation,
+                                          uint32_t& minuteStartMs) {
+    int n;
+    if (generation != 0) {
+        uint64_t unixMs = LogClock::toUnixMs(uptimeMs);
+        uint32_t msOfDay = static_cast<uint32_t>(unixMs % 86400000ULL);
+        int32_t year;
+        uint32_t month, day;
+        LogClock::civilFromDays(static_cast<int32_t>(unixMs / 86400000ULL), year, month, day);
+        minuteStartMs = uptimeMs - msOfDay % 60000;
+        n = snprintf(out, size, "%04ld-%02lu-%02luT%02lu:%02lu:", static_cast<long>(year),
+                     static_cast<unsigned long>(month), static_cast<unsigned long>(day),
+                     static_cast<unsigned long>(msOfDay / 3600000), static_cast<unsigned long>(msOfDay / 60000 % 60));
+    } else {
+        minuteStartMs = uptimeMs - uptimeMs % 60000;
+        n = snprintf(out, size, "0000-00-00T%02lu:%02lu:", static_cast<unsigned long>(uptimeMs / 3600000),
+                     static_cast<unsigned long>(uptimeMs / 60000 % 60));
+    }
+    return static_cast<size_t>(n);
+}
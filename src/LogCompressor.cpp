@@ -0,0 +1,226 @@
+#include "LogCompressor.h"
+
+// ============================================================================
+// ENCODER
+// ============================================================================
+
+LogLzEncoder::LogLzEncoder(Print& out, uint32_t originalSize) : out(out) {
+    uint8_t header[LOG_LZ_HEADER_SIZE];
+    memcpy(header, LOG_LZ_MAGIC, 4);
+    memcpy(header + 4, &originalSize, sizeof(originalSize));
+    put(header, sizeof(header));
+}
+
+void LogLzEncoder::write(const uint8_t* data, size_t len) {
+    inputSize += len;
+    while (len > 0) {
+        if (end == sizeof(buffer)) {
+            encode(false);
+            // Keep one window of history in front of the unencoded bytes
+            if (pos > LOG_LZ_WINDOW_SIZE) {
+                size_t shift = pos - LOG_LZ_WINDOW_SIZE;
+                memmove(buffer, buffer + shift, end - shift);
+                pos -= shift;
+                end -= shift;
+            }
+        }
+        size_t n = sizeof(buffer) - end;
+        if (n > len) n = len;
+        memcpy(buffer + end, data, n);
+        end += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void LogLzEncoder::finish() {
+    encode(true);
+    flushGroup();
+    flushOutput();
+}
+
+void LogLzEncoder::encode(bool final) {
+    // Without `final`, stop while a full lookahead is still buffered so that matches are not cut short
+    while (pos < end && (final || end - pos >= LOG_LZ_MAX_MATCH)) {
+        size_t maxLen = end - pos < LOG_LZ_MAX_MATCH ? end - pos : LOG_LZ_MAX_MATCH;
+        size_t bestLen = 0;
+        size_t bestDistance = 0;
+
+        if (maxLen >= LOG_LZ_MIN_MATCH) {
+            size_t start = pos > LOG_LZ_WINDOW_SIZE ? pos - LOG_LZ_WINDOW_SIZE : 0;
+            const uint8_t* target = buffer + pos;
+            // Nearest candidates first; the byte at bestLen is checked first to reject quickly
+            for (size_t i = pos; i-- > start;) {
+                const uint8_t* candidate = buffer + i;
+                if (candidate[bestLen] != target[bestLen] || candidate[0] != target[0]) continue;
+                size_t len = 0;
+                while (len < maxLen && candidate[len] == target[len]) len++;
+                if (len > bestLen) {
+                    bestLen = len;
+                    bestDistance = pos - i;
+                    if (len == maxLen) break;
+                }
+            }
+        }
+
+        if (bestLen >= LOG_LZ_MIN_MATCH) {
+            emitMatch(bestDistance, bestLen);
+            pos += bestLen;
+        } else {
+            emitLiteral(buffer[pos]);
+            pos++;
+        }
+    }
+}
+
+void LogLzEncoder::emitLiteral(uint8_t value) {
+    group[0] |= static_cast<uint8_t>(1u << groupTokens);
+    group[groupLen++] = value;
+    endToken();
+}
+
+void LogLzEncoder::emitMatch(size_t distance, size_t length) {
+    uint16_t token = static_cast<uint16_t>(((distance - 1) << LOG_LZ_LENGTH_BITS) | (length - LOG_LZ_MIN_MATCH));
+    group[groupLen++] = static_cast<uint8_t>(token >> 8);
+    group[groupLen++] = static_cast<uint8_t>(token & 0xFF);
+    endToken();
+}
+
+void LogLzEncoder::endToken() {
+    if (++groupTokens == 8) {
+        flushGroup();
+    }
+}
+
+void LogLzEncoder::flushGroup() {
+    if (groupTokens == 0) return;
+    put(group, groupLen);
+    group[0] = 0;
+    groupLen = 1;
+    groupTokens = 0;
+}
+
+void LogLzEncoder::put(const uint8_t* data, size_t len) {
+    if (outUsed + len > sizeof(outBuffer)) {
+        flushOutput();
+    }
+    memcpy(outBuffer + outUsed, data, len);
+    outUsed += len;
+    outputSize += len;
+}
+
+void LogLzEncoder::flushOutput() {
+    if (outUsed > 0) {
+        out.write(outBuffer, outUsed);
+        outUsed = 0;
+    }
+}
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+LogLzDecoder::LogLzDecoder(Print& out) : out(out) {}
+
+void LogLzDecoder::write(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len && valid; ++i) {
+        uint8_t b = data[i];
+        if (headerUsed < LOG_LZ_HEADER_SIZE) {
+            header[headerUsed++] = b;
+            if (headerUsed == LOG_LZ_HEADER_SIZE) {
+                valid = memcmp(header, LOG_LZ_MAGIC, 4) == 0;
+                memcpy(&originalSize, header + 4, sizeof(originalSize));
+            }
+            continue;
+        }
+        if (flagsLeft == 0) {
+            flags = b;
+            flagsLeft = 8;
+            continue;
+        }
+        if (flags & 1) {
+            put(b);
+        } else if (!haveHighByte) {
+            highByte = b;
+            haveHighByte = true;
+            continue;
+        } else {
+            uint16_t token = static_cast<uint16_t>((highByte << 8) | b);
+            size_t distance = (token >> LOG_LZ_LENGTH_BITS) + 1;
+            size_t length = (token & ((1u << LOG_LZ_LENGTH_BITS) - 1)) + LOG_LZ_MIN_MATCH;
+            if (distance > outputSize) {
+                valid = false;   // Points before the start of the stream
+                break;
+            }
+            for (size_t k = 0; k < length; ++k) {
+                put(window[(outputSize - distance) & (LOG_LZ_WINDOW_SIZE - 1)]);
+            }
+            haveHighByte = false;
+        }
+        flags >>= 1;
+        flagsLeft--;
+    }
+}
+
+void LogLzDecoder::finish() {
+    if (haveHighByte || headerUsed < LOG_LZ_HEADER_SIZE) {
+        valid = false;   // Truncated stream
+    }
+    if (outUsed > 0) {
+        out.write(outBuffer, outUsed);
+        outUsed = 0;
+    }
+}
+
+void LogLzDecoder::put(uint8_t value) {
+    window[outputSize & (LOG_LZ_WINDOW_SIZE - 1)] = value;
+    outputSize++;
+    outBuffer[outUsed++] = value;
+    if (outUsed == sizeof(outBuffer)) {
+        out.write(outBuffer, outUsed);
+        outUsed = 0;
+    }
+}
+
+// ============================================================================
+// FILE HELPERS
+// ============================================================================
+
+bool LogCompressor::compressFile(fs::FS& fs, const char* src, const char* dst, uint32_t* compressedSize) {
+    fs::File in = fs.open(src, FILE_READ);
+    if (!in) return false;
+    fs::File out = fs.open(dst, FILE_WRITE);
+    if (!out) {
+        in.close();
+        return false;
+    }
+
+    LogLzEncoder encoder(out, static_cast<uint32_t>(in.size()));
+    uint8_t chunk[LOG_LZ_CHUNK_SIZE];
+    size_t n;
+    while ((n = in.read(chunk, sizeof(chunk))) > 0) {
+        encoder.write(chunk, n);
+    }
+    encoder.finish();
+    bool ok = encoder.getInputSize() == in.size();
+    in.close();
+    out.close();
+
+    if (!ok) {
+        fs.remove(dst);
+        return false;
+    }
+    if (compressedSize) *compressedSize = encoder.getOutputSize();
+    return true;
+}
+
+bool LogCompressor::decompress(fs::File& in, Print& out) {
+    LogLzDecoder decoder(out);
+    uint8_t chunk[LOG_LZ_CHUNK_SIZE];
+    size_t n;
+    while ((n = in.read(chunk, sizeof(chunk))) > 0) {
+        decoder.write(chunk, n);
+    }
+    decoder.finish();
+    return decoder.isValid();
+}
@@ -0,0 +1,136 @@
+#include "LogCrashRing.h"
+#include <freertos/FreeRTOS.h>
+
+namespace {
+
+constexpr uint32_t CRASH_RING_MAGIC = 0x4C4F4752;   // "LOGR"
+
+struct CrashRingStorage {
+    uint32_t magic;
+    uint32_t nextSequence;
+    uint32_t bootCount;
+    LogCrashSlot slots[LOG_CRASH_RING_SLOTS];
+};
+
+// Not cleared by the startup code: survives software, watchdog and panic resets
+RTC_NOINIT_ATTR CrashRingStorage crashStorage;
+
+bool validated = false;
+uint32_t firstSequenceThisBoot = 1;
+portMUX_TYPE crashMux = portMUX_INITIALIZER_UNLOCKED;
+
+uint32_t slotChecksum(const LogCrashSlot& slot) {
+    uint32_t h = 2166136261u ^ slot.sequence;  // FNV-1a
+    const uint8_t* p = slot.record();
+    for (size_t i = 0; i < slot.recordSize(); ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool isValid(const LogCrashSlot& slot) {
+    return slot.sequence != 0 && slot.sequence < crashStorage.nextSequence &&
+           slot.length <= LOG_CRASH_PAYLOAD_SIZE && slot.checksum == slotChecksum(slot);
+}
+
+bool isPreviousRun(const LogCrashSlot& slot) {
+    return isValid(slot) && slot.sequence < firstSequenceThisBoot;
+}
+
+// Must be called inside the critical section
+void validateStorage() {
+    if (validated) return;
+    validated = true;
+    if (crashStorage.magic != CRASH_RING_MAGIC || crashStorage.nextSequence == 0) {
+        // Power-on: RTC memory holds garbage
+        memset(&crashStorage, 0, sizeof(crashStorage));
+        crashStorage.magic = CRASH_RING_MAGIC;
+        crashStorage.nextSequence = 1;
+    }
+    crashStorage.bootCount++;
+    firstSequenceThisBoot = crashStorage.nextSequence;
+}
+
+} // namespace
+
+void LogCrashRing::record(uint8_t level, uint32_t timestamp, uint16_t formatId, const void* payload, size_t length) {
+    if (length > LOG_CRASH_PAYLOAD_SIZE) length = LOG_CRASH_PAYLOAD_SIZE;
+
+    portENTER_CRITICAL(&crashMux);
+    validateStorage();
+    uint32_t sequence = crashStorage.nextSequence++;
+    LogCrashSlot& slot = crashStorage.slots[sequence % LOG_CRASH_RING_SLOTS];
+    slot.sequence = 0;          // A reset in the middle leaves an invalid slot, not a mixed one
+    slot.timestamp = timestamp;
+    slot.formatId = formatId;
+    slot.level = level;
+    slot.length = static_cast<uint8_t>(length);
+    memcpy(slot.payload, payload, length);
+    slot.sequence = sequence;
+    slot.checksum = slotChecksum(slot);
+    portEXIT_CRITICAL(&crashMux);
+}
+
+size_t LogCrashRing::forEach(void (*fn)(const LogCrashSlot& slot, void* ctx), void* ctx) {
+    portENTER_CRITICAL(&crashMux);
+    validateStorage();
+    portEXIT_CRITICAL(&crashMux);
+
+    // Slots are indexed by sequence: walking the last LOG_CRASH_RING_SLOTS sequences is oldest first
+    uint32_t end = firstSequenceThisBoot;
+    uint32_t begin = end > LOG_CRASH_RING_SLOTS ? end - LOG_CRASH_RING_SLOTS : 1;
+    size_t visited = 0;
+    for (uint32_t seq = begin; seq < end; ++seq) {
+        const LogCrashSlot& slot = crashStorage.slots[seq % LOG_CRASH_RING_SLOTS];
+        if (slot.sequence == seq && isPreviousRun(slot)) {
+            fn(slot, ctx);
+            visited++;
+        }
+    }
+    return visited;
+}
+
+size_t LogCrashRing::pending() {
+    return forEach([](const LogCrashSlot&, void*) {}, nullptr);
+}
+
+void LogCrashRing::clear() {
+    portENTER_CRITICAL(&crashMux);
+    validateStorage();
+    for (size_t i = 0; i < LOG_CRASH_RING_SLOTS; ++i) {
+        if (crashStorage.slots[i].sequence < firstSequenceThisBoot) {
+            crashStorage.slots[i].sequence = 0;
+        }
+    }
+    portEXIT_CRITICAL(&crashMux);
+}
+
+uint32_t LogCrashRing::getBootCount() {
+    portENTER_CRITICAL(&crashMux);
+    validateStorage();
+    portEXIT_CRITICAL(&crashMux);
+    return crashStorage.bootCount;
+}
+
+void LogCrashRing::simulateReboot() {
+    portENTER_CRITICAL(&crashMux);
+    validated = false;
+    portEXIT_CRITICAL(&crashMux);
+}
+
+const char* LogCrashRing::resetReasonToString(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:   return "POWERON";
+        case ESP_RST_EXT:       return "EXT";
+        case ESP_RST_SW:        return "SW";
+        case ESP_RST_PANIC:     return "PANIC";
+        case ESP_RST_INT_WDT:   return "INT_WDT";
+        case ESP_RST_TASK_WDT:  return "TASK_WDT";
+        case ESP_RST_WDT:       return "WDT";
+        case ESP_RST_DEEPSLEEP: return "DEEPSLEEP";
+        case ESP_RST_BROWNOUT:  return "BROWNOUT";
+        case ESP_RST_SDIO:      return "SDIO";
+        default:                return "UNKNOWN";
+    }
+}
@@ -0,0 +1,280 @@
+#include "LogFormat.h"
+#include <freertos/FreeRTOS.h>
+
+static_assert((LOG_FORMAT_REGISTRY_SIZE & (LOG_FORMAT_REGISTRY_SIZE - 1)) == 0,
+              "LOG_FORMAT_REGISTRY_SIZE must be a power of two");
+
+namespace {
+
+struct FormatEntry {
+    uint16_t id;          // 0 = free slot
+    uint8_t level;
+    int line;
+    const char* file;
+    const char* format;
+};
+
+// Open addressing on the format ID
+FormatEntry entries[LOG_FORMAT_REGISTRY_SIZE];
+size_t entryCount = 0;
+size_t collisionCount = 0;
+portMUX_TYPE registryMux = portMUX_INITIALIZER_UNLOCKED;
+
+uint16_t hashFormat(const char* format) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (const char* p = format; *p; ++p) {
+        h ^= static_cast<uint8_t>(*p);
+        h *= 16777619u;
+    }
+    return static_cast<uint16_t>((h >> 16) ^ (h & 0xFFFF));
+}
+
+bool isReservedId(uint16_t id) {
+    return id == LOG_FORMAT_ID_TEXT || id == LOG_FORMAT_ID_UNKNOWN || id == LOG_FORMAT_ID_FIELDS ||
+           id == LOG_FORMAT_ID_BOOT;
+}
+
+// Returns the slot holding `id`, or the free slot where it would go
+size_t findSlot(uint16_t id) {
+    size_t slot = id & (LOG_FORMAT_REGISTRY_SIZE - 1);
+    while (entries[slot].id != 0 && entries[slot].id != id) {
+        slot = (slot + 1) & (LOG_FORMAT_REGISTRY_SIZE - 1);
+    }
+    return slot;
+}
+
+// Formats one tagged argument with the printf spec `spec` (flags/width/precision) and conversion `conv`
+int renderArg(char* out, size_t size, const char* spec, char conv, uint8_t tag, const uint8_t* data, size_t dataSize) {
+    char fmt[24];
+    switch (tag) {
+        case LOG_ARG_INT32:
+        case LOG_ARG_UINT32: {
+            uint32_t v;
+            memcpy(&v, data, sizeof(v));
+            if (!conv || !strchr("diouxXc", conv)) conv = (tag == LOG_ARG_INT32) ? 'd' : 'u';
+            snprintf(fmt, sizeof(fmt), "%%%s%c", spec, conv);
+            return (tag == LOG_ARG_INT32 && (conv == 'd' || conv == 'i'))
+                ? snprintf(out, size, fmt, static_cast<int>(static_cast<int32_t>(v)))
+                : snprintf(out, size, fmt, static_cast<unsigned>(v));
+        }
+        case LOG_ARG_INT64:
+        case LOG_ARG_UINT64: {
+            uint64_t v;
+            memcpy(&v, data, sizeof(v));
+            if (!conv || !strchr("diouxX", conv)) conv = (tag == LOG_ARG_INT64) ? 'd' : 'u';
+            snprintf(fmt, sizeof(fmt), "%%%sll%c", spec, conv);
+            return (tag == LOG_ARG_INT64 && (conv == 'd' || conv == 'i'))
+                ? snprintf(out, size, fmt, static_cast<long long>(v))
+                : snprintf(out, size, fmt, static_cast<unsigned long long>(v));
+        }
+        case LOG_ARG_DOUBLE: {
+            double v;
+            memcpy(&v, data, sizeof(v));
+            if (!conv || !strchr("fFeEgGaA", conv)) conv = 'g';
+            snprintf(fmt, sizeof(fmt), "%%%s%c", spec, conv);
+            return snprintf(out, size, fmt, v);
+        }
+        case LOG_ARG_STRING: {
+            // The packed string is not terminated: the precision is always the stored length
+            int precision = static_cast<int>(dataSize);
+            const char* dot = strchr(spec, '.');
+            int width = dot ? static_cast<int>(dot - spec) : static_cast<int>(strlen(spec));
+            if (dot && atoi(dot + 1) < precision) precision = atoi(dot + 1);
+            snprintf(fmt, sizeof(fmt), "%%%.*s.*s", width, spec);
+            return snprintf(out, size, fmt, precision, reinterpret_cast<const char*>(data));
+        }
+        case LOG_ARG_POINTER: {
+            uint32_t v;
+            memcpy(&v, data, sizeof(v));
+            return snprintf(out, size, "0x%08lx", static_cast<unsigned long>(v));
+        }
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+uint16_t LogFormatRegistry::registerFormat(uint8_t level, const char* file, int line, const char* format) {
+    uint16_t id = hashFormat(format);
+    if (isReservedId(id)) id = 1;
+
+    uint16_t result = LOG_FORMAT_ID_UNKNOWN;
+    portENTER_CRITICAL(&registryMux);
+    FormatEntry& e = entries[findSlot(id)];
+    if (e.id == id) {
+        if (e.format == format || strcmp(e.format, format) == 0) {
+            result = id;  // Same format string from another call site: share the ID
+        } else {
+            // Hash collision: no probing, the ID would then depend on the registration order
+            collisionCount++;
+        }
+    } else if (entryCount < LOG_FORMAT_REGISTRY_SIZE - 1) {
+        // Keep a free slot so that probing always terminates
+        e.level = level;
+        e.line = line;
+        e.file = file;
+        e.format = format;
+        e.id = id;  // Published last: the drain task reads entries without the lock
+        entryCount++;
+        result = id;
+    }
+    portEXIT_CRITICAL(&registryMux);
+    return result;
+}
+
+const char* LogFormatRegistry::getFormat(uint16_t formatId, const char** file, int* line) {
+    if (isReservedId(formatId)) return nullptr;
+    const FormatEntry& e = entries[findSlot(formatId)];
+    if (e.id != formatId) return nullptr;
+    if (file) *file = e.file;
+    if (line) *line = e.line;
+    return e.format;
+}
+
+int LogFormatRegistry::getSlot(uint16_t formatId) {
+    if (isReservedId(formatId)) return -1;
+    size_t slot = findSlot(formatId);
+    return entries[slot].id == formatId ? static_cast<int>(slot) : -1;
+}
+
+size_t LogFormatRegistry::writeDefinition(uint16_t formatId, uint32_t timestamp, uint8_t* out, size_t size) {
+    int slot = getSlot(formatId);
+    if (slot < 0 || size <= LOG_BINARY_HEADER_SIZE) return 0;
+    const FormatEntry& e = entries[slot];
+
+    // level <TAB> file:line <TAB> format, the file without its directories
+    const char* file = strrchr(e.file, '/');
+    file = file ? file + 1 : e.file;
+    size_t room = size - LOG_BINARY_HEADER_SIZE;
+    if (room > 256) room = 256;
+    int n = snprintf(reinterpret_cast<char*>(out + LOG_BINARY_HEADER_SIZE), room, "%u\t%s:%d\t%s",
+                     e.level, file, e.line, e.format);
+    if (n < 0) return 0;
+    size_t length = static_cast<size_t>(n) < room ? static_cast<size_t>(n) : room - 1;
+
+    LogBinaryRecord header;
+    header.timestamp = timestamp;
+    header.formatId = formatId;
+    header.level = LOG_BINARY_SYNC | LOG_BINARY_DEFINITION;
+    header.length = static_cast<uint8_t>(length);
+    memcpy(out, &header, LOG_BINARY_HEADER_SIZE);
+    return LOG_BINARY_HEADER_SIZE + length;
+}
+
+size_t LogFormatRegistry::getCount() {
+    return entryCount;
+}
+
+size_t LogFormatRegistry::getCollisions() {
+    return collisionCount;
+}
+
+size_t LogFormatRegistry::render(const LogBinaryRecord& record, char* out, size_t size) {
+    if (size == 0) return 0;
+    LogArgReader args = { record.payload, record.payload + record.length };
+    size_t pos = 0;
+
+    auto append = [&](int n) {
+        if (n > 0) pos += static_cast<size_t>(n);
+        if (pos >= size) pos = size - 1;
+    };
+
+    if (record.formatId == LOG_FORMAT_ID_TEXT) {
+        append(snprintf(out, size, "%.*s", static_cast<int>(record.length),
+                        reinterpret_cast<const char*>(record.payload)));
+        return pos;
+    }
+
+    if (record.formatId == LOG_FORMAT_ID_FIELDS) {
+        // "event key=value key=value"
+        const uint8_t* data;
+        size_t dataSize;
+        if (args.next(data, dataSize) == LOG_ARG_STRING) {
+            append(snprintf(out, size, "%.*s", static_cast<int>(dataSize), reinterpret_cast<const char*>(data)));
+        }
+        append(static_cast<int>(renderFields(args.p, args.end - args.p, out + pos, size - pos)));
+        return pos;
+    }
+
+    const char* format = getFormat(record.formatId);
+    if (!format) {
+        // Unknown format: dump the raw arguments
+        append(snprintf(out, size, "<fmt#%u>", record.formatId));
+        const uint8_t* data;
+        size_t dataSize;
+        uint8_t tag;
+        while ((tag = args.next(data, dataSize)) != 0 && pos < size - 1) {
+            out[pos++] = ' ';
+            append(renderArg(out + pos, size - pos, "", 0, tag, data, dataSize));
+        }
+        out[pos] = '\0';
+        return pos;
+    }
+
+    for (const char* p = format; *p && pos < size - 1; ++p) {
+        if (*p != '%') {
+            out[pos++] = *p;
+            continue;
+        }
+        if (*++p == '%') {
+            out[pos++] = '%';
+            continue;
+        }
+
+        // Flags, width and precision are kept; '*' consumes an int argument; length modifiers are dropped
+        char spec[16];
+        size_t specLen = 0;
+        while (*p && strchr("-+ #0123456789.*", *p)) {
+            if (*p == '*') {
+                int value = 0;
+                args.nextInt(value);
+                specLen += snprintf(spec + specLen, sizeof(spec) - specLen, "%d", value);
+            } else if (specLen < sizeof(spec) - 1) {
+                spec[specLen++] = *p;
+            }
+            if (specLen >= sizeof(spec) - 1) specLen = sizeof(spec) - 1;
+            ++p;
+        }
+        spec[specLen] = '\0';
+        while (*p && strchr("hlLqjzt", *p)) ++p;
+        if (!*p) break;
+
+        const uint8_t* data;
+        size_t dataSize;
+        uint8_t tag = args.next(data, dataSize);
+        if (tag == 0) {
+            append(snprintf(out + pos, size - pos, "<?>"));
+            continue;
+        }
+        append(renderArg(out + pos, size - pos, spec, *p, tag, data, dataSize));
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+size_t LogFormatRegistry::renderFields(const uint8_t* fields, size_t length, char* out, size_t size) {
+    if (size == 0) return 0;
+    LogArgReader args = { fields, fields + length };
+    size_t pos = 0;
+    const uint8_t* key;
+    size_t keySize;
+    while (pos < size - 1 && args.next(key, keySize) == LOG_ARG_STRING) {
+        const uint8_t* data;
+        size_t dataSize;
+        uint8_t tag = args.next(data, dataSize);
+        if (tag == 0) break;
+        int n = snprintf(out + pos, size - pos, " %.*s=", static_cast<int>(keySize), reinterpret_cast<const char*>(key));
+        if (n > 0) pos += static_cast<size_t>(n);
+        if (pos >= size) pos = size - 1;
+        n = renderArg(out + pos, size - pos, "", 0, tag, data, dataSize);
+        if (n > 0) pos += static_cast<size_t>(n);
+        if (pos >= size) pos = size - 1;
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+int LogFormatRegistry::renderValue(char* out, size_t size, uint8_t tag, const uint8_t* data, size_t dataSize) {
+    return renderArg(out, size, "", 0, tag, data, dataSize);
+}
@@ -0,0 +1,452 @@
+#include "LogQuery.h"
+#include <new>
+#include "Logger.h"
+#include "LogCompressor.h"
+#include "LogClock.h"
+
+namespace {
+
+// Rendered binary record: "[s.mmm] [LEVEL] " + message
+const size_t RENDERED_LINE_SIZE = LOG_MESSAGE_SIZE + 40;
+static_assert(RENDERED_LINE_SIZE <= LOG_QUERY_CHUNK_SIZE, "a rendered record must fit the output buffer");
+static_assert(LOG_FORMAT_DEFINITION_MAX_SIZE <= LOG_QUERY_CHUNK_SIZE, "a format definition must fit a chunk");
+
+// Bit n set for every LogLevel n >= minLevel
+uint8_t levelMaskAtLeast(uint8_t minLevel) {
+    return static_cast<uint8_t>(0xFFu << (minLevel & 0x07));
+}
+
+uint8_t parseLevelName(const char* text, char terminator) {
+    for (uint8_t l = LOG_LEVEL_DEBUG; l <= LOG_LEVEL_ERROR; ++l) {
+        const char* name = logLevelToString(static_cast<LogLevel>(l));
+        size_t nameLen = strlen(name);
+        if (strncmp(text, name, nameLen) == 0 && text[nameLen] == terminator) return l;
+    }
+    return LOG_LEVEL_DEBUG;
+}
+
+// {"ts":"...","up":12345,"lvl":"WARN",...} (LogJsonSink): the uptime member is exact, no clock needed
+bool parseJsonRecord(const char* head, uint32_t& timestamp, uint8_t& level) {
+    const char* up = strstr(head, ",\"up\":");
+    if (!up) return false;
+    char* end;
+    timestamp = static_cast<uint32_t>(strtoul(up + 6, &end, 10));
+    if (end == up + 6) return false;
+    const char* lvl = strstr(end, "\"lvl\":\"");
+    level = lvl ? parseLevelName(lvl + 7, '"') : LOG_LEVEL_DEBUG;
+    return true;
+}
+
+// "[YYYY-MM-DDTHH:MM:SS.mmmZ] [LEVEL] ..." -> uptime ms and LogLevel. Year 0000 is the uptime form
+// (hours not wrapped); a UTC time is mapped back to uptime with the current LogClock offset, so
+// records of earlier boots do not parse. `resolution` is 999 for timestamps without milliseconds.
+// JSON lines are recognized by their leading '{'.
+bool parseTextRecord(const uint8_t* record, size_t len, uint32_t& timestamp, uint32_t& resolution, uint8_t& level) {
+    char head[80];
+    size_t n = len < sizeof(head) - 1 ? len : sizeof(head) - 1;
+    memcpy(head, record, n);
+    head[n] = '\0';
+
+    if (head[0] == '{') {
+        resolution = 0;
+        return parseJsonRecord(head, timestamp, level);
+    }
+
+    const char* t = strchr(head, 'T');
+    if (head[0] != '[' || !t) return false;
+    char* end;
+    unsigned long hours = strtoul(t + 1, &end, 10);
+    if (*end != ':') return false;
+    unsigned long minutes = strtoul(end + 1, &end, 10);
+    if (*end != ':') return false;
+    unsigned long seconds = strtoul(end + 1, &end, 10);
+    unsigned long millisPart = 0;
+    resolution = 999;
+    if (*end == '.') {
+        millisPart = strtoul(end + 1, &end, 10);
+        resolution = 0;
+    }
+
+    if (strncmp(head + 1, "0000-", 5) == 0) {
+        timestamp = static_cast<uint32_t>(((hours * 60 + minutes) * 60 + seconds) * 1000 + millisPart);
+    } else {
+        uint64_t unixMs;
+        if (!LogClock::parseIso8601(head + 1, unixMs) || !LogClock::toUptimeMs(unixMs, timestamp)) return false;
+    }
+
+    const char* tag = strstr(end, "] [");
+    level = tag ? parseLevelName(tag + 3, ']') : LOG_LEVEL_DEBUG;
+    return true;
+}
+
+// "[boot 1a2b3c4d]" or {"boot":"1a2b3c4d"} (Logger::prepareFile())
+bool parseBootMarker(const uint8_t* record, size_t len, uint32_t& boot) {
+    const char* text = reinterpret_cast<const char*>(record);
+    size_t prefix;
+    if (len > 6 && strncmp(text, "[boot ", 6) == 0) {
+        prefix = 6;
+    } else if (len > 9 && strncmp(text, "{\"boot\":\"", 9) == 0) {
+        prefix = 9;
+    } else {
+        return false;
+    }
+    char hex[9];
+    size_t n = len - prefix < 8 ? len - prefix : 8;
+    memcpy(hex, text + prefix, n);
+    hex[n] = '\0';
+    boot = static_cast<uint32_t>(strtoul(hex, nullptr, 16));
+    return true;
+}
+
+} // namespace
+
+LogQuery::LogQuery(uint32_t fromMs, uint32_t toMs, uint8_t minLevel, bool binary, Print& out, uint32_t bootId)
+    : fromMs(fromMs), toMs(toMs), minLevel(minLevel), binary(binary), out(out), bootId(bootId) {}
+
+LogQuery::~LogQuery() {
+    finish();
+}
+
+void LogQuery::scanFile(fs::File& data, fs::File& index) {
+    stats.filesScanned++;
+    fileBoot = LOG_BOOT_ANY;
+    uint32_t size = static_cast<uint32_t>(data.size());
+    uint32_t covered = 0;
+
+    if (index) {
+        LogIndexEntry entries[LOG_QUERY_CHUNK_SIZE / sizeof(LogIndexEntry) / 4];
+        size_t n;
+        while ((n = index.read(reinterpret_cast<uint8_t*>(entries), sizeof(entries))) >= sizeof(LogIndexEntry)) {
+            for (size_t i = 0; i < n / sizeof(LogIndexEntry); ++i) {
+                const LogIndexEntry& e = entries[i];
+                // Entries can point past the data after a reset (index appended before the block)
+                if (e.offset < covered || e.offset >= size) continue;
+                uint32_t groupEnd = e.offset + e.length < size ? e.offset + e.length : size;
+                if (e.offset > covered) {
+                    scanRange(data, covered, e.offset);   // Unindexed bytes (raw writes)
+                }
+                if (groupMayMatch(e)) {
+                    stats.groupsScanned++;
+                    scanRange(data, e.offset, groupEnd);
+                } else {
+                    stats.groupsSkipped++;
+                }
+                covered = groupEnd;
+            }
+        }
+    }
+
+    // Tail not covered by the index yet: open group, index entries still in RAM
+    scanRange(data, covered, size);
+}
+
+void LogQuery::finish() {
+    if (outUsed > 0) {
+        out.write(reinterpret_cast<const uint8_t*>(outBuffer), outUsed);
+        outUsed = 0;
+    }
+}
+
+bool LogQuery::groupMayMatch(const LogIndexEntry& entry) const {
+    return entry.lastTimestamp >= fromMs && entry.firstTimestamp <= toMs &&
+           (entry.levelMask & levelMaskAtLeast(minLevel)) != 0;
+}
+
+void LogQuery::scanRange(fs::File& data, uint32_t start, uint32_t end) {
+    if (start >= end || !data.seek(start)) return;
+
+    chunkUsed = 0;
+    uint32_t pos = start;
+    while (pos < end) {
+        size_t want = LOG_QUERY_CHUNK_SIZE - chunkUsed;
+        if (want > end - pos) want = end - pos;
+        size_t n = data.read(chunk + chunkUsed, want);
+        stats.bytesRead += n;
+        pos += n;
+        chunkUsed += n;
+        if (n < want) break;   // Short file
+        extract(false);
+    }
+    extract(true);
+}
+
+void LogQuery::scanCompressed(fs::File& archive) {
+    stats.filesScanned++;
+    fileBoot = LOG_BOOT_ANY;
+    chunkUsed = 0;
+
+    // Decompressed bytes are fed to the record splitter as they come out of the decoder
+    struct Feeder : Print {
+        LogQuery& query;
+        explicit Feeder(LogQuery& query) : query(query) {}
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buf, size_t size) override {
+            query.stats.bytesRead += size;
+            for (size_t done = 0; done < size;) {
+                size_t n = LOG_QUERY_CHUNK_SIZE - query.chunkUsed;
+                if (n > size - done) n = size - done;
+                memcpy(query.chunk + query.chunkUsed, buf + done, n);
+                query.chunkUsed += n;
+                done += n;
+                query.extract(false);
+            }
+            return size;
+        }
+    } feeder(*this);
+
+    LogCompressor::decompress(archive, feeder);
+    extract(true);
+}
+
+bool LogQuery::extract(bool endOfRange) {
+    size_t used = 0;
+    bool complete = true;
+    while (used < chunkUsed) {
+        size_t len = recordLength(chunk + used, chunkUsed - used, endOfRange);
+        if (len == 0) break;
+        // Worst case output of the record: the line itself, or a rendered binary record
+        size_t room = binary ? RENDERED_LINE_SIZE : len;
+        if (bounded && outUsed + room > sizeof(outBuffer)) {
+            complete = false;
+            break;
+        }
+        processRecord(chunk + used, len);
+        used += len;
+    }
+    if (used > 0) {
+        memmove(chunk, chunk + used, chunkUsed - used);
+        chunkUsed -= used;
+    }
+    return complete;
+}
+
+size_t LogQuery::recordLength(const uint8_t* data, size_t available, bool endOfRange) const {
+    if (binary) {
+        if (available < LOG_BINARY_HEADER_SIZE) return endOfRange ? available : 0;
+        if ((data[6] & 0xF0) != LOG_BINARY_SYNC) return 1;   // Resynchronize byte by byte
+        size_t total = LOG_BINARY_HEADER_SIZE + data[7];
+        if (available < total) return endOfRange ? available : 0;
+        return total;
+    }
+
+    size_t scan = available < LOG_QUERY_CHUNK_SIZE ? available : LOG_QUERY_CHUNK_SIZE;
+    const uint8_t* newline = static_cast<const uint8_t*>(memchr(data, '\n', scan));
+    if (newline) return static_cast<size_t>(newline - data) + 1;
+    // Last line without '\n', or a line longer than a chunk (cut)
+    return (endOfRange || scan == LOG_QUERY_CHUNK_SIZE) ? scan : 0;
+}
+
+void LogQuery::processRecord(const uint8_t* record, size_t len) {
+    uint32_t timestamp;
+    uint8_t level;
+
+    if (!binary) {
+        uint32_t boot;
+        if (parseBootMarker(record, len, boot)) {
+            enterBoot(boot);
+            return;
+        }
+        if (bootId != LOG_BOOT_ANY && fileBoot != bootId) return;
+        uint32_t resolution;
+        if (!parseTextRecord(record, len, timestamp, resolution, level)) return;
+        if (timestamp + resolution < fromMs || timestamp > toMs || level < minLevel) return;
+        stats.recordsMatched++;
+        emit(reinterpret_cast<const char*>(record), len);
+        return;
+    }
+
+    if (len < LOG_BINARY_HEADER_SIZE || (record[6] & 0xF0) != LOG_BINARY_SYNC ||
+        len != LOG_BINARY_HEADER_SIZE + record[7]) {
+        return;
+    }
+    memcpy(&timestamp, record, sizeof(timestamp));
+    level = record[6] & 0x0F;
+    if (level == LOG_BINARY_DEFINITION) {
+        // Boot marker, or format definition (the registry already has it)
+        uint16_t formatId;
+        memcpy(&formatId, record + 4, sizeof(formatId));
+        uint32_t boot;
+        if (formatId == LOG_FORMAT_ID_BOOT && record[7] == sizeof(boot)) {
+            memcpy(&boot, record + LOG_BINARY_HEADER_SIZE, sizeof(boot));
+            enterBoot(boot);
+        }
+        return;
+    }
+    if (bootId != LOG_BOOT_ANY && fileBoot != bootId) return;
+    if (timestamp < fromMs || timestamp > toMs || level < minLevel) return;
+    stats.recordsMatched++;
+
+    LogBinaryRecord copy;
+    size_t copied = len < sizeof(copy) ? len : sizeof(copy);
+    memcpy(&copy, record, copied);
+    copy.length = static_cast<uint8_t>(copied - LOG_BINARY_HEADER_SIZE);
+
+    char line[RENDERED_LINE_SIZE];
+    int n = snprintf(line, sizeof(line), "[%lu.%03lu] [%s] ", static_cast<unsigned long>(timestamp / 1000),
+                     static_cast<unsigned long>(timestamp % 1000), logLevelToString(static_cast<LogLevel>(level)));
+    size_t pos = n > 0 ? static_cast<size_t>(n) : 0;
+    pos += LogFormatRegistry::render(copy, line + pos, sizeof(line) - pos - 1);
+    line[pos++] = '\n';
+    emit(line, pos);
+}
+
+void LogQuery::enterBoot(uint32_t boot) {
+    fileBoot = boot;
+    if (bootId != LOG_BOOT_ANY) return;
+    // All boots: the uptimes restart after this line
+    char line[24];
+    int n = snprintf(line, sizeof(line), "[boot %08lx]\n", static_cast<unsigned long>(boot));
+    emit(line, static_cast<size_t>(n));
+}
+
+void LogQuery::emit(const char* data, size_t len) {
+    if (outUsed + len > sizeof(outBuffer)) {
+        finish();
+    }
+    if (len > sizeof(outBuffer)) {
+        out.write(reinterpret_cast<const uint8_t*>(data), len);
+        return;
+    }
+    memcpy(outBuffer + outUsed, data, len);
+    outUsed += len;
+}
+
+// ============================================================================
+// RESUMABLE QUERY
+// ============================================================================
+
+LogQueryCursor::LogQueryCursor(uint32_t fromMs, uint32_t toMs, uint8_t minLevel, bool binary, Print& out,
+                               uint32_t bootId)
+    : LogQuery(fromMs, toMs, minLevel, binary, out, bootId), feeder(*this) {
+    bounded = true;
+}
+
+LogQueryCursor::~LogQueryCursor() {
+    closeDecoder();
+    outUsed = 0;   // Cancelled: the output is flushed after every step otherwise
+}
+
+size_t LogQueryCursor::Feeder::write(const uint8_t* buf, size_t size) {
+    size_t room = sizeof(cursor.chunk) - cursor.chunkUsed;
+    size_t n = size < room ? size : room;
+    memcpy(cursor.chunk + cursor.chunkUsed, buf, n);
+    cursor.chunkUsed += n;
+    cursor.stats.bytesRead += size;
+    return size;
+}
+
+void LogQueryCursor::nextSource() {
+    closeDecoder();
+    fileBoot = LOG_BOOT_ANY;
+    chunkUsed = 0;
+    pos = 0;
+    rangeEnd = 0;
+    indexPos = 0;
+    covered = 0;
+    started = false;
+    tail = false;
+    draining = false;
+}
+
+void LogQueryCursor::closeDecoder() {
+    if (decoder) {
+        decoder->~LogLzDecoder();
+        decoder = nullptr;
+    }
+}
+
+bool LogQueryCursor::resume() {
+    return chunkUsed == 0 || extract(draining);
+}
+
+bool LogQueryCursor::stepFile(fs::File& data, fs::File& index) {
+    if (!resume()) return true;   // Output full: written out by the caller before the next step
+    uint32_t size = static_cast<uint32_t>(data.size());
+    if (!started) {
+        started = true;
+        stats.filesScanned++;
+    }
+    if (pos >= rangeEnd) {
+        if (tail) return false;
+        nextRange(index, size);
+        draining = false;
+        if (pos >= rangeEnd) return !tail;
+    }
+
+    size_t want = LOG_QUERY_CHUNK_SIZE - chunkUsed;
+    if (want > rangeEnd - pos) want = rangeEnd - pos;
+    size_t n = data.seek(pos) ? data.read(chunk + chunkUsed, want) : 0;
+    stats.bytesRead += n;
+    pos += n;
+    chunkUsed += n;
+    if (n < want) pos = rangeEnd;   // Short file
+    draining = pos >= rangeEnd;
+    extract(draining);
+    return true;
+}
+
+void LogQueryCursor::nextRange(fs::File& index, uint32_t size) {
+    // Same walk as scanFile(), one range per call
+    LogIndexEntry entries[LOG_QUERY_CHUNK_SIZE / sizeof(LogIndexEntry) / 4];
+    size_t n;
+    while (index && index.seek(indexPos) &&
+           (n = index.read(reinterpret_cast<uint8_t*>(entries), sizeof(entries))) >= sizeof(LogIndexEntry)) {
+        for (size_t i = 0; i < n / sizeof(LogIndexEntry); ++i) {
+            const LogIndexEntry& e = entries[i];
+            if (e.offset < covered || e.offset >= size) {
+                indexPos += sizeof(LogIndexEntry);
+                continue;
+            }
+            if (e.offset > covered) {
+                pos = covered;   // Unindexed bytes first, the entry is read again afterwards
+                rangeEnd = e.offset;
+                covered = e.offset;
+                return;
+            }
+            indexPos += sizeof(LogIndexEntry);
+            uint32_t groupEnd = e.offset + e.length < size ? e.offset + e.length : size;
+            covered = groupEnd;
+            if (groupMayMatch(e)) {
+                stats.groupsScanned++;
+                pos = e.offset;
+                rangeEnd = groupEnd;
+                return;
+            }
+            stats.groupsSkipped++;
+        }
+    }
+
+    // Tail not covered by the index
+    tail = true;
+    pos = covered;
+    rangeEnd = size > covered ? size : covered;
+}
+
+bool LogQueryCursor::stepCompressed(fs::File& archive) {
+    if (!resume()) return true;
+    if (draining) return false;   // Decoder finished and every record extracted
+    if (!started) {
+        started = true;
+        stats.filesScanned++;
+        decoder = new (decoderStorage) LogLzDecoder(feeder);
+    }
+
+    // One compressed byte at a time, as long as `chunk` can take a full decoder flush
+    uint8_t compressed[LOG_QUERY_ARCHIVE_STEP];
+    size_t n = archive.seek(pos) ? archive.read(compressed, sizeof(compressed)) : 0;
+    size_t fed = 0;
+    while (fed < n && decoder->isValid() && chunkUsed < LOG_QUERY_CHUNK_SIZE) {
+        decoder->write(compressed + fed++, 1);
+        if (!extract(false)) break;
+    }
+    pos += fed;
+    if (n > 0 && decoder->isValid()) return true;
+
+    // End of the archive (or corrupt stream): the decoder flushes what it still buffers
+    if (chunkUsed >= LOG_QUERY_CHUNK_SIZE) return true;
+    decoder->finish();
+    closeDecoder();
+    draining = true;
+    extract(true);
+    return true;
+}
@@ -0,0 +1,211 @@
+#include "LogSink.h"
+#include <math.h>
+
+namespace {
+
+// Bounded JSON writer; `limit` keeps room for what must follow (closing braces)
+struct JsonWriter {
+    char* buf;
+    size_t limit;
+    size_t pos;
+
+    bool raw(const char* s, size_t n) {
+        if (pos + n > limit) return false;
+        memcpy(buf + pos, s, n);
+        pos += n;
+        return true;
+    }
+
+    bool raw(const char* s) { return raw(s, strlen(s)); }
+
+    bool printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(buf + pos, limit - pos + 1, fmt, args);
+        va_end(args);
+        if (n < 0 || pos + static_cast<size_t>(n) > limit) return false;
+        pos += static_cast<size_t>(n);
+        return true;
+    }
+
+    // Quoted, escaped string; `cut` allows truncation (on a UTF-8 boundary) instead of failing
+    bool string(const char* s, size_t n, bool cut) {
+        size_t start = pos;
+        if (!raw("\"", 1)) return false;
+        size_t end = limit;
+        limit = end - 1;   // Room for the closing quote
+        size_t i = 0;
+        for (; i < n; ++i) {
+            char c = s[i];
+            char esc[7];
+            size_t len = 1;
+            esc[0] = c;
+            if (c == '"' || c == '\\') {
+                esc[0] = '\\';
+                esc[1] = c;
+                len = 2;
+            } else if (static_cast<uint8_t>(c) < 0x20) {
+                len = (c == '\n') ? 2 : (c == '\r') ? 2 : (c == '\t') ? 2 : 6;
+                if (len == 2) {
+                    esc[0] = '\\';
+                    esc[1] = (c == '\n') ? 'n' : (c == '\r') ? 'r' : 't';
+                } else {
+                    snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned>(c));
+                }
+            }
+            if (!raw(esc, len)) break;
+        }
+        limit = end;
+        if (i < n) {
+            if (!cut) {
+                pos = start;
+                return false;
+            }
+            // Do not leave half of a multi-byte character
+            while (i > 0 && (static_cast<uint8_t>(s[i]) & 0xC0) == 0x80) {
+                --i;
+                --pos;
+            }
+        }
+        return raw("\"", 1);
+    }
+
+    bool value(uint8_t tag, const uint8_t* data, size_t size) {
+        switch (tag) {
+            case LOG_ARG_INT32: {
+                int32_t v;
+                memcpy(&v, data, sizeof(v));
+                return printf("%ld", static_cast<long>(v));
+            }
+            case LOG_ARG_UINT32: {
+                uint32_t v;
+                memcpy(&v, data, sizeof(v));
+                return printf("%lu", static_cast<unsigned long>(v));
+            }
+            case LOG_ARG_INT64: {
+                int64_t v;
+                memcpy(&v, data, sizeof(v));
+                return printf("%lld", static_cast<long long>(v));
+            }
+            case LOG_ARG_UINT64: {
+                uint64_t v;
+                memcpy(&v, data, sizeof(v));
+                return printf("%llu", static_cast<unsigned long long>(v));
+            }
+            case LOG_ARG_DOUBLE: {
+                double v;
+                memcpy(&v, data, sizeof(v));
+                return isfinite(v) ? printf("%.7g", v) : raw("null");
+            }
+            case LOG_ARG_STRING:
+                return string(reinterpret_cast<const char*>(data), size, false);
+            case LOG_ARG_POINTER: {
+                uint32_t v;
+                memcpy(&v, data, sizeof(v));
+                return printf("\"0x%08lx\"", static_cast<unsigned long>(v));
+            }
+            default:
+                return false;
+        }
+    }
+};
+
+} // namespace
+
+void LogTextSink::write(const LogEntry& entry) {
+    char buffer[LOG_LINE_SIZE];
+    size_t len = Logger::formatEntry(entry, buffer, sizeof(buffer));
+    out.write(reinterpret_cast<const uint8_t*>(buffer), len);
+}
+
+void LogJsonSink::write(const LogEntry& entry) {
+    char buffer[LOG_LINE_SIZE];
+    size_t len = format(entry, buffer, sizeof(buffer));
+    out.write(reinterpret_cast<const uint8_t*>(buffer), len);
+}
+
+size_t LogJsonSink::format(const LogEntry& entry, char* buffer, size_t size) {
+    if (size < 4) return 0;
+
+    // Fields first, in a scratch buffer: the message is cut to make room for them
+    char fields[LOG_LINE_SIZE / 2];
+    JsonWriter f = { fields, sizeof(fields), 0 };
+    if (entry.fieldsLength > 0) {
+        LogArgReader args = { entry.fields(), entry.fields() + entry.fieldsLength };
+        const uint8_t* key;
+        size_t keySize;
+        while (args.next(key, keySize) == LOG_ARG_STRING) {
+            const uint8_t* data;
+            size_t dataSize;
+            uint8_t tag = args.next(data, dataSize);
+            if (tag == 0) break;
+            size_t mark = f.pos;
+            if (!f.raw(",", 1) || !f.string(reinterpret_cast<const char*>(key), keySize, false) || !f.raw(":", 1) ||
+                !f.value(tag, data, dataSize)) {
+                f.pos = mark;   // Pair dropped whole
+                break;
+            }
+        }
+    }
+
+    size_t closing = f.pos + 2;   // fields + "}\n"
+    JsonWriter w = { buffer, size - 1 > closing ? size - 1 - closing : 0, 0 };
+    w.raw("{\"ts\":");
+    w.string(entry.timestamp, strnlen(entry.timestamp, sizeof(entry.timestamp)), true);
+    w.printf(",\"up\":%lu,\"lvl\":\"%s\"", static_cast<unsigned long>(entry.uptimeMs), logLevelToString(entry.level));
+    // Escaped like the message: __FILE__ may hold backslashes (Windows builds) or quotes
+    if (entry.file && entry.file[0]) {
+        char src[160];
+        int n = snprintf(src, sizeof(src), "%s:%d", entry.file, entry.line);
+        size_t srcLen = n < 0 ? 0 : static_cast<size_t>(n) < sizeof(src) ? static_cast<size_t>(n) : sizeof(src) - 1;
+        size_t mark = w.pos;
+        if (!w.raw(",\"src\":") || !w.string(src, srcLen, false)) w.pos = mark;
+    }
+    if (entry.function && entry.function[0]) {
+        size_t mark = w.pos;
+        if (!w.raw(",\"fn\":") || !w.string(entry.function, strlen(entry.function), false)) w.pos = mark;
+    }
+    if (w.raw(",\"msg\":")) {
+        w.string(entry.message, strnlen(entry.message, sizeof(entry.message)), true);
+    }
+
+    // Room reserved above: fields and the closing brace always fit
+    w.limit = size - 1;
+    w.raw(fields, f.pos);
+    w.raw("}\n", 2);
+    buffer[w.pos] = '\0';
+    return w.pos;
+}
+
+void logEntryToBinary(const LogEntry& entry, LogBinaryRecord& record) {
+    record.timestamp = entry.uptimeMs;
+    record.level = LOG_BINARY_SYNC | static_cast<uint8_t>(entry.level);
+    size_t textLen = strnlen(entry.message, sizeof(entry.message));
+
+    if (entry.fieldsLength == 0) {
+        record.formatId = LOG_FORMAT_ID_TEXT;
+        size_t n = textLen < sizeof(record.payload) ? textLen : sizeof(record.payload);
+        memcpy(record.payload, entry.message, n);
+        record.length = static_cast<uint8_t>(n);
+        return;
+    }
+
+    record.formatId = LOG_FORMAT_ID_FIELDS;
+    LogArgPacker packer(record.payload, sizeof(record.payload));
+    packer.pack(entry.message);
+    size_t len = packer.length();
+
+    // Whole pairs only
+    LogArgReader args = { entry.fields(), entry.fields() + entry.fieldsLength };
+    const uint8_t* pairStart = args.p;
+    const uint8_t* data;
+    size_t dataSize;
+    while (args.next(data, dataSize) == LOG_ARG_STRING && args.next(data, dataSize) != 0) {
+        size_t pairSize = static_cast<size_t>(args.p - pairStart);
+        if (len + pairSize > sizeof(record.payload)) break;
+        memcpy(record.payload + len, pairStart, pairSize);
+        len += pairSize;
+        pairStart = args.p;
+    }
+    record.length = static_cast<uint8_t>(len);
+}
@@ -1,7 +1,11 @@
 #include "Logger.h"
 #include <stdarg.h>
 #include <Arduino.h>
+#include <esp_timer.h>
 #include "FileLogger.h"
+#include "LogCrashRing.h"
+#include "LogSink.h"
+#include "LogQuery.h"
 
 const char* logLevelToString(LogLevel level) {
     switch (level) {
@@ -14,19 +18,39 @@ const char* logLevelToString(LogLevel level) {
     }
 }
 
-static FileLogger fileLogger;
+// Deferred-format builds write binary records (/log_N.bin), see LogFormat.h; text builds JSON lines
+static FileLogger fileLogger(LOG_DEFERRED_FORMAT ? ".bin" : (LOG_FILE_JSON ? ".jsonl" : ".txt"), SPIFFS,
+                             LOG_FILE_COMPRESSION);
 
-// --- Timestamp ISO 8601 uptime ---
-String getTimestampISO8601() {
-    unsigned long ms = millis();
-    unsigned long seconds = ms / 1000;
-    unsigned long minutes = seconds / 60;
-    unsigned long hours = minutes / 60;
-    seconds = seconds % 60;
-    minutes = minutes % 60;
-    char buf[32];
-    snprintf(buf, sizeof(buf), "0000-00-00T%02lu:%02lu:%02luZ", hours, minutes, seconds);
-    return String(buf);
+// `file` of the entries replayed from the RTC crash ring
+static const char* const LOG_CRASH_FILE_TAG = "<crash>";
+
+// --- Timestamp ISO 8601 (UTC once LogClock is set, uptime before) ---
+static LogTimestampFormatter timestampFormatter;
+
+static void formatTimestampISO8601(char* buf, size_t size, unsigned long ms) {
+    timestampFormatter.format(buf, size, ms);
+}
+
+// Header of a live record (message and fields are filled by the caller)
+static void initEntry(LogEntry& entry, LogLevel level, const char* file, const char* function, int line) {
+    entry.uptimeMs = millis();
+    formatTimestampISO8601(entry.timestamp, sizeof(entry.timestamp), entry.uptimeMs);
+    entry.level = level;
+    entry.file = file;
+    entry.function = function;
+    entry.line = line;
+    entry.fieldsLength = 0;
+}
+
+// FNV-1a: identifies a repeated record without keeping a copy of it
+static uint32_t hashBytes(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
 }
 
 Logger& Logger::getInstance() {
@@ -34,33 +58,313 @@ Logger& Logger::getInstance() {
     return instance;
 }
 
-Logger::Logger() : currentLevel(LOG_LEVEL_INFO) {}
+Logger::Logger() : currentLevel(LOG_LEVEL_INFO), lowestLevel(LOG_LEVEL_INFO) {}
 
 void Logger::begin(bool enableSPIFFS) {
     // Prérequis : SPIFFS doit être monté (SPIFFS.begin()) avant d'appeler cette méthode.
     if (enableSPIFFS) {
-        fileLogger.begin();
+        fileEnabled = fileLogger.begin();
     }
     Serial.println("[Logger] Initialized");
+    acquireConsumer();
+    recoverCrashLog();
+    releaseConsumer();
+}
+
+void Logger::end() {
+    stopAsync();
+    acquireConsumer();
+    drainLocked();
+    if (fileEnabled) {
+        fileLogger.end();
+        fileEnabled = false;
+    }
+    releaseConsumer();
 }
 
-void Logger::setLevel(LogLevel level) { currentLevel = level; }
+void Logger::setLevel(LogLevel level) {
+    currentLevel = level;
+    updateLowestLevel();
+}
 LogLevel Logger::getLevel() const { return currentLevel; }
 
+bool Logger::setTagLevel(const char* tag, LogLevel level) {
+    if (!tag) return false;
+    for (size_t i = 0; i < tagLevelCount; ++i) {
+        if (strcmp(tagLevels[i].tag, tag) == 0) {
+            tagLevels[i].level = level;
+            updateLowestLevel();
+            return true;
+        }
+    }
+    if (tagLevelCount >= LOG_MAX_TAG_LEVELS) return false;
+    // The tag pointer is kept: pass a literal (LOG_TAG) or another static string
+    tagLevels[tagLevelCount].tag = tag;
+    tagLevels[tagLevelCount].level = level;
+    tagLevelCount++;
+    updateLowestLevel();
+    return true;
+}
+
+void Logger::clearTagLevel(const char* tag) {
+    if (!tag) return;
+    for (size_t i = 0; i < tagLevelCount; ++i) {
+        if (strcmp(tagLevels[i].tag, tag) == 0) {
+            tagLevels[i] = tagLevels[--tagLevelCount];
+            break;
+        }
+    }
+    updateLowestLevel();
+}
+
+void Logger::updateLowestLevel() {
+    LogLevel lowest = currentLevel;
+    for (size_t i = 0; i < tagLevelCount; ++i) {
+        if (tagLevels[i].level < lowest) lowest = tagLevels[i].level;
+    }
+    lowestLevel = lowest;
+}
+
 void Logger::log(LogLevel level, const char* file, const char* function, int line, const char* format, ...) {
-    if (level < currentLevel) return;
+    // The LOG_* macros already applied the per-tag level; direct calls only get this pre-filter
+    if (level < lowestLevel) return;
+
+    // Formatted on the stack, then copied into the history slot (sync) or the ring (async):
+    // a coalesced repeat never takes a slot. No String, no heap allocation either way.
+    LogEntry entry;
+    initEntry(entry, level, file, function, line);
 
-    char buffer[256];
     va_list args;
     va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    vsnprintf(entry.message, sizeof(entry.message), format, args);
     va_end(args);
 
-    String ts = getTimestampISO8601();
+    dispatch(entry);
+}
+
+void Logger::submitFields(LogLevel level, const char* file, const char* function, int line, const char* event,
+                          const uint8_t* fields, size_t fieldsLength) {
+    LogEntry entry;
+    initEntry(entry, level, file, function, line);
+
+    // message = event '\0' packed fields (fieldsLength <= LOG_BINARY_PAYLOAD_SIZE)
+    const char* text = event ? event : "";
+    size_t textLen = strnlen(text, sizeof(entry.message) - 1 - fieldsLength);
+    memcpy(entry.message, text, textLen);
+    entry.message[textLen] = '\0';
+    memcpy(entry.message + textLen + 1, fields, fieldsLength);
+    entry.fieldsLength = static_cast<uint8_t>(fieldsLength);
+
+    dispatch(entry);
+}
 
-    Serial.printf("[%s] [%s] %s:%d (%s): %s\n", ts.c_str(), logLevelToString(level), file, line, function, buffer);
+void Logger::dispatch(LogEntry& entry) {
+    // WARN/ERROR also go to the RTC ring right away: they must survive a reset before any flush
+    if (entry.level >= LOG_CRASH_RING_MIN_LEVEL) {
+        if (entry.fieldsLength > 0) {
+            LogBinaryRecord record;
+            logEntryToBinary(entry, record);
+            recordCrash(record.level, record.timestamp, record.formatId, record.payload, record.length);
+        } else {
+            recordCrash(LOG_BINARY_SYNC | static_cast<uint8_t>(entry.level), entry.uptimeMs, LOG_FORMAT_ID_TEXT,
+                        entry.message, strnlen(entry.message, sizeof(entry.message)));
+        }
+    }
+    enqueue(entryRings[xPortGetCoreID()], entry, entry.level >= LOG_LEVEL_ERROR);
+}
+
+void Logger::recordCrash(uint8_t level, uint32_t timestamp, uint16_t formatId, const void* payload, size_t length) {
+#if LOG_COALESCE_REPEATS
+    // Same record as the previous one of this core: coalesced later, do not evict older slots for it
+    uint32_t hash = hashBytes(payload, length) ^ formatId ^ level;
+    uint32_t& last = lastCrashHash[xPortGetCoreID()];
+    if (hash == last) return;
+    last = hash;
+#endif
+    LogCrashRing::record(level, timestamp, formatId, payload, length);
+}
 
-    // --- Add to circular buffer history ---
+template <typename Ring, typename Record>
+void Logger::enqueue(Ring& ring, const Record& record, bool urgent) {
+    if (!asyncTask) {
+        // Sync mode: never dropped, a full ring waits for the consumer (or becomes it)
+        while (!ring.push(record, false)) {
+            if (ownsConsumer()) {
+                ring.push(record);   // Logged from a sink: waiting for the consumer would wait for itself
+                return;
+            }
+            drainFromProducer();
+            vTaskDelay(1);   // Blocks: a lower-priority holder of the role on this core gets to run
+        }
+        drainFromProducer();
+        return;
+    }
+
+    bool dropOldest = overflowPolicy == LOG_OVERFLOW_DROP_OLDEST;
+    bool accepted = ring.push(record, !dropOldest);
+    if (!accepted && dropOldest) {
+        // Only the consumer may free a slot: done here if the drain task is not running right now.
+        // Otherwise (or if another producer took the freed slot) the incoming record is the one
+        // dropped, counted apart from LOG_OVERFLOW_DROP_NEWEST rejections
+        if (tryAcquireConsumer()) {
+            ring.discardOldest();
+            releaseConsumer();
+        }
+        accepted = ring.push(record, false);
+        if (!accepted) ring.countBusyDrop();
+    }
+    if (accepted) {
+        asyncEnqueued.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Wake the drain task early for errors or when the ring is half full
+    if (urgent || ring.size() >= ring.capacity() / 2) {
+        xTaskNotifyGive(asyncTask);
+    }
+}
+
+void Logger::acquireConsumer() {
+    while (!tryAcquireConsumer()) {
+        vTaskDelay(1);
+    }
+}
+
+bool Logger::hasPending() const {
+    for (size_t core = 0; core < LOG_CORE_COUNT; ++core) {
+        if (entryRings[core].peek() || binaryRings[core].peek()) return true;
+    }
+    return false;
+}
+
+void Logger::releaseConsumer() {
+    unlockConsumer();
+    // Sync mode: a record pushed while the role was held (its producer failed to take it) is
+    // written now; in async mode the drain task picks it up
+    if (!asyncTask) drainFromProducer();
+}
+
+void Logger::drainFromProducer() {
+    // A record pushed while another task holds the role is written by that task, or found by
+    // its re-check after the release (both sides are sequentially consistent)
+    while (hasPending() && tryAcquireConsumer()) {
+        drainLocked();
+        unlockConsumer();
+    }
+}
+
+// ============================================================================
+// STORM PROTECTION
+// ============================================================================
+
+bool Logger::isRepeat(uint32_t hash, const char* file, const char* function, int line, uint8_t level,
+                      uint32_t nowMs) {
+    if (hash == repeat.hash && file == repeat.file && line == repeat.line && level == repeat.level) {
+        if (repeat.count++ == 0) {
+            repeat.sinceMs = nowMs;
+        }
+        coalesced.fetch_add(1, std::memory_order_relaxed);
+        if (nowMs - repeat.sinceMs >= LOG_REPEAT_SUMMARY_MS) {
+            flushRepeatsLocked();
+        }
+        return true;
+    }
+    // Another record: the pending summary goes out first, in order
+    flushRepeatsLocked();
+    repeat.hash = hash;
+    repeat.file = file;
+    repeat.function = function;
+    repeat.line = line;
+    repeat.level = level;
+    return false;
+}
+
+void Logger::flushRepeats() {
+    acquireConsumer();
+    drainLocked();
+    flushRepeatsLocked();
+    flushSerialBatch();
+    commitFile(false);
+    releaseConsumer();
+}
+
+void Logger::flushRepeatsLocked() {
+    if (repeat.count == 0) return;
+    uint32_t count = repeat.count;
+    repeat.count = 0;
+
+    const char* file = repeat.file;
+    const char* function = repeat.function;
+    int line = repeat.line;
+    if (!file) {
+        // Deferred-format record: `line` holds its format ID
+        LogFormatRegistry::getFormat(static_cast<uint16_t>(repeat.line), &file, &line);
+        function = "";
+    }
+    LogEntry entry;
+    initEntry(entry, static_cast<LogLevel>(repeat.level), file ? file : "?", function, line);
+    snprintf(entry.message, sizeof(entry.message), "last message repeated %lu times", static_cast<unsigned long>(count));
+    summaries.fetch_add(1, std::memory_order_relaxed);
+    writeEntry(entry);
+}
+
+bool Logger::rateLimitPass(LogRateLimiter& limiter, LogLevel level, const char* file, const char* function,
+                           int line) {
+    uint32_t suppressed = 0;
+    if (!limiter.allow(millis(), suppressed)) {
+        rateLimited.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (suppressed > 0) {
+        LogEntry entry;
+        initEntry(entry, level, file, function, line);
+        snprintf(entry.message, sizeof(entry.message), "%lu messages suppressed (rate limit)",
+                 static_cast<unsigned long>(suppressed));
+        summaries.fetch_add(1, std::memory_order_relaxed);
+        dispatch(entry);
+    }
+    return true;
+}
+
+bool Logger::addSink(LogSink& sink) {
+    // Sinks are only called by the consumer: the list changes under the same role
+    acquireConsumer();
+    size_t i = 0;
+    while (i < sinkCount && sinks[i] != &sink) ++i;
+    if (i == sinkCount && sinkCount < LOG_MAX_SINKS) {
+        sinks[sinkCount++] = &sink;
+    }
+    bool registered = i < sinkCount;
+    releaseConsumer();
+    return registered;
+}
+
+void Logger::removeSink(LogSink& sink) {
+    acquireConsumer();
+    drainLocked();   // The sink still gets what was logged before its removal
+    for (size_t i = 0; i < sinkCount; ++i) {
+        if (sinks[i] == &sink) {
+            // Order kept: sinks are called in registration order
+            memmove(&sinks[i], &sinks[i + 1], (sinkCount - i - 1) * sizeof(sinks[0]));
+            sinks[--sinkCount] = nullptr;
+            break;
+        }
+    }
+    releaseConsumer();
+}
+
+void Logger::writeSinks(const LogEntry& entry) {
+    for (size_t i = 0; i < sinkCount; ++i) {
+        sinks[i]->write(entry);
+    }
+}
+
+void Logger::submitBinary(const LogBinaryRecord& record) {
+    if ((record.level & 0x0F) >= LOG_CRASH_RING_MIN_LEVEL) {
+        recordCrash(record.level, record.timestamp, record.formatId, record.payload, record.length);
+    }
+    enqueue(binaryRings[xPortGetCoreID()], record, (record.level & 0x0F) >= LOG_LEVEL_ERROR);
+}
+
+LogEntry& Logger::reserveHistorySlot() {
     size_t pos;
     if (historyCount < LOG_HISTORY_SIZE) {
         pos = (historyHead + historyCount) % LOG_HISTORY_SIZE;
@@ -69,21 +373,453 @@ void Logger::log(LogLevel level, const char* file, const char* function, int lin
         pos = historyHead;
         historyHead = (historyHead + 1) % LOG_HISTORY_SIZE;
     }
+    historySequence++;
+    return history[pos];
+}
+
+void Logger::emit(const LogEntry& entry) {
+    flushSerialBatch();   // Keeps Serial in record order
+    // Serial.printf() mallocs for lines longer than 64 bytes, so compose on the stack
+    char buffer[LOG_LINE_SIZE];
+    size_t len = formatEntry(entry, buffer, sizeof(buffer));
+    if (serialEnabled) {
+        Serial.write(reinterpret_cast<const uint8_t*>(buffer), len);
+    }
+    writeFile(entry, buffer, len);
+    writeSinks(entry);
+}
+
+void Logger::writeFile(const LogEntry& entry, const char* text, size_t len) {
+    if (!fileEnabled) return;
+
+#if LOG_DEFERRED_FORMAT
+    if (entry.fieldsLength > 0) {
+        LogBinaryRecord fieldsRecord;
+        logEntryToBinary(entry, fieldsRecord);
+        prepareFile(fieldsRecord.storedSize());
+        fileLogger.writeRecord(reinterpret_cast<const char*>(&fieldsRecord), fieldsRecord.storedSize(),
+                               entry.uptimeMs, entry.level);
+        return;
+    }
+    // Plain text entries are stored as LOG_FORMAT_ID_TEXT records in the binary files
+    uint8_t record[LOG_BINARY_HEADER_SIZE + LOG_MESSAGE_SIZE];
+    size_t textLen = strnlen(entry.message, sizeof(entry.message));
+    if (textLen > 255) textLen = 255;
+    uint32_t timestamp = entry.uptimeMs;
+    uint16_t formatId = LOG_FORMAT_ID_TEXT;
+    memcpy(record, &timestamp, sizeof(timestamp));
+    memcpy(record + 4, &formatId, sizeof(formatId));
+    record[6] = LOG_BINARY_SYNC | static_cast<uint8_t>(entry.level);
+    record[7] = static_cast<uint8_t>(textLen);
+    memcpy(record + LOG_BINARY_HEADER_SIZE, entry.message, textLen);
+    prepareFile(LOG_BINARY_HEADER_SIZE + textLen);
+    fileLogger.writeRecord(reinterpret_cast<const char*>(record), LOG_BINARY_HEADER_SIZE + textLen,
+                           entry.uptimeMs, entry.level);
+#elif LOG_FILE_JSON
+    (void)text;
+    (void)len;
+    char json[LOG_LINE_SIZE];
+    size_t jsonLen = LogJsonSink::format(entry, json, sizeof(json));
+    prepareFile(jsonLen);
+    fileLogger.writeRecord(json, jsonLen, entry.uptimeMs, entry.level);
+#else
+    prepareFile(len);
+    fileLogger.writeRecord(text, len, entry.uptimeMs, entry.level);
+#endif
+}
+
+void Logger::prepareFile(size_t len) {
+    // Every file starts with a boot marker (uptimes only compare within one boot) and defines its formats
+    uint32_t generation = fileLogger.reserve(len + LOG_BOOT_MARKER_SIZE);
+    if (generation == fileGeneration) return;
+    fileGeneration = generation;
+    memset(definedFormats, 0, sizeof(definedFormats));
+
+    char marker[LOG_BOOT_MARKER_SIZE];
+    size_t markerLen;
+#if LOG_DEFERRED_FORMAT
+    LogBinaryRecord record;
+    record.timestamp = millis();
+    record.formatId = LOG_FORMAT_ID_BOOT;
+    record.level = LOG_BINARY_SYNC | LOG_BINARY_DEFINITION;
+    record.length = sizeof(fileBootId);
+    memcpy(record.payload, &fileBootId, sizeof(fileBootId));
+    markerLen = record.storedSize();
+    memcpy(marker, &record, markerLen);
+#elif LOG_FILE_JSON
+    markerLen = snprintf(marker, sizeof(marker), "{\"boot\":\"%08lx\"}\n", static_cast<unsigned long>(fileBootId));
+#else
+    markerLen = snprintf(marker, sizeof(marker), "[boot %08lx]\n", static_cast<unsigned long>(fileBootId));
+#endif
+    fileLogger.writeMarker(marker, markerLen);
+}
+
+void Logger::setFileBoot(uint32_t bootId) {
+    // The next record writes a marker again (and its format definition): later records belong to `bootId`
+    fileBootId = bootId;
+    fileGeneration = 0;
+}
 
-    history[pos].timestamp = ts;
-    history[pos].level = level;
-    history[pos].file = String(file);
-    history[pos].function = String(function);
-    history[pos].line = line;
-    history[pos].message = String(buffer);
+void Logger::processBinary(const LogBinaryRecord& record) {
+    LogEntry& entry = reserveHistorySlot();
+    const char* file = "?";
+    int line = 0;
+    LogFormatRegistry::getFormat(record.formatId, &file, &line);
+    entry.uptimeMs = record.timestamp;
+    formatTimestampISO8601(entry.timestamp, sizeof(entry.timestamp), record.timestamp);
+    entry.level = static_cast<LogLevel>(record.level & 0x0F);
+    entry.file = file;
+    entry.function = "";
+    entry.line = line;
+    entry.fieldsLength = 0;
+    LogArgReader args = { record.payload, record.payload + record.length };
+    const uint8_t* event;
+    size_t eventSize;
+    if (record.formatId == LOG_FORMAT_ID_FIELDS && args.next(event, eventSize) == LOG_ARG_STRING) {
+        // Back to a structured entry: event text, then the pairs still packed
+        size_t fieldsLength = static_cast<size_t>(args.end - args.p);
+        memcpy(entry.message, event, eventSize);
+        entry.message[eventSize] = '\0';
+        memcpy(entry.message + eventSize + 1, args.p, fieldsLength);
+        entry.fieldsLength = static_cast<uint8_t>(fieldsLength);
+    } else {
+        LogFormatRegistry::render(record, entry.message, sizeof(entry.message));
+    }
+
+#if LOG_DEFERRED_FORMAT
+    if (serialEnabled) {
+        char buffer[LOG_LINE_SIZE];
+        size_t len = formatEntry(entry, buffer, sizeof(buffer));
+        Serial.write(reinterpret_cast<const uint8_t*>(buffer), len);
+    }
+    if (fileEnabled) {
+        writeBinaryFile(record);
+    }
+    writeSinks(entry);
+#else
+    // Structured records replayed from the crash ring: stored like live ones
+    emit(entry);
+#endif
 }
 
-void Logger::printLogHistory(Stream& out, size_t maxEntries) const {
+void Logger::writeBinaryFile(const LogBinaryRecord& record) {
+    uint8_t buffer[LOG_FORMAT_DEFINITION_MAX_SIZE + sizeof(LogBinaryRecord)];
+    size_t len = 0;
+    int slot = LogFormatRegistry::getSlot(record.formatId);
+
+    // Room for a definition too: the record may open a file where its format is not defined yet
+    prepareFile(record.storedSize() + (slot >= 0 ? LOG_FORMAT_DEFINITION_MAX_SIZE : 0));
+    if (slot >= 0) {
+        uint32_t bit = 1u << (slot % 32);
+        if (!(definedFormats[slot / 32] & bit)) {
+            // First record of this format in the file: its definition goes in the same write
+            len = LogFormatRegistry::writeDefinition(record.formatId, record.timestamp, buffer,
+                                                     LOG_FORMAT_DEFINITION_MAX_SIZE);
+            definedFormats[slot / 32] |= bit;
+        }
+    }
+    memcpy(buffer + len, &record, record.storedSize());
+    len += record.storedSize();
+    fileLogger.writeRecord(reinterpret_cast<const char*>(buffer), len, record.timestamp, record.level & 0x0F);
+}
+
+void Logger::commitFile(bool urgent) {
+    for (size_t i = 0; i < sinkCount; ++i) {
+        sinks[i]->commit(urgent);
+    }
+    if (!fileEnabled) return;
+    // ERROR records reach the flash right away, the rest is group-committed per block
+    if (urgent) {
+        fileLogger.flushNow();
+    } else {
+        fileLogger.commitIfDue();
+    }
+}
+
+void Logger::writeSerial(const char* text, size_t len) {
+    if (serialEnabled) {
+        Serial.write(reinterpret_cast<const uint8_t*>(text), len);
+    }
+}
+
+size_t Logger::queryLogs(uint32_t fromMs, uint32_t toMs, LogLevel minLevel, Print& out, uint32_t bootId) {
+    if (!fileEnabled) return 0;
+    // The consumer role also owns the files: no record is written while they are read
+    acquireConsumer();
+    size_t matched = fileLogger.query(fromMs, toMs, minLevel, out, bootId);
+    releaseConsumer();
+    return matched;
+}
+
+bool Logger::queryStep(LogQueryCursor& cursor) {
+    if (!fileEnabled) return false;
+    if (!tryAcquireConsumer()) return true;
+    bool more = fileLogger.queryStep(cursor);
+    releaseConsumer();
+    cursor.finish();
+    return more;
+}
+
+// ============================================================================
+// CRASH RING RECOVERY
+// ============================================================================
+
+void Logger::recoverCrashLog() {
+    size_t count = LogCrashRing::pending();
+    if (count == 0) return;
+
+    esp_reset_reason_t reason = esp_reset_reason();
+    LogEntry& header = reserveHistorySlot();
+    header.uptimeMs = millis();
+    formatTimestampISO8601(header.timestamp, sizeof(header.timestamp), header.uptimeMs);
+    header.level = LOG_LEVEL_WARNING;
+    header.file = LOG_CRASH_FILE_TAG;
+    header.function = "";
+    header.line = 0;
+    header.fieldsLength = 0;
+    snprintf(header.message, sizeof(header.message), "Boot #%lu after reset %s (%d): %u records recovered",
+             static_cast<unsigned long>(LogCrashRing::getBootCount()), LogCrashRing::resetReasonToString(reason),
+             static_cast<int>(reason), static_cast<unsigned>(count));
+    emit(header);
+
+    // Uptimes of the previous run: kept apart from this boot in the files
+    setFileBoot(LOG_BOOT_EARLIER);
+    LogCrashRing::forEach(replayCrashSlot, this);
+    LogCrashRing::clear();
+    setFileBoot(LogClock::getBootId());
+    commitFile(true);
+}
+
+void Logger::replayCrashSlot(const LogCrashSlot& slot, void* ctx) {
+    Logger* self = static_cast<Logger*>(ctx);
+    if (slot.formatId != LOG_FORMAT_ID_TEXT && slot.length <= LOG_BINARY_PAYLOAD_SIZE) {
+        // Deferred-format record: same bytes as the original, rendered like a live one
+        LogBinaryRecord record;
+        memcpy(&record, slot.record(), slot.recordSize());
+        self->processBinary(record);
+        return;
+    }
+
+    LogEntry& entry = self->reserveHistorySlot();
+    entry.uptimeMs = slot.timestamp;
+    // Uptime of the previous run: the current wall clock does not apply
+    LogTimestampFormatter::formatUptime(entry.timestamp, sizeof(entry.timestamp), slot.timestamp);
+    entry.level = static_cast<LogLevel>(slot.level & 0x0F);
+    entry.file = LOG_CRASH_FILE_TAG;
+    entry.function = "";
+    entry.line = 0;
+    entry.fieldsLength = 0;
+    size_t len = slot.length < sizeof(entry.message) ? slot.length : sizeof(entry.message) - 1;
+    memcpy(entry.message, slot.payload, len);
+    entry.message[len] = '\0';
+    self->emit(entry);
+}
+
+// ============================================================================
+// ASYNC PIPELINE
+// ============================================================================
+
+bool Logger::startAsync(LogOverflowPolicy policy, UBaseType_t priority, BaseType_t core) {
+    if (asyncTask) return true;
+
+    overflowPolicy = policy;
+    asyncStopRequested = false;
+    BaseType_t ok = xTaskCreatePinnedToCore(asyncTaskEntry, "logger", LOG_ASYNC_TASK_STACK_SIZE,
+                                            this, priority, &asyncTask, core);
+    if (ok != pdPASS) {
+        asyncTask = nullptr;
+        Serial.println("[Logger] Unable to start async task");
+        return false;
+    }
+    return true;
+}
+
+void Logger::stopAsync() {
+    if (!asyncTask) return;
+
+    asyncStopRequested = true;
+    xTaskNotifyGive(asyncTask);
+    // The task drains the backlog and clears asyncTask before deleting itself
+    while (asyncTask) {
+        vTaskDelay(1);
+    }
+}
+
+LogAsyncStats Logger::getAsyncStats() const {
+    LogAsyncStats stats = {};
+    stats.enqueued = asyncEnqueued.load(std::memory_order_relaxed);
+    stats.written = asyncWritten;
+    stats.batches = asyncBatches;
+    stats.busyUs = asyncBusyUs;
+    for (size_t core = 0; core < LOG_CORE_COUNT; ++core) {
+        stats.droppedNewest += entryRings[core].getDroppedNewest() + binaryRings[core].getDroppedNewest();
+        stats.droppedOldest += entryRings[core].getDroppedOldest() + binaryRings[core].getDroppedOldest();
+        stats.droppedBusy += entryRings[core].getDroppedBusy() + binaryRings[core].getDroppedBusy();
+        stats.depth += entryRings[core].size() + binaryRings[core].size();
+    }
+    return stats;
+}
+
+void Logger::asyncTaskEntry(void* arg) {
+    Logger* self = static_cast<Logger*>(arg);
+    for (;;) {
+        bool stopping = self->asyncStopRequested;
+        if (!stopping) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_ASYNC_FLUSH_INTERVAL_MS));
+        }
+        int64_t start = esp_timer_get_time();
+        self->acquireConsumer();
+        uint32_t count = self->drainLocked();
+        self->releaseConsumer();
+        if (count > 0) {
+            self->asyncWritten += count;
+            self->asyncBatches++;
+        }
+        self->asyncBusyUs += static_cast<uint64_t>(esp_timer_get_time() - start);
+        LogTaskHook hook = self->asyncHook;
+        if (hook) {
+            hook(self->asyncHookCtx);
+        }
+        if (stopping) break;
+    }
+    self->asyncTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
+// ============================================================================
+// CONSUMER
+// ============================================================================
+
+uint32_t Logger::drainLocked() {
+    uint32_t count = 0;
+    bool urgent = false;
+
+    // The heads of all rings, text and deferred-format, per core, are merged by timestamp: the
+    // history and the files stay in time order across cores and across both kinds of records
+    LogBinaryRecord record;
+    for (;;) {
+        size_t next = LOG_CORE_COUNT;
+        bool nextBinary = false;
+        uint32_t nextMs = 0;
+        for (size_t core = 0; core < LOG_CORE_COUNT; ++core) {
+            const LogEntry* head = entryRings[core].peek();
+            if (head && (next == LOG_CORE_COUNT || static_cast<int32_t>(head->uptimeMs - nextMs) < 0)) {
+                next = core;
+                nextBinary = false;
+                nextMs = head->uptimeMs;
+            }
+            const LogBinaryRecord* binary = binaryRings[core].peek();
+            if (binary && (next == LOG_CORE_COUNT || static_cast<int32_t>(binary->timestamp - nextMs) < 0)) {
+                next = core;
+                nextBinary = true;
+                nextMs = binary->timestamp;
+            }
+        }
+        if (next == LOG_CORE_COUNT) break;
+        count++;
+
+        if (nextBinary) {
+            // Deferred-format records are rendered here, off the LOG_* call path
+            binaryRings[next].pop(record);
+            urgent |= (record.level & 0x0F) >= LOG_LEVEL_ERROR;
+#if LOG_COALESCE_REPEATS
+            if (isRepeat(hashBytes(record.payload, record.length), nullptr, "", record.formatId, record.level & 0x0F,
+                         record.timestamp)) {
+                continue;
+            }
+#endif
+            processBinary(record);
+            continue;
+        }
+
+        const LogEntry& entry = *entryRings[next].peek();
+        urgent |= entry.level >= LOG_LEVEL_ERROR;
+#if LOG_COALESCE_REPEATS
+        size_t textLen = strnlen(entry.message, sizeof(entry.message));
+        size_t len = entry.fieldsLength > 0 ? textLen + 1 + entry.fieldsLength : textLen;
+        if (!isRepeat(hashBytes(entry.message, len), entry.file, entry.function, entry.line, entry.level,
+                      entry.uptimeMs)) {
+            writeEntry(entry);
+        }
+#else
+        writeEntry(entry);
+#endif
+        entryRings[next].release();
+    }
+
+    flushSerialBatch();
+    // Also runs on idle wake-ups so that the commit deadline holds without new records
+    commitFile(urgent);
+    return count;
+}
+
+void Logger::writeEntry(const LogEntry& entry) {
+    LogEntry& slot = reserveHistorySlot();
+    slot = entry;
+#if LOG_DEFERRED_FORMAT
+    emit(slot);   // Becomes a LOG_FORMAT_ID_TEXT record, cannot be batched as text
+#else
+    if (LOG_ASYNC_BATCH_SIZE - serialBatchUsed < LOG_LINE_SIZE) {
+        flushSerialBatch();
+    }
+    // Serial gets the batch; the file gets one record per line (FileLogger blocks them, and indexes them)
+    size_t len = formatEntry(slot, serialBatch + serialBatchUsed, LOG_ASYNC_BATCH_SIZE - serialBatchUsed);
+    writeFile(slot, serialBatch + serialBatchUsed, len);
+    writeSinks(slot);
+    serialBatchUsed += len;
+#endif
+}
+
+void Logger::flushSerialBatch() {
+    if (serialBatchUsed > 0) {
+        writeSerial(serialBatch, serialBatchUsed);
+        serialBatchUsed = 0;
+    }
+}
+
+size_t Logger::formatEntry(const LogEntry& e, char* buffer, size_t size) {
+    if (size < 2) return 0;
+    // One byte kept for the '\n': a truncated line stays terminated
+    int n = snprintf(buffer, size - 1, "[%s] [%s] %s:%d (%s): %s",
+                     e.timestamp, logLevelToString(e.level), e.file, e.line, e.function, e.message);
+    if (n < 0) return 0;
+    size_t pos = static_cast<size_t>(n) < size - 1 ? static_cast<size_t>(n) : size - 2;
+    if (e.fieldsLength > 0) {
+        pos += LogFormatRegistry::renderFields(e.fields(), e.fieldsLength, buffer + pos, size - 1 - pos);
+    }
+    buffer[pos++] = '\n';
+    buffer[pos] = '\0';
+    return pos;
+}
+
+void Logger::printLogHistory(Stream& out, size_t maxEntries) {
+    acquireConsumer();
+    drainLocked();
     size_t n = (maxEntries == 0 || maxEntries > historyCount) ? historyCount : maxEntries;
+    char buffer[LOG_LINE_SIZE];
     for (size_t i = 0; i < n; ++i) {
         size_t idx = (historyHead + i) % LOG_HISTORY_SIZE;
-        const LogEntry& e = history[idx];
-        out.printf("[%s] [%s] %s:%d (%s): %s\n",
-           e.timestamp.c_str(), logLevelToString(e.level), e.file.c_str(), e.line, e.function.c_str(), e.message.c_str());
+        size_t len = formatEntry(history[idx], buffer, sizeof(buffer));
+        out.write(reinterpret_cast<const uint8_t*>(buffer), len);
+    }
+    releaseConsumer();
+}
+
+uint32_t Logger::getHistorySequence() {
+    acquireConsumer();
+    drainLocked();
+    uint32_t next = historySequence;
+    releaseConsumer();
+    return next;
+}
+
+bool Logger::readHistory(uint32_t seq, LogEntry& out) {
+    acquireConsumer();
+    uint32_t oldest = historySequence - static_cast<uint32_t>(historyCount);
+    bool present = seq - oldest < historyCount;   // Wrap-safe: also rejects seq < oldest
+    if (present) {
+        out = history[(historyHead + (seq - oldest)) % LOG_HISTORY_SIZE];
     }
+    releaseConsumer();
+    return present;
 }
@@ -0,0 +1,180 @@
+#include "SerialConsole.h"
+
+static const uint8_t CONSOLE_CTRL_C = 0x03;
+
+SerialConsole::SerialConsole(Stream& io) : io(io) {}
+
+uint32_t SerialConsole::hashName(const char* name, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+    }
+    return hash;
+}
+
+bool SerialConsole::registerCommand(const char* name, const char* help, ConsoleHandler handler, void* ctx) {
+    size_t len = strlen(name);
+    if (commandCount >= CONSOLE_MAX_COMMANDS || len == 0 || !handler || findCommand(name, len)) {
+        return false;
+    }
+    size_t slot = hashName(name, len) & (HASH_SIZE - 1);
+    while (hashSlots[slot] != 0) {
+        slot = (slot + 1) & (HASH_SIZE - 1);
+    }
+    commands[commandCount] = { name, help ? help : "", handler, ctx };
+    hashSlots[slot] = static_cast<uint8_t>(++commandCount);
+    return true;
+}
+
+const ConsoleCommand* SerialConsole::findCommand(const char* name, size_t len) const {
+    // Half-empty table: the probe stops at the first free slot after one or two steps on average
+    size_t slot = hashName(name, len) & (HASH_SIZE - 1);
+    while (hashSlots[slot] != 0) {
+        const ConsoleCommand& command = commands[hashSlots[slot] - 1];
+        if (strncmp(command.name, name, len) == 0 && command.name[len] == '\0') {
+            return &command;
+        }
+        slot = (slot + 1) & (HASH_SIZE - 1);
+    }
+    return nullptr;
+}
+
+bool SerialConsole::startJob(ConsoleJob& next) {
+    if (job) return false;
+    job = &next;
+    return true;
+}
+
+void SerialConsole::poll() {
+    readInput();
+    // Type-ahead waits in the input ring while a job is running
+    if (!job) {
+        processInput();
+    }
+    runJob();
+    sendOutput(false);
+}
+
+void SerialConsole::readInput() {
+    while (inTail - inHead < CONSOLE_INPUT_SIZE && io.available() > 0) {
+        int c = io.read();
+        if (c < 0) break;
+        if (c == CONSOLE_CTRL_C) {
+            // Interrupts the job at once, even with commands typed ahead
+            if (job) {
+                job->cancel();
+                job = nullptr;
+                stats.jobsCancelled++;
+                print("^C\n");
+            }
+            lineLength = 0;
+            lineOverflow = false;
+            continue;
+        }
+        input[inTail++ & (CONSOLE_INPUT_SIZE - 1)] = static_cast<uint8_t>(c);
+    }
+}
+
+void SerialConsole::processInput() {
+    while (!job && inHead != inTail) {
+        char c = static_cast<char>(input[inHead++ & (CONSOLE_INPUT_SIZE - 1)]);
+        if (c == '\r') continue;
+        if (c == '\b' || c == 0x7F) {
+            if (lineLength > 0) lineLength--;
+            continue;
+        }
+        if (c != '\n') {
+            if (lineLength < CONSOLE_LINE_SIZE - 1) {
+                line[lineLength++] = c;
+            } else {
+                lineOverflow = true;   // The rest of the line is dropped, then reported
+            }
+            continue;
+        }
+
+        line[lineLength] = '\0';
+        lineLength = 0;
+        if (lineOverflow) {
+            lineOverflow = false;
+            stats.inputOverflows++;
+            printf("❌ Ligne trop longue (max %u caractères)\n", static_cast<unsigned>(CONSOLE_LINE_SIZE - 1));
+            continue;
+        }
+        dispatch(line);
+    }
+}
+
+void SerialConsole::dispatch(char* text) {
+    while (*text == ' ' || *text == '\t') text++;
+    if (*text == '\0') return;
+
+    char* name = text;
+    while (*text && *text != ' ' && *text != '\t') text++;
+    size_t nameLen = static_cast<size_t>(text - name);
+    while (*text == ' ' || *text == '\t') text++;
+    char* args = text;
+    char* end = args + strlen(args);
+    while (end > args && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+
+    stats.lines++;
+    const ConsoleCommand* command = findCommand(name, nameLen);
+    if (!command) {
+        stats.unknown++;
+        name[nameLen] = '\0';
+        printf("❓ Commande inconnue: %s (help)\n", name);
+        return;
+    }
+    command->handler(*this, args, command->ctx);
+}
+
+void SerialConsole::runJob() {
+    for (int steps = 0; job && steps < CONSOLE_MAX_JOB_STEPS; ++steps) {
+        if (outputFree() < CONSOLE_JOB_CHUNK) {
+            sendOutput(false);
+            if (outputFree() < CONSOLE_JOB_CHUNK) return;   // The UART is the bottleneck: resume next poll
+        }
+        if (!job->step(*this)) {
+            job = nullptr;
+        }
+    }
+}
+
+size_t SerialConsole::write(const uint8_t* data, size_t len) {
+    size_t written = 0;
+    while (written < len) {
+        if (outputFree() == 0) {
+            stats.outputStalls++;
+            sendOutput(true);
+        }
+        size_t pos = outTail & (CONSOLE_OUTPUT_SIZE - 1);
+        size_t n = len - written;
+        size_t contiguous = CONSOLE_OUTPUT_SIZE - pos;
+        if (n > contiguous) n = contiguous;
+        if (n > outputFree()) n = outputFree();
+        memcpy(output + pos, data + written, n);
+        outTail += n;
+        written += n;
+    }
+    return written;
+}
+
+void SerialConsole::sendOutput(bool blocking) {
+    while (outHead != outTail) {
+        size_t pos = outHead & (CONSOLE_OUTPUT_SIZE - 1);
+        size_t n = outTail - outHead;
+        size_t contiguous = CONSOLE_OUTPUT_SIZE - pos;
+        if (n > contiguous) n = contiguous;
+        if (!blocking) {
+            int room = io.availableForWrite();
+            if (room <= 0) return;
+            if (n > static_cast<size_t>(room)) n = static_cast<size_t>(room);
+        }
+        size_t sent = io.write(output + pos, n);
+        if (blocking) {
+            outHead += sent ? sent : n;   // A stream that refuses the bytes must not hang the caller
+            return;                       // One piece is enough to make room
+        }
+        outHead += sent;
+        if (sent < n) return;
+    }
+}
@@ -0,0 +1,235 @@
+#include "SystemRuntime.h"
+#include <esp_timer.h>
+#include "Logger.h"
+#include "watchdog_manager.h"
+
+static const char* const RUNTIME_TASK_NAMES[RUNTIME_TASK_COUNT] = { "ocpp", "metering", "logger" };
+static const int RUNTIME_TASK_CORES[RUNTIME_TASK_COUNT] = { RUNTIME_OCPP_CORE, RUNTIME_METERING_CORE,
+                                                            RUNTIME_LOGGER_CORE };
+static const UBaseType_t RUNTIME_TASK_PRIORITIES[RUNTIME_TASK_COUNT] = { RUNTIME_OCPP_PRIORITY,
+                                                                         RUNTIME_METERING_PRIORITY,
+                                                                         RUNTIME_LOGGER_PRIORITY };
+
+// Longest blocking wait of a task: it must feed its watchdog well before the timeout
+static const uint32_t RUNTIME_MAX_WAIT_MS = RUNTIME_TASK_WDT_TIMEOUT_MS / 4;
+
+SystemRuntime::SystemRuntime()
+    : hooks(), watchdog(nullptr), sampleQueue(nullptr), requestQueue(nullptr), tasks(), meteringIntervalMs(0),
+      startUs(0), stopRequested(false), samplesSent(0), samplesDropped(0), requestsDropped(0) {
+    for (size_t i = 0; i < RUNTIME_TASK_COUNT; ++i) {
+        tasks[i].watchdogId = -1;
+    }
+}
+
+bool SystemRuntime::begin(const Hooks& taskHooks, uint32_t intervalMs, WatchdogManager* taskWatchdog) {
+    if (tasks[RUNTIME_TASK_OCPP].handle || tasks[RUNTIME_TASK_METERING].handle) return false;
+
+    hooks = taskHooks;
+    watchdog = taskWatchdog;
+    meteringIntervalMs = intervalMs ? intervalMs : MEASUREMENT_INTERVAL;
+    stopRequested = false;
+    startUs = esp_timer_get_time();
+
+    if (!sampleQueue) sampleQueue = xQueueCreate(RUNTIME_SAMPLE_QUEUE_LENGTH, sizeof(hardware_measurements_t));
+    if (!requestQueue) requestQueue = xQueueCreate(RUNTIME_REQUEST_QUEUE_LENGTH, sizeof(Request));
+    if (!sampleQueue || !requestQueue) {
+        Serial.println("❌ Runtime: création des files impossible");
+        return false;
+    }
+
+    for (size_t i = 0; i < RUNTIME_TASK_COUNT; ++i) {
+        tasks[i].cycles = 0;
+        tasks[i].busyUs = 0;
+        tasks[i].watchdogId = watchdog ? watchdog->registerTaskWatchdog(RUNTIME_TASK_NAMES[i],
+                                                                         RUNTIME_TASK_WDT_TIMEOUT_MS)
+                                       : -1;
+    }
+
+    // The Logger drain task is the background task: it only reports back through the hook
+    Logger& logger = Logger::getInstance();
+    logger.setAsyncTaskHook(loggerHook, this);
+    if (!logger.startAsync(LOG_OVERFLOW_DROP_NEWEST, RUNTIME_LOGGER_PRIORITY, RUNTIME_LOGGER_CORE)) {
+        logger.setAsyncTaskHook(nullptr, nullptr);
+    }
+    tasks[RUNTIME_TASK_LOGGER].handle = logger.getAsyncTask();
+
+    BaseType_t ok = xTaskCreatePinnedToCore(meteringTaskEntry, RUNTIME_TASK_NAMES[RUNTIME_TASK_METERING],
+                                            RUNTIME_METERING_STACK_SIZE, this, RUNTIME_METERING_PRIORITY,
+                                            &tasks[RUNTIME_TASK_METERING].handle, RUNTIME_METERING_CORE);
+    if (ok == pdPASS) {
+        ok = xTaskCreatePinnedToCore(ocppTaskEntry, RUNTIME_TASK_NAMES[RUNTIME_TASK_OCPP], RUNTIME_OCPP_STACK_SIZE,
+                                     this, RUNTIME_OCPP_PRIORITY, &tasks[RUNTIME_TASK_OCPP].handle,
+                                     RUNTIME_OCPP_CORE);
+    }
+    if (ok != pdPASS) {
+        Serial.println("❌ Runtime: création des tâches impossible");
+        end();
+        return false;
+    }
+    return true;
+}
+
+void SystemRuntime::end() {
+    stopRequested = true;
+    // Each task clears its handle before deleting itself
+    while (tasks[RUNTIME_TASK_OCPP].handle || tasks[RUNTIME_TASK_METERING].handle) {
+        vTaskDelay(1);
+    }
+    Logger& logger = Logger::getInstance();
+    logger.stopAsync();
+    logger.setAsyncTaskHook(nullptr, nullptr);
+    tasks[RUNTIME_TASK_LOGGER].handle = nullptr;
+
+    for (size_t i = 0; i < RUNTIME_TASK_COUNT; ++i) {
+        if (watchdog && tasks[i].watchdogId >= 0) {
+            watchdog->unregisterWatchdog(tasks[i].watchdogId);
+        }
+        tasks[i].watchdogId = -1;
+    }
+}
+
+bool SystemRuntime::requestSample() {
+    return sendRequest(REQUEST_SAMPLE, 0);
+}
+
+bool SystemRuntime::setMeteringInterval(uint32_t intervalMs) {
+    return intervalMs > 0 && sendRequest(REQUEST_INTERVAL, intervalMs);
+}
+
+bool SystemRuntime::sendRequest(RequestType type, uint32_t value) {
+    Request request = { type, value };
+    if (!requestQueue || xQueueSend(requestQueue, &request, 0) != pdTRUE) {
+        requestsDropped++;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// TASKS
+// ============================================================================
+
+void SystemRuntime::meteringTaskEntry(void* arg) {
+    SystemRuntime* self = static_cast<SystemRuntime*>(arg);
+    uint32_t interval = self->meteringIntervalMs;
+    uint32_t nextSample = millis() + interval;
+
+    while (!self->stopRequested) {
+        int32_t wait = static_cast<int32_t>(nextSample - millis());
+        if (wait < 0) wait = 0;
+        if (static_cast<uint32_t>(wait) > RUNTIME_MAX_WAIT_MS) wait = RUNTIME_MAX_WAIT_MS;
+
+        Request request;
+        bool sampleNow = false;
+        if (xQueueReceive(self->requestQueue, &request, pdMS_TO_TICKS(wait)) == pdTRUE) {
+            if (request.type == REQUEST_INTERVAL) {
+                interval = request.value;
+                nextSample = millis() + interval;
+            } else {
+                sampleNow = true;
+            }
+        }
+
+        int64_t start = esp_timer_get_time();
+        uint32_t now = millis();
+        if (sampleNow || static_cast<int32_t>(now - nextSample) >= 0) {
+            // Interval kept in phase; restarted after an on-demand sample or a long stall
+            nextSample = (sampleNow || static_cast<int32_t>(now - nextSample) >= static_cast<int32_t>(interval))
+                             ? now + interval
+                             : nextSample + interval;
+            hardware_measurements_t sample;
+            if (self->hooks.measure && self->hooks.measure(self->hooks.ctx, sample)) {
+                self->publishSample(sample);
+            }
+        }
+        self->endCycle(RUNTIME_TASK_METERING, start);
+    }
+    self->tasks[RUNTIME_TASK_METERING].handle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void SystemRuntime::ocppTaskEntry(void* arg) {
+    SystemRuntime* self = static_cast<SystemRuntime*>(arg);
+
+    while (!self->stopRequested) {
+        // Woken by the first sample, otherwise one OCPP cycle every RUNTIME_OCPP_PERIOD_MS
+        hardware_measurements_t sample;
+        bool received = xQueueReceive(self->sampleQueue, &sample, pdMS_TO_TICKS(RUNTIME_OCPP_PERIOD_MS)) == pdTRUE;
+
+        int64_t start = esp_timer_get_time();
+        while (received) {
+            if (self->hooks.onSample) self->hooks.onSample(self->hooks.ctx, sample);
+            received = xQueueReceive(self->sampleQueue, &sample, 0) == pdTRUE;
+        }
+        if (self->hooks.ocppLoop) self->hooks.ocppLoop(self->hooks.ctx);
+        self->endCycle(RUNTIME_TASK_OCPP, start);
+    }
+    self->tasks[RUNTIME_TASK_OCPP].handle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void SystemRuntime::loggerHook(void* ctx) {
+    SystemRuntime* self = static_cast<SystemRuntime*>(ctx);
+    TaskState& task = self->tasks[RUNTIME_TASK_LOGGER];
+    task.cycles = task.cycles + 1;
+    if (self->watchdog && task.watchdogId >= 0) {
+        self->watchdog->feedWatchdog(task.watchdogId);
+    }
+}
+
+void SystemRuntime::publishSample(const hardware_measurements_t& sample) {
+    // Single producer: making room cannot race with another sender
+    if (xQueueSend(sampleQueue, &sample, 0) != pdTRUE) {
+        hardware_measurements_t oldest;
+        if (xQueueReceive(sampleQueue, &oldest, 0) == pdTRUE) {
+            samplesDropped++;
+        }
+        xQueueSend(sampleQueue, &sample, 0);
+    }
+    samplesSent++;
+}
+
+void SystemRuntime::endCycle(RuntimeTaskId id, int64_t start) {
+    TaskState& task = tasks[id];
+    task.busyUs = task.busyUs + static_cast<uint64_t>(esp_timer_get_time() - start);
+    task.cycles = task.cycles + 1;
+    if (watchdog && task.watchdogId >= 0) {
+        watchdog->feedWatchdog(task.watchdogId);
+    }
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+bool SystemRuntime::getTaskStats(RuntimeTaskId id, RuntimeTaskStats& out) const {
+    if (id < 0 || id >= RUNTIME_TASK_COUNT) return false;
+    const TaskState& task = tasks[id];
+    TaskHandle_t handle = task.handle;
+    uint64_t busyUs = id == RUNTIME_TASK_LOGGER ? Logger::getInstance().getAsyncStats().busyUs : task.busyUs;
+    int64_t elapsedUs = esp_timer_get_time() - startUs;
+
+    out.name = RUNTIME_TASK_NAMES[id];
+    out.core = RUNTIME_TASK_CORES[id];
+    out.priority = RUNTIME_TASK_PRIORITIES[id];
+    out.running = handle != nullptr;
+    out.stackFree = handle ? uxTaskGetStackHighWaterMark(handle) : 0;
+    out.cycles = task.cycles;
+    out.cpuPercent = elapsedUs > 0 ? 100.0f * static_cast<float>(busyUs) / static_cast<float>(elapsedUs) : 0.0f;
+    return true;
+}
+
+void SystemRuntime::printTaskStats(Print& out) const {
+    out.println("🧵 Tâches     cœur prio  CPU %   pile libre  cycles");
+    for (int i = 0; i < RUNTIME_TASK_COUNT; ++i) {
+        RuntimeTaskStats stats;
+        getTaskStats(static_cast<RuntimeTaskId>(i), stats);
+        out.printf("   %-10s %d    %-4u  %6.2f  %6lu      %lu%s\n", stats.name, stats.core,
+                   static_cast<unsigned>(stats.priority), stats.cpuPercent, static_cast<unsigned long>(stats.stackFree),
+                   static_cast<unsigned long>(stats.cycles), stats.running ? "" : " (arrêtée)");
+    }
+    RuntimeQueueStats queues = getQueueStats();
+    out.printf("   Échantillons: %lu envoyés, %lu écrasés ; requêtes refusées: %lu\n",
+               static_cast<unsigned long>(queues.samplesSent), static_cast<unsigned long>(queues.samplesDropped),
+               static_cast<unsigned long>(queues.requestsDropped));
+}
@@ -0,0 +1,159 @@
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(SchedulerClock clock) : clock(clock ? clock : millisClock) {}
+
+int TaskScheduler::addTask(const char* name, uint32_t periodMs, ScheduledCallback callback, void* ctx,
+                           uint32_t firstDelayMs) {
+    if (taskCount >= SCHEDULER_MAX_TASKS || !callback) {
+        return SCHEDULER_INVALID_TASK;
+    }
+    uint8_t index = static_cast<uint8_t>(taskCount++);
+    tasks[index] = { name ? name : "", callback, ctx, periodMs, 0, 0, -1, 0, 0, 0 };
+    arm(index, clock() + firstDelayMs);
+    return index;
+}
+
+bool TaskScheduler::setPeriod(int id, uint32_t periodMs) {
+    if (!validId(id)) return false;
+    tasks[id].periodMs = periodMs;
+    arm(static_cast<uint8_t>(id), clock() + periodMs);
+    return true;
+}
+
+bool TaskScheduler::runIn(int id, uint32_t delayMs) {
+    if (!validId(id)) return false;
+    arm(static_cast<uint8_t>(id), clock() + delayMs);
+    return true;
+}
+
+bool TaskScheduler::setEnabled(int id, bool enabled) {
+    if (!validId(id)) return false;
+    Task& task = tasks[id];
+    if (!enabled) {
+        disarm(static_cast<uint8_t>(id));
+    } else if (task.heapPos < 0) {
+        arm(static_cast<uint8_t>(id), clock() + task.periodMs);
+    }
+    return true;
+}
+
+uint32_t TaskScheduler::runDue() {
+    uint32_t now = clock();
+    // One pass per job at most: a job that re-arms itself for "now" waits for the next call
+    for (size_t budget = taskCount; budget > 0 && heapSize > 0; --budget) {
+        uint8_t index = heap[0];
+        Task& task = tasks[index];
+        int32_t late = static_cast<int32_t>(now - task.deadline);
+        if (late < 0) break;
+
+        if (static_cast<uint32_t>(late) > task.maxLateMs) task.maxLateMs = static_cast<uint32_t>(late);
+        task.runs++;
+        if (task.periodMs > 0) {
+            // Re-armed before the call, from the deadline and not from `now`: no drift
+            uint32_t next = task.deadline + task.periodMs;
+            if (static_cast<int32_t>(now - next) >= 0) {
+                uint32_t skipped = (now - next) / task.periodMs + 1;
+                task.missed += skipped;
+                next += skipped * task.periodMs;
+            }
+            arm(index, next);
+        } else {
+            disarm(index);
+        }
+        task.callback(task.ctx);
+    }
+    return msUntilNext();
+}
+
+uint32_t TaskScheduler::msUntilNext() const {
+    if (heapSize == 0) return SCHEDULER_IDLE_MAX_MS;
+    int32_t left = static_cast<int32_t>(tasks[heap[0]].deadline - clock());
+    return left > 0 ? static_cast<uint32_t>(left) : 0;
+}
+
+void TaskScheduler::idle(uint32_t maxMs) {
+    uint32_t wait = msUntilNext();
+    if (wait > maxMs) wait = maxMs;
+    if (wait == 0) return;
+    // A wake() that arrives before the wait is latched by the task notification
+    idleTask = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+}
+
+void TaskScheduler::wake() {
+    TaskHandle_t task = idleTask;
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+}
+
+bool TaskScheduler::getTaskStats(int id, ScheduledTaskStats& out) const {
+    if (!validId(id)) return false;
+    const Task& task = tasks[id];
+    out = { task.name, task.periodMs, task.heapPos >= 0, task.runs, task.missed, task.maxLateMs };
+    return true;
+}
+
+// ============================================================================
+// Min-heap on (deadline, order), wrap-safe comparisons on the 32-bit clock
+// ============================================================================
+
+bool TaskScheduler::before(uint8_t a, uint8_t b) const {
+    int32_t diff = static_cast<int32_t>(tasks[a].deadline - tasks[b].deadline);
+    if (diff != 0) return diff < 0;
+    return static_cast<int32_t>(tasks[a].order - tasks[b].order) < 0;
+}
+
+void TaskScheduler::arm(uint8_t index, uint32_t deadline) {
+    Task& task = tasks[index];
+    task.deadline = deadline;
+    task.order = nextOrder++;
+    if (task.heapPos < 0) {
+        place(heapSize++, index);
+    }
+    siftUp(task.heapPos);
+    siftDown(task.heapPos);
+}
+
+void TaskScheduler::disarm(uint8_t index) {
+    int pos = tasks[index].heapPos;
+    if (pos < 0) return;
+    tasks[index].heapPos = -1;
+    uint8_t last = heap[--heapSize];
+    if (static_cast<size_t>(pos) < heapSize) {
+        place(pos, last);
+        siftUp(pos);
+        siftDown(tasks[last].heapPos);
+    }
+}
+
+void TaskScheduler::place(size_t pos, uint8_t index) {
+    heap[pos] = index;
+    tasks[index].heapPos = static_cast<int8_t>(pos);
+}
+
+void TaskScheduler::siftUp(size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!before(heap[pos], heap[parent])) break;
+        uint8_t moved = heap[parent];
+        place(parent, heap[pos]);
+        place(pos, moved);
+        pos = parent;
+    }
+}
+
+void TaskScheduler::siftDown(size_t pos) {
+    for (;;) {
+        size_t smallest = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if (left < heapSize && before(heap[left], heap[smallest])) smallest = left;
+        if (right < heapSize && before(heap[right], heap[smallest])) smallest = right;
+        if (smallest == pos) break;
+        uint8_t moved = heap[smallest];
+        place(smallest, heap[pos]);
+        place(pos, moved);
+        pos = smallest;
+    }
+}
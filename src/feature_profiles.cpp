@@ -0,0 +1,100 @@
+/**
+ * @file feature_profiles.cpp
+ * @brief Implémentation des Feature Profiles OCPP 1.6
+ *
+ * Les messages de chaque profil viennent de la table générée ocpp_actions.h ; l'activation par
+ * défaut, des FEATURE_PROFILE_* de ocpp_config.h.
+ */
+
+#include "feature_profiles.h"
+#include "ocpp_actions.h"
+#include "ocpp_config.h"
+
+const char* FEATURE_PROFILE_NAMES[FEATURE_PROFILE_COUNT] = {
+    "Core", "FirmwareManagement", "LocalAuthListManagement", "RemoteTrigger", "Reservation", "SmartCharging"
+};
+
+static const bool FEATURE_PROFILE_DEFAULTS[FEATURE_PROFILE_COUNT] = {
+    FEATURE_PROFILE_CORE != 0,
+    FEATURE_PROFILE_FIRMWARE_MANAGEMENT != 0,
+    FEATURE_PROFILE_LOCAL_AUTH_LIST != 0,
+    FEATURE_PROFILE_REMOTE_TRIGGER != 0,
+    FEATURE_PROFILE_RESERVATION != 0,
+    FEATURE_PROFILE_SMART_CHARGING != 0
+};
+
+static feature_profiles_config_t profilesConfig;
+// Noms des messages regroupés par profil : message_names pointe dans ce tableau
+static const char* profileMessageNames[OCPP_ACTION_COUNT];
+static bool profilesInitialized = false;
+
+feature_profiles_config_t* FeatureProfiles_init() {
+    if (profilesInitialized) return &profilesConfig;
+
+    size_t next = 0;
+    profilesConfig.enabled_count = 0;
+    for (int id = 0; id < FEATURE_PROFILE_COUNT; ++id) {
+        feature_profile_config_t& profile = profilesConfig.profiles[id];
+        profile.id = static_cast<feature_profile_id_t>(id);
+        profile.name = FEATURE_PROFILE_NAMES[id];
+        profile.enabled = FEATURE_PROFILE_DEFAULTS[id];
+        profile.message_names = &profileMessageNames[next];
+        profile.message_count = 0;
+        for (const ocpp_action_info_t& action : OCPP_ACTIONS) {
+            if (action.profile != id) continue;
+            profileMessageNames[next++] = action.name;
+            profile.message_count++;
+        }
+        if (profile.enabled) profilesConfig.enabled_count++;
+    }
+    profilesInitialized = true;
+    return &profilesConfig;
+}
+
+bool FeatureProfiles_isEnabled(feature_profile_id_t profile_id) {
+    if (profile_id < 0 || profile_id >= FEATURE_PROFILE_COUNT) return false;
+    return FeatureProfiles_init()->profiles[profile_id].enabled;
+}
+
+bool FeatureProfiles_setEnabled(feature_profile_id_t profile_id, bool enabled) {
+    if (profile_id < 0 || profile_id >= FEATURE_PROFILE_COUNT) return false;
+    // Core : obligatoire (OCPP 1.6 §3.3)
+    if (profile_id == FEATURE_PROFILE_CORE_ID && !enabled) return false;
+
+    feature_profiles_config_t* config = FeatureProfiles_init();
+    feature_profile_config_t& profile = config->profiles[profile_id];
+    if (profile.enabled != enabled) {
+        profile.enabled = enabled;
+        if (enabled) config->enabled_count++;
+        else config->enabled_count--;
+    }
+    return true;
+}
+
+size_t FeatureProfiles_getSupportedList(char* buffer, size_t buffer_size) {
+    if (!buffer || buffer_size == 0) return 0;
+    feature_profiles_config_t* config = FeatureProfiles_init();
+    size_t written = 0;
+    buffer[0] = '\0';
+    for (const feature_profile_config_t& profile : config->profiles) {
+        if (!profile.enabled) continue;
+        int n = snprintf(buffer + written, buffer_size - written, "%s%s", written ? "," : "", profile.name);
+        if (n < 0 || static_cast<size_t>(n) >= buffer_size - written) {
+            buffer[written] = '\0';   // Pas de nom tronqué dans la liste
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return written;
+}
+
+const char* FeatureProfiles_getName(feature_profile_id_t profile_id) {
+    if (profile_id < 0 || profile_id >= FEATURE_PROFILE_COUNT) return NULL;
+    return FEATURE_PROFILE_NAMES[profile_id];
+}
+
+bool FeatureProfiles_validateMessage(const char* message_name) {
+    if (!message_name) return false;
+    ocpp_action_t action = ocppActionFind(message_name, strlen(message_name));
+    return action != OCPP_ACTION_UNKNOWN && FeatureProfiles_isEnabled(OCPP_ACTIONS[action].profile);
+}
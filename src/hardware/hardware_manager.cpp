@@ -7,6 +7,13 @@
 */
 
 #include "hardware_manager.h"
+#include "TaskScheduler.h"
+
+#define LOG_TAG "hardware"
+#include "log_macros.h"
+
+// Borne mono-connecteur : identifiant OCPP du connecteur piloté par ce gestionnaire
+static constexpr int HW_CONNECTOR_ID = 1;
 
 HardwareManager::HardwareManager() {
     currentState = HW_STATE_INIT;
@@ -19,6 +26,11 @@ HardwareManager::HardwareManager() {
     errorLedState = false;
     blinkingEnabled = false;
     errorBlinkingEnabled = false;
+    scheduler = nullptr;
+    measurementTask = SCHEDULER_INVALID_TASK;
+    statusBlinkTask = SCHEDULER_INVALID_TASK;
+    errorBlinkTask = SCHEDULER_INVALID_TASK;
+    buttonTask = SCHEDULER_INVALID_TASK;
     
     // Initialiser les mesures à zéro
     memset(&lastMeasurements, 0, sizeof(hardware_measurements_t));
@@ -91,15 +103,13 @@ void HardwareManager::loop() {
         
         // Gestion du clignotement de la LED de statut
         if (blinkingEnabled && (now - lastBlinkTime >= blinkInterval)) {
-            statusLedState = !statusLedState;
-            digitalWrite(LED_STATUS_PIN, statusLedState);
+            toggleStatusLed();
             lastBlinkTime = now;
         }
         
         // Gestion du clignotement de la LED d'erreur
         if (errorBlinkingEnabled && (now - lastErrorBlinkTime >= errorBlinkInterval)) {
-            errorLedState = !errorLedState;
-            digitalWrite(LED_ERROR_PIN, errorLedState);
+            toggleErrorLed();
             lastErrorBlinkTime = now;
         }
         
@@ -113,6 +123,28 @@ void HardwareManager::loop() {
     }
 }
 
+void HardwareManager::registerTasks(TaskScheduler& taskScheduler, bool withMeasurements) {
+    scheduler = &taskScheduler;
+    if (withMeasurements) {
+        measurementTask = scheduler->addTask("hw_measure", MEASUREMENT_INTERVAL, [](void* ctx) {
+            static_cast<HardwareManager*>(ctx)->updateMeasurements();
+        }, this, MEASUREMENT_INTERVAL);
+    }
+    statusBlinkTask = scheduler->addTask("hw_led", blinkInterval, [](void* ctx) {
+        static_cast<HardwareManager*>(ctx)->toggleStatusLed();
+    }, this, blinkInterval);
+    errorBlinkTask = scheduler->addTask("hw_led_err", errorBlinkInterval, [](void* ctx) {
+        static_cast<HardwareManager*>(ctx)->toggleErrorLed();
+    }, this, errorBlinkInterval);
+    buttonTask = scheduler->addTask("hw_button", BUTTON_POLL_INTERVAL, [](void* ctx) {
+        static_cast<HardwareManager*>(ctx)->checkButton();
+    }, this);
+
+    // Clignotements désarmés tant qu'ils ne sont pas demandés
+    scheduler->setEnabled(statusBlinkTask, blinkingEnabled);
+    scheduler->setEnabled(errorBlinkTask, errorBlinkingEnabled);
+}
+
 hardware_state_t HardwareManager::getState() {
     return currentState;
 }
@@ -124,12 +156,14 @@ hardware_state_t HardwareManager::getState() {
 void HardwareManager::setStatusLed(bool state) {
     statusLedState = state;
     blinkingEnabled = false; // Arrêter le clignotement
+    if (scheduler) scheduler->setEnabled(statusBlinkTask, false);
     digitalWrite(LED_STATUS_PIN, state);
 }
 
 void HardwareManager::setErrorLed(bool state) {
     errorLedState = state;
     errorBlinkingEnabled = false; // Arrêter le clignotement
+    if (scheduler) scheduler->setEnabled(errorBlinkTask, false);
     digitalWrite(LED_ERROR_PIN, state);
 }
 
@@ -137,12 +171,24 @@ void HardwareManager::blinkStatusLed(uint32_t interval_ms) {
     blinkInterval = interval_ms;
     blinkingEnabled = true;
     lastBlinkTime = millis();
+    if (scheduler) scheduler->setPeriod(statusBlinkTask, interval_ms);
 }
 
 void HardwareManager::blinkErrorLed(uint32_t interval_ms) {
     errorBlinkInterval = interval_ms;
     errorBlinkingEnabled = true;
     lastErrorBlinkTime = millis();
+    if (scheduler) scheduler->setPeriod(errorBlinkTask, interval_ms);
+}
+
+void HardwareManager::toggleStatusLed() {
+    statusLedState = !statusLedState;
+    digitalWrite(LED_STATUS_PIN, statusLedState);
+}
+
+void HardwareManager::toggleErrorLed() {
+    errorLedState = !errorLedState;
+    digitalWrite(LED_ERROR_PIN, errorLedState);
 }
 
 void HardwareManager::stopBlinking() {
@@ -185,7 +231,10 @@ void HardwareManager::buzzerAlert() {
 // ============================================================================
 
 hardware_measurements_t HardwareManager::readMeasurements() {
-    return lastMeasurements;
+    portENTER_CRITICAL(&measurementsLock);
+    hardware_measurements_t copy = lastMeasurements;
+    portEXIT_CRITICAL(&measurementsLock);
+    return copy;
 }
 
 float HardwareManager::readCurrent(uint8_t phase) {
@@ -226,8 +275,9 @@ float HardwareManager::readTemperature() {
 }
 
 float HardwareManager::calculatePower() {
-    float current_total = lastMeasurements.current_l1 + lastMeasurements.current_l2;
-    return lastMeasurements.voltage * current_total / 1000.0; // kW
+    hardware_measurements_t measurements = readMeasurements();
+    float current_total = measurements.current_l1 + measurements.current_l2;
+    return measurements.voltage * current_total / 1000.0; // kW
 }
 
 bool HardwareManager::isButtonPressed() {
@@ -308,20 +358,20 @@ bool HardwareManager::testSensors() {
     return true;
 }
 
-void HardwareManager::printDiagnostics() {
-    Serial.println("🔧 ===== DIAGNOSTIC HARDWARE =====");
-    Serial.printf("   État: %d\n", currentState);
-    Serial.printf("   Heap libre: %d bytes\n", ESP.getFreeHeap());
-    Serial.printf("   Uptime: %lu ms\n", millis());
+void HardwareManager::printDiagnostics(Print& out) {
+    out.println("🔧 ===== DIAGNOSTIC HARDWARE =====");
+    out.printf("   État: %d\n", currentState);
+    out.printf("   Heap libre: %d bytes\n", ESP.getFreeHeap());
+    out.printf("   Uptime: %lu ms\n", millis());
     
     hardware_measurements_t measurements = readMeasurements();
-    Serial.printf("   Courant L1: %.2f A\n", measurements.current_l1);
-    Serial.printf("   Courant L2: %.2f A\n", measurements.current_l2);
-    Serial.printf("   Tension: %.2f V\n", measurements.voltage);
-    Serial.printf("   Température: %.2f °C\n", measurements.temperature);
-    Serial.printf("   Puissance: %.2f kW\n", measurements.power);
-    Serial.printf("   Bouton: %s\n", measurements.button_pressed ? "PRESSÉ" : "RELÂCHÉ");
-    Serial.println("🔧 ==============================");
+    out.printf("   Courant L1: %.2f A\n", measurements.current_l1);
+    out.printf("   Courant L2: %.2f A\n", measurements.current_l2);
+    out.printf("   Tension: %.2f V\n", measurements.voltage);
+    out.printf("   Température: %.2f °C\n", measurements.temperature);
+    out.printf("   Puissance: %.2f kW\n", measurements.power);
+    out.printf("   Bouton: %s\n", measurements.button_pressed ? "PRESSÉ" : "RELÂCHÉ");
+    out.println("🔧 ==============================");
 }
 
 // ============================================================================
@@ -366,13 +416,15 @@ bool HardwareManager::initializeSensors() {
 
 void HardwareManager::updateMeasurements() {
     try {
-        lastMeasurements.timestamp = millis();
-        lastMeasurements.current_l1 = readCurrent(1);
-        lastMeasurements.current_l2 = readCurrent(2);
-        lastMeasurements.voltage = readVoltage();
-        lastMeasurements.temperature = readTemperature();
-        lastMeasurements.power = calculatePower();
-        lastMeasurements.button_pressed = isButtonPressed();
+        // Mesure sur une copie (lectures ADC hors section critique), publiée d'un bloc à la fin
+        hardware_measurements_t measurements = readMeasurements();
+        measurements.timestamp = millis();
+        measurements.current_l1 = readCurrent(1);
+        measurements.current_l2 = readCurrent(2);
+        measurements.voltage = readVoltage();
+        measurements.temperature = readTemperature();
+        measurements.power = measurements.voltage * (measurements.current_l1 + measurements.current_l2) / 1000.0;
+        measurements.button_pressed = isButtonPressed();
         
         // Calcul simple de l'énergie (approximation)
         static float last_power = 0;
@@ -381,11 +433,19 @@ void HardwareManager::updateMeasurements() {
         unsigned long now = millis();
         if (last_time > 0) {
             float time_hours = (now - last_time) / 3600000.0;
-            lastMeasurements.energy += (last_power + lastMeasurements.power) / 2.0 * time_hours;
+            measurements.energy += (last_power + measurements.power) / 2.0 * time_hours;
         }
         
-        last_power = lastMeasurements.power;
+        last_power = measurements.power;
         last_time = now;
+
+        portENTER_CRITICAL(&measurementsLock);
+        lastMeasurements = measurements;
+        portEXIT_CRITICAL(&measurementsLock);
+
+        // Champs typés (JSON dans les fichiers SPIFFS), interrogeables sans regex
+        LOG_DEBUG_KV("measurements", "current", measurements.current_l1, "voltage", measurements.voltage,
+                     "power", measurements.power);
         
     } catch (...) {
         Serial.println("❌ Exception lors de la mise à jour des mesures");
@@ -416,6 +476,8 @@ void HardwareManager::checkButton() {
                 currentState = HW_STATE_READY;
                 blinkStatusLed(BLINK_INTERVAL_NORMAL);
             }
+            LOG_INFO_KV("hw_state", "connectorId", HW_CONNECTOR_ID, "state", static_cast<int>(currentState),
+                        "power", readMeasurements().power);
         }
     }
     
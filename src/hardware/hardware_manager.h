@@ -15,8 +15,11 @@
 */
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
 #include "hardware_config.h"
 
+class TaskScheduler;
+
 /**
 * @brief États du gestionnaire hardware
 */
@@ -65,10 +68,17 @@ public:
    bool init();
 
    /**
-    * @brief Boucle principale du gestionnaire
+    * @brief Boucle principale du gestionnaire (sans ordonnanceur)
     */
    void loop();
 
+   /**
+    * @brief Confie les tâches périodiques (mesures, clignotements, bouton) à l'ordonnanceur
+    * @param scheduler Ordonnanceur de loop() ; loop() ne doit plus être appelée ensuite
+    * @param withMeasurements false quand les mesures sont faites par la tâche de comptage
+    */
+   void registerTasks(TaskScheduler& scheduler, bool withMeasurements = true);
+
    /**
     * @brief Obtient l'état actuel du hardware
     * @return État du hardware
@@ -136,10 +146,18 @@ public:
 
    /**
     * @brief Lit toutes les mesures hardware
-    * @return Structure avec toutes les mesures
+    * @return Copie cohérente des dernières mesures (lisible depuis n'importe quelle tâche)
     */
    hardware_measurements_t readMeasurements();
 
+   /**
+    * @brief Effectue une mesure complète (capteurs, puissance, énergie)
+    *
+    * Appelée par la tâche de comptage (SystemRuntime) ou par l'ordonnanceur ; une seule tâche
+    * à la fois. La publication est atomique vis-à-vis de readMeasurements().
+    */
+   void updateMeasurements();
+
    /**
     * @brief Lit le courant d'une phase
     * @param phase Numéro de phase (1 ou 2)
@@ -202,12 +220,13 @@ public:
    /**
     * @brief Affiche les informations de diagnostic
     */
-   void printDiagnostics();
+   void printDiagnostics(Print& out = Serial);
 
 private:
    // Variables d'état
    hardware_state_t currentState;
    hardware_measurements_t lastMeasurements;
+   portMUX_TYPE measurementsLock = portMUX_INITIALIZER_UNLOCKED;   // Tâche de comptage / lecteurs
    unsigned long lastMeasurementTime;
    
    // Variables de clignotement
@@ -219,9 +238,17 @@ private:
    bool errorLedState;
    bool blinkingEnabled;
    bool errorBlinkingEnabled;
+
+   // Tâches de l'ordonnanceur (nullptr : mode loop())
+   TaskScheduler* scheduler;
+   int measurementTask;
+   int statusBlinkTask;
+   int errorBlinkTask;
+   int buttonTask;
    
    // Méthodes privées
-   void updateMeasurements();
+   void toggleStatusLed();
+   void toggleErrorLed();
    void checkButton();
    void handleStateChange();
    bool initializeGPIO();
@@ -6,6 +6,7 @@
 */
 
 #include "power_manager.h"
+#include "TaskScheduler.h"
 #include "esp_pm.h"
 #include "esp_sleep.h"
 #include "esp_wifi.h"
@@ -13,6 +14,9 @@
 #include "driver/adc.h"
 #include "soc/rtc.h"
 
+// Période des mesures, de la vérification des seuils et du mode éco
+static const uint32_t POWER_UPDATE_INTERVAL = 5000;
+
 PowerManager::PowerManager() {
    currentMode = POWER_MODE_ACTIVE;
    currentState = POWER_STATE_NORMAL;
@@ -79,19 +83,29 @@ void PowerManager::loop() {
    unsigned long now = millis();
    
    // Mise à jour des mesures toutes les 5 secondes
-   if (now - lastMeasurementTime >= 5000) {
-       updateMeasurements();
+   if (now - lastMeasurementTime >= POWER_UPDATE_INTERVAL) {
+       periodicUpdate();
        lastMeasurementTime = now;
-       
-       // Vérification des seuils si alertes automatiques activées
-       if (autoAlerts) {
-           checkThresholds();
-       }
-       
-       // Optimisation automatique si mode éco activé
-       if (ecoModeEnabled) {
-           optimizePowerConsumption();
-       }
+   }
+}
+
+void PowerManager::registerTasks(TaskScheduler& scheduler) {
+   scheduler.addTask("power", POWER_UPDATE_INTERVAL, [](void* ctx) {
+       static_cast<PowerManager*>(ctx)->periodicUpdate();
+   }, this, POWER_UPDATE_INTERVAL);
+}
+
+void PowerManager::periodicUpdate() {
+   updateMeasurements();
+   
+   // Vérification des seuils si alertes automatiques activées
+   if (autoAlerts) {
+       checkThresholds();
+   }
+   
+   // Optimisation automatique si mode éco activé
+   if (ecoModeEnabled) {
+       optimizePowerConsumption();
    }
 }
 
@@ -419,21 +433,21 @@ uint32_t PowerManager::estimateBatteryLife(uint32_t battery_capacity_mah) {
    return (uint32_t)(hours * 60); // Retour en minutes
 }
 
-void PowerManager::printPowerStats() {
+void PowerManager::printPowerStats(Print& out) {
    power_measurements_t measurements = readMeasurements();
    
-   Serial.println("🔋 ===== STATISTIQUES D'ALIMENTATION =====");
-   Serial.printf("   Tension d'entrée: %.2f V\n", measurements.input_voltage);
-   Serial.printf("   Courant d'entrée: %.2f mA\n", measurements.input_current);
-   Serial.printf("   Consommation: %.2f mW\n", measurements.power_consumption);
-   Serial.printf("   Fréquence CPU: %.0f MHz\n", measurements.cpu_frequency);
-   Serial.printf("   Température: %.1f °C\n", measurements.temperature);
-   Serial.printf("   Charge CPU: %d %%\n", measurements.cpu_load);
-   Serial.printf("   Temps de fonctionnement: %lu ms\n", measurements.uptime);
-   Serial.printf("   Mode actuel: %d\n", currentMode);
-   Serial.printf("   État: %d\n", currentState);
-   Serial.printf("   Consommation moyenne: %.2f mW\n", getAveragePowerConsumption());
-   Serial.println("🔋 ========================================");
+   out.println("🔋 ===== STATISTIQUES D'ALIMENTATION =====");
+   out.printf("   Tension d'entrée: %.2f V\n", measurements.input_voltage);
+   out.printf("   Courant d'entrée: %.2f mA\n", measurements.input_current);
+   out.printf("   Consommation: %.2f mW\n", measurements.power_consumption);
+   out.printf("   Fréquence CPU: %.0f MHz\n", measurements.cpu_frequency);
+   out.printf("   Température: %.1f °C\n", measurements.temperature);
+   out.printf("   Charge CPU: %d %%\n", measurements.cpu_load);
+   out.printf("   Temps de fonctionnement: %lu ms\n", measurements.uptime);
+   out.printf("   Mode actuel: %d\n", currentMode);
+   out.printf("   État: %d\n", currentState);
+   out.printf("   Consommation moyenne: %.2f mW\n", getAveragePowerConsumption());
+   out.println("🔋 ========================================");
 }
 
 void PowerManager::resetStats() {
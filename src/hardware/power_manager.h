@@ -14,6 +14,8 @@
 #include <Arduino.h>
 #include "hardware_config.h"
 
+class TaskScheduler;
+
 /**
 * @brief Modes de consommation
 */
@@ -74,10 +76,16 @@ public:
    bool init();
 
    /**
-    * @brief Boucle principale de gestion de l'alimentation
+    * @brief Boucle principale de gestion de l'alimentation (sans ordonnanceur)
     */
    void loop();
 
+   /**
+    * @brief Confie la mise à jour périodique (mesures, seuils, mode éco) à l'ordonnanceur
+    * @param scheduler Ordonnanceur de loop() ; loop() ne doit plus être appelée ensuite
+    */
+   void registerTasks(TaskScheduler& scheduler);
+
    /**
     * @brief Obtient l'état actuel de l'alimentation
     * @return État de l'alimentation
@@ -270,7 +278,7 @@ public:
    /**
     * @brief Affiche les statistiques d'alimentation
     */
-   void printPowerStats();
+   void printPowerStats(Print& out = Serial);
 
    /**
     * @brief Réinitialise les statistiques
@@ -303,6 +311,7 @@ private:
    
    // Méthodes privées
    void updateMeasurements();
+   void periodicUpdate();
    void checkThresholds();
    void optimizePowerConsumption();
    float readInternalTemperature();
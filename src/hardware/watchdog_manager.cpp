@@ -7,6 +7,10 @@
 */
 
 #include "watchdog_manager.h"
+#include "TaskScheduler.h"
+
+#define LOG_TAG "watchdog"
+#include "log_macros.h"
 
 static const char* TAG = "WatchdogManager";
 
@@ -99,6 +103,12 @@ void WatchdogManager::loop() {
    // pour éviter les conflits et avoir un contrôle plus fin
 }
 
+void WatchdogManager::registerTasks(TaskScheduler& scheduler) {
+   scheduler.addTask("wdt_check", WDT_CHECK_INTERVAL, [](void* ctx) {
+       static_cast<WatchdogManager*>(ctx)->loop();
+   }, this);
+}
+
 void WatchdogManager::shutdown() {
    if (!initialized) return;
    
@@ -374,6 +384,9 @@ esp_reset_reason_t WatchdogManager::getLastResetReason() {
 
 void WatchdogManager::forceSystemReset(const char* reason) {
    Serial.printf("🐕 RESET SYSTÈME FORCÉ: %s\n", reason);
+   // Conservé dans l'anneau RTC du Logger, rejoué au prochain démarrage avec esp_reset_reason()
+   LOG_ERROR("Forced system reset: %s", reason);
+   Logger::getInstance().end(); // Vide le bloc SPIFFS en attente
    delay(100); // Laisser le temps au message de s'afficher
    esp_restart();
 }
@@ -423,22 +436,22 @@ bool WatchdogManager::restartTask(const char* task_name) {
 // LOGS ET RAPPORTS
 // ============================================================================
 
-void WatchdogManager::printWatchdogStatus() {
-   Serial.println("🐕 ===== ÉTAT DES WATCHDOGS =====");
-   Serial.printf("   Watchdogs totaux: %d\n", watchdog_count);
-   Serial.printf("   Watchdogs actifs: %lu\n", getActiveWatchdogCount());
-   Serial.printf("   Système sain: %s\n", isSystemHealthy() ? "OUI" : "NON");
-   Serial.printf("   Mode sécurisé: %s\n", safe_mode ? "OUI" : "NON");
+void WatchdogManager::printWatchdogStatus(Print& out) {
+   out.println("🐕 ===== ÉTAT DES WATCHDOGS =====");
+   out.printf("   Watchdogs totaux: %d\n", watchdog_count);
+   out.printf("   Watchdogs actifs: %lu\n", getActiveWatchdogCount());
+   out.printf("   Système sain: %s\n", isSystemHealthy() ? "OUI" : "NON");
+   out.printf("   Mode sécurisé: %s\n", safe_mode ? "OUI" : "NON");
    
    for (int i = 0; i < MAX_WATCHDOGS; i++) {
        if (watchdogs[i].is_registered) {
            unsigned long since_feed = millis() - watchdogs[i].last_feed;
-           Serial.printf("   [%d] %s: État=%d, Timeout=%lu ms, Depuis feed=%lu ms\n",
+           out.printf("   [%d] %s: État=%d, Timeout=%lu ms, Depuis feed=%lu ms\n",
                         i, watchdogs[i].config.name, watchdogs[i].state,
                         watchdogs[i].config.timeout_ms, since_feed);
        }
    }
-   Serial.println("🐕 ==============================");
+   out.println("🐕 ==============================");
 }
 
 void WatchdogManager::printDetailedStats() {
@@ -642,7 +655,8 @@ void WatchdogManager::checkTimeouts() {
        if (since_feed > (timeout * 0.8) && watchdogs[i].state == WDT_STATE_ENABLED) {
            watchdogs[i].state = WDT_STATE_WARNING;
            if (debug_mode) {
-               Serial.printf("⚠️ Watchdog %s en warning\n", watchdogs[i].config.name);
+               // Appelé à chaque tour de loop() : limité pendant un incident (plusieurs watchdogs en alerte)
+               LOG_WARN_RATE(1000, 3, "⚠️ Watchdog %s en warning", watchdogs[i].config.name);
            }
        }
        
@@ -663,8 +677,7 @@ void WatchdogManager::handleTimeout(int watchdog_id) {
    watchdogs[watchdog_id].timeout_count++;
    stats.total_timeouts++;
    
-   Serial.printf("🚨 TIMEOUT WATCHDOG: %s (ID: %d)\n", 
-                watchdogs[watchdog_id].config.name, watchdog_id);
+   LOG_ERROR_RATE(1000, 5, "🚨 TIMEOUT WATCHDOG: %s (ID: %d)", watchdogs[watchdog_id].config.name, watchdog_id);
    
    logEvent(watchdog_id, "TIMEOUT");
    
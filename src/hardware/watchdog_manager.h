@@ -14,6 +14,8 @@
 #include "esp_system.h"
 #include "hardware_config.h"
 
+class TaskScheduler;
+
 // Inclure le watchdog de tâche seulement si disponible
 #ifdef CONFIG_ESP_TASK_WDT_EN
 #include "esp_task_wdt.h"
@@ -116,10 +118,16 @@ public:
    bool init();
 
    /**
-    * @brief Boucle principale de surveillance
+    * @brief Boucle principale de surveillance (sans ordonnanceur : à chaque tour de loop())
     */
    void loop();
 
+   /**
+    * @brief Confie la vérification des timeouts à l'ordonnanceur (toutes les WDT_CHECK_INTERVAL ms)
+    * @param scheduler Ordonnanceur de loop() ; loop() ne doit plus être appelée ensuite
+    */
+   void registerTasks(TaskScheduler& scheduler);
+
    /**
     * @brief Arrête tous les watchdogs
     */
@@ -317,7 +325,7 @@ public:
    /**
     * @brief Affiche l'état de tous les watchdogs
     */
-   void printWatchdogStatus();
+   void printWatchdogStatus(Print& out = Serial);
 
    /**
     * @brief Affiche les statistiques détaillées
@@ -12,30 +12,98 @@
 
 #include "Logger.h"
 #include "log_macros.h"
-#include "FileLogger.h"
+#include "SerialConsole.h"
+#include "ConsoleCommands.h"
+#include "TaskScheduler.h"
+#include "SystemRuntime.h"
+#include "hardware_manager.h"
+#include "power_manager.h"
+#include "watchdog_manager.h"
+#include "ocpp_wrapper.h"
+#ifdef OCPP_SERVER_URL
+#include <WiFi.h>
+#endif
 
 // Configuration simple
 #define LED_STATUS_PIN 2
 #define SERIAL_BAUD_RATE 115200
+#define CONSOLE_BUSY_POLL_MS 5    // ~64 octets à 115200 bauds : cadence de loop() pendant une sortie longue
+#define OCPP_CONNECTOR_ID 1
 
 // Variables globales
-unsigned long lastBlink = 0;
-unsigned long lastHeartbeat = 0;
 bool ledState = false;
 
-void printLogFile(const char* filename) {
-    File file = SPIFFS.open(filename, FILE_READ);
-    if (file) {
-        Serial.printf("\n📄 Contenu de %s :\n", filename);
-        while (file.available()) {
-            Serial.write(file.read());
-        }
-        file.close();
-    } else {
-        Serial.printf("❌ Unable to open %s\n", filename);
+// Ordonnanceur des tâches périodiques : loop() dort jusqu'à la prochaine échéance
+TaskScheduler scheduler;
+
+HardwareManager hardwareManager;
+PowerManager powerManager;
+WatchdogManager watchdogManager;
+
+// Tâches FreeRTOS : OCPP (cœur 0), comptage (cœur 1), logs/flash (arrière-plan)
+SystemRuntime runtime;
+
+// Client OCPP, piloté par la tâche ocpp. Actif si le build définit OCPP_SERVER_URL
+// (ainsi que WIFI_SSID, WIFI_PASSWORD et OCPP_CHARGE_POINT_ID)
+OCPPWrapper ocpp;
+
+// Console série non bloquante (commandes : help)
+SerialConsole console(Serial);
+
+// Clignotement LED toutes les secondes
+static void blinkTask(void*) {
+    ledState = !ledState;
+    digitalWrite(LED_STATUS_PIN, ledState);
+}
+
+// Heartbeat toutes les 5 secondes
+static void heartbeatTask(void*) {
+    // Message identique à chaque fois : regroupé en "last message repeated N times" (LOG_COALESCE_REPEATS)
+    LOG_INFO("❤️ Heartbeat: ESP32 is alive!");
+}
+
+// Tâche de comptage (cœur 1) : mesure complète, publiée vers la tâche OCPP
+static bool measureHardware(void* ctx, hardware_measurements_t& out) {
+    HardwareManager* hardware = static_cast<HardwareManager*>(ctx);
+    hardware->updateMeasurements();
+    out = hardware->readMeasurements();
+    return true;
+}
+
+// Tâche OCPP (cœur 0) : MicroOCPP puis la file des CALL sortants
+static void ocppLoop(void*) {
+    ocpp.loop();
+}
+
+// Tâche OCPP : événements du connecteur tirés du matériel. Le bouton de test (HW_STATE_CHARGING,
+// état lu sans verrou) tient lieu de câble ; une température hors plage met le connecteur en défaut
+static void ocppConnectorEvents(const hardware_measurements_t& sample) {
+    static bool plugged = false;
+    bool nowPlugged = hardwareManager.getState() == HW_STATE_CHARGING;
+    if (nowPlugged != plugged) {
+        plugged = nowPlugged;
+        if (!plugged) ocpp.stopTransaction(OCPP_CONNECTOR_ID, OCPP_STOP_EV_DISCONNECTED);
+        ocpp.handleConnectorEvent(OCPP_CONNECTOR_ID, plugged ? OCPP_EVENT_PLUG_IN : OCPP_EVENT_UNPLUG);
+    }
+    bool faulted = ocpp.getConnectorStatus(OCPP_CONNECTOR_ID) == OCPP_STATUS_FAULTED;
+    if (IS_TEMP_VALID(sample.temperature) == faulted) {
+        ocpp.handleConnectorEvent(OCPP_CONNECTOR_ID, faulted ? OCPP_EVENT_FAULT_CLEARED : OCPP_EVENT_FAULT);
     }
 }
 
+// Tâche OCPP, pour chaque mesure : agrégée, un MeterValues par MeterValueSampleInterval et par
+// frontière de ClockAlignedDataInterval
+static void ocppSample(void*, const hardware_measurements_t& sample) {
+    ocppConnectorEvents(sample);
+    ocpp_meter_sample_t meter;
+    meter.timestampMs = sample.timestamp;
+    meter.energyWh = sample.energy * 1000.0f;
+    meter.powerW = sample.power * 1000.0f;
+    meter.currentA = sample.current_l1 + sample.current_l2;
+    meter.voltageV = sample.voltage;
+    meter.temperatureC = sample.temperature;
+    ocpp.addMeterSample(OCPP_CONNECTOR_ID, meter);
+}
 
 void setup() {
     // 1. Initialisation série (avant tout le reste)
@@ -95,52 +163,59 @@ void setup() {
 
     // 10. Lancement de la boucle principale
     Serial.println("🚀 Démarrage de la boucle principale...");
-    lastBlink = millis();
-    lastHeartbeat = millis();
 
-    // 11. (Optionnel) Démarrage du web log viewer si besoin
+    // 11. Gestionnaires consultés par la console (hw, power, wdt)
+    watchdogManager.init();
+    powerManager.init();
+    hardwareManager.init();
+
+    // Tâches périodiques : plus de millis() scrutés à chaque tour de loop()
+    scheduler.addTask("blink", 1000, blinkTask, nullptr, 1000);
+    scheduler.addTask("heartbeat", 5000, heartbeatTask, nullptr, 5000);
+    watchdogManager.registerTasks(scheduler);
+    powerManager.registerTasks(scheduler);
+
+    // Client OCPP : le WebSocket se (re)connecte seul une fois le WiFi associé
+    SystemRuntime::Hooks hooks = { nullptr, measureHardware, nullptr, &hardwareManager };
+#ifdef OCPP_SERVER_URL
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    if (ocpp.init(OCPP_SERVER_URL, OCPP_CHARGE_POINT_ID)) {
+        hooks.ocppLoop = ocppLoop;
+        hooks.onSample = ocppSample;
+    }
+#endif
+
+    // Tâches OCPP / comptage / logs ; le Logger passe en mode asynchrone
+    bool runtimeStarted = runtime.begin(hooks, MEASUREMENT_INTERVAL, &watchdogManager);
+    if (!runtimeStarted) {
+        Serial.println("⚠️ Runtime indisponible : mesures dans loop()");
+    }
+    hardwareManager.registerTasks(scheduler, !runtimeStarted);
+
+    // 12. Console série
+    registerCoreCommands(console);
+    registerSystemCommands(console, &hardwareManager, &powerManager, &watchdogManager);
+    registerRuntimeCommands(console, runtime);
+    registerOcppCommands(console, ocpp);
+    Serial.println("⌨️ Console prête (help)");
+    // Une commande tapée réveille loop() sans attendre la prochaine échéance
+    Serial.onReceive([]() { scheduler.wake(); });
+
+    // 13. (Optionnel) Démarrage du web log viewer si besoin
     // startWebLogViewer();
 }
 
 
 void loop() {
-    unsigned long now = millis();
-    
-    // Clignotement LED toutes les secondes
-    if (now - lastBlink >= 1000) {
-        ledState = !ledState;
-        digitalWrite(LED_STATUS_PIN, ledState);
-        lastBlink = now;
-    }
-    
-    // Affichage du heartbeat toutes les 5 secondes
-    if (now - lastHeartbeat >= 5000) {
-        LOG_INFO("❤️ Heartbeat: ESP32 is alive!");
-        lastHeartbeat = now;
-    }
+    // Console : lecture, commandes et sortie par morceaux, sans jamais attendre l'UART
+    console.poll();
 
-    // Affichage du log
-    static String inputBuffer = ""; // Buffer to accumulate input
-    while (Serial.available()) {
-        char receivedChar = Serial.read();
-        if (receivedChar == '\n') {
-            if (inputBuffer.startsWith("log ")) {
-                String filename = inputBuffer.substring(4);
-                if (filename.length() > 0) {
-                    printLogFile(filename.c_str());
-                } else {
-                    Serial.println("❌ Veuillez spécifier un nom de fichier.");
-                }
-            } else {
-                Serial.printf("📥 Commande reçue: %s\n", inputBuffer.c_str());
-            }
-            inputBuffer = ""; // Clear the buffer after processing
-        } else {
-            inputBuffer += receivedChar; // Accumulate characters
-        }
-    }
+    // Tâches échues (clignotement, heartbeat, alimentation, watchdogs), dans l'ordre des échéances
+    scheduler.runDue();
+    watchdogManager.feedMainLoop();
 
-    
-    // Petite pause
-    delay(10);
+    // Sommeil jusqu'à la prochaine échéance (ou une entrée série), au plus court pendant une sortie longue
+    bool consoleBusy = console.isBusy() || console.getOutputPending() > 0;
+    scheduler.idle(consoleBusy ? CONSOLE_BUSY_POLL_MS : SCHEDULER_IDLE_MAX_MS);
 }
@@ -0,0 +1,398 @@
+/**
+ * @file ocpp_auth_store.cpp
+ * @brief Implémentation des autorisations locales (Local List et cache)
+ */
+
+#include "ocpp_auth_store.h"
+#include <strings.h>
+
+#define LOG_TAG "auth"
+#include "log_macros.h"
+
+const char* const OCPP_AUTH_STATUS_NAMES[OCPP_AUTH_STATUS_COUNT] = {
+    "Accepted", "Blocked", "Expired", "Invalid", "ConcurrentTx"
+};
+const char* const OCPP_LIST_UPDATE_STATUS_NAMES[OCPP_LIST_UPDATE_STATUS_COUNT] = {
+    "Accepted", "Failed", "NotSupported", "VersionMismatch"
+};
+
+static const uint32_t AUTH_MAGIC = 0x3153414F;      // "OAS1"
+static const size_t AUTH_HEADER_SIZE = 16;          // magic | capacité | taille d'enregistrement | version | réservé
+// flags | statut | idTag | parentIdTag | expiration | CRC-16
+static const size_t AUTH_RECORD_SIZE = 1 + 1 + ID_TAG_MAX_LENGTH + ID_TAG_MAX_LENGTH + 4 + 2;
+static const size_t AUTH_CHUNK_RECORDS = 16;        // Enregistrements lus ou écrits d'un coup par begin()
+
+enum RecordFlag : uint8_t { RECORD_EMPTY = 0, RECORD_CACHE = 1, RECORD_LIST = 2, RECORD_DELETED = 3 };
+
+// CRC-16/CCITT-FALSE : 46 octets par enregistrement, pas de table
+static uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Enregistrement lu : false s'il est vide, supprimé ou invalide (`valid` : CRC correct)
+static bool decodeRecord(const uint8_t* record, ocpp_auth_entry_t& entry, bool& valid) {
+    valid = true;
+    if (record[0] != RECORD_CACHE && record[0] != RECORD_LIST) return false;
+    uint16_t crc;
+    memcpy(&crc, record + AUTH_RECORD_SIZE - 2, sizeof(crc));
+    if (crc != crc16(record, AUTH_RECORD_SIZE - 2) || record[1] >= OCPP_AUTH_STATUS_COUNT) {
+        valid = false;
+        return false;
+    }
+    entry.localList = record[0] == RECORD_LIST;
+    entry.status = record[1];
+    memcpy(entry.idTag, record + 2, ID_TAG_MAX_LENGTH);
+    entry.idTag[ID_TAG_MAX_LENGTH] = '\0';
+    memcpy(entry.parentIdTag, record + 2 + ID_TAG_MAX_LENGTH, ID_TAG_MAX_LENGTH);
+    entry.parentIdTag[ID_TAG_MAX_LENGTH] = '\0';
+    memcpy(&entry.expiryUnixS, record + 2 + 2 * ID_TAG_MAX_LENGTH, sizeof(entry.expiryUnixS));
+    return entry.idTag[0] != '\0';
+}
+
+// ============================================================================
+// CYCLE DE VIE
+// ============================================================================
+
+OcppAuthStore::OcppAuthStore(const char* path, fs::FS& filesystem)
+    : fs(filesystem), path(path), started(false), updating(false), listEnabled(true), cacheEnabled(true),
+      listVersion(0), pendingVersion(0), evictCursor(0), stats() {
+    memset(index, 0, sizeof(index));
+}
+
+OcppAuthStore::~OcppAuthStore() {
+    end();
+}
+
+bool OcppAuthStore::begin() {
+    if (started) return true;
+    memset(index, 0, sizeof(index));
+    memset(&stats, 0, sizeof(stats));
+    listVersion = 0;
+    updating = false;
+
+    // Géométrie différente (capacité, taille d'idTag) : fichier recréé, la liste sera renvoyée
+    uint8_t header[AUTH_HEADER_SIZE];
+    bool valid = false;
+    if (fs.exists(path)) {
+        file = fs.open(path, "r+");
+        if (file && file.read(header, sizeof(header)) == sizeof(header)) {
+            uint32_t magic;
+            uint16_t capacity, recordSize;
+            memcpy(&magic, header, 4);
+            memcpy(&capacity, header + 4, 2);
+            memcpy(&recordSize, header + 6, 2);
+            memcpy(&listVersion, header + 8, 4);
+            valid = magic == AUTH_MAGIC && capacity == OCPP_AUTH_STORE_CAPACITY && recordSize == AUTH_RECORD_SIZE &&
+                    file.size() == AUTH_HEADER_SIZE + OCPP_AUTH_STORE_CAPACITY * AUTH_RECORD_SIZE;
+        }
+    }
+    if (!valid) {
+        if (file) file.close();
+        listVersion = 0;
+        if (!create()) {
+            LOG_ERROR("Autorisations: création de %s impossible", path);
+            return false;
+        }
+    }
+
+    // Empreintes reconstruites en une lecture séquentielle du fichier
+    uint8_t chunk[AUTH_CHUNK_RECORDS * AUTH_RECORD_SIZE];
+    if (!file.seek(AUTH_HEADER_SIZE)) return false;
+    for (uint16_t base = 0; base < OCPP_AUTH_STORE_CAPACITY; base += AUTH_CHUNK_RECORDS) {
+        if (file.read(chunk, sizeof(chunk)) != sizeof(chunk)) {
+            file.close();
+            return false;
+        }
+        for (uint16_t i = 0; i < AUTH_CHUNK_RECORDS; ++i) {
+            const uint8_t* record = chunk + i * AUTH_RECORD_SIZE;
+            ocpp_auth_entry_t entry;
+            bool crcOk;
+            uint16_t slot = static_cast<uint16_t>(base + i);
+            if (decodeRecord(record, entry, crcOk)) {
+                uint16_t origin = entry.localList ? SLOT_LIST : 0;
+                index[slot] = static_cast<uint16_t>(fingerprint(hashTag(entry.idTag)) | origin);
+                if (entry.localList) stats.listEntries++;
+                else stats.cacheEntries++;
+            } else if (record[0] != RECORD_EMPTY) {
+                // Supprimé, ou interrompu pendant l'écriture : garde la chaîne de sondage
+                index[slot] = SLOT_DELETED;
+                if (!crcOk) stats.discarded++;
+            }
+        }
+    }
+    started = true;
+    if (stats.discarded > 0) {
+        LOG_WARN("Autorisations: %lu enregistrement(s) invalides ignorés",
+                 static_cast<unsigned long>(stats.discarded));
+    }
+    return true;
+}
+
+void OcppAuthStore::end() {
+    if (!started) return;
+    file.close();
+    started = false;
+    updating = false;
+}
+
+bool OcppAuthStore::create() {
+    File out = fs.open(path, FILE_WRITE);
+    if (!out) return false;
+    uint8_t chunk[AUTH_CHUNK_RECORDS * AUTH_RECORD_SIZE];
+    memset(chunk, 0, sizeof(chunk));
+    bool ok = out.write(chunk, AUTH_HEADER_SIZE) == AUTH_HEADER_SIZE;
+    for (uint16_t base = 0; ok && base < OCPP_AUTH_STORE_CAPACITY; base += AUTH_CHUNK_RECORDS) {
+        ok = out.write(chunk, sizeof(chunk)) == sizeof(chunk);
+    }
+    out.close();
+    file = fs.open(path, "r+");
+    return ok && file && writeHeader(0);
+}
+
+bool OcppAuthStore::writeHeader(int32_t version) {
+    uint8_t header[AUTH_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    const uint16_t capacity = OCPP_AUTH_STORE_CAPACITY;
+    const uint16_t recordSize = AUTH_RECORD_SIZE;
+    memcpy(header, &AUTH_MAGIC, 4);
+    memcpy(header + 4, &capacity, 2);
+    memcpy(header + 6, &recordSize, 2);
+    memcpy(header + 8, &version, 4);
+    if (!file.seek(0) || file.write(header, sizeof(header)) != sizeof(header)) return false;
+    file.flush();
+    return true;
+}
+
+// ============================================================================
+// RECHERCHE
+// ============================================================================
+
+uint32_t OcppAuthStore::hashTag(const char* idTag) {
+    // FNV-1a sur l'idTag en majuscules, puis brassage : les bits bas choisissent l'emplacement
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < ID_TAG_MAX_LENGTH && idTag[i]; ++i) {
+        hash ^= static_cast<uint8_t>(toupper(static_cast<unsigned char>(idTag[i])));
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+uint16_t OcppAuthStore::fingerprint(uint32_t hash) {
+    uint16_t fp = static_cast<uint16_t>((hash >> 17) & 0x7FFF);
+    return fp < 2 ? static_cast<uint16_t>(fp + 2) : fp;
+}
+
+int32_t OcppAuthStore::find(const char* idTag, uint32_t hash, int32_t* freeSlot, ocpp_auth_entry_t* found) {
+    const uint16_t mask = OCPP_AUTH_STORE_CAPACITY - 1;
+    const uint16_t fp = fingerprint(hash);
+    uint16_t slot = static_cast<uint16_t>(hash & mask);
+    int32_t firstFree = -1;
+    int32_t result = -1;
+    uint16_t probes = 0;
+    ocpp_auth_entry_t entry;
+    while (probes < OCPP_AUTH_STORE_CAPACITY) {
+        uint16_t value = index[slot];
+        probes++;
+        if (value == SLOT_EMPTY) {
+            if (firstFree < 0) firstFree = slot;
+            break;
+        }
+        if (value == SLOT_DELETED) {
+            if (firstFree < 0) firstFree = slot;
+        } else if ((value & ~SLOT_LIST) == fp) {
+            stats.flashReads++;
+            if (readEntry(slot, entry) && strncasecmp(entry.idTag, idTag, ID_TAG_MAX_LENGTH) == 0) {
+                if (found) *found = entry;
+                result = slot;
+                break;
+            }
+        }
+        slot = static_cast<uint16_t>((slot + 1) & mask);
+    }
+    if (probes > stats.maxProbe) stats.maxProbe = probes;
+    if (freeSlot) *freeSlot = firstFree;
+    return result;
+}
+
+bool OcppAuthStore::lookup(const char* idTag, uint32_t nowUnixS, ocpp_auth_entry_t& out) {
+    stats.lookups++;
+    if (!started || !idTag || !idTag[0] || strlen(idTag) > ID_TAG_MAX_LENGTH) return false;
+    if (!listEnabled && !cacheEnabled) return false;
+    if (find(idTag, hashTag(idTag), nullptr, &out) < 0) return false;
+    if (out.localList ? !listEnabled : !cacheEnabled) return false;
+    stats.hits++;
+    if (out.status == OCPP_AUTH_ACCEPTED && out.expiryUnixS != 0 && nowUnixS != 0 && nowUnixS >= out.expiryUnixS) {
+        out.status = OCPP_AUTH_EXPIRED;
+    }
+    return true;
+}
+
+ocpp_auth_status_t OcppAuthStore::parseStatus(const char* status) {
+    for (uint8_t s = 0; s < OCPP_AUTH_STATUS_COUNT; ++s) {
+        if (status && strcmp(status, OCPP_AUTH_STATUS_NAMES[s]) == 0) return static_cast<ocpp_auth_status_t>(s);
+    }
+    return OCPP_AUTH_STATUS_COUNT;
+}
+
+// ============================================================================
+// MISES À JOUR
+// ============================================================================
+
+bool OcppAuthStore::readEntry(uint16_t slot, ocpp_auth_entry_t& entry) {
+    uint8_t record[AUTH_RECORD_SIZE];
+    bool valid;
+    return file.seek(AUTH_HEADER_SIZE + static_cast<uint32_t>(slot) * AUTH_RECORD_SIZE) &&
+           file.read(record, sizeof(record)) == sizeof(record) && decodeRecord(record, entry, valid);
+}
+
+bool OcppAuthStore::writeEntry(uint16_t slot, const ocpp_auth_entry_t* entry) {
+    uint8_t record[AUTH_RECORD_SIZE];
+    memset(record, 0, sizeof(record));
+    record[0] = entry ? (entry->localList ? RECORD_LIST : RECORD_CACHE) : RECORD_DELETED;
+    if (entry) {
+        record[1] = entry->status;
+        // Champs de ID_TAG_MAX_LENGTH octets, sans '\0' final quand ils sont pleins
+        memcpy(record + 2, entry->idTag, strnlen(entry->idTag, ID_TAG_MAX_LENGTH));
+        memcpy(record + 2 + ID_TAG_MAX_LENGTH, entry->parentIdTag, strnlen(entry->parentIdTag, ID_TAG_MAX_LENGTH));
+        memcpy(record + 2 + 2 * ID_TAG_MAX_LENGTH, &entry->expiryUnixS, sizeof(entry->expiryUnixS));
+    }
+    uint16_t crc = crc16(record, AUTH_RECORD_SIZE - 2);
+    memcpy(record + AUTH_RECORD_SIZE - 2, &crc, sizeof(crc));
+    stats.flashWrites++;
+    return file.seek(AUTH_HEADER_SIZE + static_cast<uint32_t>(slot) * AUTH_RECORD_SIZE) &&
+           file.write(record, sizeof(record)) == sizeof(record);
+}
+
+bool OcppAuthStore::store(const ocpp_auth_entry_t& entry, bool list) {
+    if (!started || !entry.idTag[0] || strlen(entry.idTag) > ID_TAG_MAX_LENGTH ||
+        strlen(entry.parentIdTag) > ID_TAG_MAX_LENGTH || entry.status >= OCPP_AUTH_STATUS_COUNT) {
+        return false;
+    }
+    uint32_t hash = hashTag(entry.idTag);
+    int32_t freeSlot = -1;
+    int32_t slot = find(entry.idTag, hash, &freeSlot, nullptr);
+    bool wasList = slot >= 0 && (index[slot] & SLOT_LIST);
+    if (!list && wasList) return false;         // La liste a priorité sur le cache
+
+    if (slot < 0 || (list && !wasList)) {
+        if (list && stats.listEntries >= OCPP_LOCAL_LIST_MAX_LENGTH) return false;
+        // Cache plein : une entrée remplacée, puis nouvelle recherche (l'effacement change les emplacements libres)
+        if (!list && slot < 0 && stats.cacheEntries >= OCPP_AUTH_CACHE_MAX_ENTRIES) {
+            if (!evictCacheEntry()) return false;
+            slot = find(entry.idTag, hash, &freeSlot, nullptr);
+        }
+    }
+    if (slot < 0) slot = freeSlot;
+    if (slot < 0) return false;
+
+    ocpp_auth_entry_t written = entry;
+    written.localList = list;
+    if (!writeEntry(static_cast<uint16_t>(slot), &written)) return false;
+
+    uint16_t previous = index[slot];
+    if (previous >= 2 && !(previous & SLOT_LIST)) stats.cacheEntries--;
+    if (previous >= 2 && (previous & SLOT_LIST)) stats.listEntries--;
+    index[slot] = static_cast<uint16_t>(fingerprint(hash) | (list ? SLOT_LIST : 0));
+    if (list) stats.listEntries++;
+    else stats.cacheEntries++;
+    return true;
+}
+
+void OcppAuthStore::erase(uint16_t slot) {
+    if (index[slot] < 2) return;
+    writeEntry(slot, nullptr);
+    if (index[slot] & SLOT_LIST) stats.listEntries--;
+    else stats.cacheEntries--;
+    index[slot] = SLOT_DELETED;
+
+    // Suivi d'un emplacement vide : les supprimés qui le précèdent ne prolongent plus aucune chaîne
+    const uint16_t mask = OCPP_AUTH_STORE_CAPACITY - 1;
+    if (index[(slot + 1) & mask] != SLOT_EMPTY) return;
+    for (uint16_t s = slot; index[s] == SLOT_DELETED; s = static_cast<uint16_t>((s - 1) & mask)) {
+        index[s] = SLOT_EMPTY;
+    }
+}
+
+bool OcppAuthStore::evictCacheEntry() {
+    // Curseur circulaire : les entrées sont remplacées à tour de rôle
+    for (uint32_t n = 0; n < OCPP_AUTH_STORE_CAPACITY; ++n) {
+        uint16_t slot = static_cast<uint16_t>((evictCursor + n) & (OCPP_AUTH_STORE_CAPACITY - 1));
+        if (index[slot] >= 2 && !(index[slot] & SLOT_LIST)) {
+            erase(slot);
+            evictCursor = static_cast<uint16_t>(slot + 1);
+            stats.evictions++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void OcppAuthStore::setEnabled(bool localList, bool authCache) {
+    listEnabled = localList;
+    cacheEnabled = authCache;
+}
+
+bool OcppAuthStore::cache(const ocpp_auth_entry_t& entry) {
+    if (!cacheEnabled) return false;
+    bool ok = store(entry, false);
+    if (ok) file.flush();
+    return ok;
+}
+
+bool OcppAuthStore::clearCache() {
+    if (!started) return false;
+    for (uint16_t slot = 0; slot < OCPP_AUTH_STORE_CAPACITY; ++slot) {
+        if (index[slot] >= 2 && !(index[slot] & SLOT_LIST)) erase(slot);
+    }
+    file.flush();
+    return true;
+}
+
+ocpp_list_update_status_t OcppAuthStore::beginListUpdate(int32_t version, bool full) {
+    if (!started) return OCPP_LIST_UPDATE_FAILED;
+    if (!full && version <= listVersion) return OCPP_LIST_UPDATE_VERSION_MISMATCH;
+
+    // Version 0 jusqu'à la fin : une mise à jour interrompue n'est jamais prise pour complète
+    if (!writeHeader(0)) return OCPP_LIST_UPDATE_FAILED;
+    listVersion = 0;
+    pendingVersion = version;
+    updating = true;
+    if (full) {
+        for (uint16_t slot = 0; slot < OCPP_AUTH_STORE_CAPACITY; ++slot) {
+            if (index[slot] & SLOT_LIST) erase(slot);
+        }
+    }
+    return OCPP_LIST_UPDATE_ACCEPTED;
+}
+
+bool OcppAuthStore::putListEntry(const ocpp_auth_entry_t& entry) {
+    return updating && store(entry, true);
+}
+
+bool OcppAuthStore::removeListEntry(const char* idTag) {
+    if (!updating || !idTag || strlen(idTag) > ID_TAG_MAX_LENGTH) return false;
+    int32_t slot = find(idTag, hashTag(idTag), nullptr, nullptr);
+    if (slot >= 0 && (index[slot] & SLOT_LIST)) erase(static_cast<uint16_t>(slot));
+    return true;
+}
+
+ocpp_list_update_status_t OcppAuthStore::endListUpdate(bool ok) {
+    if (!updating) return OCPP_LIST_UPDATE_FAILED;
+    updating = false;
+    if (!ok || !writeHeader(pendingVersion)) {
+        file.flush();
+        return OCPP_LIST_UPDATE_FAILED;
+    }
+    listVersion = pendingVersion;
+    return OCPP_LIST_UPDATE_ACCEPTED;
+}
@@ -0,0 +1,186 @@
+#ifndef OCPP_AUTH_STORE_H
+#define OCPP_AUTH_STORE_H
+
+/**
+ * @file ocpp_auth_store.h
+ * @brief Autorisations locales : Local Authorization List et cache d'autorisation, sur la flash
+ *
+ * Une seule table de hachage à adressage ouvert (sondage linéaire) de OCPP_AUTH_STORE_CAPACITY
+ * emplacements, écrite telle quelle dans un fichier SPIFFS : en-tête, puis un enregistrement de
+ * taille fixe par emplacement (idTag et parentIdTag sur ID_TAG_MAX_LENGTH octets, expiration,
+ * statut, CRC-16). Un emplacement se lit ou s'écrit par un seek : aucune réécriture du fichier.
+ *
+ * En RAM, seulement une empreinte de 16 bits par emplacement (vide, supprimé, ou 15 bits du
+ * hachage et l'origine : liste ou cache). Une recherche sonde les empreintes et ne lit la flash
+ * que pour un emplacement dont l'empreinte correspond : en pratique une lecture pour un idTag
+ * connu, aucune pour un inconnu. Pas d'Authorize pour un badge connu : une lecture SPIFFS au lieu
+ * d'un aller-retour réseau (durée mesurée sur la cible par test_ocpp_auth_store_benchmark).
+ *
+ * - Local List (SendLocalList) : mise à jour complète ou différentielle, entrée par entrée. La
+ *   version passe à 0 au début de la mise à jour et ne prend la nouvelle valeur qu'à la fin : après
+ *   une coupure ou un échec, GetLocalListVersion répond 0 et le serveur renvoie la liste.
+ * - Cache (idTagInfo des réponses du serveur) : au plus OCPP_AUTH_CACHE_MAX_ENTRIES entrées,
+ *   remplacées à tour de rôle quand il est plein. Une entrée de la liste a priorité sur le cache.
+ * - idTag comparés sans la casse (CiString20Type).
+ * - LocalAuthListEnabled / AuthorizationCacheEnabled (setEnabled) : les entrées d'une origine
+ *   désactivée restent sur la flash mais lookup() les ignore ; cache() n'écrit plus rien.
+ *
+ * Mono-tâche : tous les appels viennent de la tâche OCPP.
+ */
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SPIFFS.h>
+#include "ocpp_config.h"
+
+#ifndef OCPP_AUTH_STORE_CAPACITY
+#define OCPP_AUTH_STORE_CAPACITY 4096            // Emplacements, puissance de 2 ; 8 Ko d'empreintes en RAM
+#endif
+#ifndef OCPP_LOCAL_LIST_MAX_LENGTH
+#define OCPP_LOCAL_LIST_MAX_LENGTH 2048          // LocalAuthListMaxLength
+#endif
+#ifndef OCPP_AUTH_CACHE_MAX_ENTRIES
+#define OCPP_AUTH_CACHE_MAX_ENTRIES 512
+#endif
+
+static_assert((OCPP_AUTH_STORE_CAPACITY & (OCPP_AUTH_STORE_CAPACITY - 1)) == 0, "capacité : puissance de 2");
+static_assert(OCPP_AUTH_STORE_CAPACITY <= 32768, "emplacements indexés sur 15 bits");
+// Taux de remplissage d'au plus 3/4 : sondages courts
+static_assert((OCPP_LOCAL_LIST_MAX_LENGTH + OCPP_AUTH_CACHE_MAX_ENTRIES) * 4 <= OCPP_AUTH_STORE_CAPACITY * 3,
+              "table d'autorisations trop pleine");
+
+/**
+ * @brief Statut d'un idTag (AuthorizationStatus)
+ */
+typedef enum {
+    OCPP_AUTH_ACCEPTED = 0,
+    OCPP_AUTH_BLOCKED,
+    OCPP_AUTH_EXPIRED,
+    OCPP_AUTH_INVALID,
+    OCPP_AUTH_CONCURRENT_TX,
+    OCPP_AUTH_STATUS_COUNT           // Inconnu localement
+} ocpp_auth_status_t;
+
+/**
+ * @brief Réponse à SendLocalList (UpdateStatus)
+ */
+typedef enum {
+    OCPP_LIST_UPDATE_ACCEPTED = 0,
+    OCPP_LIST_UPDATE_FAILED,
+    OCPP_LIST_UPDATE_NOT_SUPPORTED,
+    OCPP_LIST_UPDATE_VERSION_MISMATCH,
+    OCPP_LIST_UPDATE_STATUS_COUNT
+} ocpp_list_update_status_t;
+
+extern const char* const OCPP_AUTH_STATUS_NAMES[OCPP_AUTH_STATUS_COUNT];
+extern const char* const OCPP_LIST_UPDATE_STATUS_NAMES[OCPP_LIST_UPDATE_STATUS_COUNT];
+
+/**
+ * @brief Autorisation d'un idTag (IdTagInfo)
+ */
+typedef struct {
+    char idTag[ID_TAG_MAX_LENGTH + 1];
+    char parentIdTag[ID_TAG_MAX_LENGTH + 1];  // "" : aucun
+    uint32_t expiryUnixS;                     // 0 : sans expiration
+    uint8_t status;                           // ocpp_auth_status_t
+    bool localList;                           // Entrée de la Local List (sinon du cache)
+} ocpp_auth_entry_t;
+
+/**
+ * @brief Compteurs des autorisations locales
+ */
+typedef struct {
+    uint16_t listEntries;
+    uint16_t cacheEntries;
+    uint16_t maxProbe;           // Plus long sondage d'une recherche
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t flashReads;         // Enregistrements lus pendant les recherches
+    uint32_t flashWrites;        // Enregistrements écrits
+    uint32_t evictions;          // Entrées du cache remplacées, cache plein
+    uint32_t discarded;          // Enregistrements invalides (écriture interrompue) ignorés par begin()
+} ocpp_auth_store_stats_t;
+
+class OcppAuthStore {
+public:
+    explicit OcppAuthStore(const char* path = STORAGE_AUTH_CACHE_FILE, fs::FS& filesystem = SPIFFS);
+    ~OcppAuthStore();
+
+    /**
+     * @brief Ouvre le fichier et reconstruit les empreintes ; crée un fichier vide s'il manque
+     *        ou si sa géométrie a changé
+     */
+    bool begin();
+    void end();
+
+    /**
+     * @brief Autorisation locale d'un idTag
+     * @param nowUnixS Heure courante (0 si inconnue : expiration non vérifiée)
+     * @return false si l'idTag n'est ni dans la liste ni dans le cache (ou si son origine est
+     *         désactivée). Une entrée acceptée mais échue est rendue Expired.
+     */
+    bool lookup(const char* idTag, uint32_t nowUnixS, ocpp_auth_entry_t& out);
+
+    /**
+     * @brief Met en cache l'IdTagInfo reçu du serveur (sans effet si l'idTag est dans la liste ou
+     *        si le cache est désactivé)
+     */
+    bool cache(const ocpp_auth_entry_t& entry);
+    bool clearCache();
+
+    /**
+     * @brief Début d'une mise à jour de la Local List
+     * @param full true : la liste est vidée, puis remplacée par les entrées reçues
+     * @return Accepted si la mise à jour peut commencer, VersionMismatch sinon
+     */
+    ocpp_list_update_status_t beginListUpdate(int32_t version, bool full);
+    // Ajoute ou remplace une entrée ; false : liste pleine
+    bool putListEntry(const ocpp_auth_entry_t& entry);
+    // Entrée sans IdTagInfo d'une mise à jour différentielle
+    bool removeListEntry(const char* idTag);
+    // Fin de la mise à jour : la nouvelle version est écrite si `ok`, sinon la liste reste en version 0
+    ocpp_list_update_status_t endListUpdate(bool ok);
+
+    /**
+     * @brief Origines consultées par lookup() (LocalAuthListEnabled, AuthorizationCacheEnabled)
+     */
+    void setEnabled(bool localList, bool authCache);
+
+    int32_t getListVersion() const { return listVersion; }
+    ocpp_auth_store_stats_t getStats() const { return stats; }
+
+    static ocpp_auth_status_t parseStatus(const char* status);
+
+private:
+    // Empreintes : 0 vide, 1 supprimé, sinon 15 bits du hachage (≥ 2) et le bit de la liste
+    static const uint16_t SLOT_EMPTY = 0;
+    static const uint16_t SLOT_DELETED = 1;
+    static const uint16_t SLOT_LIST = 0x8000;
+
+    fs::FS& fs;
+    const char* path;
+    File file;
+    bool started;
+    bool updating;               // Mise à jour de la Local List en cours
+    bool listEnabled;
+    bool cacheEnabled;
+    int32_t listVersion;
+    int32_t pendingVersion;
+    uint16_t evictCursor;        // Prochain emplacement examiné pour remplacer une entrée du cache
+    uint16_t index[OCPP_AUTH_STORE_CAPACITY];
+    ocpp_auth_store_stats_t stats;
+
+    static uint32_t hashTag(const char* idTag);
+    static uint16_t fingerprint(uint32_t hash);
+    bool create();
+    bool writeHeader(int32_t version);
+    bool readEntry(uint16_t slot, ocpp_auth_entry_t& entry);
+    bool writeEntry(uint16_t slot, const ocpp_auth_entry_t* entry);
+    // Emplacement de l'idTag (-1 : absent) ; `freeSlot` : premier emplacement libre de la chaîne
+    int32_t find(const char* idTag, uint32_t hash, int32_t* freeSlot, ocpp_auth_entry_t* found);
+    bool store(const ocpp_auth_entry_t& entry, bool list);
+    void erase(uint16_t slot);
+    bool evictCacheEntry();
+};
+
+#endif // OCPP_AUTH_STORE_H
@@ -0,0 +1,430 @@
+/**
+ * @file ocpp_call_queue.cpp
+ * @brief Implémentation de la file des CALL OCPP sortants
+ */
+
+#include "ocpp_call_queue.h"
+
+static_assert(OCPP_MESSAGE_QUEUE_SIZE > 0 && OCPP_MAX_IN_FLIGHT > 0, "file OCPP vide");
+
+// Classe de priorité par type (0 : la plus haute)
+static const uint8_t OCPP_CALL_PRIORITIES[OCPP_CALL_TYPE_COUNT] = { 0, 0, 1, 2 };
+static const char* const OCPP_CALL_ACTIONS[OCPP_CALL_TYPE_COUNT] = {
+    "StartTransaction", "StopTransaction", "MeterValues", "StatusNotification"
+};
+const char* const OCPP_STOP_REASONS[OCPP_STOP_REASON_COUNT] = {
+    "Local", "DeAuthorized", "Remote", "UnlockCommand", "HardReset", "SoftReset", "EVDisconnected"
+};
+
+// ============================================================================
+// FILE
+// ============================================================================
+
+OcppCallQueue::OcppCallQueue(uint32_t idSeed)
+    : handlers(), nextId(idSeed), nextSeq(0), depth(0), inFlight(0), foreignInFlight(0), stats(), rttSumMs(0),
+      rttCount(0), batchMax(1), batchWindowMs(0) {
+    memset(slots, 0, sizeof(slots));
+    memset(foreign, 0, sizeof(foreign));
+}
+
+void OcppCallQueue::setHandlers(const Handlers& newHandlers) {
+    handlers = newHandlers;
+}
+
+void OcppCallQueue::setMeterValuesBatch(uint8_t maxReadings, uint32_t windowMs) {
+    batchMax = maxReadings < 1 ? 1 : (maxReadings > OCPP_MESSAGE_QUEUE_SIZE ? OCPP_MESSAGE_QUEUE_SIZE : maxReadings);
+    batchWindowMs = windowMs;
+}
+
+uint8_t OcppCallQueue::priorityOf(ocpp_call_type_t type) {
+    return type < OCPP_CALL_TYPE_COUNT ? OCPP_CALL_PRIORITIES[type] : UINT8_MAX;
+}
+
+const char* OcppCallQueue::actionName(ocpp_call_type_t type) {
+    return type < OCPP_CALL_TYPE_COUNT ? OCPP_CALL_ACTIONS[type] : "";
+}
+
+bool OcppCallQueue::isTransactionMessage(const ocpp_call_t& call) {
+    return call.type == OCPP_CALL_START_TRANSACTION || call.type == OCPP_CALL_STOP_TRANSACTION ||
+           (call.type == OCPP_CALL_METER_VALUES && call.txRef != 0);
+}
+
+bool OcppCallQueue::enqueue(const ocpp_call_t& call, uint32_t nowMs) {
+    if (call.type >= OCPP_CALL_TYPE_COUNT) return false;
+
+    // Seul le dernier statut d'un connecteur compte : il prend la place du précédent
+    if (call.type == OCPP_CALL_STATUS_NOTIFICATION) {
+        for (Slot& slot : slots) {
+            if (slot.state == SLOT_QUEUED && slot.call.type == OCPP_CALL_STATUS_NOTIFICATION &&
+                slot.call.connectorId == call.connectorId) {
+                slot.call = call;
+                stats.evicted++;
+                stats.enqueued++;
+                return true;
+            }
+        }
+    }
+
+    Slot* target = nullptr;
+    for (Slot& slot : slots) {
+        if (slot.state == SLOT_FREE) {
+            target = &slot;
+            break;
+        }
+    }
+
+    bool hasVictim = false;
+    ocpp_call_t victim;
+    if (!target) {
+        target = evictionVictim(priorityOf(call.type));
+        if (!target) {
+            stats.rejected++;
+            return false;
+        }
+        victim = target->call;
+        hasVictim = true;
+        setState(*target, SLOT_FREE);
+        stats.evicted++;
+    }
+
+    target->call = call;
+    target->attempts = 0;
+    target->seq = nextSeq++;
+    target->notBefore = nowMs;
+    target->queuedAt = nowMs;
+    target->sentAt = 0;
+    target->id[0] = '\0';
+    setState(*target, SLOT_QUEUED);
+    stats.enqueued++;
+
+    // Après l'insertion : le ResultHandler peut lui-même appeler enqueue()
+    if (hasVictim) notify(victim, OCPP_CALL_DROPPED, "", 0);
+    return true;
+}
+
+void OcppCallQueue::poll(uint32_t nowMs, bool connected) {
+    for (Slot& slot : slots) {
+        if (slot.state == SLOT_IN_FLIGHT && nowMs - slot.sentAt >= OCPP_MESSAGE_TIMEOUT_MS) {
+            stats.timeouts++;
+            finish(slot, OCPP_CALL_DROPPED, nowMs, "", 0);
+        }
+    }
+    for (ForeignCall& call : foreign) {
+        if (call.used && nowMs - call.sentAt >= OCPP_MESSAGE_TIMEOUT_MS) {
+            call.used = false;
+            foreignInFlight--;
+            stats.timeouts++;
+        }
+    }
+
+    if (!connected) return;
+    while (inFlight + foreignInFlight < OCPP_MAX_IN_FLIGHT) {
+        Slot* slot = nextToSend(nowMs);
+        if (!slot || !dispatch(*slot, nowMs)) break;
+    }
+}
+
+ocpp_frame_kind_t OcppCallQueue::handleIncoming(const char* text, size_t len, uint32_t nowMs, char* action,
+                                                size_t actionSize) {
+    ocpp_frame_t frame;
+    if (!OcppFrame::parse(text, len, frame)) return OCPP_FRAME_OTHER;
+    return handleIncoming(frame, nowMs, action, actionSize);
+}
+
+ocpp_frame_kind_t OcppCallQueue::handleIncoming(const ocpp_frame_t& frame, uint32_t nowMs, char* action,
+                                                size_t actionSize) {
+    if (frame.type == OCPP_MESSAGE_CALL) return OCPP_FRAME_OTHER;
+
+    Slot* slot = findSlot(frame.uniqueId);
+    if (slot) {
+        recordRtt(nowMs - slot->sentAt);
+        if (frame.type == OCPP_MESSAGE_CALL_RESULT) {
+            stats.confirmed++;
+            finish(*slot, OCPP_CALL_CONFIRMED, nowMs, frame.payload.data, frame.payload.len);
+        } else {
+            stats.callErrors++;
+            finish(*slot, OCPP_CALL_REJECTED, nowMs, frame.body.data, frame.body.len);
+        }
+        return OCPP_FRAME_OWN;
+    }
+
+    ForeignCall* call = findForeign(frame.uniqueId);
+    if (!call) return OCPP_FRAME_OTHER;
+    recordRtt(nowMs - call->sentAt);
+    if (action && actionSize > 0) snprintf(action, actionSize, "%s", call->action);
+    call->used = false;
+    foreignInFlight--;
+    return OCPP_FRAME_FOREIGN;
+}
+
+bool OcppCallQueue::trackOutgoing(const char* text, size_t len, uint32_t nowMs) {
+    // Réponses aux CALL du serveur : hors fenêtre
+    ocpp_frame_t frame;
+    if (!OcppFrame::parse(text, len, frame) || frame.type != OCPP_MESSAGE_CALL) return true;
+
+    if (inFlight + foreignInFlight >= OCPP_MAX_IN_FLIGHT) {
+        stats.foreignDeferred++;
+        return false;
+    }
+    for (ForeignCall& call : foreign) {
+        if (call.used) continue;
+        OcppFrame::copy(frame.uniqueId, call.id, sizeof(call.id));
+        OcppFrame::copy(frame.action, call.action, sizeof(call.action));
+        call.sentAt = nowMs;
+        call.used = true;
+        foreignInFlight++;
+        break;
+    }
+    return true;
+}
+
+void OcppCallQueue::cancelOutgoing(const char* text, size_t len) {
+    ocpp_frame_t frame;
+    if (!OcppFrame::parse(text, len, frame) || frame.type != OCPP_MESSAGE_CALL) return;
+    ForeignCall* call = findForeign(frame.uniqueId);
+    if (call) {
+        call->used = false;
+        foreignInFlight--;
+    }
+}
+
+void OcppCallQueue::clear() {
+    for (Slot& slot : slots) {
+        setState(slot, SLOT_FREE);
+    }
+    for (ForeignCall& call : foreign) {
+        call.used = false;
+    }
+    foreignInFlight = 0;
+}
+
+ocpp_queue_stats_t OcppCallQueue::getStats() const {
+    ocpp_queue_stats_t out = stats;
+    out.depth = static_cast<uint16_t>(depth);
+    out.inFlight = static_cast<uint16_t>(inFlight);
+    out.foreignInFlight = static_cast<uint16_t>(foreignInFlight);
+    out.rttAvgMs = rttCount ? static_cast<uint32_t>(rttSumMs / rttCount) : 0;
+    return out;
+}
+
+// ============================================================================
+// MÉTHODES PRIVÉES
+// ============================================================================
+
+OcppCallQueue::Slot* OcppCallQueue::findSlot(const ocpp_text_t& id) {
+    for (Slot& slot : slots) {
+        if (slot.state == SLOT_IN_FLIGHT && OcppFrame::equals(id, slot.id)) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+OcppCallQueue::Slot* OcppCallQueue::findBatched(const char* id) {
+    Slot* first = nullptr;
+    for (Slot& slot : slots) {
+        if (slot.state == SLOT_BATCHED && strcmp(slot.id, id) == 0 && (!first || slot.seq < first->seq)) {
+            first = &slot;
+        }
+    }
+    return first;
+}
+
+OcppCallQueue::ForeignCall* OcppCallQueue::findForeign(const ocpp_text_t& id) {
+    for (ForeignCall& call : foreign) {
+        if (call.used && OcppFrame::equals(id, call.id)) {
+            return &call;
+        }
+    }
+    return nullptr;
+}
+
+OcppCallQueue::Slot* OcppCallQueue::nextToSend(uint32_t nowMs) {
+    Slot* best = nullptr;
+    for (Slot& slot : slots) {
+        if (slot.state != SLOT_QUEUED || static_cast<int32_t>(nowMs - slot.notBefore) < 0) continue;
+
+        // Un message de transaction attend tous les messages plus anciens de la même transaction
+        bool blocked = false;
+        if (slot.call.txRef != 0) {
+            for (const Slot& other : slots) {
+                if (other.state != SLOT_FREE && other.call.txRef == slot.call.txRef && other.seq < slot.seq) {
+                    blocked = true;
+                    break;
+                }
+            }
+        }
+        if (blocked || isHeld(slot, nowMs)) continue;
+
+        uint8_t priority = priorityOf(slot.call.type);
+        uint8_t bestPriority = best ? priorityOf(best->call.type) : UINT8_MAX;
+        if (!best || priority < bestPriority || (priority == bestPriority && slot.seq < best->seq)) {
+            best = &slot;
+        }
+    }
+    return best;
+}
+
+bool OcppCallQueue::isHeld(const Slot& slot, uint32_t nowMs) const {
+    if (batchMax <= 1 || slot.call.type != OCPP_CALL_METER_VALUES || slot.attempts > 0) return false;
+    size_t readings = 0;
+    uint32_t oldest = slot.queuedAt;
+    for (const Slot& other : slots) {
+        if (other.state == SLOT_FREE || other.call.connectorId != slot.call.connectorId) continue;
+        // Début ou fin de transaction derrière le relevé : le lot part avant
+        if (other.seq > slot.seq && priorityOf(other.call.type) == 0) return false;
+        if (other.state == SLOT_QUEUED && other.call.type == OCPP_CALL_METER_VALUES &&
+            other.call.txRef == slot.call.txRef) {
+            readings++;
+            if (static_cast<int32_t>(other.queuedAt - oldest) < 0) oldest = other.queuedAt;
+        }
+    }
+    return readings < batchMax && nowMs - oldest < batchWindowMs;
+}
+
+size_t OcppCallQueue::collectBatch(Slot& head, uint32_t nowMs, Slot** batch) {
+    batch[0] = &head;
+    size_t count = 1;
+    if (batchMax <= 1 || head.call.type != OCPP_CALL_METER_VALUES) return 1;
+
+    // Relevés suivants du connecteur, par seq croissant, jusqu'au premier message de transaction
+    uint32_t lastSeq = head.seq;
+    while (count < batchMax) {
+        Slot* next = nullptr;
+        for (Slot& slot : slots) {
+            if (slot.state == SLOT_FREE || slot.call.connectorId != head.call.connectorId || slot.seq <= lastSeq) {
+                continue;
+            }
+            if (!next || slot.seq < next->seq) next = &slot;
+        }
+        if (!next || priorityOf(next->call.type) == 0) break;
+        lastSeq = next->seq;
+        if (next->state == SLOT_QUEUED && next->call.type == OCPP_CALL_METER_VALUES &&
+            next->call.txRef == head.call.txRef && static_cast<int32_t>(nowMs - next->notBefore) >= 0) {
+            batch[count++] = next;
+        }
+    }
+    return count;
+}
+
+OcppCallQueue::Slot* OcppCallQueue::evictionVictim(uint8_t priority) {
+    // Le message en attente le moins prioritaire et le plus récent, jamais un message de transaction
+    Slot* victim = nullptr;
+    for (Slot& slot : slots) {
+        if (slot.state != SLOT_QUEUED || isTransactionMessage(slot.call)) continue;
+        uint8_t slotPriority = priorityOf(slot.call.type);
+        if (slotPriority <= priority) continue;
+        uint8_t victimPriority = victim ? priorityOf(victim->call.type) : 0;
+        if (!victim || slotPriority > victimPriority || (slotPriority == victimPriority && slot.seq > victim->seq)) {
+            victim = &slot;
+        }
+    }
+    return victim;
+}
+
+bool OcppCallQueue::dispatch(Slot& slot, uint32_t nowMs) {
+    char id[OCPP_UNIQUE_ID_SIZE];
+    snprintf(id, sizeof(id), "q%08lx", static_cast<unsigned long>(nextId));
+
+    Slot* batch[OCPP_MESSAGE_QUEUE_SIZE];
+    const ocpp_call_t* calls[OCPP_MESSAGE_QUEUE_SIZE];
+    size_t collected = collectBatch(slot, nowMs, batch);
+    size_t count = collected;
+    for (size_t i = 0; i < count; ++i) calls[i] = &batch[i]->call;
+
+    char* frame = frameBuffer + OCPP_FRAME_HEADROOM;
+    int head = snprintf(frame, OCPP_MAX_MESSAGE_SIZE, "[2,\"%s\",\"%s\",", id, actionName(slot.call.type));
+    size_t room = OCPP_MAX_MESSAGE_SIZE - static_cast<size_t>(head) - 1;   // Place du ']' final
+    size_t payloadLen = 0;
+    while (handlers.writePayload) {
+        payloadLen = handlers.writePayload(handlers.ctx, calls, count, frame + head, room);
+        if ((payloadLen > 0 && payloadLen < room - 1) || count == 1) break;
+        count--;                   // Lot trop grand pour une trame : les derniers relevés attendront
+    }
+    if (payloadLen == 0 || payloadLen >= room - 1) {
+        // Charge utile impossible (transaction inconnue du serveur) ou trop grande : jamais envoyable
+        ocpp_call_t call = slot.call;
+        stats.dropped++;
+        setState(slot, SLOT_FREE);
+        notify(call, OCPP_CALL_DROPPED, "", 0);
+        return true;
+    }
+    size_t len = static_cast<size_t>(head) + payloadLen;
+    frame[len++] = ']';
+    frame[len] = '\0';
+
+    if (!handlers.send || !handlers.send(handlers.ctx, frame, len)) return false;
+
+    // Relevés restés hors de la trame : fenêtre échue, ils partent au CALL suivant
+    for (size_t i = count; i < collected; ++i) batch[i]->queuedAt = nowMs - batchWindowMs;
+
+    nextId++;
+    for (size_t i = 0; i < count; ++i) {
+        Slot& member = *batch[i];
+        memcpy(member.id, id, sizeof(id));
+        member.sentAt = nowMs;
+        member.attempts++;
+        setState(member, i == 0 ? SLOT_IN_FLIGHT : SLOT_BATCHED);
+    }
+    stats.sent++;
+    if (slot.call.type == OCPP_CALL_METER_VALUES) {
+        stats.meterCalls++;
+        stats.meterReadings += static_cast<uint32_t>(count);
+    }
+    return true;
+}
+
+void OcppCallQueue::fail(Slot& slot, ocpp_call_result_t result, uint32_t nowMs, const char* payload, size_t len) {
+    if (isTransactionMessage(slot.call) && slot.attempts < TRANSACTION_MESSAGE_ATTEMPTS) {
+        // Reste à sa place (même seq) : les messages suivants de la transaction attendent le renvoi
+        slot.notBefore = nowMs + static_cast<uint32_t>(TRANSACTION_MESSAGE_RETRY_INTERVAL) * slot.attempts;
+        slot.id[0] = '\0';
+        stats.retries++;
+        setState(slot, SLOT_QUEUED);
+        return;
+    }
+    ocpp_call_t call = slot.call;
+    stats.dropped++;
+    setState(slot, SLOT_FREE);
+    notify(call, result, payload, len);
+}
+
+void OcppCallQueue::finish(Slot& head, ocpp_call_result_t result, uint32_t nowMs, const char* payload, size_t len) {
+    // La tête, puis les relevés partis avec elle, dans l'ordre ; l'emplacement est libéré avant
+    // chaque notification (le ResultHandler peut appeler enqueue())
+    char id[OCPP_UNIQUE_ID_SIZE];
+    memcpy(id, head.id, sizeof(id));
+    for (Slot* slot = &head; slot; slot = findBatched(id)) {
+        if (result != OCPP_CALL_CONFIRMED) {
+            fail(*slot, result, nowMs, payload, len);
+            continue;
+        }
+        ocpp_call_t call = slot->call;
+        setState(*slot, SLOT_FREE);
+        notify(call, result, payload, len);
+    }
+}
+
+void OcppCallQueue::setState(Slot& slot, SlotState state) {
+    if (slot.state == SLOT_QUEUED) depth--;
+    else if (slot.state == SLOT_IN_FLIGHT) inFlight--;
+    slot.state = state;
+    if (state == SLOT_QUEUED) {
+        depth++;
+        if (depth > stats.depthMax) stats.depthMax = static_cast<uint16_t>(depth);
+    } else if (state == SLOT_IN_FLIGHT) {
+        inFlight++;
+    }
+}
+
+void OcppCallQueue::recordRtt(uint32_t rttMs) {
+    stats.rttLastMs = rttMs;
+    if (rttCount == 0 || rttMs < stats.rttMinMs) stats.rttMinMs = rttMs;
+    if (rttMs > stats.rttMaxMs) stats.rttMaxMs = rttMs;
+    rttSumMs += rttMs;
+    rttCount++;
+}
+
+void OcppCallQueue::notify(const ocpp_call_t& call, ocpp_call_result_t result, const char* payload, size_t len) {
+    if (handlers.onResult) handlers.onResult(handlers.ctx, call, result, payload, len);
+}
@@ -0,0 +1,267 @@
+#ifndef OCPP_CALL_QUEUE_H
+#define OCPP_CALL_QUEUE_H
+
+/**
+ * @file ocpp_call_queue.h
+ * @brief File des CALL OCPP sortants : priorités, contre-pression et suivi des requêtes en vol
+ *
+ * La file ne connaît ni le WebSocket ni le JSON des charges utiles : elle construit l'enveloppe
+ * `[2,"<uniqueId>","<Action>",<payload>]`, délègue la charge utile à un PayloadWriter et remet la
+ * trame à un FrameSender. Elle est donc testable sur hôte avec un transport simulé.
+ *
+ * - Priorités : StartTransaction/StopTransaction, puis MeterValues, puis StatusNotification ;
+ *   FIFO à priorité égale. Les messages d'une même transaction (txRef) partent toujours dans leur
+ *   ordre de création : un StopTransaction ne double jamais le MeterValues qui le précède.
+ * - Contre-pression : pool fixe de OCPP_MESSAGE_QUEUE_SIZE entrées. File pleine, un message plus
+ *   prioritaire évince le message hors transaction le moins prioritaire et le plus récent
+ *   (StatusNotification d'abord) ; sinon enqueue() refuse (compté).
+ *   Un nouveau statut d'un connecteur remplace celui qui attend encore.
+ * - En vol : au plus OCPP_MAX_IN_FLIGHT CALL sans réponse, les nôtres comme ceux d'une autre pile
+ *   (MicroOcpp) déclarés par trackOutgoing(). Réponse associée par uniqueId, expiration après
+ *   OCPP_MESSAGE_TIMEOUT_MS. Expiré ou CALLERROR : un message de transaction est renvoyé sous un
+ *   nouvel uniqueId, jusqu'à TRANSACTION_MESSAGE_ATTEMPTS envois espacés de
+ *   TRANSACTION_MESSAGE_RETRY_INTERVAL × tentatives ; les autres messages sont abandonnés.
+ * - Regroupement (setMeterValuesBatch, désactivé par défaut) : les MeterValues d'un même connecteur
+ *   et d'une même transaction attendent dans la file, puis partent ensemble dans un seul CALL (un
+ *   meterValue par relevé) dès qu'ils sont `maxReadings`, que le plus ancien a attendu `windowMs`,
+ *   ou qu'un StartTransaction/StopTransaction du connecteur les suit. Le CALL regroupé occupe une
+ *   seule place de la fenêtre ; sa réponse vaut pour chacun de ses relevés.
+ *
+ * Mono-tâche : tous les appels viennent de la tâche OCPP.
+ */
+
+#include <Arduino.h>
+#include "ocpp_config.h"
+#include "ocpp_frame.h"
+#include "ocpp_meter_sampler.h"
+
+#define OCPP_UNIQUE_ID_SIZE      12   // "q" + 8 chiffres hexadécimaux + NUL
+#define OCPP_FOREIGN_ID_SIZE     40   // uniqueId d'une autre pile (OCPP-J : 36 caractères max)
+#define OCPP_ACTION_NAME_SIZE    32
+#define OCPP_STATUS_TEXT_SIZE    16   // "SuspendedEVSE" + NUL
+#define OCPP_FRAME_HEADROOM      14   // Devant la trame : en-tête WebSocket (WEBSOCKETS_MAX_HEADER_SIZE)
+
+/**
+ * @brief Types de CALL émis par la file
+ */
+typedef enum {
+    OCPP_CALL_START_TRANSACTION = 0,
+    OCPP_CALL_STOP_TRANSACTION,
+    OCPP_CALL_METER_VALUES,
+    OCPP_CALL_STATUS_NOTIFICATION,
+    OCPP_CALL_TYPE_COUNT
+} ocpp_call_type_t;
+
+/**
+ * @brief Raison d'un StopTransaction (Reason OCPP 1.6, celles que la borne émet)
+ */
+typedef enum {
+    OCPP_STOP_LOCAL = 0,                 // Arrêt demandé sur la borne
+    OCPP_STOP_DEAUTHORIZED,              // idTag refusé par le StartTransaction.conf
+    OCPP_STOP_REMOTE,                    // RemoteStopTransaction
+    OCPP_STOP_UNLOCK_COMMAND,            // UnlockConnector
+    OCPP_STOP_HARD_RESET,                // Reset Hard
+    OCPP_STOP_SOFT_RESET,                // Reset Soft
+    OCPP_STOP_EV_DISCONNECTED,           // Câble débranché pendant la transaction
+    OCPP_STOP_REASON_COUNT
+} ocpp_stop_reason_t;
+
+extern const char* const OCPP_STOP_REASONS[OCPP_STOP_REASON_COUNT];
+
+/**
+ * @brief Issue d'un CALL, remise au ResultHandler
+ */
+typedef enum {
+    OCPP_CALL_CONFIRMED = 0,     // CALLRESULT reçu
+    OCPP_CALL_REJECTED,          // CALLERROR reçu, pas de nouvel envoi
+    OCPP_CALL_DROPPED            // Expiré, tentatives épuisées, charge utile impossible ou évincé
+} ocpp_call_result_t;
+
+/**
+ * @brief Données d'un CALL ; la charge utile est sérialisée à l'envoi
+ */
+typedef struct {
+    ocpp_call_type_t type;
+    uint8_t connectorId;
+    uint16_t txRef;                          // Transaction locale (0 : aucune)
+    uint32_t journalSeq;                     // Enregistrement du journal (0 : hors journal)
+    uint32_t timestampMs;                    // Uptime de l'événement
+    uint64_t unixMs;                         // Heure de l'événement si connue (0 : dériver de timestampMs)
+    int32_t meterWh;                         // meterStart / meterStop / énergie active
+    uint8_t readingContext;                  // MeterValues : ocpp_reading_context_t
+    uint8_t measurands;                      // MeterValues : bit m, values[m] renseignée
+    int32_t values[OCPP_MEASURAND_COUNT];    // MeterValues, virgule fixe (OCPP_MEASURANDS[m].decimals)
+    char idTag[ID_TAG_MAX_LENGTH + 1];       // StartTransaction
+    uint8_t stopReason;                      // StopTransaction : ocpp_stop_reason_t
+    char status[OCPP_STATUS_TEXT_SIZE];      // StatusNotification
+} ocpp_call_t;
+
+/**
+ * @brief Statistiques de la file (supervision)
+ */
+typedef struct {
+    uint16_t depth;              // Messages en attente d'envoi
+    uint16_t depthMax;
+    uint16_t inFlight;           // Nos CALL sans réponse
+    uint16_t foreignInFlight;    // CALL de l'autre pile sans réponse
+    uint32_t enqueued;
+    uint32_t rejected;           // Refusés : file pleine
+    uint32_t evicted;            // Évincés par un message plus prioritaire ou statuts remplacés
+    uint32_t sent;               // Trames émises, renvois compris
+    uint32_t confirmed;
+    uint32_t callErrors;
+    uint32_t timeouts;
+    uint32_t retries;
+    uint32_t dropped;
+    uint32_t meterCalls;         // CALL MeterValues émis, renvois compris
+    uint32_t meterReadings;      // Relevés qu'ils portaient : un CALL chacun sans regroupement
+    uint32_t foreignDeferred;    // Envois de l'autre pile différés : fenêtre pleine
+    uint32_t rttLastMs;
+    uint32_t rttMinMs;
+    uint32_t rttMaxMs;
+    uint32_t rttAvgMs;           // Moyenne de toutes les réponses, les nôtres et celles de l'autre pile
+} ocpp_queue_stats_t;
+
+/**
+ * @brief Classement d'une trame entrante par handleIncoming()
+ */
+typedef enum {
+    OCPP_FRAME_OWN = 0,          // Réponse à un de nos CALL : consommée
+    OCPP_FRAME_FOREIGN,          // Réponse à un CALL suivi par trackOutgoing() : à transmettre
+    OCPP_FRAME_OTHER             // CALL du serveur, réponse inconnue ou trame invalide : à transmettre
+} ocpp_frame_kind_t;
+
+class OcppCallQueue {
+public:
+    // false : trame non émise (déconnecté), le CALL reste en tête de file. `frame` est précédée de
+    // OCPP_FRAME_HEADROOM octets libres : l'émetteur peut y écrire l'en-tête WebSocket et masquer la
+    // trame sur place ; elle est réécrite à chaque envoi
+    typedef bool (*FrameSender)(void* ctx, char* frame, size_t len);
+    // Début de la réserve devant `frame` : le `payload` attendu par WebSocketsClient::sendTXT(payload,
+    // len, true), qui écrit l'en-tête dans les WEBSOCKETS_MAX_HEADER_SIZE premiers octets
+    static uint8_t* headroom(char* frame) { return reinterpret_cast<uint8_t*>(frame - OCPP_FRAME_HEADROOM); }
+    // Écrit l'objet JSON de la charge utile ; 0 : impossible ou trop grand (le CALL est abandonné).
+    // `count` > 1 : MeterValues regroupés (même connecteur, même transaction), dans l'ordre ; sur 0,
+    // le lot est rappelé avec un relevé de moins
+    typedef size_t (*PayloadWriter)(void* ctx, const ocpp_call_t* const* calls, size_t count, char* out,
+                                    size_t size);
+    // `payload` : charge utile du CALLRESULT, `"code","description",{détails}` d'un CALLERROR, sinon vide
+    typedef void (*ResultHandler)(void* ctx, const ocpp_call_t& call, ocpp_call_result_t result,
+                                  const char* payload, size_t len);
+
+    struct Handlers {
+        FrameSender send;
+        PayloadWriter writePayload;
+        ResultHandler onResult;
+        void* ctx;
+    };
+
+    /**
+     * @param idSeed Premier numéro d'uniqueId (aléatoire au démarrage : pas de réutilisation après reboot)
+     */
+    explicit OcppCallQueue(uint32_t idSeed = 0);
+
+    void setHandlers(const Handlers& handlers);
+
+    /**
+     * @brief Regroupement des MeterValues
+     * @param maxReadings Relevés par CALL (1 : pas de regroupement), au plus OCPP_MESSAGE_QUEUE_SIZE
+     * @param windowMs Attente maximale du plus ancien relevé
+     */
+    void setMeterValuesBatch(uint8_t maxReadings, uint32_t windowMs);
+
+    /**
+     * @brief Ajoute un CALL à la file
+     * @return false si la file est pleine (contre-pression : à l'appelant de réessayer ou d'abandonner)
+     */
+    bool enqueue(const ocpp_call_t& call, uint32_t nowMs);
+
+    /**
+     * @brief Expire les CALL sans réponse puis émet tant que la fenêtre le permet
+     * @param connected false : rien n'est émis, les expirations continuent
+     */
+    void poll(uint32_t nowMs, bool connected);
+
+    /**
+     * @brief Associe une trame entrante à un CALL en vol
+     * @param action Si non nul et OCPP_FRAME_FOREIGN : action du CALL d'origine
+     */
+    ocpp_frame_kind_t handleIncoming(const char* frame, size_t len, uint32_t nowMs,
+                                     char* action = nullptr, size_t actionSize = 0);
+    // Trame déjà découpée par OcppFrame::parse() (une seule lecture par trame reçue)
+    ocpp_frame_kind_t handleIncoming(const ocpp_frame_t& frame, uint32_t nowMs, char* action = nullptr,
+                                     size_t actionSize = 0);
+
+    /**
+     * @brief Déclare une trame sortante d'une autre pile ; seuls ses CALL occupent la fenêtre
+     * @return false si la fenêtre est pleine : la trame ne doit pas être émise maintenant
+     */
+    bool trackOutgoing(const char* frame, size_t len, uint32_t nowMs);
+
+    // La trame déclarée par trackOutgoing() n'a finalement pas pu être émise
+    void cancelOutgoing(const char* frame, size_t len);
+
+    // Vide la file et oublie les CALL en vol (sans appeler le ResultHandler)
+    void clear();
+
+    size_t getDepth() const { return depth; }
+    size_t getInFlight() const { return inFlight + foreignInFlight; }
+    ocpp_queue_stats_t getStats() const;
+
+    static uint8_t priorityOf(ocpp_call_type_t type);
+    static const char* actionName(ocpp_call_type_t type);
+    static bool isTransactionMessage(const ocpp_call_t& call);
+
+private:
+    // SLOT_BATCHED : MeterValues parti dans le CALL d'un autre emplacement (même uniqueId)
+    enum SlotState : uint8_t { SLOT_FREE = 0, SLOT_QUEUED, SLOT_IN_FLIGHT, SLOT_BATCHED };
+
+    struct Slot {
+        ocpp_call_t call;
+        SlotState state;
+        uint8_t attempts;
+        uint32_t seq;              // Ordre de création, conservé pendant les renvois
+        uint32_t notBefore;        // Prochain envoi autorisé (renvoi)
+        uint32_t queuedAt;
+        uint32_t sentAt;
+        char id[OCPP_UNIQUE_ID_SIZE];
+    };
+
+    struct ForeignCall {
+        bool used;
+        uint32_t sentAt;
+        char id[OCPP_FOREIGN_ID_SIZE];
+        char action[OCPP_ACTION_NAME_SIZE];
+    };
+
+    Handlers handlers;
+    Slot slots[OCPP_MESSAGE_QUEUE_SIZE];
+    ForeignCall foreign[OCPP_MAX_IN_FLIGHT];
+    char frameBuffer[OCPP_FRAME_HEADROOM + OCPP_MAX_MESSAGE_SIZE];
+    uint32_t nextId;
+    uint32_t nextSeq;
+    size_t depth;
+    size_t inFlight;
+    size_t foreignInFlight;
+    ocpp_queue_stats_t stats;
+    uint64_t rttSumMs;
+    uint32_t rttCount;
+    uint8_t batchMax;
+    uint32_t batchWindowMs;
+
+    Slot* findSlot(const ocpp_text_t& id);
+    Slot* findBatched(const char* id);
+    Slot* nextToSend(uint32_t nowMs);
+    bool isHeld(const Slot& slot, uint32_t nowMs) const;
+    size_t collectBatch(Slot& head, uint32_t nowMs, Slot** batch);
+    Slot* evictionVictim(uint8_t priority);
+    bool dispatch(Slot& slot, uint32_t nowMs);
+    void fail(Slot& slot, ocpp_call_result_t result, uint32_t nowMs, const char* payload, size_t len);
+    void finish(Slot& head, ocpp_call_result_t result, uint32_t nowMs, const char* payload, size_t len);
+    void setState(Slot& slot, SlotState state);
+    ForeignCall* findForeign(const ocpp_text_t& id);
+    void recordRtt(uint32_t rttMs);
+    void notify(const ocpp_call_t& call, ocpp_call_result_t result, const char* payload, size_t len);
+};
+
+#endif // OCPP_CALL_QUEUE_H
@@ -0,0 +1,131 @@
+/**
+ * @file ocpp_connector_state.cpp
+ * @brief Implémentation de la machine d'états des connecteurs
+ */
+
+#include "ocpp_connector_state.h"
+
+const char* const OCPP_CONNECTOR_STATUS_NAMES[OCPP_STATUS_COUNT] = {
+    "Available", "Preparing", "Charging", "SuspendedEV", "SuspendedEVSE", "Finishing", "Reserved", "Unavailable",
+    "Faulted"
+};
+
+namespace {
+
+// Abréviations de la table ; XX : événement refusé
+const uint8_t AV = OCPP_STATUS_AVAILABLE;
+const uint8_t PR = OCPP_STATUS_PREPARING;
+const uint8_t CH = OCPP_STATUS_CHARGING;
+const uint8_t SV = OCPP_STATUS_SUSPENDED_EV;
+const uint8_t SS = OCPP_STATUS_SUSPENDED_EVSE;
+const uint8_t FI = OCPP_STATUS_FINISHING;
+const uint8_t RE = OCPP_STATUS_RESERVED;
+const uint8_t UN = OCPP_STATUS_UNAVAILABLE;
+const uint8_t FA = OCPP_STATUS_FAULTED;
+const uint8_t XX = OCPP_STATUS_COUNT;
+
+// Transitions OCPP 1.6 (§4.9) ; colonnes dans l'ordre de ocpp_connector_event_t
+const uint8_t TRANSITIONS[OCPP_STATUS_COUNT][OCPP_EVENT_COUNT] = {
+    //            plug unplg auth  deau  txOn  txOff evSus seSus flow  resv  rsEnd off   on    fault clear
+    /* AV */    { PR,  XX,   PR,   XX,   CH,   XX,   XX,   XX,   XX,   RE,   XX,   UN,   AV,   FA,   XX },
+    /* PR */    { PR,  AV,   PR,   AV,   CH,   XX,   SV,   SS,   XX,   XX,   XX,   UN,   XX,   FA,   XX },
+    /* CH */    { XX,  FI,   XX,   XX,   CH,   FI,   SV,   SS,   CH,   XX,   XX,   XX,   XX,   FA,   XX },
+    /* SV */    { XX,  FI,   XX,   XX,   XX,   FI,   SV,   SS,   CH,   XX,   XX,   XX,   XX,   FA,   XX },
+    /* SS */    { XX,  FI,   XX,   XX,   XX,   FI,   SV,   SS,   CH,   XX,   XX,   XX,   XX,   FA,   XX },
+    /* FI */    { XX,  AV,   PR,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   UN,   XX,   FA,   XX },
+    /* RE */    { PR,  XX,   PR,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   AV,   UN,   XX,   FA,   XX },
+    /* UN */    { XX,  XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   UN,   AV,   FA,   XX },
+    /* FA */    { XX,  XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   XX,   FA,   AV },
+};
+
+// Connecteur 0 : disponibilité et défauts du Charge Point seulement
+const uint32_t CHARGE_POINT_EVENTS = (1u << OCPP_EVENT_DISABLE) | (1u << OCPP_EVENT_ENABLE) |
+                                     (1u << OCPP_EVENT_FAULT) | (1u << OCPP_EVENT_FAULT_CLEARED);
+
+} // namespace
+
+OcppConnectorStateMachine::OcppConnectorStateMachine() : sink(nullptr), sinkCtx(nullptr), stats() {
+    for (Connector& connector : connectors) {
+        connector.status = OCPP_STATUS_AVAILABLE;
+        connector.reported = OCPP_STATUS_COUNT;
+        connector.pending = false;
+        connector.dueMs = 0;
+    }
+}
+
+void OcppConnectorStateMachine::setSink(StatusSink statusSink, void* ctx) {
+    sink = statusSink;
+    sinkCtx = ctx;
+}
+
+ocpp_connector_status_t OcppConnectorStateMachine::next(ocpp_connector_status_t status,
+                                                        ocpp_connector_event_t event) {
+    if (status >= OCPP_STATUS_COUNT || event >= OCPP_EVENT_COUNT) return OCPP_STATUS_COUNT;
+    return static_cast<ocpp_connector_status_t>(TRANSITIONS[status][event]);
+}
+
+bool OcppConnectorStateMachine::handle(uint8_t connectorId, ocpp_connector_event_t event, uint32_t nowMs) {
+    ocpp_connector_status_t target = OCPP_STATUS_COUNT;
+    if (connectorId <= MAX_CONNECTORS && event < OCPP_EVENT_COUNT &&
+        (connectorId != 0 || (CHARGE_POINT_EVENTS & (1u << event)))) {
+        target = next(static_cast<ocpp_connector_status_t>(connectors[connectorId].status), event);
+    }
+    if (target == OCPP_STATUS_COUNT) {
+        stats.refused++;
+        return false;
+    }
+    change(connectorId, target, nowMs);
+    return true;
+}
+
+bool OcppConnectorStateMachine::set(uint8_t connectorId, ocpp_connector_status_t status, uint32_t nowMs) {
+    if (connectorId > MAX_CONNECTORS || status >= OCPP_STATUS_COUNT) return false;
+    if (connectorId == 0 && status != OCPP_STATUS_AVAILABLE && status != OCPP_STATUS_UNAVAILABLE &&
+        status != OCPP_STATUS_FAULTED) {
+        return false;
+    }
+    change(connectorId, status, nowMs);
+    return true;
+}
+
+void OcppConnectorStateMachine::change(uint8_t connectorId, ocpp_connector_status_t status, uint32_t nowMs) {
+    Connector& connector = connectors[connectorId];
+    if (connector.status == status) return;
+    connector.status = static_cast<uint8_t>(status);
+    stats.transitions++;
+
+    // Le statut en attente n'est plus d'actualité : un message de moins
+    if (connector.pending) stats.collapsed++;
+    connector.pending = connector.reported != status;
+    connector.dueMs = nowMs + (status == OCPP_STATUS_FAULTED ? 0 : STATUS_NOTIFICATION_DEBOUNCE);
+}
+
+size_t OcppConnectorStateMachine::poll(uint32_t nowMs) {
+    size_t sent = 0;
+    for (uint8_t id = 0; id <= MAX_CONNECTORS; ++id) {
+        Connector& connector = connectors[id];
+        if (!connector.pending || static_cast<int32_t>(nowMs - connector.dueMs) < 0) continue;
+        if (sink && !sink(sinkCtx, id, static_cast<ocpp_connector_status_t>(connector.status))) {
+            stats.deferred++;
+            continue;
+        }
+        connector.reported = connector.status;
+        connector.pending = false;
+        stats.notifications++;
+        sent++;
+    }
+    return sent;
+}
+
+void OcppConnectorStateMachine::reportAll(uint32_t nowMs) {
+    for (Connector& connector : connectors) {
+        connector.reported = OCPP_STATUS_COUNT;
+        connector.pending = true;
+        connector.dueMs = nowMs;
+    }
+}
+
+ocpp_connector_status_t OcppConnectorStateMachine::getStatus(uint8_t connectorId) const {
+    if (connectorId > MAX_CONNECTORS) return OCPP_STATUS_COUNT;
+    return static_cast<ocpp_connector_status_t>(connectors[connectorId].status);
+}
@@ -0,0 +1,130 @@
+#ifndef OCPP_CONNECTOR_STATE_H
+#define OCPP_CONNECTOR_STATE_H
+
+/**
+ * @file ocpp_connector_state.h
+ * @brief Machine d'états des connecteurs (ChargePointStatus OCPP 1.6) et StatusNotification différés
+ *
+ * Une table [statut][événement] donne le statut suivant : une transition est une lecture de
+ * tableau, sans comparaison de chaînes. Les événements non prévus dans un statut sont refusés
+ * (comptés) et ne changent rien. Le connecteur 0 (le Charge Point) ne connaît que Available,
+ * Unavailable et Faulted.
+ *
+ * StatusNotification : un statut n'est signalé qu'après STATUS_NOTIFICATION_DEBOUNCE ms de
+ * stabilité. Une rafale (Preparing → Charging → SuspendedEV en quelques centaines de ms) donne un
+ * seul message, le dernier statut ; un aller-retour vers le statut déjà signalé n'en donne aucun.
+ * Faulted est signalé sans attendre.
+ *
+ * Mémoire fixe, MAX_CONNECTORS + 1 connecteurs. Mono-tâche : tous les appels viennent de la
+ * tâche OCPP.
+ */
+
+#include <Arduino.h>
+#include "ocpp_config.h"
+
+/**
+ * @brief Statuts d'un connecteur (ChargePointStatus)
+ */
+typedef enum {
+    OCPP_STATUS_AVAILABLE = 0,
+    OCPP_STATUS_PREPARING,
+    OCPP_STATUS_CHARGING,
+    OCPP_STATUS_SUSPENDED_EV,
+    OCPP_STATUS_SUSPENDED_EVSE,
+    OCPP_STATUS_FINISHING,
+    OCPP_STATUS_RESERVED,
+    OCPP_STATUS_UNAVAILABLE,
+    OCPP_STATUS_FAULTED,
+    OCPP_STATUS_COUNT
+} ocpp_connector_status_t;
+
+/**
+ * @brief Événements du connecteur
+ */
+typedef enum {
+    OCPP_EVENT_PLUG_IN = 0,          // Câble branché
+    OCPP_EVENT_UNPLUG,               // Câble débranché
+    OCPP_EVENT_AUTHORIZE,            // idTag accepté
+    OCPP_EVENT_DEAUTHORIZE,          // Autorisation annulée ou expirée avant la charge
+    OCPP_EVENT_TX_START,             // Transaction démarrée
+    OCPP_EVENT_TX_STOP,              // Transaction arrêtée, câble encore branché
+    OCPP_EVENT_EV_SUSPEND,           // Le véhicule ne prend plus d'énergie
+    OCPP_EVENT_EVSE_SUSPEND,         // La borne ne délivre plus d'énergie (limite, délestage)
+    OCPP_EVENT_ENERGY_FLOW,          // L'énergie circule à nouveau
+    OCPP_EVENT_RESERVE,              // ReserveNow accepté
+    OCPP_EVENT_RESERVATION_END,      // Réservation expirée ou annulée
+    OCPP_EVENT_DISABLE,              // ChangeAvailability Inoperative
+    OCPP_EVENT_ENABLE,               // ChangeAvailability Operative
+    OCPP_EVENT_FAULT,                // Défaut matériel
+    OCPP_EVENT_FAULT_CLEARED,
+    OCPP_EVENT_COUNT
+} ocpp_connector_event_t;
+
+// Statuts tels qu'écrits dans StatusNotification
+extern const char* const OCPP_CONNECTOR_STATUS_NAMES[OCPP_STATUS_COUNT];
+
+/**
+ * @brief Compteurs de la machine d'états
+ */
+typedef struct {
+    uint32_t transitions;        // Changements de statut
+    uint32_t refused;            // Événements non prévus dans le statut courant
+    uint32_t notifications;      // StatusNotification remis
+    uint32_t collapsed;          // Statuts remplacés ou annulés pendant l'attente : messages évités
+    uint32_t deferred;           // Remises refusées (file pleine), retentées au poll() suivant
+} ocpp_connector_state_stats_t;
+
+class OcppConnectorStateMachine {
+public:
+    // Remet un StatusNotification ; false : à retenter (file pleine)
+    typedef bool (*StatusSink)(void* ctx, uint8_t connectorId, ocpp_connector_status_t status);
+
+    OcppConnectorStateMachine();
+
+    void setSink(StatusSink sink, void* ctx);
+
+    /**
+     * @brief Applique un événement : O(1), une lecture de la table de transitions
+     * @return false si l'événement n'est pas prévu dans le statut courant (ou connecteur invalide)
+     */
+    bool handle(uint8_t connectorId, ocpp_connector_event_t event, uint32_t nowMs);
+
+    /**
+     * @brief Impose un statut, hors table (reprise après redémarrage, test)
+     */
+    bool set(uint8_t connectorId, ocpp_connector_status_t status, uint32_t nowMs);
+
+    /**
+     * @brief Remet les StatusNotification dont le statut est stable depuis le délai
+     * @return Nombre de messages remis
+     */
+    size_t poll(uint32_t nowMs);
+
+    /**
+     * @brief Signale à nouveau le statut de chaque connecteur (BootNotification accepté)
+     */
+    void reportAll(uint32_t nowMs);
+
+    ocpp_connector_status_t getStatus(uint8_t connectorId) const;
+    ocpp_connector_state_stats_t getStats() const { return stats; }
+
+    // Statut suivant d'après la table ; OCPP_STATUS_COUNT si l'événement n'est pas prévu
+    static ocpp_connector_status_t next(ocpp_connector_status_t status, ocpp_connector_event_t event);
+
+private:
+    struct Connector {
+        uint8_t status;              // ocpp_connector_status_t
+        uint8_t reported;            // Dernier statut signalé ; OCPP_STATUS_COUNT : aucun
+        bool pending;
+        uint32_t dueMs;              // Remise du statut en attente
+    };
+
+    StatusSink sink;
+    void* sinkCtx;
+    Connector connectors[MAX_CONNECTORS + 1];
+    ocpp_connector_state_stats_t stats;
+
+    void change(uint8_t connectorId, ocpp_connector_status_t status, uint32_t nowMs);
+};
+
+#endif // OCPP_CONNECTOR_STATE_H
@@ -0,0 +1,91 @@
+/**
+ * @file ocpp_dispatch.cpp
+ * @brief Implémentation de l'aiguillage des CALL reçus
+ */
+
+#include "ocpp_dispatch.h"
+#include "feature_profiles.h"
+
+OcppDispatcher::OcppDispatcher() {
+    memset(handlers, 0, sizeof(handlers));
+    validation.error = OCPP_VALID;
+    validation.field = nullptr;
+}
+
+void OcppDispatcher::setHandler(ocpp_action_t action, Handler handler, void* context) {
+    if (action >= OCPP_ACTION_COUNT) return;
+    handlers[action].handler = handler;
+    handlers[action].context = context;
+}
+
+ocpp_dispatch_result_t OcppDispatcher::dispatch(const ocpp_frame_t& frame, ocpp_action_t* action) {
+    validation.error = OCPP_VALID;
+    validation.field = nullptr;
+
+    ocpp_action_t id = ocppActionFind(frame.action.data, frame.action.len);
+    if (action) *action = id;
+    if (id == OCPP_ACTION_UNKNOWN) return OCPP_DISPATCH_NOT_IMPLEMENTED;
+
+    const ocpp_action_info_t& info = OCPP_ACTIONS[id];
+    if (!(info.direction & OCPP_ACTION_CS_TO_CP) || !FeatureProfiles_isEnabled(info.profile)) {
+        return OCPP_DISPATCH_NOT_SUPPORTED;
+    }
+
+    const Entry& entry = handlers[id];
+    DeserializationError error = deserializeJson(doc, frame.payload.data, frame.payload.len);
+    // Trop gros pour le document : refusé par le gestionnaire de l'action (son état est ici, pas dans
+    // MicroOCPP), ou lu et validé par MicroOCPP avec ses propres moyens
+    if (error == DeserializationError::NoMemory) {
+        doc.clear();
+        if (entry.handler && entry.handler(entry.context, frame, JsonObjectConst())) return OCPP_DISPATCH_HANDLED;
+        return OCPP_DISPATCH_FORWARD;
+    }
+    if (error != DeserializationError::Ok) {
+        validation.error = OCPP_INVALID_FORMATION;
+        return OCPP_DISPATCH_INVALID;
+    }
+    validation = OcppValidator::validate(id, OCPP_SCHEMA_REQUEST, doc.as<JsonVariantConst>());
+    if (validation.error != OCPP_VALID) return OCPP_DISPATCH_INVALID;
+
+    if (entry.handler && entry.handler(entry.context, frame, doc.as<JsonObjectConst>())) return OCPP_DISPATCH_HANDLED;
+    return OCPP_DISPATCH_FORWARD;
+}
+
+size_t OcppDispatcher::writeError(char* out, size_t size, const ocpp_frame_t& frame,
+                                  ocpp_dispatch_result_t result) const {
+    const char* code;
+    const char* reason;
+    if (result == OCPP_DISPATCH_NOT_IMPLEMENTED) {
+        code = "NotImplemented";
+        reason = "Unknown action";
+    } else if (result == OCPP_DISPATCH_NOT_SUPPORTED) {
+        code = "NotSupported";
+        reason = "Action not supported";
+    } else if (result == OCPP_DISPATCH_INVALID && validation.error != OCPP_VALID) {
+        code = OcppValidator::errorCode(validation.error);
+        switch (validation.error) {
+            case OCPP_INVALID_OCCURRENCE: reason = "Missing property "; break;
+            case OCPP_INVALID_TYPE:       reason = "Wrong type for "; break;
+            case OCPP_INVALID_PROPERTY:   reason = "Invalid value for "; break;
+            default:                      reason = validation.field ? "Unexpected property " : "Malformed payload"; break;
+        }
+    } else {
+        return 0;
+    }
+
+    // uniqueId recopié tel quel : il est déjà échappé dans la trame reçue
+    int n = snprintf(out, size, "[4,\"%.*s\",\"%s\",\"%s", static_cast<int>(frame.uniqueId.len),
+                     frame.uniqueId.data, code, reason);
+    if (n < 0 || static_cast<size_t>(n) >= size) return 0;
+    size_t len = static_cast<size_t>(n);
+
+    // Nom de propriété : celui du schéma, ou une clé reçue ; seuls les caractères sûrs sont gardés
+    if (result == OCPP_DISPATCH_INVALID && validation.field) {
+        for (const char* p = validation.field; *p && len + 1 < size; ++p) {
+            if (isalnum(static_cast<unsigned char>(*p)) || *p == '_' || *p == '.' || *p == '-') out[len++] = *p;
+        }
+    }
+    n = snprintf(out + len, size - len, "\",{}]");
+    if (n < 0 || static_cast<size_t>(n) >= size - len) return 0;
+    return len + static_cast<size_t>(n);
+}
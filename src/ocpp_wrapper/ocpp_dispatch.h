@@ -0,0 +1,95 @@
+#ifndef OCPP_DISPATCH_H
+#define OCPP_DISPATCH_H
+
+/**
+ * @file ocpp_dispatch.h
+ * @brief Aiguillage des CALL reçus du serveur par la table d'actions générée (ocpp_actions.h)
+ *
+ * L'action d'un CALL est identifiée par un hachage et une comparaison (ocppActionFind), puis :
+ * - action inconnue d'OCPP 1.6 : CALLERROR NotImplemented ;
+ * - action d'un Feature Profile désactivé, ou que le serveur n'émet pas : CALLERROR NotSupported ;
+ * - charge utile non conforme au schéma (ocpp_validator.h) : CALLERROR FormationViolation,
+ *   OccurenceConstraintViolation, TypeConstraintViolation ou PropertyConstraintViolation ;
+ * - action avec un gestionnaire enregistré : traitée ici, sur le document déjà validé ;
+ * - sinon : transmise à MicroOCPP.
+ *
+ * Les gestionnaires sont indexés par ocpp_action_t : pas de recherche par nom à la réception.
+ * La charge utile est désérialisée dans un document de taille fixe membre du dispatcher ; trop
+ * grosse pour lui, elle n'est pas validée ici : le gestionnaire de l'action la reçoit nulle et
+ * répond lui-même (refus), sinon elle part telle quelle à MicroOCPP.
+ * Mono-tâche : tous les appels viennent de la tâche OCPP.
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "ocpp_actions.h"
+#include "ocpp_config.h"
+#include "ocpp_frame.h"
+#include "ocpp_validator.h"
+
+// `[4,"<uniqueId>","OccurenceConstraintViolation","Missing property <nom>",{}]`
+#define OCPP_DISPATCH_ERROR_SIZE 192
+#ifndef OCPP_DISPATCH_DOC_SIZE
+#define OCPP_DISPATCH_DOC_SIZE 2048     // SetChargingProfile avec une dizaine de périodes
+#endif
+
+// SendLocalList qui tient à coup sûr dans le document (SendLocalListMaxLength annoncé) : entrées
+// avec un IdTagInfo complet, clés et chaînes recopiées (la trame reçue est en lecture seule)
+static constexpr size_t OCPP_DISPATCH_LOCAL_LIST_ENTRY_SIZE =
+    JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(3) + sizeof("idTag") + sizeof("idTagInfo") +
+    sizeof("status") + sizeof("expiryDate") + sizeof("parentIdTag") + 2 * (ID_TAG_MAX_LENGTH + 1) +
+    sizeof("ConcurrentTx") + sizeof("2024-01-01T00:00:00.000+00:00");
+static constexpr size_t OCPP_DISPATCH_LOCAL_LIST_HEADER_SIZE =
+    JSON_OBJECT_SIZE(3) + sizeof("listVersion") + sizeof("updateType") + sizeof("Differential") +
+    sizeof("localAuthorizationList");
+static constexpr int OCPP_SEND_LOCAL_LIST_MAX_LENGTH = static_cast<int>(
+    (OCPP_DISPATCH_DOC_SIZE - OCPP_DISPATCH_LOCAL_LIST_HEADER_SIZE) / OCPP_DISPATCH_LOCAL_LIST_ENTRY_SIZE);
+static_assert(OCPP_SEND_LOCAL_LIST_MAX_LENGTH >= 1, "OCPP_DISPATCH_DOC_SIZE trop petit pour SendLocalList");
+
+/**
+ * @brief Issue de l'aiguillage d'un CALL
+ */
+typedef enum {
+    OCPP_DISPATCH_FORWARD = 0,       // Pas de gestionnaire : à transmettre à MicroOCPP
+    OCPP_DISPATCH_HANDLED,           // Traité par le gestionnaire enregistré
+    OCPP_DISPATCH_NOT_IMPLEMENTED,   // Action inconnue : CALLERROR à renvoyer
+    OCPP_DISPATCH_NOT_SUPPORTED,     // Profil désactivé ou mauvais sens : CALLERROR à renvoyer
+    OCPP_DISPATCH_INVALID            // Charge utile non conforme au schéma : CALLERROR à renvoyer
+} ocpp_dispatch_result_t;
+
+class OcppDispatcher {
+public:
+    // Traite le CALL (charge utile validée, ou nulle si trop grosse pour le document) ;
+    // false : le CALL est finalement transmis à MicroOCPP
+    typedef bool (*Handler)(void* context, const ocpp_frame_t& frame, JsonObjectConst payload);
+
+    OcppDispatcher();
+
+    void setHandler(ocpp_action_t action, Handler handler, void* context);
+
+    /**
+     * @brief Aiguille un CALL reçu
+     * @param action Identifiant de l'action (OCPP_ACTION_UNKNOWN si inconnue), peut être nul
+     */
+    ocpp_dispatch_result_t dispatch(const ocpp_frame_t& frame, ocpp_action_t* action = nullptr);
+
+    /**
+     * @brief CALLERROR de réponse au dernier CALL refusé par dispatch()
+     * @return Longueur de la trame, 0 si le résultat n'appelle pas d'erreur ou si `size` est trop petit
+     */
+    size_t writeError(char* out, size_t size, const ocpp_frame_t& frame, ocpp_dispatch_result_t result) const;
+
+    // Détail de la dernière validation (OCPP_DISPATCH_INVALID)
+    const ocpp_validation_t& getValidation() const { return validation; }
+
+private:
+    struct Entry {
+        Handler handler;
+        void* context;
+    };
+    Entry handlers[OCPP_ACTION_COUNT];
+    StaticJsonDocument<OCPP_DISPATCH_DOC_SIZE> doc;
+    ocpp_validation_t validation;
+};
+
+#endif // OCPP_DISPATCH_H
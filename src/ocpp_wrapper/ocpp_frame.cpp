@@ -0,0 +1,115 @@
+/**
+ * @file ocpp_frame.cpp
+ * @brief Implémentation de la lecture de l'enveloppe OCPP-J
+ */
+
+#include "ocpp_frame.h"
+
+static size_t skipSpaces(const char* text, size_t len, size_t pos) {
+    while (pos < len && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) {
+        pos++;
+    }
+    return pos;
+}
+
+static bool readChar(const char* text, size_t len, size_t& pos, char expected) {
+    pos = skipSpaces(text, len, pos);
+    if (pos >= len || text[pos] != expected) return false;
+    pos++;
+    return true;
+}
+
+// `"<texte>"` ; la vue exclut les guillemets, `pos` passe après le guillemet fermant
+static bool readString(const char* text, size_t len, size_t& pos, ocpp_text_t& value) {
+    if (!readChar(text, len, pos, '"')) return false;
+    size_t start = pos;
+    while (pos < len && text[pos] != '"') {
+        pos += text[pos] == '\\' ? 2 : 1;
+    }
+    if (pos >= len) return false;
+    value.data = text + start;
+    value.len = pos - start;
+    pos++;
+    return true;
+}
+
+// Objet JSON `{...}` : seules les imbrications et les chaînes sont suivies, ArduinoJson valide le reste
+static bool readObject(const char* text, size_t len, size_t& pos, ocpp_text_t& value) {
+    pos = skipSpaces(text, len, pos);
+    if (pos >= len || text[pos] != '{') return false;
+    size_t start = pos;
+    int depth = 0;
+    bool inString = false;
+    for (; pos < len; ++pos) {
+        char c = text[pos];
+        if (inString) {
+            if (c == '\\') pos++;
+            else if (c == '"') inString = false;
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) break;
+            if (depth < 0) return false;
+        }
+    }
+    if (pos >= len || text[pos] != '}') return false;
+    pos++;
+    value.data = text + start;
+    value.len = pos - start;
+    return true;
+}
+
+bool OcppFrame::parse(const char* text, size_t len, ocpp_frame_t& frame) {
+    memset(&frame, 0, sizeof(frame));
+    if (!text) return false;
+
+    size_t pos = 0;
+    if (!readChar(text, len, pos, '[')) return false;
+    pos = skipSpaces(text, len, pos);
+    if (pos + 1 >= len || text[pos] < '2' || text[pos] > '4' || (text[pos + 1] >= '0' && text[pos + 1] <= '9')) {
+        return false;
+    }
+    frame.type = static_cast<ocpp_message_type_t>(text[pos] - '0');
+    pos++;
+    if (!readChar(text, len, pos, ',') || !readString(text, len, pos, frame.uniqueId) ||
+        !readChar(text, len, pos, ',')) {
+        return false;
+    }
+
+    size_t bodyStart = skipSpaces(text, len, pos);
+    bool ok = false;
+    switch (frame.type) {
+        case OCPP_MESSAGE_CALL:
+            ok = readString(text, len, pos, frame.action) && readChar(text, len, pos, ',') &&
+                 readObject(text, len, pos, frame.payload);
+            break;
+        case OCPP_MESSAGE_CALL_RESULT:
+            ok = readObject(text, len, pos, frame.payload);
+            break;
+        case OCPP_MESSAGE_CALL_ERROR:
+            ok = readString(text, len, pos, frame.errorCode) && readChar(text, len, pos, ',') &&
+                 readString(text, len, pos, frame.errorDescription) && readChar(text, len, pos, ',') &&
+                 readObject(text, len, pos, frame.payload);
+            break;
+    }
+    if (!ok) return false;
+    frame.body.data = text + bodyStart;
+    frame.body.len = pos - bodyStart;
+
+    if (!readChar(text, len, pos, ']')) return false;
+    return skipSpaces(text, len, pos) == len;
+}
+
+bool OcppFrame::equals(const ocpp_text_t& text, const char* value) {
+    return value && strlen(value) == text.len && memcmp(text.data, value, text.len) == 0;
+}
+
+size_t OcppFrame::copy(const ocpp_text_t& text, char* out, size_t size) {
+    if (size == 0) return 0;
+    size_t len = text.len < size ? text.len : size - 1;
+    if (len > 0) memcpy(out, text.data, len);
+    out[len] = '\0';
+    return len;
+}
@@ -0,0 +1,72 @@
+#ifndef OCPP_FRAME_H
+#define OCPP_FRAME_H
+
+/**
+ * @file ocpp_frame.h
+ * @brief Lecture de l'enveloppe OCPP-J sur place, sans copie ni allocation
+ *
+ * `[2,"<uniqueId>","<Action>",{payload}]`, `[3,"<uniqueId>",{payload}]` ou
+ * `[4,"<uniqueId>","<errorCode>","<errorDescription>",{errorDetails}]` : parse() découpe la
+ * trame reçue en vues (pointeur + longueur) sur le tampon du WebSocket. Seule la charge utile est
+ * ensuite donnée à ArduinoJson, avec un document de taille fixe :
+ *
+ *     ocpp_frame_t frame;
+ *     if (OcppFrame::parse(text, len, frame) && OcppFrame::equals(frame.action, "Reset")) {
+ *         StaticJsonDocument<128> doc;
+ *         deserializeJson(doc, frame.payload.data, frame.payload.len);
+ *     }
+ *
+ * Les vues ne sont valides que tant que le tampon de la trame l'est ; elles ne sont pas terminées
+ * par '\0'. Les chaînes sont laissées échappées (`\"` reste tel quel) : uniqueId et noms d'action
+ * OCPP n'en contiennent pas.
+ */
+
+#include <Arduino.h>
+
+/**
+ * @brief Types de message OCPP-J (premier élément de l'enveloppe)
+ */
+typedef enum {
+    OCPP_MESSAGE_CALL = 2,
+    OCPP_MESSAGE_CALL_RESULT = 3,
+    OCPP_MESSAGE_CALL_ERROR = 4
+} ocpp_message_type_t;
+
+/**
+ * @brief Vue sur une partie de la trame
+ */
+typedef struct {
+    const char* data;
+    size_t len;
+} ocpp_text_t;
+
+/**
+ * @brief Enveloppe découpée ; les champs absents du type de message restent vides
+ */
+typedef struct {
+    ocpp_message_type_t type;
+    ocpp_text_t uniqueId;
+    ocpp_text_t action;              // CALL
+    ocpp_text_t errorCode;           // CALLERROR
+    ocpp_text_t errorDescription;    // CALLERROR
+    ocpp_text_t payload;             // Objet JSON brut : charge utile, ou errorDetails d'un CALLERROR
+    ocpp_text_t body;                // Tout ce qui suit l'uniqueId (CALLERROR : code, description, détails)
+} ocpp_frame_t;
+
+class OcppFrame {
+public:
+    /**
+     * @brief Découpe une trame OCPP-J
+     * @return false si l'enveloppe est invalide (type inconnu, élément manquant, objet non fermé,
+     *         texte après le crochet fermant)
+     */
+    static bool parse(const char* text, size_t len, ocpp_frame_t& frame);
+
+    // Comparaison d'une vue avec une chaîne terminée par '\0'
+    static bool equals(const ocpp_text_t& text, const char* value);
+
+    // Copie tronquée et terminée par '\0' ; retourne la longueur copiée
+    static size_t copy(const ocpp_text_t& text, char* out, size_t size);
+};
+
+#endif // OCPP_FRAME_H
@@ -0,0 +1,574 @@
+/**
+ * @file ocpp_journal.cpp
+ * @brief Implémentation du journal des messages de transaction
+ */
+
+#include "ocpp_journal.h"
+#include "LogClock.h"
+
+#define LOG_TAG "journal"
+#include "log_macros.h"
+
+static const uint8_t JOURNAL_MAGIC = 0xA5;
+static const size_t JOURNAL_HEADER_SIZE = 8;     // magic | type | longueur | seq
+static const size_t JOURNAL_CRC_SIZE = 4;
+// type | connecteur | txRef | meterWh | powerW | unixMs | timestampMs | idTag, puis le relevé :
+// contexte | grandeurs | valeurs. Les enregistrements sans relevé (premier format) restent lisibles.
+// Un StopTransaction n'a pas de relevé : l'octet du contexte porte sa raison (0 : Local)
+static const size_t JOURNAL_CALL_V1_SIZE = 1 + 1 + 2 + 4 + 4 + 8 + 4 + (ID_TAG_MAX_LENGTH + 1);
+static const size_t JOURNAL_CALL_SIZE = JOURNAL_CALL_V1_SIZE + 1 + 1 + 4 * OCPP_MEASURAND_COUNT;
+static const size_t JOURNAL_ACK_SIZE = 2 + 1 + 4;            // txRef | type | valeur
+static const size_t JOURNAL_TRANSACTION_SIZE = 2 + 4;        // txRef | transactionId
+static const size_t JOURNAL_META_SIZE = 2;                   // dernier txRef
+static const size_t JOURNAL_MAX_PAYLOAD = JOURNAL_CALL_SIZE;
+static const size_t JOURNAL_MAX_RECORD = JOURNAL_HEADER_SIZE + JOURNAL_MAX_PAYLOAD + JOURNAL_CRC_SIZE;
+
+static_assert(JOURNAL_MAX_RECORD <= OCPP_JOURNAL_BLOCK_SIZE, "un enregistrement doit tenir dans un bloc");
+
+// ============================================================================
+// ENCODAGE (petit-boutiste, comme la cible)
+// ============================================================================
+
+// CRC-32 IEEE 802.3, table de 16 entrées : ~2 décalages par demi-octet, 64 octets de flash
+static uint32_t crc32(const uint8_t* data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+template <typename T>
+static uint8_t* put(uint8_t* out, const T& value) {
+    memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+template <typename T>
+static const uint8_t* get(const uint8_t* in, T& value) {
+    memcpy(&value, in, sizeof(T));
+    return in + sizeof(T);
+}
+
+static size_t encodeRecord(uint8_t* out, uint8_t kind, uint32_t seq, const uint8_t* data, size_t len) {
+    uint8_t* p = out;
+    *p++ = JOURNAL_MAGIC;
+    *p++ = kind;
+    p = put(p, static_cast<uint16_t>(len));
+    p = put(p, seq);
+    memcpy(p, data, len);
+    p += len;
+    uint32_t crc = crc32(out, static_cast<size_t>(p - out));
+    p = put(p, crc);
+    return static_cast<size_t>(p - out);
+}
+
+// Lit un enregistrement complet à la position courante ; false : fin de fichier ou enregistrement invalide
+static bool readRecord(File& in, uint8_t* record, size_t& size) {
+    if (in.read(record, JOURNAL_HEADER_SIZE) != JOURNAL_HEADER_SIZE || record[0] != JOURNAL_MAGIC) return false;
+    uint16_t len = 0;
+    get(record + 2, len);
+    if (record[1] < 1 || record[1] > 4 || len > JOURNAL_MAX_PAYLOAD) return false;
+    size_t rest = len + JOURNAL_CRC_SIZE;
+    if (in.read(record + JOURNAL_HEADER_SIZE, rest) != rest) return false;
+    uint32_t crc = 0;
+    get(record + JOURNAL_HEADER_SIZE + len, crc);
+    if (crc != crc32(record, JOURNAL_HEADER_SIZE + len)) return false;
+    size = JOURNAL_HEADER_SIZE + rest;
+    return true;
+}
+
+static void encodeCall(uint8_t* out, const ocpp_call_t& call) {
+    uint8_t* p = out;
+    *p++ = static_cast<uint8_t>(call.type);
+    *p++ = call.connectorId;
+    p = put(p, call.txRef);
+    p = put(p, call.meterWh);
+    // Puissance en W, pour les lecteurs du premier format
+    float powerW = (call.measurands & OCPP_MEASURAND_BIT(OCPP_MEASURAND_POWER))
+                       ? call.values[OCPP_MEASURAND_POWER] / 10.0f : 0.0f;
+    p = put(p, powerW);
+    p = put(p, call.unixMs);
+    p = put(p, call.timestampMs);
+    memcpy(p, call.idTag, ID_TAG_MAX_LENGTH + 1);
+    p += ID_TAG_MAX_LENGTH + 1;
+    *p++ = call.type == OCPP_CALL_STOP_TRANSACTION ? call.stopReason : call.readingContext;
+    *p++ = call.measurands;
+    for (int32_t value : call.values) p = put(p, value);
+}
+
+static void decodeCall(const uint8_t* in, size_t len, ocpp_call_t& call) {
+    memset(&call, 0, sizeof(call));
+    call.type = static_cast<ocpp_call_type_t>(*in++);
+    call.connectorId = *in++;
+    in = get(in, call.txRef);
+    in = get(in, call.meterWh);
+    float powerW = 0.0f;
+    in = get(in, powerW);
+    in = get(in, call.unixMs);
+    in = get(in, call.timestampMs);
+    memcpy(call.idTag, in, ID_TAG_MAX_LENGTH);
+    in += ID_TAG_MAX_LENGTH + 1;
+    if (len >= JOURNAL_CALL_SIZE) {
+        uint8_t context = *in++;
+        if (call.type == OCPP_CALL_STOP_TRANSACTION) {
+            call.stopReason = context < OCPP_STOP_REASON_COUNT ? context : OCPP_STOP_LOCAL;
+        } else {
+            call.readingContext = context;
+        }
+        call.measurands = *in++;
+        for (int32_t& value : call.values) in = get(in, value);
+    } else if (call.type == OCPP_CALL_METER_VALUES) {
+        // Premier format : index et puissance
+        call.measurands = OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_REGISTER) | OCPP_MEASURAND_BIT(OCPP_MEASURAND_POWER);
+        call.values[OCPP_MEASURAND_ENERGY_REGISTER] = call.meterWh;
+        call.values[OCPP_MEASURAND_POWER] = static_cast<int32_t>(lroundf(powerW * 10.0f));
+    }
+}
+
+// ============================================================================
+// CYCLE DE VIE
+// ============================================================================
+
+OcppJournal::OcppJournal(const char* journalPath, fs::FS& filesystem)
+    : fs(filesystem), path(journalPath), started(false) {
+    reset();
+}
+
+OcppJournal::~OcppJournal() {
+    end();
+}
+
+void OcppJournal::reset() {
+    blockUsed = 0;
+    blockStartMs = 0;
+    fileSize = 0;
+    blockLastSeq = 0;
+    durableSeq = 0;
+    pendingCount = 0;
+    memset(transactions, 0, sizeof(transactions));
+    nextTransactionSlot = 0;
+    nextSeq = 1;
+    lastTxRef = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool OcppJournal::begin(uint32_t nowMs) {
+    if (started) return true;
+    reset();
+    recover(nowMs);
+
+    file = fs.open(path, FILE_APPEND);
+    if (!file) {
+        LOG_ERROR("Journal OCPP: ouverture de %s impossible", path);
+        return false;
+    }
+    started = true;
+
+    // Fin invalide : les ajouts suivants seraient illisibles derrière elle
+    if ((stats.discardedBytes > 0 || fileSize > OCPP_JOURNAL_COMPACT_SIZE) && !compact() &&
+        stats.discardedBytes > 0) {
+        file.close();
+        started = false;
+        return false;
+    }
+    stats.recovered = static_cast<uint32_t>(pendingCount);
+    if (pendingCount > 0 || stats.discardedBytes > 0) {
+        LOG_WARN("Journal OCPP: %u message(s) à rejouer, %lu octet(s) invalides ignorés",
+                 static_cast<unsigned>(pendingCount), static_cast<unsigned long>(stats.discardedBytes));
+    }
+    return true;
+}
+
+void OcppJournal::end(bool commitBlock) {
+    if (!started) return;
+    if (commitBlock) commit();
+    blockUsed = 0;
+    file.close();
+    started = false;
+}
+
+// ============================================================================
+// ÉCRITURE
+// ============================================================================
+
+bool OcppJournal::append(ocpp_call_t& call, uint32_t nowMs) {
+    if (!started || pendingCount >= OCPP_JOURNAL_MAX_PENDING) return false;
+
+    call.journalSeq = nextSeq;
+    if (call.unixMs == 0) call.unixMs = LogClock::toUnixMs(call.timestampMs);
+    uint8_t data[JOURNAL_CALL_SIZE];
+    encodeCall(data, call);
+    uint32_t offset = 0;
+    if (!writeRecord(RECORD_CALL, call.journalSeq, data, sizeof(data), nowMs, &offset)) return false;
+
+    nextSeq++;
+    Pending& entry = pending[pendingCount++];
+    entry.seq = call.journalSeq;
+    entry.offset = offset;
+    entry.retryAt = nowMs;
+    entry.txRef = call.txRef;
+    entry.type = static_cast<uint8_t>(call.type);
+    entry.queued = false;
+    entry.recovered = false;
+    if (call.txRef != 0) lastTxRef = call.txRef;
+    stats.appended++;
+
+    // Début et fin de transaction : durables avant de rendre la main
+    if (call.type == OCPP_CALL_START_TRANSACTION || call.type == OCPP_CALL_STOP_TRANSACTION) commit();
+    return true;
+}
+
+bool OcppJournal::onResult(const ocpp_call_t& call, ocpp_call_result_t result, int32_t transactionId,
+                           uint32_t nowMs) {
+    if (call.journalSeq == 0) return true;
+    Pending* entry = findPending(call.journalSeq);
+    if (!entry) return true;
+
+    int32_t value = 0;
+    if (result == OCPP_CALL_CONFIRMED) {
+        value = call.type == OCPP_CALL_START_TRANSACTION ? transactionId : 0;
+    } else if (result == OCPP_CALL_DROPPED &&
+               (call.type == OCPP_CALL_START_TRANSACTION || transactionUsable(call.txRef))) {
+        // Serveur muet : redonné plus tard, les messages suivants de la transaction attendent
+        entry->queued = false;
+        entry->retryAt = nowMs + TRANSACTION_MESSAGE_RETRY_INTERVAL;
+        stats.deferred++;
+        return false;
+    } else {
+        value = -1;   // Refusé par le serveur, ou transaction inconnue du serveur
+    }
+
+    uint8_t data[JOURNAL_ACK_SIZE];
+    uint8_t* p = put(data, call.txRef);
+    *p++ = static_cast<uint8_t>(call.type);
+    put(p, value);
+    writeRecord(RECORD_ACK, call.journalSeq, data, sizeof(data), nowMs);
+    acknowledge(call.journalSeq, call.txRef, static_cast<uint8_t>(call.type), value);
+    stats.acked++;
+
+    // Un accusé de début perdu ferait ouvrir une seconde transaction au serveur
+    if (call.type == OCPP_CALL_START_TRANSACTION || call.type == OCPP_CALL_STOP_TRANSACTION) commit();
+    return true;
+}
+
+bool OcppJournal::writeRecord(RecordKind kind, uint32_t seq, const uint8_t* data, size_t len, uint32_t nowMs,
+                              uint32_t* offset) {
+    if (!started) return false;
+    if (blockUsed + JOURNAL_HEADER_SIZE + len + JOURNAL_CRC_SIZE > sizeof(block)) commit();
+    if (blockUsed == 0) blockStartMs = nowMs;
+    if (offset) *offset = fileSize + static_cast<uint32_t>(blockUsed);
+    blockUsed += encodeRecord(block + blockUsed, kind, seq, data, len);
+    if (kind == RECORD_CALL && seq > blockLastSeq) blockLastSeq = seq;
+    return true;
+}
+
+void OcppJournal::commitIfDue(uint32_t nowMs) {
+    if (!started) return;
+    if (blockUsed > 0 && nowMs - blockStartMs >= OCPP_JOURNAL_COMMIT_INTERVAL_MS) commit();
+    if (fileSize > OCPP_JOURNAL_COMPACT_SIZE) compact();
+}
+
+void OcppJournal::commit() {
+    if (!started || blockUsed == 0) return;
+    size_t written = file.write(block, blockUsed);
+    file.flush();
+    if (written != blockUsed) {
+        LOG_ERROR("Journal OCPP: écriture incomplète (%u/%u octets)", static_cast<unsigned>(written),
+                  static_cast<unsigned>(blockUsed));
+    }
+    fileSize += static_cast<uint32_t>(written);
+    blockUsed = 0;
+    if (blockLastSeq > durableSeq) durableSeq = blockLastSeq;
+    stats.commits++;
+}
+
+bool OcppJournal::compact() {
+    if (!started) return false;
+    commit();
+
+    String tmp = tempPath();
+    File out = fs.open(tmp, FILE_WRITE);
+    File in = fs.open(path, FILE_READ);
+    if (!out || !in) {
+        LOG_ERROR("Journal OCPP: compaction impossible");
+        return false;
+    }
+
+    uint8_t record[JOURNAL_MAX_RECORD];
+    uint32_t outSize = 0;
+    uint32_t offsets[OCPP_JOURNAL_MAX_PENDING];
+    bool ok = true;
+
+    // Numérotation et transactions ouvertes : l'historique qui les portait disparaît
+    uint8_t meta[JOURNAL_META_SIZE];
+    put(meta, lastTxRef);
+    size_t size = encodeRecord(record, RECORD_META, nextSeq, meta, sizeof(meta));
+    ok = out.write(record, size) == size;
+    outSize += static_cast<uint32_t>(size);
+    for (const Transaction& transaction : transactions) {
+        if (!ok || transaction.txRef == 0) continue;
+        uint8_t data[JOURNAL_TRANSACTION_SIZE];
+        put(put(data, transaction.txRef), transaction.transactionId);
+        size = encodeRecord(record, RECORD_TRANSACTION, 0, data, sizeof(data));
+        ok = out.write(record, size) == size;
+        outSize += static_cast<uint32_t>(size);
+    }
+    for (size_t i = 0; ok && i < pendingCount; ++i) {
+        ok = in.seek(pending[i].offset) && readRecord(in, record, size) && out.write(record, size) == size;
+        offsets[i] = outSize;
+        outSize += static_cast<uint32_t>(size);
+    }
+    out.flush();
+    out.close();
+    in.close();
+    if (!ok) {
+        fs.remove(tmp);
+        LOG_ERROR("Journal OCPP: compaction interrompue, journal conservé");
+        return false;
+    }
+
+    // Coupure entre les deux : begin() renomme le fichier temporaire
+    file.close();
+    fs.remove(path);
+    fs.rename(tmp, path);
+    file = fs.open(path, FILE_APPEND);
+    fileSize = outSize;
+    for (size_t i = 0; i < pendingCount; ++i) {
+        pending[i].offset = offsets[i];
+    }
+    stats.compactions++;
+    if (!file) {
+        started = false;
+        LOG_ERROR("Journal OCPP: réouverture de %s impossible", path);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// REJEU
+// ============================================================================
+
+size_t OcppJournal::feed(OcppCallQueue& queue, uint32_t nowMs) {
+    if (!started) return 0;
+    size_t queued = 0;
+    for (size_t i = 0; i < pendingCount; ++i) {
+        if (pending[i].queued) queued++;
+    }
+
+    File in;
+    size_t fed = 0;
+    for (size_t i = 0; i < pendingCount && queued < OCPP_JOURNAL_REPLAY_WINDOW; ++i) {
+        Pending& entry = pending[i];
+        if (entry.queued) continue;
+        bool wait = static_cast<int32_t>(nowMs - entry.retryAt) < 0;
+        // Un message plus ancien de la même transaction, hors de la file, passe d'abord
+        for (size_t j = 0; !wait && entry.txRef != 0 && j < i; ++j) {
+            wait = pending[j].txRef == entry.txRef && !pending[j].queued;
+        }
+        if (wait) continue;
+
+        // Encore dans le bloc : lu en mémoire, sans forcer d'écriture
+        if (entry.offset < fileSize && !in) in = fs.open(path, FILE_READ);
+        ocpp_call_t call;
+        if (!readCall(in, entry, call, nowMs)) {
+            LOG_ERROR("Journal OCPP: message %lu illisible", static_cast<unsigned long>(entry.seq));
+            break;
+        }
+        if (!queue.enqueue(call, nowMs)) break;
+        entry.queued = true;
+        queued++;
+        fed++;
+        stats.replayed++;
+    }
+    return fed;
+}
+
+bool OcppJournal::readCall(File& in, const Pending& entry, ocpp_call_t& call, uint32_t nowMs) {
+    uint8_t record[JOURNAL_MAX_RECORD];
+    size_t size = 0;
+    uint32_t seq = 0;
+    if (entry.offset >= fileSize) {
+        size_t pos = entry.offset - fileSize;
+        if (pos + JOURNAL_HEADER_SIZE + JOURNAL_CALL_SIZE + JOURNAL_CRC_SIZE > blockUsed) return false;
+        memcpy(record, block + pos, JOURNAL_HEADER_SIZE + JOURNAL_CALL_SIZE + JOURNAL_CRC_SIZE);
+    } else if (!in || !in.seek(entry.offset) || !readRecord(in, record, size)) {
+        return false;
+    }
+    if (record[1] != RECORD_CALL) return false;
+    uint16_t len = 0;
+    get(record + 2, len);
+    get(record + 4, seq);
+    if (seq != entry.seq) return false;
+    decodeCall(record + JOURNAL_HEADER_SIZE, len, call);
+    call.journalSeq = seq;
+    // Uptime d'un démarrage précédent : sans heure absolue, seule l'heure du rejeu a un sens
+    if (entry.recovered && call.unixMs == 0) call.timestampMs = nowMs;
+    return true;
+}
+
+// ============================================================================
+// RELECTURE
+// ============================================================================
+
+void OcppJournal::recover(uint32_t nowMs) {
+    // Compaction interrompue : le journal complet, ou à défaut sa copie terminée
+    String tmp = tempPath();
+    if (fs.exists(tmp)) {
+        if (fs.exists(path)) {
+            fs.remove(tmp);
+        } else {
+            fs.rename(tmp, path);
+        }
+    }
+
+    File in = fs.open(path, FILE_READ);
+    if (!in) return;
+    size_t total = in.size();
+    uint32_t offset = 0;
+    uint8_t record[JOURNAL_MAX_RECORD];
+    size_t size = 0;
+    while (offset < total && readRecord(in, record, size)) {
+        uint32_t seq = 0;
+        get(record + 4, seq);
+        uint16_t len = 0;
+        get(record + 2, len);
+        applyRecord(static_cast<RecordKind>(record[1]), seq, record + JOURNAL_HEADER_SIZE, len, offset, nowMs);
+        offset += static_cast<uint32_t>(size);
+    }
+    in.close();
+    fileSize = offset;
+    stats.discardedBytes = static_cast<uint32_t>(total - offset);
+    durableSeq = nextSeq - 1;
+}
+
+void OcppJournal::applyRecord(RecordKind kind, uint32_t seq, const uint8_t* data, size_t len, uint32_t offset,
+                              uint32_t nowMs) {
+    switch (kind) {
+        case RECORD_CALL: {
+            ocpp_call_t call;
+            decodeCall(data, len, call);
+            if (seq >= nextSeq) nextSeq = seq + 1;
+            if (call.txRef != 0) lastTxRef = call.txRef;
+            if (pendingCount >= OCPP_JOURNAL_MAX_PENDING) break;
+            Pending& entry = pending[pendingCount++];
+            entry.seq = seq;
+            entry.offset = offset;
+            entry.retryAt = nowMs;
+            entry.txRef = call.txRef;
+            entry.type = static_cast<uint8_t>(call.type);
+            entry.queued = false;
+            entry.recovered = true;
+            break;
+        }
+        case RECORD_ACK: {
+            uint16_t txRef = 0;
+            int32_t value = 0;
+            const uint8_t* p = get(data, txRef);
+            uint8_t type = *p++;
+            get(p, value);
+            acknowledge(seq, txRef, type, value);
+            break;
+        }
+        case RECORD_TRANSACTION: {
+            uint16_t txRef = 0;
+            int32_t transactionId = 0;
+            get(get(data, txRef), transactionId);
+            setTransaction(txRef, transactionId);
+            break;
+        }
+        case RECORD_META:
+            if (seq > nextSeq) nextSeq = seq;
+            get(data, lastTxRef);
+            break;
+    }
+}
+
+// ============================================================================
+// ÉTAT
+// ============================================================================
+
+void OcppJournal::acknowledge(uint32_t seq, uint16_t txRef, uint8_t type, int32_t value) {
+    for (size_t i = 0; i < pendingCount; ++i) {
+        if (pending[i].seq != seq) continue;
+        memmove(&pending[i], &pending[i + 1], (pendingCount - i - 1) * sizeof(Pending));
+        pendingCount--;
+        break;
+    }
+    if (type == OCPP_CALL_START_TRANSACTION) {
+        setTransaction(txRef, value);
+    } else if (type == OCPP_CALL_STOP_TRANSACTION) {
+        clearTransaction(txRef);
+    }
+}
+
+void OcppJournal::setTransaction(uint16_t txRef, int32_t transactionId) {
+    if (txRef == 0) return;
+    Transaction* slot = nullptr;
+    for (Transaction& transaction : transactions) {
+        if (transaction.txRef == txRef) {
+            slot = &transaction;
+            break;
+        }
+        if (!slot && transaction.txRef == 0) slot = &transaction;
+    }
+    if (!slot) {
+        // Table pleine : la plus ancienne transaction ouverte est oubliée
+        slot = &transactions[nextTransactionSlot];
+        nextTransactionSlot = (nextTransactionSlot + 1) % OCPP_JOURNAL_MAX_TRANSACTIONS;
+    }
+    slot->txRef = txRef;
+    slot->transactionId = transactionId;
+}
+
+void OcppJournal::clearTransaction(uint16_t txRef) {
+    for (Transaction& transaction : transactions) {
+        if (transaction.txRef == txRef) transaction.txRef = 0;
+    }
+}
+
+bool OcppJournal::findTransactionId(uint16_t txRef, int32_t& transactionId) const {
+    if (txRef == 0) return false;
+    for (const Transaction& transaction : transactions) {
+        if (transaction.txRef == txRef) {
+            transactionId = transaction.transactionId;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OcppJournal::transactionUsable(uint16_t txRef) const {
+    int32_t transactionId = -1;
+    if (findTransactionId(txRef, transactionId)) return transactionId >= 0;
+    // Début pas encore confirmé : la transaction reste possible
+    for (size_t i = 0; i < pendingCount; ++i) {
+        if (pending[i].txRef == txRef && pending[i].type == OCPP_CALL_START_TRANSACTION) return true;
+    }
+    return false;
+}
+
+OcppJournal::Pending* OcppJournal::findPending(uint32_t seq) {
+    for (size_t i = 0; i < pendingCount; ++i) {
+        if (pending[i].seq == seq) return &pending[i];
+    }
+    return nullptr;
+}
+
+ocpp_journal_stats_t OcppJournal::getStats() const {
+    ocpp_journal_stats_t out = stats;
+    out.pending = static_cast<uint16_t>(pendingCount);
+    out.fileSize = fileSize;
+    return out;
+}
+
+String OcppJournal::tempPath() const {
+    return String(path) + ".tmp";
+}
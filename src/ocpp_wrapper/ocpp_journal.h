@@ -0,0 +1,183 @@
+#ifndef OCPP_JOURNAL_H
+#define OCPP_JOURNAL_H
+
+/**
+ * @file ocpp_journal.h
+ * @brief Journal persistant des messages de transaction, rejoué à la reconnexion
+ *
+ * StartTransaction, StopTransaction et les MeterValues d'une transaction sont d'abord écrits dans
+ * un fichier SPIFFS en ajout seul, puis donnés à l'OcppCallQueue par feed(). Une confirmation du
+ * serveur ajoute un accusé ; un message non confirmé reste dans le journal, y compris après une
+ * coupure d'alimentation.
+ *
+ * Format : suite d'enregistrements `A5 | type | longueur (2) | seq (4) | données | CRC-32 (4)`.
+ * À begin(), la relecture s'arrête au premier enregistrement invalide (écriture interrompue) et
+ * le fichier est compacté pour effacer cette fin.
+ *
+ * Usure de la flash :
+ * - les écritures sont groupées dans un bloc de OCPP_JOURNAL_BLOCK_SIZE octets, écrit quand il est
+ *   plein ou après OCPP_JOURNAL_COMMIT_INTERVAL_MS ;
+ * - StartTransaction et StopTransaction sont écrits avant le retour de append() (durables) ;
+ * - une coupure peut donc perdre au plus les MeterValues et les accusés de la dernière
+ *   seconde ou deux. Un accusé perdu produit un renvoi, jamais une perte.
+ *
+ * Compaction : au-delà de OCPP_JOURNAL_COMPACT_SIZE octets, les enregistrements en attente sont
+ * recopiés dans un fichier temporaire, renommé ensuite sur le journal. Une coupure pendant la
+ * compaction laisse l'un ou l'autre fichier intact.
+ *
+ * Rejeu : dans l'ordre du journal, au plus OCPP_JOURNAL_REPLAY_WINDOW messages dans la file à la
+ * fois. Un message que la file abandonne (serveur muet) n'est redonné qu'après
+ * TRANSACTION_MESSAGE_RETRY_INTERVAL, et les messages suivants de sa transaction l'attendent.
+ * Un message refusé par le serveur (CALLERROR) est retiré du journal.
+ *
+ * Mono-tâche : tous les appels viennent de la tâche OCPP.
+ */
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SPIFFS.h>
+#include "ocpp_call_queue.h"
+
+#ifndef OCPP_JOURNAL_FILE
+#define OCPP_JOURNAL_FILE "/ocpp_journal.bin"
+#endif
+#ifndef OCPP_JOURNAL_BLOCK_SIZE
+#define OCPP_JOURNAL_BLOCK_SIZE 256              // Une page logique SPIFFS par écriture
+#endif
+#ifndef OCPP_JOURNAL_COMMIT_INTERVAL_MS
+#define OCPP_JOURNAL_COMMIT_INTERVAL_MS 2000
+#endif
+#ifndef OCPP_JOURNAL_COMPACT_SIZE
+#define OCPP_JOURNAL_COMPACT_SIZE 8192
+#endif
+#ifndef OCPP_JOURNAL_MAX_PENDING
+#define OCPP_JOURNAL_MAX_PENDING 64              // ~1 h de MeterValues à 60 s hors ligne
+#endif
+#ifndef OCPP_JOURNAL_REPLAY_WINDOW
+#define OCPP_JOURNAL_REPLAY_WINDOW 4             // Le reste de la file reste aux statuts et mesures
+#endif
+#ifndef OCPP_JOURNAL_MAX_TRANSACTIONS
+#define OCPP_JOURNAL_MAX_TRANSACTIONS 4          // transactionId du serveur conservés par txRef
+#endif
+
+static_assert(OCPP_JOURNAL_REPLAY_WINDOW < OCPP_MESSAGE_QUEUE_SIZE, "le rejeu ne doit pas remplir la file");
+
+/**
+ * @brief Compteurs du journal
+ */
+typedef struct {
+    uint16_t pending;            // Messages non confirmés
+    uint32_t fileSize;           // Octets écrits dans le fichier
+    uint32_t appended;
+    uint32_t acked;              // Confirmés ou retirés
+    uint32_t replayed;           // Messages donnés à la file, renvois compris
+    uint32_t deferred;           // Abandonnés par la file, redonnés après TRANSACTION_MESSAGE_RETRY_INTERVAL
+    uint32_t commits;            // Écritures de bloc (write + flush)
+    uint32_t compactions;
+    uint32_t recovered;          // Messages retrouvés par begin()
+    uint32_t discardedBytes;     // Fin de fichier invalide ignorée par begin()
+} ocpp_journal_stats_t;
+
+class OcppJournal {
+public:
+    explicit OcppJournal(const char* path = OCPP_JOURNAL_FILE, fs::FS& filesystem = SPIFFS);
+    ~OcppJournal();
+
+    /**
+     * @brief Relit le journal (messages en attente, transactionId connus) et l'ouvre en ajout
+     */
+    bool begin(uint32_t nowMs);
+
+    /**
+     * @brief Ferme le journal
+     * @param commit false : le bloc en mémoire est perdu, comme lors d'une coupure (tests)
+     */
+    void end(bool commit = true);
+
+    /**
+     * @brief Ajoute un message de transaction ; renseigne call.journalSeq et call.unixMs
+     * @return false si le journal est plein ou illisible (contre-pression)
+     */
+    bool append(ocpp_call_t& call, uint32_t nowMs);
+
+    /**
+     * @brief Issue d'un message du journal, à appeler depuis le ResultHandler de la file
+     * @param transactionId Pour un StartTransaction confirmé : l'identifiant du serveur
+     * @return true si le message a quitté le journal, false s'il sera redonné à la file
+     */
+    bool onResult(const ocpp_call_t& call, ocpp_call_result_t result, int32_t transactionId, uint32_t nowMs);
+
+    /**
+     * @brief Donne à la file les messages en attente, dans l'ordre du journal
+     * @return Nombre de messages ajoutés à la file
+     */
+    size_t feed(OcppCallQueue& queue, uint32_t nowMs);
+
+    // Écrit le bloc s'il a plus de OCPP_JOURNAL_COMMIT_INTERVAL_MS, puis compacte si nécessaire
+    void commitIfDue(uint32_t nowMs);
+    void commit();
+    bool compact();
+
+    // transactionId attribué par le serveur ; -1 si la transaction a été refusée ou abandonnée
+    bool findTransactionId(uint16_t txRef, int32_t& transactionId) const;
+    // Plus grande référence de transaction vue : à continuer après un redémarrage
+    uint16_t getLastTxRef() const { return lastTxRef; }
+    // Dernier numéro d'enregistrement écrit sur la flash
+    uint32_t getDurableSeq() const { return durableSeq; }
+    size_t getPending() const { return pendingCount; }
+    ocpp_journal_stats_t getStats() const;
+
+private:
+    enum RecordKind : uint8_t { RECORD_CALL = 1, RECORD_ACK = 2, RECORD_TRANSACTION = 3, RECORD_META = 4 };
+
+    struct Pending {
+        uint32_t seq;
+        uint32_t offset;           // Position de l'enregistrement dans le fichier
+        uint32_t retryAt;
+        uint16_t txRef;
+        uint8_t type;
+        bool queued;               // Dans la file, en attente de son issue
+        bool recovered;            // Écrit avant le redémarrage
+    };
+
+    struct Transaction {
+        uint16_t txRef;            // 0 : libre
+        int32_t transactionId;
+    };
+
+    fs::FS& fs;
+    const char* path;
+    File file;
+    bool started;
+
+    uint8_t block[OCPP_JOURNAL_BLOCK_SIZE];
+    size_t blockUsed;
+    uint32_t blockStartMs;
+    uint32_t fileSize;
+    uint32_t blockLastSeq;         // Plus grand seq du bloc en mémoire
+    uint32_t durableSeq;
+
+    Pending pending[OCPP_JOURNAL_MAX_PENDING];
+    size_t pendingCount;
+    Transaction transactions[OCPP_JOURNAL_MAX_TRANSACTIONS];
+    size_t nextTransactionSlot;
+    uint32_t nextSeq;
+    uint16_t lastTxRef;
+    ocpp_journal_stats_t stats;
+
+    void reset();
+    bool writeRecord(RecordKind kind, uint32_t seq, const uint8_t* data, size_t len, uint32_t nowMs,
+                     uint32_t* offset = nullptr);
+    bool readCall(File& in, const Pending& entry, ocpp_call_t& call, uint32_t nowMs);
+    void recover(uint32_t nowMs);
+    void applyRecord(RecordKind kind, uint32_t seq, const uint8_t* data, size_t len, uint32_t offset,
+                     uint32_t nowMs);
+    void acknowledge(uint32_t seq, uint16_t txRef, uint8_t type, int32_t value);
+    void setTransaction(uint16_t txRef, int32_t transactionId);
+    void clearTransaction(uint16_t txRef);
+    bool transactionUsable(uint16_t txRef) const;
+    Pending* findPending(uint32_t seq);
+    String tempPath() const;
+};
+
+#endif // OCPP_JOURNAL_H
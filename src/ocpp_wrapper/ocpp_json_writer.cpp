@@ -0,0 +1,146 @@
+/**
+ * @file ocpp_json_writer.cpp
+ * @brief Implémentation de l'écriture JSON en flux
+ */
+
+#include "ocpp_json_writer.h"
+#include <math.h>
+
+static const uint32_t POWERS_OF_TEN[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+static const uint8_t MAX_DECIMALS = 6;
+
+OcppJsonWriter::OcppJsonWriter(char* out, size_t size)
+    : out(out), size(out ? size : 0), len(0), depth(0), hasItems(0), overflow(false) {}
+
+void OcppJsonWriter::put(char c) {
+    // Le dernier octet reste au '\0' de finish()
+    if (len + 1 < size) {
+        out[len++] = c;
+    } else {
+        overflow = true;
+    }
+}
+
+void OcppJsonWriter::putText(const char* text) {
+    while (*text) put(*text++);
+}
+
+void OcppJsonWriter::putString(const char* text) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    put('"');
+    for (const char* p = text ? text : ""; *p; ++p) {
+        uint8_t c = static_cast<uint8_t>(*p);
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put(static_cast<char>(c));
+        } else if (c < 0x20) {
+            putText("\\u00");
+            put(HEX_DIGITS[c >> 4]);
+            put(HEX_DIGITS[c & 0x0F]);
+        } else {
+            put(static_cast<char>(c));
+        }
+    }
+    put('"');
+}
+
+void OcppJsonWriter::putUnsigned(uint32_t value) {
+    char digits[10];
+    uint8_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) put(digits[--count]);
+}
+
+void OcppJsonWriter::beginValue(const char* key) {
+    uint16_t bit = static_cast<uint16_t>(1u << depth);
+    if (hasItems & bit) put(',');
+    hasItems |= bit;
+    if (key) {
+        putString(key);
+        put(':');
+    }
+}
+
+OcppJsonWriter& OcppJsonWriter::open(const char* key, char bracket) {
+    if (depth + 1 >= OCPP_JSON_MAX_DEPTH) {
+        overflow = true;
+        return *this;
+    }
+    beginValue(key);
+    put(bracket);
+    depth++;
+    hasItems &= static_cast<uint16_t>(~(1u << depth));
+    return *this;
+}
+
+OcppJsonWriter& OcppJsonWriter::close(char bracket) {
+    if (depth == 0) {
+        overflow = true;
+        return *this;
+    }
+    depth--;
+    put(bracket);
+    return *this;
+}
+
+OcppJsonWriter& OcppJsonWriter::beginObject(const char* key) { return open(key, '{'); }
+OcppJsonWriter& OcppJsonWriter::endObject() { return close('}'); }
+OcppJsonWriter& OcppJsonWriter::beginArray(const char* key) { return open(key, '['); }
+OcppJsonWriter& OcppJsonWriter::endArray() { return close(']'); }
+
+OcppJsonWriter& OcppJsonWriter::add(const char* key, const char* value) {
+    beginValue(key);
+    putString(value);
+    return *this;
+}
+
+OcppJsonWriter& OcppJsonWriter::add(const char* key, int32_t value) {
+    beginValue(key);
+    if (value < 0) put('-');
+    // -INT32_MIN déborde en int32_t, pas en uint32_t
+    putUnsigned(value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value));
+    return *this;
+}
+
+void OcppJsonWriter::putFixed(bool negative, uint64_t units, uint8_t decimals) {
+    put('"');
+    if (negative && units > 0) put('-');
+    uint64_t whole = units / POWERS_OF_TEN[decimals];
+    if (whole > UINT32_MAX) {
+        overflow = true;         // Hors de portée d'une mesure : jamais envoyé tronqué
+        whole = 0;
+    }
+    putUnsigned(static_cast<uint32_t>(whole));
+    if (decimals > 0) {
+        put('.');
+        uint32_t fraction = static_cast<uint32_t>(units % POWERS_OF_TEN[decimals]);
+        for (uint8_t i = decimals; i > 0; --i) {
+            put(static_cast<char>('0' + fraction / POWERS_OF_TEN[i - 1] % 10));
+        }
+    }
+    put('"');
+}
+
+OcppJsonWriter& OcppJsonWriter::addDecimal(const char* key, float value, uint8_t decimals) {
+    if (decimals > MAX_DECIMALS) decimals = MAX_DECIMALS;
+    beginValue(key);
+    // Entier mis à l'échelle : un arrondi, puis des divisions entières
+    double scaled = isfinite(value) ? fabs(static_cast<double>(value)) * POWERS_OF_TEN[decimals] + 0.5 : 0.0;
+    putFixed(value < 0, scaled < 1.8e19 ? static_cast<uint64_t>(scaled) : UINT64_MAX, decimals);
+    return *this;
+}
+
+OcppJsonWriter& OcppJsonWriter::addDecimal(const char* key, int32_t units, uint8_t decimals) {
+    if (decimals > MAX_DECIMALS) decimals = MAX_DECIMALS;
+    beginValue(key);
+    putFixed(units < 0, units < 0 ? 0u - static_cast<uint32_t>(units) : static_cast<uint32_t>(units), decimals);
+    return *this;
+}
+
+size_t OcppJsonWriter::finish() {
+    if (size > 0) out[len] = '\0';
+    return overflow || depth != 0 ? 0 : len;
+}
@@ -0,0 +1,68 @@
+#ifndef OCPP_JSON_WRITER_H
+#define OCPP_JSON_WRITER_H
+
+/**
+ * @file ocpp_json_writer.h
+ * @brief Écriture JSON en flux, directement dans le tampon de la trame
+ *
+ * Les charges utiles de nos CALL sont écrites champ par champ dans le tampon d'envoi de la file,
+ * sans document intermédiaire ni allocation :
+ *
+ *     OcppJsonWriter json(out, size);
+ *     json.beginObject().add("connectorId", 1).beginArray("meterValue").beginObject()
+ *         .add("timestamp", timestamp).endObject().endArray().endObject();
+ *     size_t len = json.finish();   // 0 : tampon trop petit
+ *
+ * Les nombres sont formatés en virgule fixe (addDecimal), sans printf("%f"). Un débordement n'écrit
+ * jamais au-delà de `size` : l'écriture continue à vide et finish() retourne 0.
+ */
+
+#include <Arduino.h>
+
+#define OCPP_JSON_MAX_DEPTH 8
+
+class OcppJsonWriter {
+public:
+    OcppJsonWriter(char* out, size_t size);
+
+    // `key` : nullptr pour un élément de tableau ou la racine
+    OcppJsonWriter& beginObject(const char* key = nullptr);
+    OcppJsonWriter& endObject();
+    OcppJsonWriter& beginArray(const char* key = nullptr);
+    OcppJsonWriter& endArray();
+
+    OcppJsonWriter& add(const char* key, const char* value);    // Chaîne échappée
+    OcppJsonWriter& add(const char* key, int32_t value);
+
+    // Chaîne décimale en virgule fixe ("7.4"), comme SampledValue.value ; arrondi au plus proche
+    OcppJsonWriter& addDecimal(const char* key, float value, uint8_t decimals);
+    // Idem depuis un entier déjà à l'échelle : addDecimal("value", 74, 1) -> "7.4"
+    OcppJsonWriter& addDecimal(const char* key, int32_t units, uint8_t decimals);
+
+    /**
+     * @brief Termine l'écriture (ajoute '\0' si la place le permet)
+     * @return Longueur écrite, 0 si le tampon a débordé ou si un objet/tableau n'est pas fermé
+     */
+    size_t finish();
+
+    bool overflowed() const { return overflow; }
+
+private:
+    char* out;
+    size_t size;
+    size_t len;
+    uint8_t depth;
+    uint16_t hasItems;       // Bit n : le conteneur de profondeur n a déjà un élément
+    bool overflow;
+
+    void put(char c);
+    void putText(const char* text);
+    void putString(const char* text);
+    void putUnsigned(uint32_t value);
+    void putFixed(bool negative, uint64_t units, uint8_t decimals);
+    void beginValue(const char* key);
+    OcppJsonWriter& open(const char* key, char bracket);
+    OcppJsonWriter& close(char bracket);
+};
+
+#endif // OCPP_JSON_WRITER_H
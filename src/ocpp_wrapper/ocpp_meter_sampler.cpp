@@ -0,0 +1,182 @@
+/**
+ * @file ocpp_meter_sampler.cpp
+ * @brief Implémentation de l'échantillonnage des MeterValues
+ */
+
+#include "ocpp_meter_sampler.h"
+#include <math.h>
+#include <string.h>
+
+const ocpp_measurand_info_t OCPP_MEASURANDS[OCPP_MEASURAND_COUNT] = {
+    { "Energy.Active.Import.Register", "Wh", 0, OCPP_METER_STAT_LAST },
+    { "Energy.Active.Import.Interval", "Wh", 0, OCPP_METER_STAT_SUM },
+    { "Power.Active.Import", "W", 1, OCPP_METER_STAT_MEAN },
+    { "Current.Import", "A", 1, OCPP_METER_STAT_MEAN },
+    { "Voltage", "V", 1, OCPP_METER_STAT_MEAN },
+    { "Temperature", "Celsius", 1, OCPP_METER_STAT_MEAN },
+};
+
+const char* const OCPP_READING_CONTEXTS[OCPP_READING_CONTEXT_COUNT] = { "Sample.Periodic", "Sample.Clock" };
+
+static const float DECIMAL_SCALE[] = { 1.0f, 10.0f, 100.0f, 1000.0f };
+static const float MS_PER_HOUR = 3600000.0f;
+
+OcppMeterSampler::OcppMeterSampler() : sink(nullptr), sinkCtx(nullptr) {
+    intervalsS[OCPP_READING_PERIODIC] = METER_VALUES_INTERVAL;
+    intervalsS[OCPP_READING_CLOCK] = CLOCK_ALIGNED_DATA_INTERVAL;
+    measurands[OCPP_READING_PERIODIC] = OCPP_METER_SAMPLED_DATA;
+    measurands[OCPP_READING_CLOCK] = OCPP_METER_ALIGNED_DATA;
+    memset(connectors, 0, sizeof(connectors));
+    for (Connector& connector : connectors) {
+        for (Window& window : connector.windows) resetWindow(window);
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+void OcppMeterSampler::setSink(ReadingSink readingSink, void* ctx) {
+    sink = readingSink;
+    sinkCtx = ctx;
+}
+
+void OcppMeterSampler::setIntervals(uint32_t sampleIntervalS, uint32_t clockAlignedIntervalS) {
+    const uint32_t requested[OCPP_READING_CONTEXT_COUNT] = { sampleIntervalS, clockAlignedIntervalS };
+    for (uint8_t context = 0; context < OCPP_READING_CONTEXT_COUNT; ++context) {
+        if (intervalsS[context] == requested[context]) continue;
+        intervalsS[context] = requested[context];
+        for (Connector& connector : connectors) {
+            resetWindow(connector.windows[context]);
+            connector.windows[context].open = false;
+            connector.windows[context].endUnixMs = 0;
+        }
+    }
+}
+
+void OcppMeterSampler::setMeasurands(ocpp_reading_context_t context, uint8_t mask) {
+    if (context < OCPP_READING_CONTEXT_COUNT) {
+        measurands[context] = static_cast<uint8_t>(mask & ((1u << OCPP_MEASURAND_COUNT) - 1));
+    }
+}
+
+void OcppMeterSampler::resetWindow(Window& window) {
+    for (ocpp_meter_aggregate_t& aggregate : window.values) {
+        aggregate.sum = 0.0f;
+        aggregate.min = 0.0f;
+        aggregate.max = 0.0f;
+        aggregate.last = 0.0f;
+        aggregate.count = 0;
+    }
+}
+
+bool OcppMeterSampler::addSample(uint8_t connectorId, const ocpp_meter_sample_t& sample, uint64_t unixMs) {
+    if (connectorId > MAX_CONNECTORS) return false;
+    Connector& connector = connectors[connectorId];
+    uint32_t nowMs = sample.timestampMs;
+    stats.samples++;
+
+    // Énergie depuis la mesure précédente : trapèze de la puissance, continu d'une fenêtre à l'autre
+    float energyStepWh = 0.0f;
+    if (connector.started) {
+        uint32_t elapsedMs = nowMs - connector.lastSampleMs;
+        energyStepWh = (connector.lastPowerW + sample.powerW) * 0.5f * elapsedMs / MS_PER_HOUR;
+    }
+    connector.started = true;
+    connector.lastSampleMs = nowMs;
+    connector.lastPowerW = sample.powerW;
+
+    const float values[OCPP_MEASURAND_COUNT] = {
+        sample.energyWh, energyStepWh, sample.powerW, sample.currentA, sample.voltageV, sample.temperatureC
+    };
+
+    for (uint8_t context = 0; context < OCPP_READING_CONTEXT_COUNT; ++context) {
+        uint32_t intervalS = intervalsS[context];
+        if (intervalS == 0) continue;
+        Window& window = connector.windows[context];
+        bool clock = context == OCPP_READING_CLOCK;
+        if (clock && unixMs == 0) continue;
+
+        for (uint8_t m = 0; m < OCPP_MEASURAND_COUNT; ++m) {
+            ocpp_meter_aggregate_t& aggregate = window.values[m];
+            float value = values[m];
+            if (aggregate.count == 0 || value < aggregate.min) aggregate.min = value;
+            if (aggregate.count == 0 || value > aggregate.max) aggregate.max = value;
+            aggregate.sum += value;
+            aggregate.last = value;
+            aggregate.count++;
+        }
+
+        if (!clock) {
+            // La mesure qui atteint l'intervalle ferme la fenêtre ; la suivante reste calée sur la
+            // première, sauf après un trou de plus d'un intervalle
+            uint32_t intervalMs = intervalS * 1000UL;
+            if (!window.open) {
+                window.startMs = nowMs;
+                window.open = true;
+            } else if (nowMs - window.startMs >= intervalMs) {
+                emit(connectorId, OCPP_READING_PERIODIC, window, nowMs, 0);
+                window.startMs += intervalMs;
+                if (nowMs - window.startMs >= intervalMs) window.startMs = nowMs;
+            }
+            continue;
+        }
+
+        // Frontières alignées sur minuit UTC ; recalculées si l'heure a reculé de plus d'un intervalle
+        uint64_t intervalMs = static_cast<uint64_t>(intervalS) * 1000ULL;
+        uint64_t nextBoundary = (unixMs / intervalMs + 1) * intervalMs;
+        if (window.endUnixMs == 0 || window.endUnixMs > nextBoundary) {
+            window.endUnixMs = nextBoundary;
+        } else if (unixMs >= window.endUnixMs) {
+            emit(connectorId, OCPP_READING_CLOCK, window, nowMs, window.endUnixMs);
+            window.endUnixMs = nextBoundary;
+        }
+    }
+    return true;
+}
+
+void OcppMeterSampler::emit(uint8_t connectorId, ocpp_reading_context_t context, Window& window,
+                            uint32_t timestampMs, uint64_t unixMs) {
+    ocpp_meter_reading_t reading;
+    memset(&reading, 0, sizeof(reading));
+    reading.connectorId = connectorId;
+    reading.context = static_cast<uint8_t>(context);
+    reading.timestampMs = timestampMs;
+    reading.unixMs = unixMs;
+    for (uint8_t m = 0; m < OCPP_MEASURAND_COUNT; ++m) {
+        const ocpp_meter_aggregate_t& aggregate = window.values[m];
+        if (!(measurands[context] & OCPP_MEASURAND_BIT(m)) || aggregate.count == 0) continue;
+        const ocpp_measurand_info_t& info = OCPP_MEASURANDS[m];
+        float value = aggregate.last;
+        if (info.stat == OCPP_METER_STAT_MEAN) value = aggregate.sum / aggregate.count;
+        if (info.stat == OCPP_METER_STAT_SUM) value = aggregate.sum;
+        reading.values[m] = static_cast<int32_t>(lroundf(value * DECIMAL_SCALE[info.decimals]));
+        reading.measurands |= static_cast<uint8_t>(OCPP_MEASURAND_BIT(m));
+    }
+    // Fenêtre suivante vide
+    resetWindow(window);
+    if (reading.measurands == 0) return;
+    stats.readings[context]++;
+    if (sink) sink(sinkCtx, reading);
+}
+
+const ocpp_meter_aggregate_t* OcppMeterSampler::getAggregate(uint8_t connectorId, ocpp_reading_context_t context,
+                                                             ocpp_measurand_t measurand) const {
+    if (connectorId > MAX_CONNECTORS || context >= OCPP_READING_CONTEXT_COUNT || measurand >= OCPP_MEASURAND_COUNT) {
+        return nullptr;
+    }
+    return &connectors[connectorId].windows[context].values[measurand];
+}
+
+uint8_t OcppMeterSampler::parseMeasurands(const char* list) {
+    uint8_t mask = 0;
+    const char* p = list ? list : "";
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        size_t len = strcspn(p, ", ");
+        for (uint8_t m = 0; m < OCPP_MEASURAND_COUNT && len > 0; ++m) {
+            if (strlen(OCPP_MEASURANDS[m].name) == len && strncmp(OCPP_MEASURANDS[m].name, p, len) == 0) {
+                mask |= static_cast<uint8_t>(OCPP_MEASURAND_BIT(m));
+            }
+        }
+        p += len;
+    }
+    return mask;
+}
@@ -0,0 +1,188 @@
+#ifndef OCPP_METER_SAMPLER_H
+#define OCPP_METER_SAMPLER_H
+
+/**
+ * @file ocpp_meter_sampler.h
+ * @brief Échantillonnage des MeterValues : agrégats par connecteur, relevés périodiques et alignés
+ *
+ * Chaque mesure (toutes les MEASUREMENT_INTERVAL ms) met à jour, par connecteur et par grandeur,
+ * des agrégats glissants (somme, min, max, dernière valeur) ; l'énergie de l'intervalle est
+ * l'intégrale de la puissance (trapèzes entre deux mesures). Mémoire fixe : O(1) par grandeur.
+ *
+ * Deux fenêtres indépendantes par connecteur :
+ * - Sample.Periodic : un relevé toutes les MeterValueSampleInterval secondes (uptime) ;
+ * - Sample.Clock : un relevé à chaque multiple de ClockAlignedDataInterval secondes depuis minuit
+ *   UTC (heure du serveur) ; rien tant que l'heure n'est pas connue.
+ * Un intervalle à 0 désactive la fenêtre. Un relevé regroupe toutes les grandeurs configurées
+ * (MeterValuesSampledData / MeterValuesAlignedData) : un seul MeterValues par intervalle, au lieu
+ * d'un message par mesure.
+ *
+ * Valeurs des relevés en virgule fixe (OCPP_MEASURANDS[m].decimals) : aucun formatage flottant
+ * à l'envoi. Mono-tâche : tous les appels viennent de la tâche OCPP.
+ */
+
+#include <Arduino.h>
+#include "ocpp_config.h"
+
+/**
+ * @brief Grandeurs relevées (Measurand OCPP 1.6)
+ */
+typedef enum {
+    OCPP_MEASURAND_ENERGY_REGISTER = 0,   // Energy.Active.Import.Register : index (Wh)
+    OCPP_MEASURAND_ENERGY_INTERVAL,       // Energy.Active.Import.Interval : intégrale de la puissance (Wh)
+    OCPP_MEASURAND_POWER,                 // Power.Active.Import : moyenne (W)
+    OCPP_MEASURAND_CURRENT,               // Current.Import : moyenne, toutes phases (A)
+    OCPP_MEASURAND_VOLTAGE,               // Voltage : moyenne (V)
+    OCPP_MEASURAND_TEMPERATURE,           // Temperature : moyenne (Celsius)
+    OCPP_MEASURAND_COUNT
+} ocpp_measurand_t;
+
+#define OCPP_MEASURAND_BIT(m) (1u << (m))
+
+#ifndef OCPP_METER_SAMPLED_DATA
+#define OCPP_METER_SAMPLED_DATA (OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_REGISTER) | \
+                                 OCPP_MEASURAND_BIT(OCPP_MEASURAND_POWER) | \
+                                 OCPP_MEASURAND_BIT(OCPP_MEASURAND_CURRENT) | \
+                                 OCPP_MEASURAND_BIT(OCPP_MEASURAND_VOLTAGE))
+#endif
+#ifndef OCPP_METER_ALIGNED_DATA
+#define OCPP_METER_ALIGNED_DATA (OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_REGISTER) | \
+                                 OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_INTERVAL))
+#endif
+
+/**
+ * @brief Contexte d'un relevé (ReadingContext OCPP 1.6)
+ */
+typedef enum {
+    OCPP_READING_PERIODIC = 0,            // Sample.Periodic
+    OCPP_READING_CLOCK,                   // Sample.Clock
+    OCPP_READING_CONTEXT_COUNT
+} ocpp_reading_context_t;
+
+/**
+ * @brief Valeur d'une fenêtre retenue dans le relevé
+ */
+typedef enum {
+    OCPP_METER_STAT_LAST = 0,
+    OCPP_METER_STAT_MEAN,
+    OCPP_METER_STAT_SUM
+} ocpp_meter_stat_t;
+
+typedef struct {
+    const char* name;                     // Measurand OCPP
+    const char* unit;                     // UnitOfMeasure OCPP
+    uint8_t decimals;                     // Virgule fixe des relevés
+    ocpp_meter_stat_t stat;
+} ocpp_measurand_info_t;
+
+extern const ocpp_measurand_info_t OCPP_MEASURANDS[OCPP_MEASURAND_COUNT];
+extern const char* const OCPP_READING_CONTEXTS[OCPP_READING_CONTEXT_COUNT];
+
+/**
+ * @brief Mesure d'un connecteur (unités des relevés)
+ */
+typedef struct {
+    uint32_t timestampMs;                 // Uptime de la mesure
+    float energyWh;                       // Index du compteur
+    float powerW;
+    float currentA;
+    float voltageV;
+    float temperatureC;
+} ocpp_meter_sample_t;
+
+/**
+ * @brief Agrégats glissants d'une grandeur sur la fenêtre en cours
+ */
+typedef struct {
+    float sum;
+    float min;
+    float max;
+    float last;
+    uint32_t count;
+} ocpp_meter_aggregate_t;
+
+/**
+ * @brief Relevé émis en fin de fenêtre : la charge utile d'un MeterValues
+ */
+typedef struct {
+    uint8_t connectorId;
+    uint8_t context;                      // ocpp_reading_context_t
+    uint8_t measurands;                   // Bit m : values[m] renseignée
+    uint32_t timestampMs;                 // Uptime de la mesure qui a fermé la fenêtre
+    uint64_t unixMs;                      // Sample.Clock : frontière alignée ; 0 : dériver de timestampMs
+    int32_t values[OCPP_MEASURAND_COUNT]; // Virgule fixe, OCPP_MEASURANDS[m].decimals
+} ocpp_meter_reading_t;
+
+/**
+ * @brief Compteurs de l'échantillonnage
+ */
+typedef struct {
+    uint32_t samples;
+    uint32_t readings[OCPP_READING_CONTEXT_COUNT];
+} ocpp_meter_sampler_stats_t;
+
+class OcppMeterSampler {
+public:
+    typedef void (*ReadingSink)(void* ctx, const ocpp_meter_reading_t& reading);
+
+    OcppMeterSampler();
+
+    void setSink(ReadingSink sink, void* ctx);
+
+    /**
+     * @brief Intervalles en secondes (0 : fenêtre désactivée) ; une fenêtre modifiée repart de zéro
+     */
+    void setIntervals(uint32_t sampleIntervalS, uint32_t clockAlignedIntervalS);
+
+    // Grandeurs d'un contexte : masque de OCPP_MEASURAND_BIT()
+    void setMeasurands(ocpp_reading_context_t context, uint8_t mask);
+    uint8_t getMeasurands(ocpp_reading_context_t context) const { return measurands[context]; }
+
+    /**
+     * @brief Ajoute une mesure ; émet les relevés des fenêtres qu'elle ferme
+     * @param unixMs Heure de la mesure si connue (0 : pas de relevé aligné)
+     * @return false si le connecteur est invalide
+     */
+    bool addSample(uint8_t connectorId, const ocpp_meter_sample_t& sample, uint64_t unixMs);
+
+    // Agrégats de la fenêtre en cours (nullptr si hors bornes)
+    const ocpp_meter_aggregate_t* getAggregate(uint8_t connectorId, ocpp_reading_context_t context,
+                                               ocpp_measurand_t measurand) const;
+
+    ocpp_meter_sampler_stats_t getStats() const { return stats; }
+
+    /**
+     * @brief Masque des grandeurs d'une liste OCPP ("Energy.Active.Import.Register,Power.Active.Import")
+     *
+     * Les grandeurs non relevées par le boîtier sont ignorées.
+     */
+    static uint8_t parseMeasurands(const char* list);
+
+private:
+    struct Window {
+        ocpp_meter_aggregate_t values[OCPP_MEASURAND_COUNT];
+        uint32_t startMs;          // Sample.Periodic : début de la fenêtre
+        uint64_t endUnixMs;        // Sample.Clock : prochaine frontière (0 : à calculer)
+        bool open;
+    };
+
+    struct Connector {
+        Window windows[OCPP_READING_CONTEXT_COUNT];
+        uint32_t lastSampleMs;
+        float lastPowerW;
+        bool started;
+    };
+
+    ReadingSink sink;
+    void* sinkCtx;
+    uint32_t intervalsS[OCPP_READING_CONTEXT_COUNT];
+    uint8_t measurands[OCPP_READING_CONTEXT_COUNT];
+    Connector connectors[MAX_CONNECTORS + 1];
+    ocpp_meter_sampler_stats_t stats;
+
+    static void resetWindow(Window& window);
+    void emit(uint8_t connectorId, ocpp_reading_context_t context, Window& window, uint32_t timestampMs,
+              uint64_t unixMs);
+};
+
+#endif // OCPP_METER_SAMPLER_H
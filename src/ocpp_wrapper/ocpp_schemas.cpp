@@ -0,0 +1,342 @@
+/**
+ * @file ocpp_schemas.cpp
+ * @brief Tables de validation des charges utiles OCPP 1.6
+ *
+ * GÉNÉRÉ par scripts/gen_ocpp_schemas.py depuis schemas/json : ne pas modifier à la main.
+ */
+
+#include "ocpp_validator.h"
+
+const char* const OCPP_SCHEMA_ENUMS[174] = {
+    /*   0 */ "Accepted", "Blocked", "Expired", "Invalid", "ConcurrentTx",
+    /*   5 */ "Accepted", "Pending", "Rejected",
+    /*   8 */ "Accepted", "Rejected",
+    /*  10 */ "Inoperative", "Operative",
+    /*  12 */ "Accepted", "Rejected", "Scheduled",
+    /*  15 */ "Accepted", "Rejected", "RebootRequired", "NotSupported",
+    /*  19 */ "ChargePointMaxProfile", "TxDefaultProfile", "TxProfile",
+    /*  22 */ "Accepted", "Unknown",
+    /*  24 */ "Accepted", "Rejected", "UnknownMessageId", "UnknownVendorId",
+    /*  28 */ "Idle", "Uploaded", "UploadFailed", "Uploading",
+    /*  32 */ "Downloaded", "DownloadFailed", "Downloading", "Idle", "InstallationFailed", "Installing",
+              "Installed",
+    /*  39 */ "A", "W",
+    /*  41 */ "Interruption.Begin", "Interruption.End", "Sample.Clock", "Sample.Periodic",
+              "Transaction.Begin", "Transaction.End", "Trigger", "Other",
+    /*  49 */ "Raw", "SignedData",
+    /*  51 */ "Energy.Active.Export.Register", "Energy.Active.Import.Register",
+              "Energy.Reactive.Export.Register", "Energy.Reactive.Import.Register",
+              "Energy.Active.Export.Interval", "Energy.Active.Import.Interval",
+              "Energy.Reactive.Export.Interval", "Energy.Reactive.Import.Interval", "Power.Active.Export",
+              "Power.Active.Import", "Power.Offered", "Power.Reactive.Export", "Power.Reactive.Import",
+              "Power.Factor", "Current.Import", "Current.Export", "Current.Offered", "Voltage", "Frequency",
+              "Temperature", "SoC", "RPM",
+    /*  73 */ "L1", "L2", "L3", "N", "L1-N", "L2-N", "L3-N", "L1-L2", "L2-L3", "L3-L1",
+    /*  83 */ "Cable", "EV", "Inlet", "Outlet", "Body",
+    /*  88 */ "Wh", "kWh", "varh", "kvarh", "W", "kW", "VA", "kVA", "var", "kvar", "A", "V", "K", "Celcius",
+              "Celsius", "Fahrenheit", "Percent",
+    /* 105 */ "Absolute", "Recurring", "Relative",
+    /* 108 */ "Daily", "Weekly",
+    /* 110 */ "Accepted", "Faulted", "Occupied", "Rejected", "Unavailable",
+    /* 115 */ "Hard", "Soft",
+    /* 117 */ "Differential", "Full",
+    /* 119 */ "Accepted", "Failed", "NotSupported", "VersionMismatch",
+    /* 123 */ "Accepted", "Rejected", "NotSupported",
+    /* 126 */ "ConnectorLockFailure", "EVCommunicationError", "GroundFailure", "HighTemperature",
+              "InternalError", "LocalListConflict", "NoError", "OtherError", "OverCurrentFailure",
+              "PowerMeterFailure", "PowerSwitchFailure", "ReaderFailure", "ResetFailure", "UnderVoltage",
+              "OverVoltage", "WeakSignal",
+    /* 142 */ "Available", "Preparing", "Charging", "SuspendedEVSE", "SuspendedEV", "Finishing", "Reserved",
+              "Unavailable", "Faulted",
+    /* 151 */ "EmergencyStop", "EVDisconnected", "HardReset", "Local", "Other", "PowerLoss", "Reboot",
+              "Remote", "SoftReset", "UnlockCommand", "DeAuthorized",
+    /* 162 */ "BootNotification", "DiagnosticsStatusNotification", "FirmwareStatusNotification", "Heartbeat",
+              "MeterValues", "StatusNotification",
+    /* 168 */ "Accepted", "Rejected", "NotImplemented",
+    /* 171 */ "Unlocked", "UnlockFailed", "NotSupported",
+};
+
+const ocpp_schema_node_t OCPP_SCHEMA_NODES[251] = {
+    /*   0 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 1, 1 },   // Authorize
+    /*   1 */ { "idTag", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 20, 0, 0 },   // Authorize.idTag
+    /*   2 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 3, 1 },   // AuthorizeResponse
+    /*   3 */ { "idTagInfo", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_CLOSED, 0, 4, 3 },   // AuthorizeResponse.idTagInfo
+    /*   4 */ { "expiryDate", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // AuthorizeResponse.idTagInfo.expiryDate
+    /*   5 */ { "parentIdTag", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // AuthorizeResponse.idTagInfo.parentIdTag
+    /*   6 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 0, 5 },   // AuthorizeResponse.idTagInfo.status
+    /*   7 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 8, 9 },   // BootNotification
+    /*   8 */ { "chargePointVendor", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 20, 0, 0 },   // BootNotification.chargePointVendor
+    /*   9 */ { "chargePointModel", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 20, 0, 0 },   // BootNotification.chargePointModel
+    /*  10 */ { "chargePointSerialNumber", OCPP_SCHEMA_STRING, 0, 25, 0, 0 },   // BootNotification.chargePointSerialNumber
+    /*  11 */ { "chargeBoxSerialNumber", OCPP_SCHEMA_STRING, 0, 25, 0, 0 },   // BootNotification.chargeBoxSerialNumber
+    /*  12 */ { "firmwareVersion", OCPP_SCHEMA_STRING, 0, 50, 0, 0 },   // BootNotification.firmwareVersion
+    /*  13 */ { "iccid", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // BootNotification.iccid
+    /*  14 */ { "imsi", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // BootNotification.imsi
+    /*  15 */ { "meterType", OCPP_SCHEMA_STRING, 0, 25, 0, 0 },   // BootNotification.meterType
+    /*  16 */ { "meterSerialNumber", OCPP_SCHEMA_STRING, 0, 25, 0, 0 },   // BootNotification.meterSerialNumber
+    /*  17 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 18, 3 },   // BootNotificationResponse
+    /*  18 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 5, 3 },   // BootNotificationResponse.status
+    /*  19 */ { "currentTime", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // BootNotificationResponse.currentTime
+    /*  20 */ { "interval", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // BootNotificationResponse.interval
+    /*  21 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 22, 1 },   // CancelReservation
+    /*  22 */ { "reservationId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // CancelReservation.reservationId
+    /*  23 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 24, 1 },   // CancelReservationResponse
+    /*  24 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 8, 2 },   // CancelReservationResponse.status
+    /*  25 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 26, 2 },   // ChangeAvailability
+    /*  26 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // ChangeAvailability.connectorId
+    /*  27 */ { "type", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 10, 2 },   // ChangeAvailability.type
+    /*  28 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 29, 1 },   // ChangeAvailabilityResponse
+    /*  29 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 12, 3 },   // ChangeAvailabilityResponse.status
+    /*  30 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 31, 2 },   // ChangeConfiguration
+    /*  31 */ { "key", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 50, 0, 0 },   // ChangeConfiguration.key
+    /*  32 */ { "value", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 500, 0, 0 },   // ChangeConfiguration.value
+    /*  33 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 34, 1 },   // ChangeConfigurationResponse
+    /*  34 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 15, 4 },   // ChangeConfigurationResponse.status
+    /*  35 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 36, 0 },   // ClearCache
+    /*  36 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 37, 1 },   // ClearCacheResponse
+    /*  37 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 8, 2 },   // ClearCacheResponse.status
+    /*  38 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 39, 4 },   // ClearChargingProfile
+    /*  39 */ { "id", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // ClearChargingProfile.id
+    /*  40 */ { "connectorId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // ClearChargingProfile.connectorId
+    /*  41 */ { "chargingProfilePurpose", OCPP_SCHEMA_STRING, 0, 0, 19, 3 },   // ClearChargingProfile.chargingProfilePurpose
+    /*  42 */ { "stackLevel", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // ClearChargingProfile.stackLevel
+    /*  43 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 44, 1 },   // ClearChargingProfileResponse
+    /*  44 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 22, 2 },   // ClearChargingProfileResponse.status
+    /*  45 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 46, 3 },   // DataTransfer
+    /*  46 */ { "vendorId", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 255, 0, 0 },   // DataTransfer.vendorId
+    /*  47 */ { "messageId", OCPP_SCHEMA_STRING, 0, 50, 0, 0 },   // DataTransfer.messageId
+    /*  48 */ { "data", OCPP_SCHEMA_STRING, 0, 0, 0, 0 },   // DataTransfer.data
+    /*  49 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 50, 2 },   // DataTransferResponse
+    /*  50 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 24, 4 },   // DataTransferResponse.status
+    /*  51 */ { "data", OCPP_SCHEMA_STRING, 0, 0, 0, 0 },   // DataTransferResponse.data
+    /*  52 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 53, 1 },   // DiagnosticsStatusNotification
+    /*  53 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 28, 4 },   // DiagnosticsStatusNotification.status
+    /*  54 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 55, 0 },   // DiagnosticsStatusNotificationResponse
+    /*  55 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 56, 1 },   // FirmwareStatusNotification
+    /*  56 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 32, 7 },   // FirmwareStatusNotification.status
+    /*  57 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 58, 0 },   // FirmwareStatusNotificationResponse
+    /*  58 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 59, 3 },   // GetCompositeSchedule
+    /*  59 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // GetCompositeSchedule.connectorId
+    /*  60 */ { "duration", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // GetCompositeSchedule.duration
+    /*  61 */ { "chargingRateUnit", OCPP_SCHEMA_STRING, 0, 0, 39, 2 },   // GetCompositeSchedule.chargingRateUnit
+    /*  62 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 63, 4 },   // GetCompositeScheduleResponse
+    /*  63 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 8, 2 },   // GetCompositeScheduleResponse.status
+    /*  64 */ { "connectorId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // GetCompositeScheduleResponse.connectorId
+    /*  65 */ { "scheduleStart", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // GetCompositeScheduleResponse.scheduleStart
+    /*  66 */ { "chargingSchedule", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 67, 5 },   // GetCompositeScheduleResponse.chargingSchedule
+    /*  67 */ { "duration", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // GetCompositeScheduleResponse.chargingSchedule.duration
+    /*  68 */ { "startSchedule", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // GetCompositeScheduleResponse.chargingSchedule.startSchedule
+    /*  69 */ { "chargingRateUnit", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 39, 2 },   // GetCompositeScheduleResponse.chargingSchedule.chargingRateUnit
+    /*  70 */ { "chargingSchedulePeriod", OCPP_SCHEMA_ARRAY, OCPP_SCHEMA_REQUIRED, 0, 72, 1 },   // GetCompositeScheduleResponse.chargingSchedule.chargingSchedulePeriod
+    /*  71 */ { "minChargingRate", OCPP_SCHEMA_NUMBER, OCPP_SCHEMA_DECIMAL, 0, 0, 0 },   // GetCompositeScheduleResponse.chargingSchedule.minChargingRate
+    /*  72 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 73, 3 },   // GetCompositeScheduleResponse.chargingSchedule.chargingSchedulePeriod[]
+    /*  73 */ { "startPeriod", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // GetCompositeScheduleResponse.chargingSchedule.chargingSchedulePeriod[].startPeriod
+    /*  74 */ { "limit", OCPP_SCHEMA_NUMBER, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DECIMAL, 0, 0, 0 },   // GetCompositeScheduleResponse.chargingSchedule.chargingSchedulePeriod[].limit
+    /*  75 */ { "numberPhases", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // GetCompositeScheduleResponse.chargingSchedule.chargingSchedulePeriod[].numberPhases
+    /*  76 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 77, 1 },   // GetConfiguration
+    /*  77 */ { "key", OCPP_SCHEMA_ARRAY, 0, 0, 78, 1 },   // GetConfiguration.key
+    /*  78 */ { nullptr, OCPP_SCHEMA_STRING, 0, 50, 0, 0 },   // GetConfiguration.key[]
+    /*  79 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 80, 2 },   // GetConfigurationResponse
+    /*  80 */ { "configurationKey", OCPP_SCHEMA_ARRAY, 0, 0, 82, 1 },   // GetConfigurationResponse.configurationKey
+    /*  81 */ { "unknownKey", OCPP_SCHEMA_ARRAY, 0, 0, 86, 1 },   // GetConfigurationResponse.unknownKey
+    /*  82 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 83, 3 },   // GetConfigurationResponse.configurationKey[]
+    /*  83 */ { "key", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 50, 0, 0 },   // GetConfigurationResponse.configurationKey[].key
+    /*  84 */ { "readonly", OCPP_SCHEMA_BOOLEAN, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // GetConfigurationResponse.configurationKey[].readonly
+    /*  85 */ { "value", OCPP_SCHEMA_STRING, 0, 500, 0, 0 },   // GetConfigurationResponse.configurationKey[].value
+    /*  86 */ { nullptr, OCPP_SCHEMA_STRING, 0, 50, 0, 0 },   // GetConfigurationResponse.unknownKey[]
+    /*  87 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 88, 5 },   // GetDiagnostics
+    /*  88 */ { "location", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_URI, 0, 0, 0 },   // GetDiagnostics.location
+    /*  89 */ { "retries", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // GetDiagnostics.retries
+    /*  90 */ { "retryInterval", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // GetDiagnostics.retryInterval
+    /*  91 */ { "startTime", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // GetDiagnostics.startTime
+    /*  92 */ { "stopTime", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // GetDiagnostics.stopTime
+    /*  93 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 94, 1 },   // GetDiagnosticsResponse
+    /*  94 */ { "fileName", OCPP_SCHEMA_STRING, 0, 255, 0, 0 },   // GetDiagnosticsResponse.fileName
+    /*  95 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 96, 0 },   // GetLocalListVersion
+    /*  96 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 97, 1 },   // GetLocalListVersionResponse
+    /*  97 */ { "listVersion", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // GetLocalListVersionResponse.listVersion
+    /*  98 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 99, 0 },   // Heartbeat
+    /*  99 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 100, 1 },   // HeartbeatResponse
+    /* 100 */ { "currentTime", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // HeartbeatResponse.currentTime
+    /* 101 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 102, 3 },   // MeterValues
+    /* 102 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // MeterValues.connectorId
+    /* 103 */ { "transactionId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // MeterValues.transactionId
+    /* 104 */ { "meterValue", OCPP_SCHEMA_ARRAY, OCPP_SCHEMA_REQUIRED, 0, 105, 1 },   // MeterValues.meterValue
+    /* 105 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 106, 2 },   // MeterValues.meterValue[]
+    /* 106 */ { "timestamp", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // MeterValues.meterValue[].timestamp
+    /* 107 */ { "sampledValue", OCPP_SCHEMA_ARRAY, OCPP_SCHEMA_REQUIRED, 0, 108, 1 },   // MeterValues.meterValue[].sampledValue
+    /* 108 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 109, 7 },   // MeterValues.meterValue[].sampledValue[]
+    /* 109 */ { "value", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // MeterValues.meterValue[].sampledValue[].value
+    /* 110 */ { "context", OCPP_SCHEMA_STRING, 0, 0, 41, 8 },   // MeterValues.meterValue[].sampledValue[].context
+    /* 111 */ { "format", OCPP_SCHEMA_STRING, 0, 0, 49, 2 },   // MeterValues.meterValue[].sampledValue[].format
+    /* 112 */ { "measurand", OCPP_SCHEMA_STRING, 0, 0, 51, 22 },   // MeterValues.meterValue[].sampledValue[].measurand
+    /* 113 */ { "phase", OCPP_SCHEMA_STRING, 0, 0, 73, 10 },   // MeterValues.meterValue[].sampledValue[].phase
+    /* 114 */ { "location", OCPP_SCHEMA_STRING, 0, 0, 83, 5 },   // MeterValues.meterValue[].sampledValue[].location
+    /* 115 */ { "unit", OCPP_SCHEMA_STRING, 0, 0, 88, 17 },   // MeterValues.meterValue[].sampledValue[].unit
+    /* 116 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 117, 0 },   // MeterValuesResponse
+    /* 117 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 118, 3 },   // RemoteStartTransaction
+    /* 118 */ { "connectorId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // RemoteStartTransaction.connectorId
+    /* 119 */ { "idTag", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 20, 0, 0 },   // RemoteStartTransaction.idTag
+    /* 120 */ { "chargingProfile", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 121, 9 },   // RemoteStartTransaction.chargingProfile
+    /* 121 */ { "chargingProfileId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.chargingProfileId
+    /* 122 */ { "transactionId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.transactionId
+    /* 123 */ { "stackLevel", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.stackLevel
+    /* 124 */ { "chargingProfilePurpose", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 19, 3 },   // RemoteStartTransaction.chargingProfile.chargingProfilePurpose
+    /* 125 */ { "chargingProfileKind", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 105, 3 },   // RemoteStartTransaction.chargingProfile.chargingProfileKind
+    /* 126 */ { "recurrencyKind", OCPP_SCHEMA_STRING, 0, 0, 108, 2 },   // RemoteStartTransaction.chargingProfile.recurrencyKind
+    /* 127 */ { "validFrom", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.validFrom
+    /* 128 */ { "validTo", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.validTo
+    /* 129 */ { "chargingSchedule", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_CLOSED, 0, 130, 5 },   // RemoteStartTransaction.chargingProfile.chargingSchedule
+    /* 130 */ { "duration", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.duration
+    /* 131 */ { "startSchedule", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.startSchedule
+    /* 132 */ { "chargingRateUnit", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 39, 2 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.chargingRateUnit
+    /* 133 */ { "chargingSchedulePeriod", OCPP_SCHEMA_ARRAY, OCPP_SCHEMA_REQUIRED, 0, 135, 1 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.chargingSchedulePeriod
+    /* 134 */ { "minChargingRate", OCPP_SCHEMA_NUMBER, OCPP_SCHEMA_DECIMAL, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.minChargingRate
+    /* 135 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 136, 3 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.chargingSchedulePeriod[]
+    /* 136 */ { "startPeriod", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.chargingSchedulePeriod[].startPeriod
+    /* 137 */ { "limit", OCPP_SCHEMA_NUMBER, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DECIMAL, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.chargingSchedulePeriod[].limit
+    /* 138 */ { "numberPhases", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // RemoteStartTransaction.chargingProfile.chargingSchedule.chargingSchedulePeriod[].numberPhases
+    /* 139 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 140, 1 },   // RemoteStartTransactionResponse
+    /* 140 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 8, 2 },   // RemoteStartTransactionResponse.status
+    /* 141 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 142, 1 },   // RemoteStopTransaction
+    /* 142 */ { "transactionId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // RemoteStopTransaction.transactionId
+    /* 143 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 144, 1 },   // RemoteStopTransactionResponse
+    /* 144 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 8, 2 },   // RemoteStopTransactionResponse.status
+    /* 145 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 146, 5 },   // ReserveNow
+    /* 146 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // ReserveNow.connectorId
+    /* 147 */ { "expiryDate", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // ReserveNow.expiryDate
+    /* 148 */ { "idTag", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 20, 0, 0 },   // ReserveNow.idTag
+    /* 149 */ { "parentIdTag", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // ReserveNow.parentIdTag
+    /* 150 */ { "reservationId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // ReserveNow.reservationId
+    /* 151 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 152, 1 },   // ReserveNowResponse
+    /* 152 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 110, 5 },   // ReserveNowResponse.status
+    /* 153 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 154, 1 },   // Reset
+    /* 154 */ { "type", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 115, 2 },   // Reset.type
+    /* 155 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 156, 1 },   // ResetResponse
+    /* 156 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 8, 2 },   // ResetResponse.status
+    /* 157 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 158, 3 },   // SendLocalList
+    /* 158 */ { "listVersion", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // SendLocalList.listVersion
+    /* 159 */ { "localAuthorizationList", OCPP_SCHEMA_ARRAY, 0, 0, 161, 1 },   // SendLocalList.localAuthorizationList
+    /* 160 */ { "updateType", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 117, 2 },   // SendLocalList.updateType
+    /* 161 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 162, 2 },   // SendLocalList.localAuthorizationList[]
+    /* 162 */ { "idTag", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 20, 0, 0 },   // SendLocalList.localAuthorizationList[].idTag
+    /* 163 */ { "idTagInfo", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 164, 3 },   // SendLocalList.localAuthorizationList[].idTagInfo
+    /* 164 */ { "expiryDate", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // SendLocalList.localAuthorizationList[].idTagInfo.expiryDate
+    /* 165 */ { "parentIdTag", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // SendLocalList.localAuthorizationList[].idTagInfo.parentIdTag
+    /* 166 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 0, 5 },   // SendLocalList.localAuthorizationList[].idTagInfo.status
+    /* 167 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 168, 1 },   // SendLocalListResponse
+    /* 168 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 119, 4 },   // SendLocalListResponse.status
+    /* 169 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 170, 2 },   // SetChargingProfile
+    /* 170 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // SetChargingProfile.connectorId
+    /* 171 */ { "csChargingProfiles", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_CLOSED, 0, 172, 9 },   // SetChargingProfile.csChargingProfiles
+    /* 172 */ { "chargingProfileId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.chargingProfileId
+    /* 173 */ { "transactionId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.transactionId
+    /* 174 */ { "stackLevel", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.stackLevel
+    /* 175 */ { "chargingProfilePurpose", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 19, 3 },   // SetChargingProfile.csChargingProfiles.chargingProfilePurpose
+    /* 176 */ { "chargingProfileKind", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 105, 3 },   // SetChargingProfile.csChargingProfiles.chargingProfileKind
+    /* 177 */ { "recurrencyKind", OCPP_SCHEMA_STRING, 0, 0, 108, 2 },   // SetChargingProfile.csChargingProfiles.recurrencyKind
+    /* 178 */ { "validFrom", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.validFrom
+    /* 179 */ { "validTo", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.validTo
+    /* 180 */ { "chargingSchedule", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_CLOSED, 0, 181, 5 },   // SetChargingProfile.csChargingProfiles.chargingSchedule
+    /* 181 */ { "duration", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.duration
+    /* 182 */ { "startSchedule", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.startSchedule
+    /* 183 */ { "chargingRateUnit", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 39, 2 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.chargingRateUnit
+    /* 184 */ { "chargingSchedulePeriod", OCPP_SCHEMA_ARRAY, OCPP_SCHEMA_REQUIRED, 0, 186, 1 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.chargingSchedulePeriod
+    /* 185 */ { "minChargingRate", OCPP_SCHEMA_NUMBER, OCPP_SCHEMA_DECIMAL, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.minChargingRate
+    /* 186 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 187, 3 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.chargingSchedulePeriod[]
+    /* 187 */ { "startPeriod", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.chargingSchedulePeriod[].startPeriod
+    /* 188 */ { "limit", OCPP_SCHEMA_NUMBER, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DECIMAL, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.chargingSchedulePeriod[].limit
+    /* 189 */ { "numberPhases", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // SetChargingProfile.csChargingProfiles.chargingSchedule.chargingSchedulePeriod[].numberPhases
+    /* 190 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 191, 1 },   // SetChargingProfileResponse
+    /* 191 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 123, 3 },   // SetChargingProfileResponse.status
+    /* 192 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 193, 5 },   // StartTransaction
+    /* 193 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // StartTransaction.connectorId
+    /* 194 */ { "idTag", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 20, 0, 0 },   // StartTransaction.idTag
+    /* 195 */ { "meterStart", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // StartTransaction.meterStart
+    /* 196 */ { "reservationId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // StartTransaction.reservationId
+    /* 197 */ { "timestamp", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // StartTransaction.timestamp
+    /* 198 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 199, 2 },   // StartTransactionResponse
+    /* 199 */ { "idTagInfo", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_CLOSED, 0, 201, 3 },   // StartTransactionResponse.idTagInfo
+    /* 200 */ { "transactionId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // StartTransactionResponse.transactionId
+    /* 201 */ { "expiryDate", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // StartTransactionResponse.idTagInfo.expiryDate
+    /* 202 */ { "parentIdTag", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // StartTransactionResponse.idTagInfo.parentIdTag
+    /* 203 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 0, 5 },   // StartTransactionResponse.idTagInfo.status
+    /* 204 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 205, 7 },   // StatusNotification
+    /* 205 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // StatusNotification.connectorId
+    /* 206 */ { "errorCode", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 126, 16 },   // StatusNotification.errorCode
+    /* 207 */ { "info", OCPP_SCHEMA_STRING, 0, 50, 0, 0 },   // StatusNotification.info
+    /* 208 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 142, 9 },   // StatusNotification.status
+    /* 209 */ { "timestamp", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // StatusNotification.timestamp
+    /* 210 */ { "vendorId", OCPP_SCHEMA_STRING, 0, 255, 0, 0 },   // StatusNotification.vendorId
+    /* 211 */ { "vendorErrorCode", OCPP_SCHEMA_STRING, 0, 50, 0, 0 },   // StatusNotification.vendorErrorCode
+    /* 212 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 213, 0 },   // StatusNotificationResponse
+    /* 213 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 214, 6 },   // StopTransaction
+    /* 214 */ { "idTag", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // StopTransaction.idTag
+    /* 215 */ { "meterStop", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // StopTransaction.meterStop
+    /* 216 */ { "timestamp", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // StopTransaction.timestamp
+    /* 217 */ { "transactionId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // StopTransaction.transactionId
+    /* 218 */ { "reason", OCPP_SCHEMA_STRING, 0, 0, 151, 11 },   // StopTransaction.reason
+    /* 219 */ { "transactionData", OCPP_SCHEMA_ARRAY, 0, 0, 220, 1 },   // StopTransaction.transactionData
+    /* 220 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 221, 2 },   // StopTransaction.transactionData[]
+    /* 221 */ { "timestamp", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // StopTransaction.transactionData[].timestamp
+    /* 222 */ { "sampledValue", OCPP_SCHEMA_ARRAY, OCPP_SCHEMA_REQUIRED, 0, 223, 1 },   // StopTransaction.transactionData[].sampledValue
+    /* 223 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 224, 7 },   // StopTransaction.transactionData[].sampledValue[]
+    /* 224 */ { "value", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // StopTransaction.transactionData[].sampledValue[].value
+    /* 225 */ { "context", OCPP_SCHEMA_STRING, 0, 0, 41, 8 },   // StopTransaction.transactionData[].sampledValue[].context
+    /* 226 */ { "format", OCPP_SCHEMA_STRING, 0, 0, 49, 2 },   // StopTransaction.transactionData[].sampledValue[].format
+    /* 227 */ { "measurand", OCPP_SCHEMA_STRING, 0, 0, 51, 22 },   // StopTransaction.transactionData[].sampledValue[].measurand
+    /* 228 */ { "phase", OCPP_SCHEMA_STRING, 0, 0, 73, 10 },   // StopTransaction.transactionData[].sampledValue[].phase
+    /* 229 */ { "location", OCPP_SCHEMA_STRING, 0, 0, 83, 5 },   // StopTransaction.transactionData[].sampledValue[].location
+    /* 230 */ { "unit", OCPP_SCHEMA_STRING, 0, 0, 88, 17 },   // StopTransaction.transactionData[].sampledValue[].unit
+    /* 231 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 232, 1 },   // StopTransactionResponse
+    /* 232 */ { "idTagInfo", OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 233, 3 },   // StopTransactionResponse.idTagInfo
+    /* 233 */ { "expiryDate", OCPP_SCHEMA_STRING, OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // StopTransactionResponse.idTagInfo.expiryDate
+    /* 234 */ { "parentIdTag", OCPP_SCHEMA_STRING, 0, 20, 0, 0 },   // StopTransactionResponse.idTagInfo.parentIdTag
+    /* 235 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 0, 5 },   // StopTransactionResponse.idTagInfo.status
+    /* 236 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 237, 2 },   // TriggerMessage
+    /* 237 */ { "requestedMessage", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 162, 6 },   // TriggerMessage.requestedMessage
+    /* 238 */ { "connectorId", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // TriggerMessage.connectorId
+    /* 239 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 240, 1 },   // TriggerMessageResponse
+    /* 240 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 168, 3 },   // TriggerMessageResponse.status
+    /* 241 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 242, 1 },   // UnlockConnector
+    /* 242 */ { "connectorId", OCPP_SCHEMA_INTEGER, OCPP_SCHEMA_REQUIRED, 0, 0, 0 },   // UnlockConnector.connectorId
+    /* 243 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 244, 1 },   // UnlockConnectorResponse
+    /* 244 */ { "status", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED, 0, 171, 3 },   // UnlockConnectorResponse.status
+    /* 245 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 246, 4 },   // UpdateFirmware
+    /* 246 */ { "location", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_URI, 0, 0, 0 },   // UpdateFirmware.location
+    /* 247 */ { "retries", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // UpdateFirmware.retries
+    /* 248 */ { "retrieveDate", OCPP_SCHEMA_STRING, OCPP_SCHEMA_REQUIRED | OCPP_SCHEMA_DATE_TIME, 0, 0, 0 },   // UpdateFirmware.retrieveDate
+    /* 249 */ { "retryInterval", OCPP_SCHEMA_INTEGER, 0, 0, 0, 0 },   // UpdateFirmware.retryInterval
+    /* 250 */ { nullptr, OCPP_SCHEMA_OBJECT, OCPP_SCHEMA_CLOSED, 0, 251, 0 },   // UpdateFirmwareResponse
+};
+
+const uint16_t OCPP_SCHEMA_ROOTS[OCPP_ACTION_COUNT][OCPP_SCHEMA_KIND_COUNT] = {
+    { 0, 2 },   // OCPP_ACTION_AUTHORIZE
+    { 7, 17 },   // OCPP_ACTION_BOOT_NOTIFICATION
+    { 21, 23 },   // OCPP_ACTION_CANCEL_RESERVATION
+    { 25, 28 },   // OCPP_ACTION_CHANGE_AVAILABILITY
+    { 30, 33 },   // OCPP_ACTION_CHANGE_CONFIGURATION
+    { 35, 36 },   // OCPP_ACTION_CLEAR_CACHE
+    { 38, 43 },   // OCPP_ACTION_CLEAR_CHARGING_PROFILE
+    { 45, 49 },   // OCPP_ACTION_DATA_TRANSFER
+    { 52, 54 },   // OCPP_ACTION_DIAGNOSTICS_STATUS_NOTIFICATION
+    { 55, 57 },   // OCPP_ACTION_FIRMWARE_STATUS_NOTIFICATION
+    { 58, 62 },   // OCPP_ACTION_GET_COMPOSITE_SCHEDULE
+    { 76, 79 },   // OCPP_ACTION_GET_CONFIGURATION
+    { 87, 93 },   // OCPP_ACTION_GET_DIAGNOSTICS
+    { 95, 96 },   // OCPP_ACTION_GET_LOCAL_LIST_VERSION
+    { 98, 99 },   // OCPP_ACTION_HEARTBEAT
+    { 101, 116 },   // OCPP_ACTION_METER_VALUES
+    { 117, 139 },   // OCPP_ACTION_REMOTE_START_TRANSACTION
+    { 141, 143 },   // OCPP_ACTION_REMOTE_STOP_TRANSACTION
+    { 145, 151 },   // OCPP_ACTION_RESERVE_NOW
+    { 153, 155 },   // OCPP_ACTION_RESET
+    { 157, 167 },   // OCPP_ACTION_SEND_LOCAL_LIST
+    { 169, 190 },   // OCPP_ACTION_SET_CHARGING_PROFILE
+    { 192, 198 },   // OCPP_ACTION_START_TRANSACTION
+    { 204, 212 },   // OCPP_ACTION_STATUS_NOTIFICATION
+    { 213, 231 },   // OCPP_ACTION_STOP_TRANSACTION
+    { 236, 239 },   // OCPP_ACTION_TRIGGER_MESSAGE
+    { 241, 243 },   // OCPP_ACTION_UNLOCK_CONNECTOR
+    { 245, 250 },   // OCPP_ACTION_UPDATE_FIRMWARE
+};
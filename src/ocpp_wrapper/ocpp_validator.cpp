@@ -0,0 +1,136 @@
+/**
+ * @file ocpp_validator.cpp
+ * @brief Implémentation de la validation des charges utiles OCPP 1.6
+ */
+
+#include "ocpp_validator.h"
+#include <math.h>
+#include "LogClock.h"
+
+// Schéma (RFC 3986) suivi de ':'
+static bool isUri(const char* text) {
+    if (!isalpha(static_cast<unsigned char>(text[0]))) return false;
+    const char* p = text + 1;
+    while (isalnum(static_cast<unsigned char>(*p)) || *p == '+' || *p == '-' || *p == '.') p++;
+    return *p == ':' && p[1] != '\0';
+}
+
+// maxLength compte des caractères : octets de continuation UTF-8 exclus
+static bool fitsLength(const char* text, uint16_t maxLength) {
+    size_t chars = 0;
+    for (const char* p = text; *p; ++p) {
+        if ((static_cast<uint8_t>(*p) & 0xC0) != 0x80 && ++chars > maxLength) return false;
+    }
+    return true;
+}
+
+static bool isDecimal(double value) {
+    double tenths = value * 10.0;
+    return fabs(tenths - round(tenths)) <= 1e-6 * (fabs(tenths) > 1.0 ? fabs(tenths) : 1.0);
+}
+
+static bool hasChild(const ocpp_schema_node_t& node, const char* key) {
+    for (uint16_t i = node.first; i < node.first + node.count; ++i) {
+        if (strcmp(OCPP_SCHEMA_NODES[i].name, key) == 0) return true;
+    }
+    return false;
+}
+
+static bool fail(ocpp_validation_t& result, ocpp_validation_error_t error, const char* field) {
+    result.error = error;
+    result.field = field;
+    return false;
+}
+
+static bool validateNode(const ocpp_schema_node_t& node, JsonVariantConst value, ocpp_validation_t& result) {
+    switch (node.type) {
+        case OCPP_SCHEMA_OBJECT: {
+            if (!value.is<JsonObjectConst>()) return fail(result, OCPP_INVALID_TYPE, node.name);
+            JsonObjectConst object = value.as<JsonObjectConst>();
+            if (node.flags & OCPP_SCHEMA_CLOSED) {
+                for (JsonPairConst pair : object) {
+                    if (!hasChild(node, pair.key().c_str())) {
+                        return fail(result, OCPP_INVALID_FORMATION, pair.key().c_str());
+                    }
+                }
+            }
+            for (uint16_t i = node.first; i < node.first + node.count; ++i) {
+                const ocpp_schema_node_t& child = OCPP_SCHEMA_NODES[i];
+                JsonVariantConst member = object[child.name];
+                if (member.isNull()) {
+                    if (child.flags & OCPP_SCHEMA_REQUIRED) return fail(result, OCPP_INVALID_OCCURRENCE, child.name);
+                    continue;
+                }
+                if (!validateNode(child, member, result)) return false;
+            }
+            return true;
+        }
+
+        case OCPP_SCHEMA_ARRAY: {
+            if (!value.is<JsonArrayConst>()) return fail(result, OCPP_INVALID_TYPE, node.name);
+            for (JsonVariantConst item : value.as<JsonArrayConst>()) {
+                if (!validateNode(OCPP_SCHEMA_NODES[node.first], item, result)) {
+                    // Élément de tableau : la propriété fautive est le tableau, sauf plus profond
+                    if (!result.field) result.field = node.name;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        case OCPP_SCHEMA_STRING: {
+            if (!value.is<const char*>()) return fail(result, OCPP_INVALID_TYPE, node.name);
+            const char* text = value.as<const char*>();
+            if (node.maxLength > 0 && !fitsLength(text, node.maxLength)) {
+                return fail(result, OCPP_INVALID_PROPERTY, node.name);
+            }
+            if (node.count > 0) {
+                bool listed = false;
+                for (uint16_t i = node.first; i < node.first + node.count && !listed; ++i) {
+                    listed = strcmp(OCPP_SCHEMA_ENUMS[i], text) == 0;
+                }
+                if (!listed) return fail(result, OCPP_INVALID_PROPERTY, node.name);
+            }
+            uint64_t unixMs;
+            if (((node.flags & OCPP_SCHEMA_DATE_TIME) && !LogClock::parseIso8601(text, unixMs)) ||
+                ((node.flags & OCPP_SCHEMA_URI) && !isUri(text))) {
+                return fail(result, OCPP_INVALID_PROPERTY, node.name);
+            }
+            return true;
+        }
+
+        case OCPP_SCHEMA_INTEGER:
+            return value.is<long>() || fail(result, OCPP_INVALID_TYPE, node.name);
+
+        case OCPP_SCHEMA_NUMBER:
+            if (!value.is<double>()) return fail(result, OCPP_INVALID_TYPE, node.name);
+            if ((node.flags & OCPP_SCHEMA_DECIMAL) && !isDecimal(value.as<double>())) {
+                return fail(result, OCPP_INVALID_PROPERTY, node.name);
+            }
+            return true;
+
+        case OCPP_SCHEMA_BOOLEAN:
+            return value.is<bool>() || fail(result, OCPP_INVALID_TYPE, node.name);
+    }
+    return fail(result, OCPP_INVALID_FORMATION, node.name);
+}
+
+ocpp_validation_t OcppValidator::validate(ocpp_action_t action, ocpp_schema_kind_t kind, JsonVariantConst payload) {
+    ocpp_validation_t result = { OCPP_VALID, nullptr };
+    if (action >= OCPP_ACTION_COUNT || kind >= OCPP_SCHEMA_KIND_COUNT) {
+        result.error = OCPP_INVALID_FORMATION;
+        return result;
+    }
+    validateNode(OCPP_SCHEMA_NODES[OCPP_SCHEMA_ROOTS[action][kind]], payload, result);
+    return result;
+}
+
+const char* OcppValidator::errorCode(ocpp_validation_error_t error) {
+    switch (error) {
+        case OCPP_INVALID_FORMATION:  return "FormationViolation";
+        case OCPP_INVALID_OCCURRENCE: return "OccurenceConstraintViolation";
+        case OCPP_INVALID_TYPE:       return "TypeConstraintViolation";
+        case OCPP_INVALID_PROPERTY:   return "PropertyConstraintViolation";
+        default:                      return nullptr;
+    }
+}
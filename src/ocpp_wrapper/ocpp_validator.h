@@ -0,0 +1,96 @@
+#ifndef OCPP_VALIDATOR_H
+#define OCPP_VALIDATOR_H
+
+/**
+ * @file ocpp_validator.h
+ * @brief Validation des charges utiles OCPP 1.6 par les tables générées depuis schemas/json
+ *
+ * scripts/gen_ocpp_schemas.py produit ocpp_schemas.cpp : un nœud par propriété (type, obligatoire,
+ * maxLength, enum, format), les enfants d'un objet contigus. validate() parcourt ces nœuds sur un
+ * JsonDocument déjà désérialisé, sans allocation ni copie : longueurs mesurées sur place, enums
+ * comparés aux chaînes de la table.
+ *
+ * L'erreur retournée correspond aux codes CALLERROR d'OCPP-J (§4.2.3) :
+ * - propriété inconnue (additionalProperties: false) : FormationViolation ;
+ * - propriété obligatoire absente : OccurenceConstraintViolation ;
+ * - mauvais type JSON : TypeConstraintViolation ;
+ * - maxLength, enum, date-time, uri, multipleOf : PropertyConstraintViolation.
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "ocpp_actions.h"
+
+/**
+ * @brief Type JSON d'un nœud
+ */
+typedef enum {
+    OCPP_SCHEMA_OBJECT = 0,
+    OCPP_SCHEMA_ARRAY,
+    OCPP_SCHEMA_STRING,
+    OCPP_SCHEMA_INTEGER,
+    OCPP_SCHEMA_NUMBER,
+    OCPP_SCHEMA_BOOLEAN
+} ocpp_schema_type_t;
+
+#define OCPP_SCHEMA_REQUIRED   0x01   // Dans "required" de l'objet parent
+#define OCPP_SCHEMA_CLOSED     0x02   // Objet : additionalProperties: false
+#define OCPP_SCHEMA_DATE_TIME  0x04   // Chaîne : format date-time
+#define OCPP_SCHEMA_URI        0x08   // Chaîne : format uri
+#define OCPP_SCHEMA_DECIMAL    0x10   // Nombre : multipleOf 0.1
+
+/**
+ * @brief Nœud de schéma (12 octets)
+ */
+typedef struct {
+    const char* name;        // Propriété ; nullptr pour une racine ou un élément de tableau
+    uint8_t type;            // ocpp_schema_type_t
+    uint8_t flags;           // OCPP_SCHEMA_*
+    uint16_t maxLength;      // En caractères, 0 : sans limite
+    uint16_t first;          // Objet : premier enfant ; tableau : élément ; chaîne : première valeur d'enum
+    uint8_t count;           // Objet : nombre d'enfants ; chaîne : nombre de valeurs d'enum (0 : libre)
+} ocpp_schema_node_t;
+
+/**
+ * @brief Schéma de requête (.req) ou de réponse (.conf)
+ */
+typedef enum {
+    OCPP_SCHEMA_REQUEST = 0,
+    OCPP_SCHEMA_RESPONSE,
+    OCPP_SCHEMA_KIND_COUNT
+} ocpp_schema_kind_t;
+
+// Tables générées (ocpp_schemas.cpp)
+extern const char* const OCPP_SCHEMA_ENUMS[];
+extern const ocpp_schema_node_t OCPP_SCHEMA_NODES[];
+extern const uint16_t OCPP_SCHEMA_ROOTS[OCPP_ACTION_COUNT][OCPP_SCHEMA_KIND_COUNT];
+
+/**
+ * @brief Résultat d'une validation
+ */
+typedef enum {
+    OCPP_VALID = 0,
+    OCPP_INVALID_FORMATION,      // FormationViolation
+    OCPP_INVALID_OCCURRENCE,     // OccurenceConstraintViolation
+    OCPP_INVALID_TYPE,           // TypeConstraintViolation
+    OCPP_INVALID_PROPERTY        // PropertyConstraintViolation
+} ocpp_validation_error_t;
+
+typedef struct {
+    ocpp_validation_error_t error;
+    const char* field;       // Propriété fautive (table ou document) ; nullptr : la charge utile
+} ocpp_validation_t;
+
+class OcppValidator {
+public:
+    /**
+     * @brief Valide une charge utile ; s'arrête à la première erreur
+     * @param payload Variante du document ; `field` du résultat pointe dans la table ou le document
+     */
+    static ocpp_validation_t validate(ocpp_action_t action, ocpp_schema_kind_t kind, JsonVariantConst payload);
+
+    // Code CALLERROR OCPP-J ("FormationViolation", ...) ; nullptr pour OCPP_VALID
+    static const char* errorCode(ocpp_validation_error_t error);
+};
+
+#endif // OCPP_VALIDATOR_H
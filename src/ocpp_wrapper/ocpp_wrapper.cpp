@@ -0,0 +1,1109 @@
+/**
+ * @file ocpp_wrapper.cpp
+ * @brief Implémentation du wrapper MicroOCPP
+ *
+ * Issue: [INFRA] Project Structure Setup - MicroOCPP Integration
+ */
+
+#include "ocpp_wrapper.h"
+#include <ArduinoJson.h>
+#include <WebSocketsClient.h>
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <esp_system.h>
+#include "LogClock.h"
+#include "ocpp_json_writer.h"
+
+#define LOG_TAG "ocpp"
+#include "log_macros.h"
+
+#ifndef OCPP_CHARGE_POINT_MODEL
+#define OCPP_CHARGE_POINT_MODEL "ESP32 DevKitC"
+#endif
+#ifndef OCPP_CHARGE_POINT_VENDOR
+#define OCPP_CHARGE_POINT_VENDOR PROJECT_NAME
+#endif
+
+// Réponses de BootNotification/Heartbeat et StartTransaction.conf, filtrées : quelques champs
+static const size_t OCPP_RESPONSE_DOC_SIZE = 192;
+
+static_assert(OCPP_FRAME_HEADROOM == WEBSOCKETS_MAX_HEADER_SIZE, "réserve de l'en-tête WebSocket devant les trames");
+// Après un redémarrage, le rejeu ne remet que OCPP_JOURNAL_REPLAY_WINDOW messages dans la file
+static_assert(METER_VALUES_BATCH_MAX <= OCPP_JOURNAL_REPLAY_WINDOW, "lot de relevés plus grand que le rejeu");
+
+// Horodatage ISO 8601 des charges utiles (heure du serveur, via LogClock)
+static LogTimestampFormatter payloadTimestamps;
+
+// Heure absolue d'un message du journal, éventuellement écrit avant le redémarrage
+static void formatUnixTimestamp(char* buf, size_t size, uint64_t unixMs) {
+    int32_t year = 0;
+    uint32_t month = 0, day = 0;
+    LogClock::civilFromDays(static_cast<int32_t>(unixMs / 86400000ULL), year, month, day);
+    uint32_t msOfDay = static_cast<uint32_t>(unixMs % 86400000ULL);
+    snprintf(buf, size, "%04ld-%02lu-%02luT%02lu:%02lu:%02lu.%03luZ", static_cast<long>(year),
+             static_cast<unsigned long>(month), static_cast<unsigned long>(day),
+             static_cast<unsigned long>(msOfDay / 3600000), static_cast<unsigned long>(msOfDay / 60000 % 60),
+             static_cast<unsigned long>(msOfDay / 1000 % 60), static_cast<unsigned long>(msOfDay % 1000));
+}
+
+// Heure courante pour les expirations d'idTag ; 0 tant que le serveur ne l'a pas donnée
+static uint32_t nowUnixS() {
+    return LogClock::isSet() ? static_cast<uint32_t>(LogClock::toUnixMs(millis()) / 1000) : 0;
+}
+
+// IdTagInfo reçu du serveur (SendLocalList, StartTransaction.conf)
+static bool readIdTagInfo(const char* idTag, JsonObjectConst info, ocpp_auth_entry_t& entry) {
+    memset(&entry, 0, sizeof(entry));
+    ocpp_auth_status_t status = OcppAuthStore::parseStatus(info["status"] | "");
+    const char* parentIdTag = info["parentIdTag"] | "";
+    if (!idTag || strlen(idTag) > ID_TAG_MAX_LENGTH || strlen(parentIdTag) > ID_TAG_MAX_LENGTH ||
+        status == OCPP_AUTH_STATUS_COUNT) {
+        return false;
+    }
+    strcpy(entry.idTag, idTag);
+    strcpy(entry.parentIdTag, parentIdTag);
+    entry.status = status;
+    uint64_t expiryMs = 0;
+    const char* expiryDate = info["expiryDate"];
+    if (expiryDate && LogClock::parseIso8601(expiryDate, expiryMs)) {
+        entry.expiryUnixS = static_cast<uint32_t>(expiryMs / 1000);
+    }
+    return true;
+}
+
+// Limite en lecture seule annoncée au serveur (déjà déclarée par MicroOCPP, ou créée ici)
+static void declareReadOnlyLimit(const char* key, int value) {
+    MicroOcpp::Configuration* config =
+        MicroOcpp::declareConfiguration<int>(key, value, CONFIGURATION_VOLATILE, true);
+    if (config) config->setInt(value);
+}
+
+// Débit horaire d'un compteur depuis le démarrage
+static uint32_t perHour(uint32_t count, uint32_t uptimeMs) {
+    return uptimeMs ? static_cast<uint32_t>(static_cast<uint64_t>(count) * 3600000ULL / uptimeMs) : 0;
+}
+
+// ============================================================================
+// CONNEXION PARTAGÉE AVEC MICROOCPP
+// ============================================================================
+
+/**
+ * @brief Connexion WebSocket donnée à MicroOCPP
+ *
+ * Ses CALL sortants sont déclarés à la file (fenêtre commune) ; les réponses à nos CALL sont
+ * consommées ici, tout le reste lui est transmis.
+ */
+class OCPPWrapper::Transport : public MicroOcpp::Connection {
+public:
+    explicit Transport(OCPPWrapper& owner) : owner(owner), client(&socket), localReplyLen(0) {}
+
+    WebSocketsClient& getSocket() { return socket; }
+
+    void loop() override {
+        client.loop();
+        if (localReplyLen > 0 && forward) {
+            size_t len = localReplyLen;
+            localReplyLen = 0;
+            forward(localReply, len);
+        }
+    }
+
+    bool sendTXT(const char* msg, size_t length) override {
+        // StatusNotification de MicroOCPP : les statuts viennent de notre machine d'états. Rien n'est
+        // émis ; MicroOCPP reçoit sa confirmation au prochain loop(), pas pendant son propre envoi
+        ocpp_frame_t frame;
+        if (OcppFrame::parse(msg, length, frame) && frame.type == OCPP_MESSAGE_CALL &&
+            OcppFrame::equals(frame.action, "StatusNotification")) {
+            int len = snprintf(localReply, sizeof(localReply), "[3,\"%.*s\",{}]",
+                               static_cast<int>(frame.uniqueId.len), frame.uniqueId.data);
+            localReplyLen = len > 0 && static_cast<size_t>(len) < sizeof(localReply) ? static_cast<size_t>(len) : 0;
+            owner.microStatusSuppressed++;
+            return true;
+        }
+        // Fenêtre pleine : MicroOCPP garde le message et réessaie au prochain mocpp_loop()
+        if (!owner.callQueue.trackOutgoing(msg, length, millis())) return false;
+        if (client.sendTXT(msg, length)) return true;
+        owner.callQueue.cancelOutgoing(msg, length);
+        return false;
+    }
+
+    void setReceiveTXTcallback(MicroOcpp::ReceiveTXTcallback& callback) override {
+        forward = callback;
+        MicroOcpp::ReceiveTXTcallback intercept = [this](const char* payload, size_t length) {
+            return receive(payload, length);
+        };
+        client.setReceiveTXTcallback(intercept);
+    }
+
+    unsigned long getLastRecv() { return client.getLastRecv(); }
+    unsigned long getLastConnected() { return client.getLastConnected(); }
+    bool isConnected() { return client.isConnected(); }
+
+    // Nos trames : directement sur le WebSocket, sans passer par la fenêtre
+    bool sendOwn(const char* frame, size_t len) { return client.sendTXT(frame, len); }
+
+    // Trame précédée de OCPP_FRAME_HEADROOM octets : en-tête écrit devant, masquage sur place. Sans
+    // cela, WebSocketsClient alloue et recopie chaque trame pour l'envoyer en un paquet TCP.
+    // sendTXT(..., true) attend le début de la réserve ; `len` ne compte que la trame.
+    bool sendInPlace(char* frame, size_t len) {
+        return socket.sendTXT(OcppCallQueue::headroom(frame), len, true);
+    }
+
+private:
+    OCPPWrapper& owner;
+    WebSocketsClient socket;
+    MicroOcpp::EspWiFi::WSClient client;
+    MicroOcpp::ReceiveTXTcallback forward;
+    char localReply[OCPP_FOREIGN_ID_SIZE + 8];   // `[3,"<uniqueId>",{}]` en attente pour MicroOCPP
+    size_t localReplyLen;
+
+    // Enveloppe lue une fois, sur le tampon du WebSocket ; MicroOCPP relit ce qui lui revient
+    bool receive(const char* payload, size_t length) {
+        ocpp_frame_t frame;
+        if (OcppFrame::parse(payload, length, frame)) {
+            if (frame.type == OCPP_MESSAGE_CALL) {
+                ocpp_dispatch_result_t result = owner.dispatcher.dispatch(frame);
+                if (result == OCPP_DISPATCH_HANDLED) return true;
+                if (result != OCPP_DISPATCH_FORWARD) return replyError(frame, result);
+            } else {
+                char action[OCPP_ACTION_NAME_SIZE] = "";
+                ocpp_frame_kind_t kind = owner.callQueue.handleIncoming(frame, millis(), action, sizeof(action));
+                if (kind == OCPP_FRAME_OWN) return true;
+                if (kind == OCPP_FRAME_FOREIGN) {
+                    owner.handleServerResponse(ocppActionFind(action, strlen(action)), frame.payload);
+                }
+            }
+        }
+        return forward ? forward(payload, length) : true;
+    }
+
+    // CALL refusé à l'aiguillage (inconnu, non pris en charge, non conforme) : MicroOCPP ne le voit pas
+    bool replyError(const ocpp_frame_t& frame, ocpp_dispatch_result_t result) {
+        char error[OCPP_DISPATCH_ERROR_SIZE];
+        size_t len = owner.dispatcher.writeError(error, sizeof(error), frame, result);
+        char action[OCPP_ACTION_NAME_SIZE];
+        OcppFrame::copy(frame.action, action, sizeof(action));
+        LOG_WARN_RATE(10000, 3, "OCPP: CALL %s refusé : %s", action, len > 0 ? error : "?");
+        return len > 0 && sendOwn(error, len);
+    }
+};
+
+// ============================================================================
+// CYCLE DE VIE
+// ============================================================================
+
+OCPPWrapper::OCPPWrapper()
+    : wsUrl(nullptr), chargePointId(nullptr), initialized(false), connected(false), bootAccepted(false),
+      transport(nullptr), callQueue(esp_random()), nextTxRef(1), microStatusSuppressed(0), statsState(STATS_IDLE) {
+    memset(connectors, 0, sizeof(connectors));
+    memset(&statsSnapshot, 0, sizeof(statsSnapshot));
+    for (ConnectorState& connector : connectors) {
+        connector.transactionId = -1;
+    }
+    configValue[0] = '\0';
+
+    OcppCallQueue::Handlers handlers = { sendFrame, writePayload, onCallResult, this };
+    callQueue.setHandlers(handlers);
+#if METER_VALUES_BATCHING_ENABLED
+    callQueue.setMeterValuesBatch(METER_VALUES_BATCH_MAX, METER_VALUES_BATCH_WINDOW_MS);
+#endif
+    meterSampler.setSink(onMeterReading, this);
+    connectorStates.setSink(onConnectorStatus, this);
+    dispatcher.setHandler(OCPP_ACTION_SEND_LOCAL_LIST, onSendLocalList, this);
+    dispatcher.setHandler(OCPP_ACTION_GET_LOCAL_LIST_VERSION, onGetLocalListVersion, this);
+    dispatcher.setHandler(OCPP_ACTION_CLEAR_CACHE, onClearCache, this);
+    dispatcher.setHandler(OCPP_ACTION_REMOTE_START_TRANSACTION, onRemoteStartTransaction, this);
+    dispatcher.setHandler(OCPP_ACTION_REMOTE_STOP_TRANSACTION, onRemoteStopTransaction, this);
+    dispatcher.setHandler(OCPP_ACTION_CHANGE_AVAILABILITY, onChangeAvailability, this);
+    dispatcher.setHandler(OCPP_ACTION_RESET, onReset, this);
+    dispatcher.setHandler(OCPP_ACTION_UNLOCK_CONNECTOR, onUnlockConnector, this);
+}
+
+OCPPWrapper::~OCPPWrapper() {
+    if (initialized) {
+        mocpp_deinitialize();
+    }
+    delete transport;
+    free(wsUrl);
+    free(chargePointId);
+}
+
+bool OCPPWrapper::init(const char* url, const char* id) {
+    if (initialized || !url || !id || strlen(id) > CHARGE_POINT_ID_MAX_LENGTH) return false;
+
+    // ws://hôte[:port][/chemin] ou wss://... ; le chemin final se termine par /<chargePointId>
+    bool secure = strncmp(url, "wss://", 6) == 0;
+    if (!secure && strncmp(url, "ws://", 5) != 0) {
+        logMessage("❌ URL OCPP invalide (ws:// ou wss:// attendu)");
+        return false;
+    }
+    const char* hostStart = url + (secure ? 6 : 5);
+    size_t hostLen = strcspn(hostStart, ":/");
+    char host[64];
+    if (hostLen == 0 || hostLen >= sizeof(host)) {
+        logMessage("❌ Hôte OCPP invalide");
+        return false;
+    }
+    memcpy(host, hostStart, hostLen);
+    host[hostLen] = '\0';
+
+    const char* rest = hostStart + hostLen;
+    uint16_t port = secure ? 443 : 80;
+    if (*rest == ':') {
+        port = static_cast<uint16_t>(strtoul(rest + 1, nullptr, 10));
+        rest = strchr(rest, '/');
+        if (!rest) rest = "";
+    }
+    size_t pathLen = strlen(rest);
+    while (pathLen > 0 && rest[pathLen - 1] == '/') pathLen--;
+    char path[160];
+    int written = snprintf(path, sizeof(path), "%.*s/%s", static_cast<int>(pathLen), rest, id);
+    if (written < 0 || static_cast<size_t>(written) >= sizeof(path)) {
+        logMessage("❌ Chemin OCPP trop long");
+        return false;
+    }
+
+    wsUrl = strdup(url);
+    chargePointId = strdup(id);
+    transport = new Transport(*this);
+
+    WebSocketsClient& socket = transport->getSocket();
+    if (secure) {
+        socket.beginSSL(host, port, path, "", "ocpp1.6");
+    } else {
+        socket.begin(host, port, path, "ocpp1.6");
+    }
+    socket.setReconnectInterval(WEBSOCKET_RECONNECT_INTERVAL);
+    socket.enableHeartbeat(WEBSOCKET_PING_INTERVAL, WEBSOCKET_PONG_TIMEOUT, 2);
+
+    // Messages d'avant le redémarrage : rejoués dès le BootNotification accepté
+    if (journal.begin(millis())) {
+        nextTxRef = static_cast<uint16_t>(journal.getLastTxRef() + 1);
+        if (nextTxRef == 0) nextTxRef = 1;
+    } else {
+        logMessage("⚠️ Journal OCPP indisponible, transactions non persistées");
+    }
+    if (!authStore.begin()) {
+        logMessage("⚠️ Autorisations locales indisponibles, décision laissée au serveur");
+    }
+
+    mocpp_initialize(*transport, ChargerCredentials(OCPP_CHARGE_POINT_MODEL, OCPP_CHARGE_POINT_VENDOR,
+                                                    PROJECT_VERSION));
+    // La Local List est tenue par OcppAuthStore ; un SendLocalList doit tenir dans le document du dispatcher
+    declareReadOnlyLimit("LocalAuthListMaxLength", OCPP_LOCAL_LIST_MAX_LENGTH);
+    declareReadOnlyLimit("SendLocalListMaxLength", OCPP_SEND_LOCAL_LIST_MAX_LENGTH < OCPP_LOCAL_LIST_MAX_LENGTH
+                                                       ? OCPP_SEND_LOCAL_LIST_MAX_LENGTH
+                                                       : OCPP_LOCAL_LIST_MAX_LENGTH);
+    // Relues à chaque autorisation (applyAuthConfig) : ChangeConfiguration pris en compte aussitôt
+    MicroOcpp::declareConfiguration<bool>("LocalAuthListEnabled", true);
+    MicroOcpp::declareConfiguration<bool>("AuthorizationCacheEnabled", true);
+    initialized = true;
+    LOG_INFO("OCPP: %s:%u%s (%s)", host, static_cast<unsigned>(port), path, secure ? "TLS" : "clair");
+    return true;
+}
+
+void OCPPWrapper::loop() {
+    if (!initialized) return;
+
+    mocpp_loop();
+
+    bool nowConnected = transport->isConnected();
+    if (nowConnected != connected) {
+        connected = nowConnected;
+        logMessage(connected ? "✅ Connecté au serveur OCPP" : "⚠️ Déconnecté du serveur OCPP");
+    }
+
+    uint32_t now = millis();
+    journal.commitIfDue(now);
+    journal.feed(callQueue, now);
+    connectorStates.poll(now);
+
+    // Rien avant le BootNotification accepté (OCPP 1.6 §4.2) ; les expirations continuent
+    callQueue.poll(now, connected && bootAccepted);
+
+    if (statsState.load(std::memory_order_acquire) == STATS_REQUESTED) {
+        fillStats(statsSnapshot);
+        statsState.store(STATS_READY, std::memory_order_release);
+    }
+}
+
+bool OCPPWrapper::isConnected() {
+    return initialized && connected;
+}
+
+// ============================================================================
+// MESSAGES SORTANTS
+// ============================================================================
+
+bool OCPPWrapper::handleConnectorEvent(int connectorId, ocpp_connector_event_t event) {
+    if (connectorId < 0 || connectorId > MAX_CONNECTORS) return false;
+    return connectorStates.handle(static_cast<uint8_t>(connectorId), event, millis());
+}
+
+bool OCPPWrapper::setConnectorStatus(int connectorId, ocpp_connector_status_t status) {
+    if (connectorId < 0 || connectorId > MAX_CONNECTORS) return false;
+    return connectorStates.set(static_cast<uint8_t>(connectorId), status, millis());
+}
+
+ocpp_connector_status_t OCPPWrapper::getConnectorStatus(int connectorId) const {
+    if (connectorId < 0 || connectorId > MAX_CONNECTORS) return OCPP_STATUS_COUNT;
+    return connectorStates.getStatus(static_cast<uint8_t>(connectorId));
+}
+
+bool OCPPWrapper::onConnectorStatus(void* ctx, uint8_t connectorId, ocpp_connector_status_t status) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    ocpp_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.type = OCPP_CALL_STATUS_NOTIFICATION;
+    call.connectorId = connectorId;
+    call.timestampMs = millis();
+    strcpy(call.status, OCPP_CONNECTOR_STATUS_NAMES[status]);
+    // File pleine : la machine d'états garde le statut et le repropose au prochain loop()
+    if (!self->callQueue.enqueue(call, call.timestampMs)) return false;
+    self->handleStatusChange(connectorId, call.status);
+    return true;
+}
+
+ocpp_auth_status_t OCPPWrapper::authorize(const char* idTag, char* parentIdTag) {
+    applyAuthConfig();
+    ocpp_auth_entry_t entry;
+    if (!authStore.lookup(idTag, nowUnixS(), entry)) return OCPP_AUTH_STATUS_COUNT;
+    if (parentIdTag) strcpy(parentIdTag, entry.parentIdTag);
+    return static_cast<ocpp_auth_status_t>(entry.status);
+}
+
+int OCPPWrapper::startTransaction(int connectorId, const char* idTag) {
+    if (connectorId < 1 || connectorId > MAX_CONNECTORS || !idTag || strlen(idTag) > ID_TAG_MAX_LENGTH) {
+        return -1;
+    }
+    ConnectorState& connector = connectors[connectorId];
+    if (connector.txRef != 0) {
+        LOG_WARN("OCPP: transaction déjà en cours sur le connecteur %d", connectorId);
+        return -1;
+    }
+    ocpp_connector_status_t status = connectorStates.getStatus(static_cast<uint8_t>(connectorId));
+    if (status == OCPP_STATUS_UNAVAILABLE || status == OCPP_STATUS_FAULTED) {
+        LOG_WARN("OCPP: connecteur %d %s, pas de transaction", connectorId, OCPP_CONNECTOR_STATUS_NAMES[status]);
+        return -1;
+    }
+    // Badge connu localement et refusé : pas de StartTransaction ; inconnu : le serveur décide
+    ocpp_auth_status_t auth = authorize(idTag);
+    if (auth != OCPP_AUTH_ACCEPTED && auth != OCPP_AUTH_STATUS_COUNT) {
+        LOG_WARN("OCPP: idTag %s refusé localement (%s)", idTag, OCPP_AUTH_STATUS_NAMES[auth]);
+        return -1;
+    }
+
+    uint16_t txRef = nextTxRef++;
+    if (nextTxRef == 0) nextTxRef = 1;
+    if (!enqueueCall(OCPP_CALL_START_TRANSACTION, connectorId, txRef, connector.energyWh)) return -1;
+
+    connector.txRef = txRef;
+    connector.transactionId = -1;
+    connector.stopping = false;
+    strcpy(connector.idTag, idTag);
+    connectorStates.handle(static_cast<uint8_t>(connectorId), OCPP_EVENT_TX_START, millis());
+    LOG_INFO_KV("tx_start_req", "connectorId", connectorId, "txRef", static_cast<int>(txRef), "meterStart",
+                static_cast<int>(connector.energyWh));
+    return txRef;
+}
+
+bool OCPPWrapper::stopTransaction(int connectorId, ocpp_stop_reason_t reason) {
+    if (connectorId < 1 || connectorId > MAX_CONNECTORS) return false;
+    ConnectorState& connector = connectors[connectorId];
+    if (connector.txRef == 0 || connector.stopping) return false;
+
+    if (!enqueueCall(OCPP_CALL_STOP_TRANSACTION, connectorId, connector.txRef, connector.energyWh, nullptr, reason)) {
+        return false;
+    }
+    connector.stopping = true;
+    connectorStates.handle(static_cast<uint8_t>(connectorId), OCPP_EVENT_TX_STOP, millis());
+    applyPendingAvailability(static_cast<uint8_t>(connectorId));
+    LOG_INFO_KV("tx_stop_req", "connectorId", connectorId, "txRef", static_cast<int>(connector.txRef),
+                "meterStop", static_cast<int>(connector.energyWh), "reason", OCPP_STOP_REASONS[reason]);
+    return true;
+}
+
+bool OCPPWrapper::sendMeterValues(int connectorId, float energy, float power) {
+    if (connectorId < 0 || connectorId > MAX_CONNECTORS) return false;
+    ocpp_meter_reading_t reading;
+    memset(&reading, 0, sizeof(reading));
+    reading.connectorId = static_cast<uint8_t>(connectorId);
+    reading.context = OCPP_READING_PERIODIC;
+    reading.measurands = OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_REGISTER) | OCPP_MEASURAND_BIT(OCPP_MEASURAND_POWER);
+    reading.timestampMs = millis();
+    reading.values[OCPP_MEASURAND_ENERGY_REGISTER] = static_cast<int32_t>(energy);
+    reading.values[OCPP_MEASURAND_POWER] = static_cast<int32_t>(lroundf(power * 10.0f));
+    return enqueueReading(reading);
+}
+
+bool OCPPWrapper::addMeterSample(int connectorId, const ocpp_meter_sample_t& sample) {
+    if (connectorId < 0 || connectorId > MAX_CONNECTORS) return false;
+    // Configuration OCPP (ChangeConfiguration) relue à chaque mesure : prise en compte sans redémarrage
+    meterSampler.setIntervals(configInt("MeterValueSampleInterval", METER_VALUES_INTERVAL),
+                              configInt("ClockAlignedDataInterval", CLOCK_ALIGNED_DATA_INTERVAL));
+    const char* sampled = getConfiguration("MeterValuesSampledData");
+    if (sampled) meterSampler.setMeasurands(OCPP_READING_PERIODIC, OcppMeterSampler::parseMeasurands(sampled));
+    const char* aligned = getConfiguration("MeterValuesAlignedData");
+    if (aligned) meterSampler.setMeasurands(OCPP_READING_CLOCK, OcppMeterSampler::parseMeasurands(aligned));
+
+    // Énergie pendant la transaction : Charging ↔ SuspendedEV (SuspendedEVSE : décision de la borne)
+    const ConnectorState& connector = connectors[connectorId];
+    if (connectorId > 0 && connector.txRef != 0 && !connector.stopping) {
+        uint8_t id = static_cast<uint8_t>(connectorId);
+        ocpp_connector_status_t status = connectorStates.getStatus(id);
+        bool flowing = sample.powerW >= CONNECTOR_ENERGY_FLOW_MIN_W;
+        if (flowing && status == OCPP_STATUS_SUSPENDED_EV) {
+            connectorStates.handle(id, OCPP_EVENT_ENERGY_FLOW, millis());
+        } else if (!flowing && status == OCPP_STATUS_CHARGING) {
+            connectorStates.handle(id, OCPP_EVENT_EV_SUSPEND, millis());
+        }
+    }
+
+    uint64_t unixMs = LogClock::isSet() ? LogClock::toUnixMs(sample.timestampMs) : 0;
+    return meterSampler.addSample(static_cast<uint8_t>(connectorId), sample, unixMs);
+}
+
+void OCPPWrapper::onMeterReading(void* ctx, const ocpp_meter_reading_t& reading) {
+    static_cast<OCPPWrapper*>(ctx)->enqueueReading(reading);
+}
+
+bool OCPPWrapper::enqueueReading(const ocpp_meter_reading_t& reading) {
+    ConnectorState& connector = connectors[reading.connectorId];
+    if (reading.measurands & OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_REGISTER)) {
+        connector.energyWh = reading.values[OCPP_MEASURAND_ENERGY_REGISTER];
+    }
+    uint16_t txRef = connector.stopping ? 0 : connector.txRef;
+    return enqueueCall(OCPP_CALL_METER_VALUES, reading.connectorId, txRef, connector.energyWh, &reading);
+}
+
+// LocalAuthListEnabled / AuthorizationCacheEnabled : absentes ou illisibles, les deux restent actives
+void OCPPWrapper::applyAuthConfig() {
+    const char* list = getConfiguration("LocalAuthListEnabled");
+    const char* cache = getConfiguration("AuthorizationCacheEnabled");
+    authStore.setEnabled(!list || strcmp(list, "false") != 0, !cache || strcmp(cache, "false") != 0);
+}
+
+int OCPPWrapper::configInt(const char* key, int fallback) {
+    const char* value = getConfiguration(key);
+    if (!value) return fallback;
+    char* end = nullptr;
+    long number = strtol(value, &end, 10);
+    return end != value && *end == '\0' && number >= 0 ? static_cast<int>(number) : fallback;
+}
+
+bool OCPPWrapper::enqueueCall(ocpp_call_type_t type, int connectorId, uint16_t txRef, int32_t meterWh,
+                              const ocpp_meter_reading_t* reading, ocpp_stop_reason_t reason) {
+    ocpp_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.type = type;
+    call.connectorId = static_cast<uint8_t>(connectorId);
+    call.txRef = txRef;
+    call.timestampMs = millis();
+    call.meterWh = meterWh;
+    if (reading) {
+        call.timestampMs = reading->timestampMs;
+        call.unixMs = reading->unixMs;
+        call.readingContext = reading->context;
+        call.measurands = reading->measurands;
+        memcpy(call.values, reading->values, sizeof(call.values));
+    }
+    if (type == OCPP_CALL_START_TRANSACTION) {
+        strcpy(call.idTag, connectors[connectorId].idTag);
+    } else if (type == OCPP_CALL_STOP_TRANSACTION) {
+        call.stopReason = static_cast<uint8_t>(reason);
+    }
+    // Journal plein ou indisponible : la file seule, sans persistance
+    if (OcppCallQueue::isTransactionMessage(call) && journal.append(call, call.timestampMs)) return true;
+    if (!callQueue.enqueue(call, call.timestampMs)) {
+        LOG_WARN_RATE(10000, 3, "OCPP: file pleine, %s refusé", OcppCallQueue::actionName(type));
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// CALLBACKS DE LA FILE
+// ============================================================================
+
+bool OCPPWrapper::sendFrame(void* ctx, char* frame, size_t len) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    return self->transport && self->transport->sendInPlace(frame, len);
+}
+
+static void formatCallTimestamp(char* out, size_t size, const ocpp_call_t& call) {
+    if (call.unixMs != 0) {
+        formatUnixTimestamp(out, size, call.unixMs);
+    } else {
+        payloadTimestamps.format(out, size, call.timestampMs);
+    }
+}
+
+size_t OCPPWrapper::writePayload(void* ctx, const ocpp_call_t* const* calls, size_t count, char* out, size_t size) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    const ocpp_call_t& call = *calls[0];
+    char timestamp[LOG_CLOCK_TEXT_SIZE];
+    formatCallTimestamp(timestamp, sizeof(timestamp), call);
+
+    // Transaction côté serveur, connue seulement une fois StartTransaction confirmé ; après un
+    // redémarrage, seul le journal la connaît
+    int32_t transactionId = -1;
+    if (call.txRef != 0) {
+        ConnectorState* connector = self->findTransaction(call.txRef);
+        if (connector && connector->transactionId >= 0) {
+            transactionId = connector->transactionId;
+        } else if (!self->journal.findTransactionId(call.txRef, transactionId) || transactionId < 0) {
+            return 0;
+        }
+    }
+
+    // Écrite en flux dans le tampon de la trame : ni document, ni copie, ni allocation
+    OcppJsonWriter json(out, size);
+    json.beginObject();
+    switch (call.type) {
+        case OCPP_CALL_START_TRANSACTION:
+            json.add("connectorId", call.connectorId)
+                .add("idTag", call.idTag)
+                .add("meterStart", call.meterWh)
+                .add("timestamp", timestamp);
+            break;
+        case OCPP_CALL_STOP_TRANSACTION:
+            json.add("meterStop", call.meterWh)
+                .add("timestamp", timestamp)
+                .add("transactionId", transactionId)
+                .add("reason", OCPP_STOP_REASONS[call.stopReason]);
+            break;
+        case OCPP_CALL_METER_VALUES:
+            json.add("connectorId", call.connectorId);
+            if (transactionId >= 0) json.add("transactionId", transactionId);
+            json.beginArray("meterValue");
+            // Un meterValue par relevé du lot (même connecteur, même transaction), chacun à son heure ;
+            // toutes les grandeurs d'un relevé dans le même meterValue
+            for (size_t i = 0; i < count; ++i) {
+                const ocpp_call_t& reading = *calls[i];
+                if (i > 0) formatCallTimestamp(timestamp, sizeof(timestamp), reading);
+                json.beginObject()
+                    .add("timestamp", timestamp)
+                    .beginArray("sampledValue");
+                for (uint8_t m = 0; m < OCPP_MEASURAND_COUNT; ++m) {
+                    if (!(reading.measurands & OCPP_MEASURAND_BIT(m))) continue;
+                    const ocpp_measurand_info_t& info = OCPP_MEASURANDS[m];
+                    json.beginObject()
+                        .addDecimal("value", reading.values[m], info.decimals)
+                        .add("context", OCPP_READING_CONTEXTS[reading.readingContext])
+                        .add("measurand", info.name)
+                        .add("unit", info.unit)
+                        .endObject();
+                }
+                json.endArray().endObject();
+            }
+            json.endArray();
+            break;
+        case OCPP_CALL_STATUS_NOTIFICATION:
+            json.add("connectorId", call.connectorId)
+                .add("errorCode", strcmp(call.status, "Faulted") == 0 ? "OtherError" : "NoError")
+                .add("status", call.status)
+                .add("timestamp", timestamp);
+            break;
+        default:
+            return 0;
+    }
+    json.endObject();
+    return json.finish();
+}
+
+void OCPPWrapper::onCallResult(void* ctx, const ocpp_call_t& call, ocpp_call_result_t result, const char* payload,
+                               size_t len) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    ConnectorState* connector = call.txRef ? self->findTransaction(call.txRef) : nullptr;
+
+    int32_t transactionId = -1;
+    const char* status = "Invalid";
+    StaticJsonDocument<OCPP_RESPONSE_DOC_SIZE> doc;
+    if (result == OCPP_CALL_CONFIRMED && call.type == OCPP_CALL_START_TRANSACTION) {
+        StaticJsonDocument<96> filter;
+        filter["transactionId"] = true;
+        filter["idTagInfo"]["status"] = true;
+        filter["idTagInfo"]["expiryDate"] = true;
+        filter["idTagInfo"]["parentIdTag"] = true;
+        if (deserializeJson(doc, payload, len, DeserializationOption::Filter(filter)) != DeserializationError::Ok) {
+            LOG_ERROR("OCPP: StartTransaction.conf illisible");
+        } else {
+            transactionId = doc["transactionId"] | -1;
+            status = doc["idTagInfo"]["status"] | "Invalid";
+        }
+    }
+    // Encore dans le journal : redonné à la file après TRANSACTION_MESSAGE_RETRY_INTERVAL
+    if (!self->journal.onResult(call, result, transactionId, millis())) {
+        LOG_WARN_KV("ocpp_call_deferred", "action", OcppCallQueue::actionName(call.type), "txRef",
+                    static_cast<int>(call.txRef), "seq", static_cast<int>(call.journalSeq));
+        return;
+    }
+
+    if (result != OCPP_CALL_CONFIRMED) {
+        LOG_WARN_KV("ocpp_call_failed", "action", OcppCallQueue::actionName(call.type), "connectorId",
+                    static_cast<int>(call.connectorId), "txRef", static_cast<int>(call.txRef), "result",
+                    static_cast<int>(result));
+        // Transaction abandonnée : ses messages suivants seront abandonnés à leur tour (writePayload)
+        if (connector && (call.type == OCPP_CALL_START_TRANSACTION || call.type == OCPP_CALL_STOP_TRANSACTION)) {
+            connector->txRef = 0;
+            connector->transactionId = -1;
+            connector->stopping = false;
+            self->applyPendingAvailability(call.connectorId);
+        }
+        return;
+    }
+
+    if (call.type == OCPP_CALL_START_TRANSACTION) {
+        LOG_INFO_KV("tx_started", "connectorId", static_cast<int>(call.connectorId), "transactionId",
+                    static_cast<int>(transactionId), "idTagStatus", status);
+        // Décision du serveur mémorisée : le prochain passage du badge se passe de lui
+        ocpp_auth_entry_t entry;
+        self->applyAuthConfig();
+        if (readIdTagInfo(call.idTag, doc["idTagInfo"].as<JsonObjectConst>(), entry)) self->authStore.cache(entry);
+        if (!connector) return;   // Transaction d'avant le redémarrage
+        connector->transactionId = transactionId;
+        if (strcmp(status, "Accepted") != 0) {
+            // Transaction refusée : jamais annoncée. StopTransactionOnInvalidId (vrai par défaut) l'arrête
+            // aussitôt, sinon elle reste ouverte sans énergie jusqu'à l'arrêt local
+            LOG_WARN("OCPP: idTag %s refusé par le serveur (%s)", connector->idTag, status);
+            const char* stopOnInvalid = self->getConfiguration("StopTransactionOnInvalidId");
+            if (!stopOnInvalid || strcmp(stopOnInvalid, "false") != 0) {
+                self->stopTransaction(call.connectorId, OCPP_STOP_DEAUTHORIZED);
+            } else {
+                self->connectorStates.handle(call.connectorId, OCPP_EVENT_EVSE_SUSPEND, millis());
+            }
+            return;
+        }
+        self->handleTransaction(connector->transactionId, connector->idTag);
+    } else if (call.type == OCPP_CALL_STOP_TRANSACTION) {
+        LOG_INFO_KV("tx_stopped", "connectorId", static_cast<int>(call.connectorId), "txRef",
+                    static_cast<int>(call.txRef), "meterStop", static_cast<int>(call.meterWh));
+        if (!connector) return;
+        connector->txRef = 0;
+        connector->transactionId = -1;
+        connector->stopping = false;
+    }
+}
+
+// ============================================================================
+// AUTORISATIONS LOCALES (CALL DU SERVEUR)
+// ============================================================================
+
+// `[3,"<uniqueId>",{payload}]`, directement sur le WebSocket
+bool OCPPWrapper::replyResult(const ocpp_frame_t& frame, const char* payload) {
+    char reply[OCPP_DISPATCH_ERROR_SIZE];
+    int len = snprintf(reply, sizeof(reply), "[3,\"%.*s\",%s]", static_cast<int>(frame.uniqueId.len),
+                       frame.uniqueId.data, payload);
+    if (len < 0 || static_cast<size_t>(len) >= sizeof(reply)) return false;
+    return transport && transport->sendOwn(reply, static_cast<size_t>(len));
+}
+
+bool OCPPWrapper::onSendLocalList(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    // Plus de SendLocalListMaxLength entrées : trop gros pour le document, jamais confié à MicroOCPP
+    // (sa propre liste divergerait de l'OcppAuthStore)
+    if (payload.isNull()) {
+        LOG_WARN("OCPP: SendLocalList de %u octets trop gros (SendLocalListMaxLength %d) : Failed",
+                 static_cast<unsigned>(frame.payload.len), OCPP_SEND_LOCAL_LIST_MAX_LENGTH);
+        self->replyResult(frame, "{\"status\":\"Failed\"}");
+        return true;
+    }
+    int32_t version = payload["listVersion"] | 0;
+    bool full = strcmp(payload["updateType"] | "", "Full") == 0;
+    JsonArrayConst list = payload["localAuthorizationList"].as<JsonArrayConst>();
+
+    // Entrée par entrée, sans copie de la liste ; un échec laisse la version à 0
+    ocpp_list_update_status_t status = OCPP_LIST_UPDATE_FAILED;
+    if (list.size() <= OCPP_LOCAL_LIST_MAX_LENGTH) status = self->authStore.beginListUpdate(version, full);
+    if (status == OCPP_LIST_UPDATE_ACCEPTED) {
+        bool ok = true;
+        for (JsonVariantConst item : list) {
+            const char* idTag = item["idTag"] | "";
+            JsonObjectConst info = item["idTagInfo"].as<JsonObjectConst>();
+            ocpp_auth_entry_t entry;
+            if (info.isNull()) {
+                // Sans IdTagInfo : retiré de la liste (mise à jour différentielle)
+                ok = self->authStore.removeListEntry(idTag);
+            } else {
+                ok = readIdTagInfo(idTag, info, entry) && self->authStore.putListEntry(entry);
+            }
+            if (!ok) break;
+        }
+        status = self->authStore.endListUpdate(ok);
+    }
+    LOG_INFO("OCPP: SendLocalList %s v%ld, %u entrée(s) : %s", full ? "Full" : "Differential",
+             static_cast<long>(version), static_cast<unsigned>(list.size()), OCPP_LIST_UPDATE_STATUS_NAMES[status]);
+
+    char reply[32];
+    snprintf(reply, sizeof(reply), "{\"status\":\"%s\"}", OCPP_LIST_UPDATE_STATUS_NAMES[status]);
+    self->replyResult(frame, reply);
+    return true;
+}
+
+bool OCPPWrapper::onGetLocalListVersion(void* ctx, const ocpp_frame_t& frame, JsonObjectConst) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    char reply[32];
+    snprintf(reply, sizeof(reply), "{\"listVersion\":%ld}", static_cast<long>(self->authStore.getListVersion()));
+    self->replyResult(frame, reply);
+    return true;
+}
+
+bool OCPPWrapper::onClearCache(void* ctx, const ocpp_frame_t& frame, JsonObjectConst) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    bool cleared = self->authStore.clearCache();
+    self->replyResult(frame, cleared ? "{\"status\":\"Accepted\"}" : "{\"status\":\"Rejected\"}");
+    return true;
+}
+
+// ============================================================================
+// COMMANDES DU SERVEUR SUR LES TRANSACTIONS
+// ============================================================================
+
+// MicroOCPP ne connaît pas nos transactions : il refuserait un transactionId du wrapper et ouvrirait
+// des transactions que le wrapper ignore. Ces CALL sont donc traités ici.
+
+bool OCPPWrapper::onRemoteStartTransaction(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    const char* idTag = payload["idTag"] | "";
+    // Sans connectorId : le premier connecteur libre ; chargingProfile n'est pas appliqué
+    int connectorId = payload["connectorId"] | 0;
+    if (!payload.isNull() && payload["connectorId"].isNull()) {
+        for (int id = 1; id <= MAX_CONNECTORS && connectorId == 0; ++id) {
+            ocpp_connector_status_t status = self->connectorStates.getStatus(static_cast<uint8_t>(id));
+            if (self->connectors[id].txRef == 0 && status != OCPP_STATUS_UNAVAILABLE && status != OCPP_STATUS_FAULTED) {
+                connectorId = id;
+            }
+        }
+    }
+    // Même chemin qu'un badge local : idTag connu et refusé, connecteur occupé ou indisponible : Rejected
+    bool accepted = *idTag && self->startTransaction(connectorId, idTag) > 0;
+    LOG_INFO("OCPP: RemoteStartTransaction connecteur %d, idTag %s : %s", connectorId, idTag,
+             accepted ? "Accepted" : "Rejected");
+    self->replyResult(frame, accepted ? "{\"status\":\"Accepted\"}" : "{\"status\":\"Rejected\"}");
+    if (accepted) self->handleCommand(connectorId, OCPP_ACTION_REMOTE_START_TRANSACTION);
+    return true;
+}
+
+bool OCPPWrapper::onRemoteStopTransaction(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    int32_t transactionId = payload["transactionId"] | -1;
+    int connectorId = 0;
+    for (int id = 1; id <= MAX_CONNECTORS && transactionId >= 0; ++id) {
+        const ConnectorState& connector = self->connectors[id];
+        if (connector.txRef != 0 && connector.transactionId == transactionId) {
+            connectorId = id;
+            break;
+        }
+    }
+    bool accepted = connectorId != 0 && self->stopTransaction(connectorId, OCPP_STOP_REMOTE);
+    LOG_INFO("OCPP: RemoteStopTransaction %ld : %s", static_cast<long>(transactionId),
+             accepted ? "Accepted" : "Rejected");
+    self->replyResult(frame, accepted ? "{\"status\":\"Accepted\"}" : "{\"status\":\"Rejected\"}");
+    if (accepted) self->handleCommand(connectorId, OCPP_ACTION_REMOTE_STOP_TRANSACTION);
+    return true;
+}
+
+bool OCPPWrapper::onChangeAvailability(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    int connectorId = payload["connectorId"] | -1;
+    bool operative = strcmp(payload["type"] | "", "Operative") == 0;
+    const char* status = "Rejected";
+    if (connectorId >= 0 && connectorId <= MAX_CONNECTORS) {
+        // Connecteur 0 : le Charge Point et tous ses connecteurs
+        int last = connectorId == 0 ? MAX_CONNECTORS : connectorId;
+        bool scheduled = false;
+        bool applied = true;
+        for (int id = connectorId; id <= last; ++id) {
+            ConnectorState& connector = self->connectors[id];
+            uint8_t stateId = static_cast<uint8_t>(id);
+            // Inoperative pendant une transaction : appliqué à son arrêt (Scheduled)
+            connector.inoperativePending = !operative && connector.txRef != 0 && !connector.stopping;
+            if (connector.inoperativePending) {
+                scheduled = true;
+            } else if (!operative || self->connectorStates.getStatus(stateId) == OCPP_STATUS_UNAVAILABLE) {
+                applied &= self->connectorStates.handle(stateId, operative ? OCPP_EVENT_ENABLE : OCPP_EVENT_DISABLE,
+                                                        millis());
+            }
+        }
+        status = scheduled ? "Scheduled" : applied ? "Accepted" : "Rejected";
+    }
+    LOG_INFO("OCPP: ChangeAvailability connecteur %d %s : %s", connectorId, operative ? "Operative" : "Inoperative",
+             status);
+    char reply[32];
+    snprintf(reply, sizeof(reply), "{\"status\":\"%s\"}", status);
+    self->replyResult(frame, reply);
+    if (strcmp(status, "Rejected") != 0) self->handleCommand(connectorId, OCPP_ACTION_CHANGE_AVAILABILITY);
+    return true;
+}
+
+bool OCPPWrapper::onReset(void* ctx, const ocpp_frame_t&, JsonObjectConst payload) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    bool hard = strcmp(payload["type"] | "", "Hard") == 0;
+    for (int id = 1; id <= MAX_CONNECTORS; ++id) {
+        self->stopTransaction(id, hard ? OCPP_STOP_HARD_RESET : OCPP_STOP_SOFT_RESET);
+    }
+    // StopTransaction sur la flash avant le redémarrage : rejoué au boot suivant
+    self->journal.commit();
+    self->handleCommand(0, OCPP_ACTION_RESET);
+    return false;   // Réponse et redémarrage : MicroOCPP
+}
+
+bool OCPPWrapper::onUnlockConnector(void* ctx, const ocpp_frame_t&, JsonObjectConst payload) {
+    OCPPWrapper* self = static_cast<OCPPWrapper*>(ctx);
+    int connectorId = payload["connectorId"] | 0;
+    if (connectorId >= 1 && connectorId <= MAX_CONNECTORS) {
+        self->stopTransaction(connectorId, OCPP_STOP_UNLOCK_COMMAND);
+        self->handleCommand(connectorId, OCPP_ACTION_UNLOCK_CONNECTOR);
+    }
+    return false;   // Déverrouillage et réponse : MicroOCPP
+}
+
+// Inoperative reçu pendant la transaction : appliqué une fois celle-ci arrêtée ou abandonnée
+void OCPPWrapper::applyPendingAvailability(uint8_t connectorId) {
+    ConnectorState& connector = connectors[connectorId];
+    if (!connector.inoperativePending) return;
+    connector.inoperativePending = false;
+    connectorStates.handle(connectorId, OCPP_EVENT_DISABLE, millis());
+}
+
+// ============================================================================
+// RÉPONSES AUX CALL DE MICROOCPP
+// ============================================================================
+
+void OCPPWrapper::handleServerResponse(ocpp_action_t action, const ocpp_text_t& payloadText) {
+    bool boot = action == OCPP_ACTION_BOOT_NOTIFICATION;
+    if (!boot && action != OCPP_ACTION_HEARTBEAT) return;
+
+    // Seule la charge utile est lue, et seulement les champs utiles
+    StaticJsonDocument<64> filter;
+    filter["currentTime"] = true;
+    filter["status"] = true;
+    StaticJsonDocument<OCPP_RESPONSE_DOC_SIZE> doc;
+    if (deserializeJson(doc, payloadText.data, payloadText.len, DeserializationOption::Filter(filter)) !=
+        DeserializationError::Ok) {
+        return;
+    }
+    JsonObject payload = doc.as<JsonObject>();
+
+    // Heure du serveur : horodatage des logs et des charges utiles
+    const char* currentTime = payload["currentTime"];
+    if (currentTime && !LogClock::setFromIso8601(currentTime)) {
+        LOG_WARN("OCPP: currentTime invalide (%s)", currentTime);
+    }
+    if (boot) {
+        const char* status = payload["status"] | "";
+        bool accepted = strcmp(status, "Accepted") == 0;
+        // Statut de chaque connecteur signalé après chaque BootNotification accepté (OCPP 1.6 §4.2)
+        if (accepted && !bootAccepted) connectorStates.reportAll(millis());
+        bootAccepted = accepted;
+        LOG_INFO("OCPP: BootNotification %s", status);
+    }
+}
+
+OCPPWrapper::ConnectorState* OCPPWrapper::findTransaction(uint16_t txRef) {
+    for (ConnectorState& connector : connectors) {
+        if (connector.txRef == txRef) return &connector;
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// CALLBACKS ET CONFIGURATION
+// ============================================================================
+
+void OCPPWrapper::setLogCallback(LogCallback callback) {
+    logCallback = callback;
+}
+
+void OCPPWrapper::setStatusCallback(StatusCallback callback) {
+    statusCallback = callback;
+}
+
+void OCPPWrapper::setTransactionCallback(TransactionCallback callback) {
+    transactionCallback = callback;
+}
+
+void OCPPWrapper::setCommandCallback(CommandCallback callback) {
+    commandCallback = callback;
+}
+
+const char* OCPPWrapper::getConfiguration(const char* key) {
+    if (!initialized || !key) return nullptr;
+    MicroOcpp::Configuration* config = MicroOcpp::getConfigurationPublic(key);
+    if (!config) return nullptr;
+    switch (config->getType()) {
+        case MicroOcpp::TConfig::Int:
+            snprintf(configValue, sizeof(configValue), "%d", config->getInt());
+            return configValue;
+        case MicroOcpp::TConfig::Bool:
+            return config->getBool() ? "true" : "false";
+        case MicroOcpp::TConfig::String:
+            return config->getString();
+    }
+    return nullptr;
+}
+
+bool OCPPWrapper::setConfiguration(const char* key, const char* value) {
+    if (!initialized || !key || !value) return false;
+    MicroOcpp::Configuration* config = MicroOcpp::getConfigurationPublic(key);
+    if (!config) return false;
+    switch (config->getType()) {
+        case MicroOcpp::TConfig::Int: {
+            char* end = nullptr;
+            long number = strtol(value, &end, 10);
+            if (end == value || *end != '\0') return false;
+            config->setInt(static_cast<int>(number));
+            break;
+        }
+        case MicroOcpp::TConfig::Bool:
+            if (strcmp(value, "true") != 0 && strcmp(value, "false") != 0) return false;
+            config->setBool(strcmp(value, "true") == 0);
+            break;
+        case MicroOcpp::TConfig::String:
+            if (!config->setString(value)) return false;
+            break;
+    }
+    return MicroOcpp::configuration_save();
+}
+
+void OCPPWrapper::setMeterValuesBatching(uint8_t maxReadings, uint32_t windowMs) {
+    callQueue.setMeterValuesBatch(maxReadings, windowMs);
+}
+
+void OCPPWrapper::printQueueStats(Print& out) const {
+    ocpp_wrapper_stats_t stats;
+    fillStats(stats);
+    for (uint8_t line = 0; printStatsLine(stats, line, out); ++line) {
+    }
+}
+
+void OCPPWrapper::requestStats() {
+    if (!initialized) {
+        fillStats(statsSnapshot);
+        statsState.store(STATS_READY, std::memory_order_release);
+        return;
+    }
+    statsState.store(STATS_REQUESTED, std::memory_order_release);
+}
+
+bool OCPPWrapper::takeStats(ocpp_wrapper_stats_t& out) {
+    if (statsState.load(std::memory_order_acquire) != STATS_READY) return false;
+    out = statsSnapshot;
+    statsState.store(STATS_IDLE, std::memory_order_release);
+    return true;
+}
+
+void OCPPWrapper::fillStats(ocpp_wrapper_stats_t& out) const {
+    out.connected = connected;
+    out.bootAccepted = bootAccepted;
+    out.uptimeMs = millis();
+    out.queue = callQueue.getStats();
+    out.meter = meterSampler.getStats();
+    out.connectors = connectorStates.getStats();
+    out.microStatusSuppressed = microStatusSuppressed;
+    for (uint8_t id = 0; id <= MAX_CONNECTORS; ++id) {
+        out.status[id] = connectorStates.getStatus(id);
+    }
+    out.auth = authStore.getStats();
+    out.localListVersion = authStore.getListVersion();
+    out.journal = journal.getStats();
+}
+
+bool OCPPWrapper::printStatsLine(const ocpp_wrapper_stats_t& stats, uint8_t line, Print& out) {
+    const ocpp_queue_stats_t& queue = stats.queue;
+    switch (line) {
+        case 0:
+            out.printf("📡 OCPP: %s, BootNotification %s\n", stats.connected ? "connecté" : "déconnecté",
+                       stats.bootAccepted ? "accepté" : "en attente");
+            return true;
+        case 1:
+            out.printf("   File: %u en attente (max %u), %u en vol, %u MicroOCPP en vol\n",
+                       static_cast<unsigned>(queue.depth), static_cast<unsigned>(queue.depthMax),
+                       static_cast<unsigned>(queue.inFlight), static_cast<unsigned>(queue.foreignInFlight));
+            return true;
+        case 2:
+            out.printf("   CALL: %lu envoyés, %lu confirmés, %lu CALLERROR, %lu expirés, %lu renvois, %lu abandonnés\n",
+                       static_cast<unsigned long>(queue.sent), static_cast<unsigned long>(queue.confirmed),
+                       static_cast<unsigned long>(queue.callErrors), static_cast<unsigned long>(queue.timeouts),
+                       static_cast<unsigned long>(queue.retries), static_cast<unsigned long>(queue.dropped));
+            return true;
+        case 3:
+            out.printf("   Contre-pression: %lu refusés, %lu évincés, %lu envois MicroOCPP différés\n",
+                       static_cast<unsigned long>(queue.rejected), static_cast<unsigned long>(queue.evicted),
+                       static_cast<unsigned long>(queue.foreignDeferred));
+            return true;
+        case 4:
+            out.printf("   RTT: dernier %lu ms, min %lu, moyen %lu, max %lu\n",
+                       static_cast<unsigned long>(queue.rttLastMs), static_cast<unsigned long>(queue.rttMinMs),
+                       static_cast<unsigned long>(queue.rttAvgMs), static_cast<unsigned long>(queue.rttMaxMs));
+            return true;
+        case 5:
+            out.printf("   Relevés: %lu mesures, %lu Sample.Periodic, %lu Sample.Clock\n",
+                       static_cast<unsigned long>(stats.meter.samples),
+                       static_cast<unsigned long>(stats.meter.readings[OCPP_READING_PERIODIC]),
+                       static_cast<unsigned long>(stats.meter.readings[OCPP_READING_CLOCK]));
+            return true;
+        case 6:
+            out.printf("   MeterValues: %lu CALL pour %lu relevés (%lu relevés/h, %lu CALL/h)\n",
+                       static_cast<unsigned long>(queue.meterCalls), static_cast<unsigned long>(queue.meterReadings),
+                       static_cast<unsigned long>(perHour(queue.meterReadings, stats.uptimeMs)),
+                       static_cast<unsigned long>(perHour(queue.meterCalls, stats.uptimeMs)));
+            return true;
+        case 7:
+            out.printf("   Connecteurs:");
+            for (uint8_t id = 0; id <= MAX_CONNECTORS; ++id) {
+                out.printf(" %u=%s", static_cast<unsigned>(id), OCPP_CONNECTOR_STATUS_NAMES[stats.status[id]]);
+            }
+            out.printf(" (%lu transitions, %lu refusées, %lu StatusNotification, %lu évités, "
+                       "%lu de MicroOCPP écartés)\n",
+                       static_cast<unsigned long>(stats.connectors.transitions),
+                       static_cast<unsigned long>(stats.connectors.refused),
+                       static_cast<unsigned long>(stats.connectors.notifications),
+                       static_cast<unsigned long>(stats.connectors.collapsed),
+                       static_cast<unsigned long>(stats.microStatusSuppressed));
+            return true;
+        case 8:
+            out.printf("   Autorisations: Local List v%ld, %u badge(s), %u en cache, %lu recherches (%lu trouvées), "
+                       "%lu lectures flash, sondage max %u\n",
+                       static_cast<long>(stats.localListVersion), static_cast<unsigned>(stats.auth.listEntries),
+                       static_cast<unsigned>(stats.auth.cacheEntries), static_cast<unsigned long>(stats.auth.lookups),
+                       static_cast<unsigned long>(stats.auth.hits), static_cast<unsigned long>(stats.auth.flashReads),
+                       static_cast<unsigned>(stats.auth.maxProbe));
+            return true;
+        case 9:
+            out.printf("   Journal: %u en attente (%lu retrouvés), %lu octets, %lu écritures, %lu rejeux, "
+                       "%lu différés, %lu compactions\n",
+                       static_cast<unsigned>(stats.journal.pending),
+                       static_cast<unsigned long>(stats.journal.recovered),
+                       static_cast<unsigned long>(stats.journal.fileSize),
+                       static_cast<unsigned long>(stats.journal.commits),
+                       static_cast<unsigned long>(stats.journal.replayed),
+                       static_cast<unsigned long>(stats.journal.deferred),
+                       static_cast<unsigned long>(stats.journal.compactions));
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ============================================================================
+// MÉTHODES PRIVÉES
+// ============================================================================
+
+void OCPPWrapper::logMessage(const char* message) {
+    LOG_INFO("%s", message);
+    if (logCallback) logCallback(message);
+}
+
+void OCPPWrapper::handleStatusChange(int connectorId, const char* status) {
+    if (statusCallback) statusCallback(connectorId, status);
+}
+
+void OCPPWrapper::handleTransaction(int transactionId, const char* idTag) {
+    if (transactionCallback) transactionCallback(transactionId, idTag);
+}
+
+void OCPPWrapper::handleCommand(int connectorId, ocpp_action_t action) {
+    if (commandCallback) commandCallback(connectorId, action);
+}
@@ -9,10 +9,63 @@
  * 
  * Cette classe fournit une interface simplifiée et adaptée à nos besoins
  * pour utiliser MicroOCPP dans notre projet ESP32.
+ *
+ * MicroOCPP garde la connexion, BootNotification, Heartbeat et les opérations du serveur.
+ * StartTransaction, StopTransaction, MeterValues et StatusNotification passent par une file
+ * explicite (OcppCallQueue : priorités, contre-pression, suivi des CALL en vol). Les deux piles
+ * partagent une seule fenêtre d'envoi : la connexion fournie à MicroOCPP diffère ses CALL tant
+ * qu'un des nôtres attend sa réponse, et inversement.
+ *
+ * Statut des connecteurs : OcppConnectorStateMachine (transitions par table, StatusNotification
+ * différé de STATUS_NOTIFICATION_DEBOUNCE ms), seule source des StatusNotification : ceux de
+ * MicroOCPP sont confirmés par la connexion sans être émis. Le wrapper y applique lui-même
+ * TX_START/TX_STOP, ENABLE/DISABLE (ChangeAvailability) et ENERGY_FLOW/EV_SUSPEND (puissance des
+ * mesures pendant une transaction) ; câble et défauts viennent de l'application
+ * (handleConnectorEvent).
+ *
+ * Les messages de transaction passent d'abord par l'OcppJournal (SPIFFS) : hors ligne ou après une
+ * coupure, ils sont rejoués dans l'ordre à la reconnexion. SPIFFS doit être monté avant init().
+ *
+ * Autorisations locales : OcppAuthStore (Local List et cache, sur SPIFFS). SendLocalList,
+ * GetLocalListVersion et ClearCache sont traités ici, pas par MicroOCPP ; l'IdTagInfo de chaque
+ * StartTransaction.conf est mis en cache. LocalAuthListEnabled et AuthorizationCacheEnabled
+ * décident des entrées consultées (liste, cache) et de la mise en cache.
+ *
+ * Les transactions sont celles du wrapper, inconnues de MicroOCPP : RemoteStartTransaction,
+ * RemoteStopTransaction et ChangeAvailability sont donc traités ici. Reset et UnlockConnector
+ * arrêtent d'abord nos transactions (HardReset/SoftReset, UnlockCommand), puis MicroOCPP répond et
+ * les exécute. L'application suit ces commandes par le CommandCallback.
+ *
+ * Toutes les méthodes s'appellent depuis la tâche OCPP (SystemRuntime), sauf les getters de
+ * statistiques (lecture sans verrou : valeurs indicatives) et requestStats() / takeStats() :
+ * l'instantané de la console est pris par la tâche OCPP elle-même.
  */
 
 #include <Arduino.h>
+#include <atomic>
 #include <functional>
+#include "ocpp_auth_store.h"
+#include "ocpp_call_queue.h"
+#include "ocpp_connector_state.h"
+#include "ocpp_dispatch.h"
+#include "ocpp_journal.h"
+
+/**
+ * @brief Instantané des statistiques du wrapper (commande console `ocpp`)
+ */
+typedef struct {
+    bool connected;
+    bool bootAccepted;
+    uint32_t uptimeMs;
+    ocpp_queue_stats_t queue;
+    ocpp_meter_sampler_stats_t meter;
+    ocpp_connector_state_stats_t connectors;
+    uint32_t microStatusSuppressed;         // StatusNotification de MicroOCPP confirmés sans être émis
+    ocpp_connector_status_t status[MAX_CONNECTORS + 1];
+    ocpp_auth_store_stats_t auth;
+    int32_t localListVersion;
+    ocpp_journal_stats_t journal;
+} ocpp_wrapper_stats_t;
 
 /**
  * @brief Wrapper autour de MicroOCPP
@@ -25,6 +78,9 @@ public:
     typedef std::function<void(const char* message)> LogCallback;
     typedef std::function<void(int connectorId, const char* status)> StatusCallback;
     typedef std::function<void(int transactionId, const char* idTag)> TransactionCallback;
+    // Commande du serveur acceptée : RemoteStart/RemoteStopTransaction, ChangeAvailability,
+    // UnlockConnector, Reset (connectorId 0 : tout le Charge Point)
+    typedef std::function<void(int connectorId, ocpp_action_t action)> CommandCallback;
     
     /**
      * @brief Constructeur
@@ -56,34 +112,76 @@ public:
     bool isConnected();
     
     /**
-     * @brief Définit le statut d'un connecteur
+     * @brief Applique un événement à la machine d'états d'un connecteur
+     * @param connectorId ID du connecteur (0 : le Charge Point)
+     * @param event Événement (câble, autorisation, suspension, défaut, etc.)
+     * @return false si l'événement n'est pas prévu dans le statut courant
+     *
+     * Le StatusNotification part une fois le statut stable depuis STATUS_NOTIFICATION_DEBOUNCE ms.
+     */
+    bool handleConnectorEvent(int connectorId, ocpp_connector_event_t event);
+
+    /**
+     * @brief Impose le statut d'un connecteur, hors transitions (reprise, défaut externe)
      * @param connectorId ID du connecteur
-     * @param status Statut (Available, Preparing, Charging, etc.)
+     * @param status Statut
+     * @return false si le statut n'est pas permis pour ce connecteur
      */
-    void setConnectorStatus(int connectorId, const char* status);
+    bool setConnectorStatus(int connectorId, ocpp_connector_status_t status);
+
+    /**
+     * @brief Statut courant d'un connecteur (OCPP_STATUS_COUNT si invalide)
+     */
+    ocpp_connector_status_t getConnectorStatus(int connectorId) const;
+
+    /**
+     * @brief Autorisation locale d'un idTag (Local List, puis cache), sans aller-retour réseau
+     * (entrées de la liste si LocalAuthListEnabled, du cache si AuthorizationCacheEnabled)
+     * @param idTag Tag d'identification
+     * @param parentIdTag Reçoit le parentIdTag (ID_TAG_MAX_LENGTH + 1 octets), peut être nul
+     * @return Statut connu localement, Expired si échu ; OCPP_AUTH_STATUS_COUNT si l'idTag est
+     *         inconnu (la décision revient alors au serveur)
+     */
+    ocpp_auth_status_t authorize(const char* idTag, char* parentIdTag = nullptr);
     
     /**
      * @brief Démarre une transaction
      * @param connectorId ID du connecteur
      * @param idTag Tag d'identification
-     * @return ID de transaction ou -1 si erreur
+     * @return Référence locale de la transaction (> 0) ou -1 si erreur (connecteur occupé, indisponible
+     *         ou en défaut, file pleine, idTag connu localement et non accepté).
+     *         L'ID attribué par le serveur arrive par le TransactionCallback.
      */
     int startTransaction(int connectorId, const char* idTag);
     
     /**
      * @brief Arrête une transaction
      * @param connectorId ID du connecteur
+     * @param reason Raison du StopTransaction
      * @return true si succès, false sinon
      */
-    bool stopTransaction(int connectorId);
+    bool stopTransaction(int connectorId, ocpp_stop_reason_t reason = OCPP_STOP_LOCAL);
     
     /**
      * @brief Envoie des valeurs de compteur
      * @param connectorId ID du connecteur
      * @param energy Énergie en Wh
      * @param power Puissance en W
+     * @return false si la file est pleine (l'index d'énergie est tout de même mémorisé)
      */
-    void sendMeterValues(int connectorId, float energy, float power);
+    bool sendMeterValues(int connectorId, float energy, float power);
+
+    /**
+     * @brief Ajoute une mesure à l'échantillonnage des MeterValues (OcppMeterSampler)
+     *
+     * Un seul MeterValues par MeterValueSampleInterval (Sample.Periodic) et par frontière de
+     * ClockAlignedDataInterval (Sample.Clock), avec toutes les grandeurs de MeterValuesSampledData /
+     * MeterValuesAlignedData, au lieu d'un message par mesure.
+     * @param connectorId ID du connecteur (0 : compteur général)
+     * @param sample Mesure, horodatée en uptime
+     * @return false si le connecteur est invalide
+     */
+    bool addMeterSample(int connectorId, const ocpp_meter_sample_t& sample);
     
     /**
      * @brief Configure le callback de log
@@ -102,6 +200,12 @@ public:
      * @param callback Fonction de callback
      */
     void setTransactionCallback(TransactionCallback callback);
+
+    /**
+     * @brief Configure le callback des commandes du serveur
+     * @param callback Fonction de callback
+     */
+    void setCommandCallback(CommandCallback callback);
     
     /**
      * @brief Obtient la configuration OCPP
@@ -118,22 +222,142 @@ public:
      */
     bool setConfiguration(const char* key, const char* value);
 
+    /**
+     * @brief Statistiques de la file sortante (profondeur, RTT, renvois)
+     */
+    ocpp_queue_stats_t getQueueStats() const { return callQueue.getStats(); }
+
+    /**
+     * @brief Statistiques du journal des transactions (en attente, écritures, rejeux)
+     */
+    ocpp_journal_stats_t getJournalStats() const { return journal.getStats(); }
+
+    /**
+     * @brief Échantillonnage des MeterValues (agrégats de la fenêtre en cours, compteurs)
+     */
+    const OcppMeterSampler& getMeterSampler() const { return meterSampler; }
+
+    /**
+     * @brief Compteurs de la machine d'états des connecteurs (transitions, messages évités)
+     */
+    ocpp_connector_state_stats_t getConnectorStateStats() const { return connectorStates.getStats(); }
+
+    /**
+     * @brief Compteurs des autorisations locales (entrées, recherches, lectures de la flash)
+     */
+    ocpp_auth_store_stats_t getAuthStoreStats() const { return authStore.getStats(); }
+
+    /**
+     * @brief Regroupement des relevés d'une transaction dans un même MeterValues
+     * @param maxReadings Relevés par message (1 : un MeterValues par relevé)
+     * @param windowMs Attente maximale du premier relevé d'un lot
+     *
+     * Désactivé par défaut (METER_VALUES_BATCHING_ENABLED). Un StartTransaction ou StopTransaction du
+     * connecteur envoie le lot sans attendre.
+     */
+    void setMeterValuesBatching(uint8_t maxReadings, uint32_t windowMs);
+
+    /**
+     * @brief Affiche l'état de la connexion, de la file et du journal (tâche OCPP uniquement)
+     * @param out Destination (Serial par défaut)
+     */
+    void printQueueStats(Print& out = Serial) const;
+
+    /**
+     * @brief Demande un instantané des statistiques, pris par la tâche OCPP au prochain loop()
+     * (toute tâche ; pris sur-le-champ si init() a échoué : aucune tâche ne modifie alors l'état)
+     */
+    void requestStats();
+
+    /**
+     * @brief Récupère l'instantané demandé par requestStats() (toute tâche)
+     * @return false tant que la tâche OCPP ne l'a pas pris
+     */
+    bool takeStats(ocpp_wrapper_stats_t& out);
+
+    /**
+     * @brief Écrit la ligne `line` du rapport de printQueueStats() (une ligne par pas de console)
+     * @return false s'il n'y a pas de ligne `line`
+     */
+    static bool printStatsLine(const ocpp_wrapper_stats_t& stats, uint8_t line, Print& out);
+
 private:
+    class Transport;
+
+    // Transaction en cours sur un connecteur
+    struct ConnectorState {
+        uint16_t txRef;                       // 0 : aucune
+        int32_t transactionId;                // -1 tant que le serveur n'a pas répondu
+        bool stopping;
+        bool inoperativePending;              // ChangeAvailability Inoperative reçu pendant la transaction
+        int32_t energyWh;                     // Dernier index connu (meterStart / meterStop)
+        char idTag[ID_TAG_MAX_LENGTH + 1];
+    };
+
     // Variables privées
     char* wsUrl;
     char* chargePointId;
     bool initialized;
     bool connected;
+    bool bootAccepted;
+    Transport* transport;
+    OcppCallQueue callQueue;
+    OcppJournal journal;
+    OcppDispatcher dispatcher;
+    OcppMeterSampler meterSampler;
+    OcppConnectorStateMachine connectorStates;
+    OcppAuthStore authStore;
+    ConnectorState connectors[MAX_CONNECTORS + 1];
+    uint16_t nextTxRef;
+    uint32_t microStatusSuppressed;
+    char configValue[32];
+
+    // Instantané des statistiques : demandé par la console, pris par la tâche OCPP
+    enum StatsState : uint8_t { STATS_IDLE, STATS_REQUESTED, STATS_READY };
+    std::atomic<uint8_t> statsState;
+    ocpp_wrapper_stats_t statsSnapshot;
     
     // Callbacks
     LogCallback logCallback;
     StatusCallback statusCallback;
     TransactionCallback transactionCallback;
+    CommandCallback commandCallback;
     
     // Méthodes privées
     void logMessage(const char* message);
+    void fillStats(ocpp_wrapper_stats_t& out) const;
     void handleStatusChange(int connectorId, const char* status);
     void handleTransaction(int transactionId, const char* idTag);
+    void handleCommand(int connectorId, ocpp_action_t action);
+    void handleServerResponse(ocpp_action_t action, const ocpp_text_t& payload);
+    ConnectorState* findTransaction(uint16_t txRef);
+    void applyPendingAvailability(uint8_t connectorId);
+    bool enqueueCall(ocpp_call_type_t type, int connectorId, uint16_t txRef, int32_t meterWh,
+                     const ocpp_meter_reading_t* reading = nullptr, ocpp_stop_reason_t reason = OCPP_STOP_LOCAL);
+    bool enqueueReading(const ocpp_meter_reading_t& reading);
+    int configInt(const char* key, int fallback);
+    void applyAuthConfig();
+    static void onMeterReading(void* ctx, const ocpp_meter_reading_t& reading);
+    static bool onConnectorStatus(void* ctx, uint8_t connectorId, ocpp_connector_status_t status);
+    bool replyResult(const ocpp_frame_t& frame, const char* payload);
+
+    // CALL du serveur traités par l'aiguillage (autorisations locales)
+    static bool onSendLocalList(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+    static bool onGetLocalListVersion(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+    static bool onClearCache(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+
+    // CALL du serveur sur nos transactions : traités ici (Reset, UnlockConnector : puis transmis)
+    static bool onRemoteStartTransaction(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+    static bool onRemoteStopTransaction(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+    static bool onChangeAvailability(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+    static bool onReset(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+    static bool onUnlockConnector(void* ctx, const ocpp_frame_t& frame, JsonObjectConst payload);
+
+    // Callbacks de la file
+    static bool sendFrame(void* ctx, char* frame, size_t len);
+    static size_t writePayload(void* ctx, const ocpp_call_t* const* calls, size_t count, char* out, size_t size);
+    static void onCallResult(void* ctx, const ocpp_call_t& call, ocpp_call_result_t result, const char* payload,
+                             size_t len);
 };
 
 #endif // OCPP_WRAPPER_H
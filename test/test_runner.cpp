@@ -7,6 +7,62 @@ void test_system();
 void test_log_history_overflow();
 void test_log_level_filtering();
 void test_log_context_integrity();
+void test_log_message_truncation();
+void test_log_allocation_free_benchmark();
+void test_log_ring_overflow_policies();
+void test_log_async_p99_latency();
+void test_log_deferred_format_render();
+void test_log_deferred_format_ids();
+void test_log_deferred_format_benchmark();
+void test_log_tag_level_override();
+void test_log_compile_time_floor();
+void test_log_crash_ring_recovery();
+void test_log_utc_timestamp_formatter();
+void test_log_structured_fields();
+void test_log_storm_rate_limit();
+void test_log_multicore_stress();
+void test_console_command_dispatch();
+void test_console_streaming_output();
+void test_scheduler_deadline_order();
+void test_scheduler_drift();
+void test_runtime_task_topology();
+void test_ocpp_queue_priority_order();
+void test_ocpp_queue_backpressure();
+void test_ocpp_queue_in_flight_timeout();
+void test_ocpp_queue_shared_window();
+void test_ocpp_queue_frame_headroom();
+void test_ocpp_journal_power_cut_replay();
+void test_ocpp_frame_envelope();
+void test_ocpp_frame_parse_benchmark();
+void test_ocpp_action_lookup();
+void test_feature_profiles_validate();
+void test_ocpp_action_dispatch();
+void test_ocpp_dispatch_oversized_local_list();
+void test_ocpp_action_lookup_benchmark();
+void test_ocpp_schema_validation();
+void test_ocpp_schema_dispatch_errors();
+void test_ocpp_schema_validation_benchmark();
+void test_ocpp_json_writer_output();
+void test_ocpp_meter_values_stream_benchmark();
+void test_ocpp_meter_sampler_aggregates();
+void test_ocpp_meter_sampler_packing();
+void test_ocpp_meter_batch_flush();
+void test_ocpp_meter_batch_failure();
+void test_ocpp_meter_batch_benchmark();
+void test_ocpp_connector_state_transitions();
+void test_ocpp_connector_status_debounce();
+void test_ocpp_connector_state_benchmark();
+void test_ocpp_auth_store_lookup();
+void test_ocpp_auth_store_list_update();
+void test_ocpp_auth_store_enabled();
+void test_ocpp_auth_store_benchmark();
+void test_file_logger_block_commit();
+void test_file_logger_commit_deadline();
+void test_file_logger_write_benchmark();
+void test_file_logger_indexed_query();
+void test_file_logger_boot_markers();
+void test_log_compressor_round_trip();
+void test_file_logger_compressed_retention();
 
 void setup() {
     UNITY_BEGIN();
@@ -16,6 +72,66 @@ void setup() {
     RUN_TEST(test_log_history_overflow);
     RUN_TEST(test_log_level_filtering);
     RUN_TEST(test_log_context_integrity);
+    RUN_TEST(test_log_message_truncation);
+    RUN_TEST(test_log_allocation_free_benchmark);
+    RUN_TEST(test_log_ring_overflow_policies);
+    RUN_TEST(test_log_async_p99_latency);
+    RUN_TEST(test_log_deferred_format_render);
+    RUN_TEST(test_log_deferred_format_ids);
+    RUN_TEST(test_log_deferred_format_benchmark);
+    RUN_TEST(test_log_tag_level_override);
+    RUN_TEST(test_log_compile_time_floor);
+    RUN_TEST(test_log_crash_ring_recovery);
+    RUN_TEST(test_log_utc_timestamp_formatter);
+    RUN_TEST(test_log_structured_fields);
+    RUN_TEST(test_log_storm_rate_limit);
+    RUN_TEST(test_log_multicore_stress);
+
+    RUN_TEST(test_console_command_dispatch);
+    RUN_TEST(test_console_streaming_output);
+
+    RUN_TEST(test_scheduler_deadline_order);
+    RUN_TEST(test_scheduler_drift);
+    RUN_TEST(test_runtime_task_topology);
+
+    RUN_TEST(test_ocpp_queue_priority_order);
+    RUN_TEST(test_ocpp_queue_backpressure);
+    RUN_TEST(test_ocpp_queue_in_flight_timeout);
+    RUN_TEST(test_ocpp_queue_shared_window);
+    RUN_TEST(test_ocpp_queue_frame_headroom);
+    RUN_TEST(test_ocpp_journal_power_cut_replay);
+    RUN_TEST(test_ocpp_frame_envelope);
+    RUN_TEST(test_ocpp_frame_parse_benchmark);
+    RUN_TEST(test_ocpp_action_lookup);
+    RUN_TEST(test_feature_profiles_validate);
+    RUN_TEST(test_ocpp_action_dispatch);
+    RUN_TEST(test_ocpp_dispatch_oversized_local_list);
+    RUN_TEST(test_ocpp_action_lookup_benchmark);
+    RUN_TEST(test_ocpp_schema_validation);
+    RUN_TEST(test_ocpp_schema_dispatch_errors);
+    RUN_TEST(test_ocpp_schema_validation_benchmark);
+    RUN_TEST(test_ocpp_json_writer_output);
+    RUN_TEST(test_ocpp_meter_values_stream_benchmark);
+    RUN_TEST(test_ocpp_meter_sampler_aggregates);
+    RUN_TEST(test_ocpp_meter_sampler_packing);
+    RUN_TEST(test_ocpp_meter_batch_flush);
+    RUN_TEST(test_ocpp_meter_batch_failure);
+    RUN_TEST(test_ocpp_meter_batch_benchmark);
+    RUN_TEST(test_ocpp_connector_state_transitions);
+    RUN_TEST(test_ocpp_connector_status_debounce);
+    RUN_TEST(test_ocpp_connector_state_benchmark);
+    RUN_TEST(test_ocpp_auth_store_lookup);
+    RUN_TEST(test_ocpp_auth_store_list_update);
+    RUN_TEST(test_ocpp_auth_store_enabled);
+    RUN_TEST(test_ocpp_auth_store_benchmark);
+
+    RUN_TEST(test_file_logger_block_commit);
+    RUN_TEST(test_file_logger_commit_deadline);
+    RUN_TEST(test_file_logger_write_benchmark);
+    RUN_TEST(test_file_logger_indexed_query);
+    RUN_TEST(test_file_logger_boot_markers);
+    RUN_TEST(test_log_compressor_round_trip);
+    RUN_TEST(test_file_logger_compressed_retention);
     UNITY_END();
 }   
 
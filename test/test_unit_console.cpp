@@ -0,0 +1,171 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+
+#include "SerialConsole.h"
+
+// ============================================================================
+// FLUX SIMULÉ : entrée scriptée, UART limité à `room` octets par poll()
+// ============================================================================
+
+namespace {
+
+class MockStream : public Stream {
+public:
+    std::string input;
+    size_t inputPos = 0;
+    std::string output;
+    int room = 1 << 20;
+    size_t maxWritten = 0;     // Plus grosse écriture non bloquante reçue
+    size_t writtenThisPoll = 0;
+
+    int available() override { return static_cast<int>(input.size() - inputPos); }
+    int read() override { return inputPos < input.size() ? static_cast<uint8_t>(input[inputPos++]) : -1; }
+    int peek() override { return inputPos < input.size() ? static_cast<uint8_t>(input[inputPos]) : -1; }
+    int availableForWrite() override { return room - static_cast<int>(writtenThisPoll); }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t len) override {
+        output.append(reinterpret_cast<const char*>(data), len);
+        writtenThisPoll += len;
+        if (writtenThisPoll > maxWritten) maxWritten = writtenThisPoll;
+        return len;
+    }
+    void nextPoll() { writtenThisPoll = 0; }
+};
+
+struct CallRecord {
+    int calls = 0;
+    std::string args;
+};
+
+void recordCall(SerialConsole&, char* args, void* ctx) {
+    CallRecord* record = static_cast<CallRecord*>(ctx);
+    record->calls++;
+    record->args = args;
+}
+
+// Job de test : `total` octets numérotés, par tranches de CONSOLE_JOB_CHUNK
+class CountingJob : public ConsoleJob {
+public:
+    size_t total = 0;
+    size_t produced = 0;
+    bool cancelled = false;
+
+    bool step(Print& out) override {
+        uint8_t chunk[CONSOLE_JOB_CHUNK];
+        size_t n = total - produced < sizeof(chunk) ? total - produced : sizeof(chunk);
+        for (size_t i = 0; i < n; ++i) {
+            chunk[i] = static_cast<uint8_t>('a' + (produced + i) % 26);
+        }
+        out.write(chunk, n);
+        produced += n;
+        return produced < total;
+    }
+    void cancel() override { cancelled = true; }
+};
+
+CountingJob countingJob;
+
+void startCounting(SerialConsole& console, char* args, void*) {
+    countingJob.total = strtoul(args, nullptr, 10);
+    countingJob.produced = 0;
+    countingJob.cancelled = false;
+    console.startJob(countingJob);
+}
+
+} // namespace
+
+void test_console_command_dispatch() {
+    MockStream io;
+    SerialConsole console(io);
+    CallRecord log, logq, history;
+
+    TEST_ASSERT_TRUE(console.registerCommand("log", "", recordCall, &log));
+    TEST_ASSERT_TRUE(console.registerCommand("logq", "", recordCall, &logq));
+    TEST_ASSERT_TRUE(console.registerCommand("history", "", recordCall, &history));
+    TEST_ASSERT_FALSE(console.registerCommand("log", "", recordCall, &log));   // Nom déjà pris
+
+    // Préfixes communs, espaces en trop, CRLF et retour arrière
+    io.input = "log /log_0.jsonl\r\n  logq 10 20 WARN  \nhistoryx\b 5\nlo\nfoo bar\n\n";
+    console.poll();
+    TEST_ASSERT_EQUAL(1, log.calls);
+    TEST_ASSERT_EQUAL_STRING("/log_0.jsonl", log.args.c_str());
+    TEST_ASSERT_EQUAL(1, logq.calls);
+    TEST_ASSERT_EQUAL_STRING("10 20 WARN", logq.args.c_str());
+    TEST_ASSERT_EQUAL(1, history.calls);
+    TEST_ASSERT_EQUAL_STRING("5", history.args.c_str());
+    TEST_ASSERT_EQUAL(5, console.getStats().lines);
+    TEST_ASSERT_EQUAL(2, console.getStats().unknown);   // "lo" et "foo"
+    TEST_ASSERT_TRUE(io.output.find("foo") != std::string::npos);
+
+    // Ligne trop longue : ignorée en entier, signalée une fois
+    io.input.assign(CONSOLE_LINE_SIZE + 10, 'x');
+    io.input += "\nlog ok\n";
+    io.inputPos = 0;
+    console.poll();
+    TEST_ASSERT_EQUAL(1, console.getStats().inputOverflows);
+    TEST_ASSERT_EQUAL(2, log.calls);
+    TEST_ASSERT_EQUAL_STRING("ok", log.args.c_str());
+
+    // Table pleine
+    static char names[CONSOLE_MAX_COMMANDS][8];
+    size_t added = console.getCommandCount();
+    for (size_t i = 0; added < CONSOLE_MAX_COMMANDS; ++i, ++added) {
+        snprintf(names[i], sizeof(names[i]), "c%u", static_cast<unsigned>(i));
+        TEST_ASSERT_TRUE(console.registerCommand(names[i], "", recordCall, &log));
+    }
+    TEST_ASSERT_FALSE(console.registerCommand("extra", "", recordCall, &log));
+    TEST_ASSERT_NOT_NULL(console.findCommand("history", 7));
+    TEST_ASSERT_NOT_NULL(console.findCommand("c0", 2));
+}
+
+void test_console_streaming_output() {
+    MockStream io;
+    io.room = 64;   // ~5 ms de 115200 bauds par tour de loop()
+    SerialConsole console(io);
+    TEST_ASSERT_TRUE(console.registerCommand("dump", "", startCounting));
+
+    // 20 Ko : jamais plus de `room` octets envoyés par poll(), commande suivante mise en attente
+    const size_t total = 20000;
+    io.input = "dump 20000\ndump 10\n";
+    int polls = 0;
+    uint32_t worstUs = 0;
+    do {
+        io.nextPoll();
+        uint32_t start = micros();
+        console.poll();
+        uint32_t elapsed = micros() - start;
+        if (elapsed > worstUs) worstUs = elapsed;
+        polls++;
+    } while ((console.isBusy() || console.getOutputPending() > 0) && polls < 10000);
+
+    TEST_ASSERT_FALSE(console.isBusy());
+    TEST_ASSERT_TRUE(io.maxWritten <= 64);
+    TEST_ASSERT_EQUAL(0, console.getStats().outputStalls);
+    TEST_ASSERT_EQUAL(total + 10, io.output.size());
+    for (size_t i = 0; i < total; ++i) {
+        if (io.output[i] != static_cast<char>('a' + i % 26)) {
+            TEST_FAIL_MESSAGE("Sortie du job corrompue");
+        }
+    }
+    TEST_ASSERT_TRUE(polls >= static_cast<int>(total / 64));
+
+    // Ctrl-C : le job est interrompu, même avec des commandes tapées d'avance
+    io.output.clear();
+    io.input = "dump 100000\n";
+    io.inputPos = 0;
+    io.nextPoll();
+    console.poll();
+    TEST_ASSERT_TRUE(console.isBusy());
+    io.input += "\x03";
+    io.nextPoll();
+    console.poll();
+    TEST_ASSERT_FALSE(console.isBusy());
+    TEST_ASSERT_TRUE(countingJob.cancelled);
+    TEST_ASSERT_EQUAL(1, console.getStats().jobsCancelled);
+
+    char report[128];
+    snprintf(report, sizeof(report), "Console: %u bytes in %d polls, worst poll %lu us", static_cast<unsigned>(total),
+             polls, static_cast<unsigned long>(worstUs));
+    TEST_MESSAGE(report);
+}
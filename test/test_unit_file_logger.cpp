@@ -0,0 +1,465 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <FS.h>
+#include <FSImpl.h>
+#include <map>
+#include <memory>
+
+#include "FileLogger.h"
+#include "LogQuery.h"
+#include "LogCompressor.h"
+
+// ============================================================================
+// FS EN MÉMOIRE : compte les écritures et les flush sans toucher la flash
+// ============================================================================
+
+namespace {
+
+struct MockStore {
+    std::map<std::string, std::string> files;
+    uint32_t writeCalls = 0;
+    uint32_t flushCalls = 0;
+    uint32_t readCalls = 0;
+};
+
+class MockFileImpl : public fs::FileImpl {
+public:
+    MockFileImpl(MockStore& store, const char* path) : store(store), filePath(path) {}
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        store.writeCalls++;
+        store.files[filePath].append(reinterpret_cast<const char*>(buf), size);
+        return size;
+    }
+    size_t read(uint8_t* buf, size_t size) override {
+        store.readCalls++;
+        const std::string& data = store.files[filePath];
+        size_t n = pos < data.size() ? std::min(size, data.size() - pos) : 0;
+        memcpy(buf, data.data() + pos, n);
+        pos += n;
+        return n;
+    }
+    void flush() override { store.flushCalls++; }
+    bool seek(uint32_t offset, fs::SeekMode mode) override {
+        if (mode != fs::SeekSet || offset > store.files[filePath].size()) return false;
+        pos = offset;
+        return true;
+    }
+    size_t position() const override { return pos; }
+    size_t size() const override { return store.files.at(filePath).size(); }
+    bool setBufferSize(size_t) override { return true; }
+    void close() override { open = false; }
+    time_t getLastWrite() override { return 0; }
+    const char* path() const override { return filePath.c_str(); }
+    const char* name() const override { return filePath.c_str(); }
+    boolean isDirectory(void) override { return false; }
+    fs::FileImplPtr openNextFile(const char*) override { return fs::FileImplPtr(); }
+    boolean seekDir(long) { return false; }
+    String getNextFileName(void) { return String(); }
+    void rewindDirectory(void) override {}
+    operator bool() override { return open; }
+
+private:
+    MockStore& store;
+    std::string filePath;
+    size_t pos = 0;
+    bool open = true;
+};
+
+class MockFSImpl : public fs::FSImpl {
+public:
+    explicit MockFSImpl(MockStore& store) : store(store) {}
+
+    fs::FileImplPtr open(const char* path, const char* mode, const bool) override {
+        if (strcmp(mode, FILE_WRITE) == 0) {
+            store.files[path].clear();
+        } else if (store.files.find(path) == store.files.end()) {
+            return fs::FileImplPtr();
+        }
+        return std::make_shared<MockFileImpl>(store, path);
+    }
+    bool exists(const char* path) override {
+        return strcmp(path, "/") == 0 || store.files.find(path) != store.files.end();
+    }
+    bool rename(const char* from, const char* to) override {
+        auto it = store.files.find(from);
+        if (it == store.files.end()) return false;
+        store.files[to] = it->second;
+        store.files.erase(it);
+        return true;
+    }
+    bool remove(const char* path) override { return store.files.erase(path) > 0; }
+    bool mkdir(const char*) override { return true; }
+    bool rmdir(const char*) override { return true; }
+
+private:
+    MockStore& store;
+};
+
+} // namespace
+
+// Le bloc n'est écrit qu'une fois plein, aligné sur LOG_FILE_BLOCK_SIZE
+void test_file_logger_block_commit() {
+    MockStore store;
+    fs::FS mockFs(std::make_shared<MockFSImpl>(store));
+    FileLogger logger(".txt", mockFs);
+    TEST_ASSERT_TRUE(logger.begin());
+
+    char line[LOG_FILE_BLOCK_SIZE / 4];
+    memset(line, 'a', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';   // strlen + '\n' = LOG_FILE_BLOCK_SIZE / 4
+
+    for (int i = 0; i < 3; ++i) {
+        logger.log(line);
+    }
+    TEST_ASSERT_EQUAL(0, store.writeCalls);
+    TEST_ASSERT_EQUAL(3 * sizeof(line), logger.getPendingBytes());
+
+    logger.log(line);
+    TEST_ASSERT_EQUAL(1, store.writeCalls);
+    TEST_ASSERT_EQUAL(1, store.flushCalls);
+    TEST_ASSERT_EQUAL(LOG_FILE_BLOCK_SIZE, store.files["/log_0.txt"].size());
+
+    // flushNow() (niveau ERROR) écrit le bloc partiel ; le bloc suivant s'arrête à la frontière
+    logger.log("error");
+    logger.flushNow();
+    TEST_ASSERT_EQUAL(2, store.writeCalls);
+    logger.log(line);
+    logger.log(line);
+    logger.log(line);
+    logger.log(line);
+    TEST_ASSERT_EQUAL(3, store.writeCalls);
+    TEST_ASSERT_EQUAL(0, store.files["/log_0.txt"].size() % LOG_FILE_BLOCK_SIZE);
+
+    logger.end();
+    TEST_ASSERT_EQUAL(0, logger.getPendingBytes());
+}
+
+// Échéance : commitIfDue() n'écrit qu'au-delà de LOG_FILE_COMMIT_INTERVAL_MS
+void test_file_logger_commit_deadline() {
+    MockStore store;
+    fs::FS mockFs(std::make_shared<MockFSImpl>(store));
+    FileLogger logger(".txt", mockFs);
+    TEST_ASSERT_TRUE(logger.begin());
+
+    logger.log("pending");
+    logger.commitIfDue();
+    TEST_ASSERT_EQUAL(0, store.writeCalls);
+
+    delay(LOG_FILE_COMMIT_INTERVAL_MS + 10);
+    logger.commitIfDue();
+    TEST_ASSERT_EQUAL(1, store.writeCalls);
+    TEST_ASSERT_EQUAL_STRING("pending\n", store.files["/log_0.txt"].c_str());
+    logger.end();
+}
+
+// Benchmark : lignes/s et appels write() par ligne, rotation comprise
+void test_file_logger_write_benchmark() {
+    MockStore store;
+    fs::FS mockFs(std::make_shared<MockFSImpl>(store));
+    FileLogger logger(".txt", mockFs);
+    TEST_ASSERT_TRUE(logger.begin());
+
+    const int N = 2000;
+    char line[96];
+    uint32_t start = micros();
+    for (int i = 0; i < N; ++i) {
+        snprintf(line, sizeof(line), "[0000-00-00T00:00:01Z] [INFO] main.cpp:118 (loop): sample %d", i);
+        logger.log(line);
+        logger.commitIfDue();
+    }
+    logger.flushNow();
+    uint32_t elapsedUs = micros() - start;
+
+    FileLoggerStats stats = logger.getStats();
+    char report[128];
+    snprintf(report, sizeof(report), "FileLogger: %lu lines/s, %.3f write calls/line, %lu commits, %lu rotations",
+             (unsigned long)((uint64_t)N * 1000000 / (elapsedUs ? elapsedUs : 1)),
+             (double)store.writeCalls / N, (unsigned long)stats.commits, (unsigned long)stats.rotations);
+    TEST_MESSAGE(report);
+
+    // Une écriture par bloc au lieu de println + flush par ligne
+    TEST_ASSERT_TRUE(store.writeCalls * 4 < (uint32_t)N);
+    TEST_ASSERT_EQUAL(stats.commits, store.writeCalls);
+    logger.end();
+}
+
+// Index creux : une requête par plage de temps saute les groupes hors plage
+void test_file_logger_indexed_query() {
+    MockStore store;
+    fs::FS mockFs(std::make_shared<MockFSImpl>(store));
+    FileLogger logger(".txt", mockFs);
+    TEST_ASSERT_TRUE(logger.begin());
+
+    // 128 enregistrements (un seul fichier), un par seconde, un WARN tous les 10
+    char line[96];
+    for (uint32_t i = 0; i < 128; ++i) {
+        bool warn = (i % 10) == 0;
+        uint32_t s = i + 1;
+        int len = snprintf(line, sizeof(line), "[0000-00-00T00:%02lu:%02luZ] [%s] test.cpp:1 (f): record %lu\n",
+                           (unsigned long)(s / 60), (unsigned long)(s % 60), warn ? "WARN" : "INFO", (unsigned long)i);
+        logger.writeRecord(line, len, s * 1000, warn ? 2 : 1);
+    }
+    logger.flushNow();
+
+    struct Capture : Print {
+        String text;
+        uint32_t writes = 0;
+        size_t write(uint8_t c) override { text += (char)c; return 1; }
+        size_t write(const uint8_t* buf, size_t size) override {
+            writes++;
+            for (size_t i = 0; i < size; ++i) text += (char)buf[i];
+            return size;
+        }
+    } out;
+
+    File data = mockFs.open("/log_0.txt", FILE_READ);
+    File index = mockFs.open("/log_0.idx", FILE_READ);
+    TEST_ASSERT_TRUE(index);
+    TEST_ASSERT_EQUAL(128 / LOG_INDEX_INTERVAL * sizeof(LogIndexEntry), index.size());
+
+    // Enregistrements 60 à 99 (t = 61..100 s), niveau >= WARN : 60, 70, 80, 90
+    LogQuery query(61000, 100000, 2, false, out);
+    query.scanFile(data, index);
+    query.finish();
+    const LogQueryStats& stats = query.getStats();
+
+    TEST_ASSERT_EQUAL(4, stats.recordsMatched);
+    TEST_ASSERT_TRUE(out.text.indexOf("record 60\n") >= 0);
+    TEST_ASSERT_TRUE(out.text.indexOf("record 90\n") >= 0);
+    TEST_ASSERT_TRUE(out.text.indexOf("record 100\n") < 0);
+    TEST_ASSERT_EQUAL(1, out.writes);                       // Sortie groupée
+    TEST_ASSERT_EQUAL(4, stats.groupsScanned);              // Groupes 3 à 6 (t = 49..112 s)
+    TEST_ASSERT_EQUAL(4, stats.groupsSkipped);
+    TEST_ASSERT_TRUE(stats.bytesRead < data.size() * 3 / 4);
+
+    char report[128];
+    snprintf(report, sizeof(report), "LogQuery: %lu/%lu bytes read, %lu groups skipped, %lu read calls",
+             (unsigned long)stats.bytesRead, (unsigned long)data.size(), (unsigned long)stats.groupsSkipped,
+             (unsigned long)store.readCalls);
+    TEST_MESSAGE(report);
+
+    // Même résultat via FileLogger::query (tous les fichiers)
+    Capture all;
+    TEST_ASSERT_EQUAL(4, logger.query(61000, 100000, 2, all));
+
+    // Forme reprenable (console `logq`) : même sortie, au plus un tampon par pas
+    Capture stepped;
+    LogQueryCursor cursor(61000, 100000, 2, false, stepped);
+    while (logger.queryStep(cursor)) {
+        size_t before = stepped.text.length();
+        cursor.finish();
+        TEST_ASSERT_TRUE(stepped.text.length() - before <= LOG_QUERY_CHUNK_SIZE);
+    }
+    TEST_ASSERT_EQUAL(4, cursor.getStats().recordsMatched);
+    TEST_ASSERT_TRUE(stepped.text == all.text);
+    logger.end();
+}
+
+// Deux boots dans le même fichier, mêmes uptimes : la requête ne garde que les enregistrements
+// qui suivent le marqueur du boot demandé
+void test_file_logger_boot_markers() {
+    MockStore store;
+    fs::FS mockFs(std::make_shared<MockFSImpl>(store));
+    FileLogger logger(".txt", mockFs);
+    TEST_ASSERT_TRUE(logger.begin());
+
+    char line[96];
+    const uint32_t boots[] = { 0x0000000a, 0x0000000b };
+    for (uint32_t boot : boots) {
+        int len = snprintf(line, sizeof(line), "[boot %08lx]\n", (unsigned long)boot);
+        logger.writeMarker(line, len);
+        for (uint32_t s = 1; s <= 40; ++s) {
+            len = snprintf(line, sizeof(line), "[0000-00-00T00:00:%02luZ] [INFO] f.cpp:1 (f): boot %lx record %lu\n",
+                           (unsigned long)s, (unsigned long)boot, (unsigned long)s);
+            logger.writeRecord(line, len, s * 1000, 1);
+        }
+    }
+    logger.flushNow();
+
+    struct Capture : Print {
+        String text;
+        size_t write(uint8_t c) override { text += (char)c; return 1; }
+        size_t write(const uint8_t* buf, size_t size) override {
+            for (size_t i = 0; i < size; ++i) text += (char)buf[i];
+            return size;
+        }
+    };
+
+    // Boot courant seulement ; les groupes de l'autre boot hors plage sont sautés sans perdre le marqueur
+    Capture current;
+    TEST_ASSERT_EQUAL(10, logger.query(31000, 40000, 0, current, 0x0000000b));
+    TEST_ASSERT_TRUE(current.text.indexOf("boot b record 31\n") >= 0);
+    TEST_ASSERT_TRUE(current.text.indexOf("boot a ") < 0);
+    TEST_ASSERT_TRUE(current.text.indexOf("[boot ") < 0);
+
+    // Forme reprenable, boot précédent
+    Capture previous;
+    LogQueryCursor cursor(31000, 40000, 0, false, previous, 0x0000000a);
+    while (logger.queryStep(cursor)) cursor.finish();
+    TEST_ASSERT_EQUAL(10, cursor.getStats().recordsMatched);
+    TEST_ASSERT_TRUE(previous.text.indexOf("boot b ") < 0);
+
+    // Tous les boots : un séparateur par marqueur
+    Capture all;
+    TEST_ASSERT_EQUAL(20, logger.query(31000, 40000, 0, all, LOG_BOOT_ANY));
+    TEST_ASSERT_TRUE(all.text.indexOf("[boot 0000000a]\n") >= 0);
+    TEST_ASSERT_TRUE(all.text.indexOf("[boot 0000000b]\n") > all.text.indexOf("boot a record 40\n"));
+    logger.end();
+}
+
+// ============================================================================
+// COMPRESSION DES FICHIERS FERMÉS
+// ============================================================================
+
+namespace {
+
+struct StringSink : Print {
+    std::string data;
+    size_t write(uint8_t c) override { data += (char)c; return 1; }
+    size_t write(const uint8_t* buf, size_t size) override {
+        data.append(reinterpret_cast<const char*>(buf), size);
+        return size;
+    }
+};
+
+// Ligne de log réaliste : horodatage, niveau, fichier source et valeurs variables
+int sampleLogLine(char* line, size_t size, uint32_t i) {
+    uint32_t s = i / 4 + 1;
+    int n = snprintf(line, size, "[0000-00-00T%02lu:%02lu:%02luZ] [%s] ", (unsigned long)(s / 3600 % 24),
+                     (unsigned long)(s / 60 % 60), (unsigned long)(s % 60), (i % 16) == 0 ? "WARN" : "INFO");
+    switch (i % 4) {
+        case 0: n += snprintf(line + n, size - n, "main.cpp:118 (loop): Heartbeat: ESP32 is alive!\n"); break;
+        case 1: n += snprintf(line + n, size - n, "hardware_manager.cpp:212 (updateMeasurements): U=%lumV I=%lumA\n",
+                              (unsigned long)(229000 + (i * 37) % 2000), (unsigned long)((i * 7919) % 32000)); break;
+        case 2: n += snprintf(line + n, size - n, "ocpp_wrapper.cpp:88 (poll): WebSocket ping, rtt=%lums\n",
+                              (unsigned long)(20 + (i * 13) % 180)); break;
+        default: n += snprintf(line + n, size - n, "watchdog_manager.cpp:41 (feed): fed after %lums\n",
+                               (unsigned long)(1000 + (i * 3) % 50)); break;
+    }
+    return n;
+}
+
+} // namespace
+
+// Aller-retour LZSS : décodage par petits morceaux, taux de compression et débit
+void test_log_compressor_round_trip() {
+    std::string plain;
+    char line[160];
+    for (uint32_t i = 0; plain.size() < 8192; ++i) {
+        int len = sampleLogLine(line, sizeof(line), i);
+        plain.append(line, len);
+    }
+
+    StringSink packed;
+    uint32_t start = micros();
+    LogLzEncoder encoder(packed, plain.size());
+    for (size_t pos = 0; pos < plain.size(); pos += 100) {   // Entrée en morceaux arbitraires
+        encoder.write(reinterpret_cast<const uint8_t*>(plain.data()) + pos, std::min<size_t>(100, plain.size() - pos));
+    }
+    encoder.finish();
+    uint32_t encodeUs = micros() - start;
+    TEST_ASSERT_EQUAL(packed.data.size(), encoder.getOutputSize());
+
+    StringSink unpacked;
+    start = micros();
+    LogLzDecoder decoder(unpacked);
+    for (size_t pos = 0; pos < packed.data.size(); pos += 7) {
+        decoder.write(reinterpret_cast<const uint8_t*>(packed.data.data()) + pos, std::min<size_t>(7, packed.data.size() - pos));
+    }
+    decoder.finish();
+    uint32_t decodeUs = micros() - start;
+
+    TEST_ASSERT_TRUE(decoder.isValid());
+    TEST_ASSERT_EQUAL(plain.size(), decoder.getOriginalSize());
+    TEST_ASSERT_TRUE(plain == unpacked.data);
+    TEST_ASSERT_TRUE(packed.data.size() * 4 <= plain.size());
+
+    char report[128];
+    snprintf(report, sizeof(report), "LogCompressor: %u -> %u bytes (x%.1f), encode %lu us, decode %lu us",
+             (unsigned)plain.size(), (unsigned)packed.data.size(), (double)plain.size() / packed.data.size(),
+             (unsigned long)encodeUs, (unsigned long)decodeUs);
+    TEST_MESSAGE(report);
+
+    // Flux tronqué au milieu d'un jeton : rejeté
+    StringSink ignored;
+    LogLzDecoder truncated(ignored);
+    truncated.write(reinterpret_cast<const uint8_t*>(packed.data.data()), packed.data.size() - 1);
+    truncated.finish();
+    TEST_ASSERT_TRUE(!truncated.isValid() || ignored.data.size() < plain.size());
+}
+
+// Rotation compressée : budget en octets compressés, historique retenu et requêtes sur les archives
+void test_file_logger_compressed_retention() {
+    MockStore store;
+    fs::FS mockFs(std::make_shared<MockFSImpl>(store));
+    FileLogger logger(".txt", mockFs, true);
+    TEST_ASSERT_TRUE(logger.begin());
+
+    char line[160];
+    for (uint32_t i = 0; logger.getStats().rotations < 40; ++i) {
+        uint32_t rotations = logger.getStats().rotations;
+        int len = sampleLogLine(line, sizeof(line), i);
+        logger.writeRecord(line, len, (i / 4 + 1) * 1000, (i % 16) == 0 ? 2 : 1);
+        // Le FS simulé n'est pas partagé entre tâches : attendre la fin de la compression
+        while (logger.getStats().rotations != rotations && logger.isCompressing()) {
+            delay(1);
+        }
+    }
+    logger.flushNow();
+
+    FileLoggerStats stats = logger.getStats();
+    size_t archiveBytes = 0, plainBytes = 0, plainFiles = 0, retained = 0;
+    for (const auto& file : store.files) {
+        if (file.first.rfind("/logz_", 0) == 0) {
+            archiveBytes += file.second.size();
+            uint32_t originalSize;
+            memcpy(&originalSize, file.second.data() + 4, sizeof(originalSize));
+            retained += originalSize;
+        } else if (file.first.find(".txt") != std::string::npos) {
+            plainFiles++;
+            plainBytes += file.second.size();
+            retained += file.second.size();
+        }
+    }
+
+    TEST_ASSERT_EQUAL(1, plainFiles);                       // Seul le fichier courant reste en clair
+    TEST_ASSERT_EQUAL(stats.archiveBytes, archiveBytes);
+    TEST_ASSERT_TRUE(archiveBytes <= LOG_ARCHIVE_BUDGET);
+    TEST_ASSERT_TRUE(logger.getFirstArchive() > 0);         // Le budget a purgé les plus anciennes
+    TEST_ASSERT_TRUE(retained >= 4 * 5 * 8192);             // >= 4x l'ancien plafond de 5 x 8 Ko
+
+    char report[128];
+    snprintf(report, sizeof(report), "Compressed retention: %u plain bytes in %u bytes (%lu archives kept)",
+             (unsigned)retained, (unsigned)(archiveBytes + plainBytes),
+             (unsigned long)(logger.getNextArchive() - logger.getFirstArchive()));
+    TEST_MESSAGE(report);
+
+    // Les archives sont interrogées par décompression à la volée
+    StringSink out;
+    File oldest = mockFs.open(logger.getArchiveFileName(logger.getFirstArchive()), FILE_READ);
+    StringSink oldestText;
+    TEST_ASSERT_TRUE(LogCompressor::decompress(oldest, oldestText));
+    TEST_ASSERT_EQUAL(0, oldestText.data.find("[0000-00-00T"));
+    unsigned long h, m, sec;
+    TEST_ASSERT_EQUAL(3, sscanf(oldestText.data.c_str(), "[0000-00-00T%lu:%lu:%luZ]", &h, &m, &sec));
+    uint32_t firstSecond = (h * 60 + m) * 60 + sec;
+    TEST_ASSERT_TRUE(logger.query(firstSecond * 1000, firstSecond * 1000, 0, out) >= 1);
+    TEST_ASSERT_EQUAL(0, out.data.find(oldestText.data.substr(0, oldestText.data.find('\n') + 1)));
+
+    // Forme reprenable sur les archives et les fichiers : même sortie que query(), par pas bornés
+    StringSink whole;
+    StringSink stepped;
+    size_t matched = logger.query(0, UINT32_MAX, 0, whole);
+    LogQueryCursor cursor(0, UINT32_MAX, 0, false, stepped);
+    size_t largestStep = 0;
+    while (logger.queryStep(cursor)) {
+        size_t before = stepped.data.size();
+        cursor.finish();
+        largestStep = std::max(largestStep, stepped.data.size() - before);
+    }
+    TEST_ASSERT_EQUAL(matched, cursor.getStats().recordsMatched);
+    TEST_ASSERT_TRUE(whole.data == stepped.data);
+    TEST_ASSERT_TRUE(largestStep <= LOG_QUERY_CHUNK_SIZE);
+    logger.end();
+}
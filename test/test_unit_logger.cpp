@@ -1,8 +1,11 @@
 #include <Arduino.h>
 #include <unity.h>
 #include <SPIFFS.h>
+#include <esp_heap_caps.h>
+#include <atomic>
 
 #include "FileLogger.h"
+#include "LogSink.h"
 
 
 #include "../features/infra/logging/log_macros.h" // Pour les macros LOG_DEBUG
@@ -19,8 +22,8 @@ void test_log_history_overflow() {
     TEST_ASSERT_EQUAL(N, logger.getHistoryCount());
 
     size_t firstIdx = logger.getHistoryHead();
-    String realMsg = logger.getHistoryEntry(firstIdx).message;
-    TEST_ASSERT_TRUE(realMsg.indexOf("Log 5") != -1);
+    const char* realMsg = logger.getHistoryEntry(firstIdx).message;
+    TEST_ASSERT_TRUE(strstr(realMsg, "Log 5") != nullptr);
 }
 
 void test_log_level_filtering() {
@@ -38,7 +41,7 @@ void test_log_level_filtering() {
     // Le log stocké doit être exactement "Info should be stored"
     size_t idx = logger.getHistoryHead();
     const LogEntry& entry = logger.getHistoryEntry(idx);
-    TEST_ASSERT_TRUE(entry.message.indexOf("Info should be stored") != -1);
+    TEST_ASSERT_TRUE(strstr(entry.message, "Info should be stored") != nullptr);
 }
 
 
@@ -53,11 +56,620 @@ void test_log_context_integrity() {
     size_t lastIdx = (logger.getHistoryHead() + logger.getHistoryCount() - 1) % Logger::LOG_HISTORY_SIZE;
     const LogEntry& entry = logger.getHistoryEntry(lastIdx);
 
-    TEST_ASSERT_TRUE(entry.file.length() > 0);
-    TEST_ASSERT_TRUE(entry.function.length() > 0);
+    TEST_ASSERT_TRUE(strlen(entry.file) > 0);
+    TEST_ASSERT_TRUE(strlen(entry.function) > 0);
     TEST_ASSERT_TRUE(entry.line > 0);
 }
 
+void test_log_message_truncation() {
+    Logger& logger = Logger::getInstance();
+    logger.clearHistory();
+    logger.setLevel(LOG_LEVEL_DEBUG);
+
+    char longMsg[LOG_MESSAGE_SIZE * 2];
+    memset(longMsg, 'x', sizeof(longMsg) - 1);
+    longMsg[sizeof(longMsg) - 1] = '\0';
+    LOG_INFO("%s", longMsg);
+
+    const LogEntry& entry = logger.getHistoryEntry(logger.getHistoryHead());
+    TEST_ASSERT_EQUAL(LOG_MESSAGE_SIZE - 1, strlen(entry.message));
+}
+
+// Benchmark : allocations heap et coût d'un LOG_INFO (sortie série coupée pour ne mesurer que le logger)
+void test_log_allocation_free_benchmark() {
+    Logger& logger = Logger::getInstance();
+    logger.clearHistory();
+    logger.setLevel(LOG_LEVEL_INFO);
+    logger.setSerialEnabled(false);
+
+    const int N = 1000;
+    multi_heap_info_t before, after;
+    heap_caps_get_info(&before, MALLOC_CAP_8BIT);
+
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        LOG_INFO("Benchmark %d: connector=%d power=%.1f", i, 1, 7.4f);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    heap_caps_get_info(&after, MALLOC_CAP_8BIT);
+    logger.setSerialEnabled(true);
+
+    uint32_t nsPerLog = (uint32_t)((uint64_t)cycles * 1000 / getCpuFrequencyMhz() / N);
+    char report[128];
+    snprintf(report, sizeof(report), "LOG_INFO: %lu ns/call, heap blocks delta=%d, bytes delta=%d",
+             (unsigned long)nsPerLog,
+             (int)after.allocated_blocks - (int)before.allocated_blocks,
+             (int)after.total_allocated_bytes - (int)before.total_allocated_bytes);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_EQUAL(before.allocated_blocks, after.allocated_blocks);
+    TEST_ASSERT_EQUAL(before.total_allocated_bytes, after.total_allocated_bytes);
+    TEST_ASSERT_EQUAL(Logger::LOG_HISTORY_SIZE, logger.getHistoryCount());
+}
+
+void test_log_ring_overflow_policies() {
+    static LogRing<int, 8> ring;
+    int value = 0;
+    while (ring.pop(value)) {}
+
+    // Drop newest : les 8 premiers sont conservés
+    for (int i = 0; i < 10; ++i) {
+        ring.push(i, LOG_OVERFLOW_DROP_NEWEST);
+    }
+    TEST_ASSERT_EQUAL(8, ring.size());
+    TEST_ASSERT_EQUAL(2, ring.getDroppedNewest());
+    TEST_ASSERT_TRUE(ring.pop(value));
+    TEST_ASSERT_EQUAL(0, value);
+
+    // Drop oldest : les plus anciens sont écrasés
+    for (int i = 100; i < 110; ++i) {
+        ring.push(i, LOG_OVERFLOW_DROP_OLDEST);
+    }
+    TEST_ASSERT_EQUAL(8, ring.size());
+    TEST_ASSERT_EQUAL(9, ring.getDroppedOldest());
+    TEST_ASSERT_TRUE(ring.pop(value));
+    TEST_ASSERT_EQUAL(102, value);
+}
+
+static int compareLatency(const void* a, const void* b) {
+    uint32_t x = *static_cast<const uint32_t*>(a);
+    uint32_t y = *static_cast<const uint32_t*>(b);
+    return (x > y) - (x < y);
+}
+
+// Latence p50/p99 d'un LOG_INFO en mode asynchrone (Serial et SPIFFS écrits par la tâche de fond)
+void test_log_async_p99_latency() {
+    Logger& logger = Logger::getInstance();
+    logger.clearHistory();
+    logger.setLevel(LOG_LEVEL_INFO);
+    TEST_ASSERT_TRUE(logger.startAsync(LOG_OVERFLOW_DROP_OLDEST));
+
+    const int N = 500;
+    static uint32_t samples[N];
+    for (int i = 0; i < N; ++i) {
+        uint32_t start = ESP.getCycleCount();
+        LOG_INFO("Async latency sample %d", i);
+        samples[i] = ESP.getCycleCount() - start;
+        if (i % 16 == 15) {
+            delay(1); // Laisse tourner la tâche de drainage
+        }
+    }
+    logger.stopAsync();
+
+    qsort(samples, N, sizeof(samples[0]), compareLatency);
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[128];
+    snprintf(report, sizeof(report), "async LOG_INFO: p50=%lu ns p99=%lu ns max=%lu ns",
+             (unsigned long)(samples[N / 2] * 1000 / mhz),
+             (unsigned long)(samples[N * 99 / 100] * 1000 / mhz),
+             (unsigned long)(samples[N - 1] * 1000 / mhz));
+    TEST_MESSAGE(report);
+
+    // Tout ce qui a été accepté est soit écrit, soit compté comme écrasé
+    LogAsyncStats stats = logger.getAsyncStats();
+    TEST_ASSERT_FALSE(logger.isAsync());
+    TEST_ASSERT_EQUAL(0, stats.depth);
+    TEST_ASSERT_EQUAL(stats.enqueued, stats.written + stats.droppedOldest);
+}
+
+// Aller-retour format différé : enregistrement du format, empaquetage des arguments, rendu texte
+void test_log_deferred_format_render() {
+    static const char* fmt = "connector=%d power=%.1f id=%s hex=%04x big=%lld";
+    uint16_t id = LogFormatRegistry::registerFormat(LOG_LEVEL_INFO, __FILE__, __LINE__, fmt);
+    TEST_ASSERT_NOT_EQUAL(LOG_FORMAT_ID_TEXT, id);
+    TEST_ASSERT_NOT_EQUAL(LOG_FORMAT_ID_UNKNOWN, id);
+    TEST_ASSERT_EQUAL(id, LogFormatRegistry::registerFormat(LOG_LEVEL_INFO, __FILE__, __LINE__, fmt));
+
+    LogBinaryRecord record;
+    record.timestamp = 0;
+    record.formatId = id;
+    record.level = LOG_BINARY_SYNC | LOG_LEVEL_INFO;
+    LogArgPacker packer(record.payload, sizeof(record.payload));
+    packer.pack(2, 7.4f, "CP-01", 0xbeefu, 1234567890123LL);
+    record.length = static_cast<uint8_t>(packer.length());
+
+    char text[LOG_MESSAGE_SIZE];
+    LogFormatRegistry::render(record, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("connector=2 power=7.4 id=CP-01 hex=beef big=1234567890123", text);
+}
+
+// ID de format = hachage du format seul : identique quel que soit l'ordre d'enregistrement ou le
+// firmware ; un format en collision n'obtient pas d'ID plutôt que d'être décodé avec un autre
+void test_log_deferred_format_ids() {
+    // "collision 45" et "collision 207" ont le même hachage (cf. scripts/check_log_formats.py)
+    static const char* first = "collision 45";
+    static const char* second = "collision 207";
+    size_t collisions = LogFormatRegistry::getCollisions();
+    uint16_t id = LogFormatRegistry::registerFormat(LOG_LEVEL_WARNING, "src/module/site.cpp", 12, first);
+    TEST_ASSERT_EQUAL(8796, id);
+    TEST_ASSERT_EQUAL(LOG_FORMAT_ID_UNKNOWN,
+                      LogFormatRegistry::registerFormat(LOG_LEVEL_WARNING, "src/module/site.cpp", 13, second));
+    TEST_ASSERT_EQUAL(collisions + 1, LogFormatRegistry::getCollisions());
+    TEST_ASSERT_EQUAL_STRING(first, LogFormatRegistry::getFormat(id));
+
+    // Enregistrement de définition écrit dans le fichier avant le premier usage du format
+    uint8_t buffer[LOG_FORMAT_DEFINITION_MAX_SIZE];
+    size_t len = LogFormatRegistry::writeDefinition(id, 1234, buffer, sizeof(buffer));
+    const char* expected = "2\tsite.cpp:12\tcollision 45";
+    TEST_ASSERT_EQUAL(LOG_BINARY_HEADER_SIZE + strlen(expected), len);
+    LogBinaryRecord header;
+    memcpy(&header, buffer, LOG_BINARY_HEADER_SIZE);
+    TEST_ASSERT_EQUAL(1234, header.timestamp);
+    TEST_ASSERT_EQUAL(id, header.formatId);
+    TEST_ASSERT_EQUAL(LOG_BINARY_SYNC | LOG_BINARY_DEFINITION, header.level);
+    TEST_ASSERT_EQUAL_MEMORY(expected, buffer + LOG_BINARY_HEADER_SIZE, strlen(expected));
+    TEST_ASSERT_EQUAL(0, LogFormatRegistry::writeDefinition(LOG_FORMAT_ID_UNKNOWN, 0, buffer, sizeof(buffer)));
+}
+
+// Coût d'un appel différé (empaquetage seul) comparé à un LOG_INFO formaté avec vsnprintf
+void test_log_deferred_format_benchmark() {
+    Logger& logger = Logger::getInstance();
+    logger.clearHistory();
+    logger.setLevel(LOG_LEVEL_INFO);
+    logger.setSerialEnabled(false);
+    TEST_ASSERT_TRUE(logger.startAsync(LOG_OVERFLOW_DROP_OLDEST));
+
+    static const char* fmt = "Benchmark %d: connector=%d power=%.1f";
+    uint16_t id = LogFormatRegistry::registerFormat(LOG_LEVEL_INFO, __FILE__, __LINE__, fmt);
+    const int N = 200;
+
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        logger.log(LOG_LEVEL_INFO, __FILE__, __FUNCTION__, __LINE__, fmt, i, 1, 7.4f);
+    }
+    uint32_t textCycles = ESP.getCycleCount() - start;
+    delay(LOG_ASYNC_FLUSH_INTERVAL_MS * 2);
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        logger.logDeferred(LOG_LEVEL_INFO, id, i, 1, 7.4f);
+    }
+    uint32_t deferredCycles = ESP.getCycleCount() - start;
+
+    logger.stopAsync();
+    logger.setSerialEnabled(true);
+
+    char report[128];
+    snprintf(report, sizeof(report), "LOG_INFO text: %lu cycles/call, deferred: %lu cycles/call",
+             (unsigned long)(textCycles / N), (unsigned long)(deferredCycles / N));
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_TRUE(deferredCycles < textCycles);
+    const LogEntry& last = logger.getHistoryEntry((logger.getHistoryHead() + logger.getHistoryCount() - 1) % Logger::LOG_HISTORY_SIZE);
+    TEST_ASSERT_TRUE(strstr(last.message, "power=7.4") != nullptr);
+}
+
+// Surcharge de niveau par module : "hardware" en DEBUG, le reste en WARN
+void test_log_tag_level_override() {
+    Logger& logger = Logger::getInstance();
+    logger.clearHistory();
+    logger.setLevel(LOG_LEVEL_WARNING);
+    TEST_ASSERT_TRUE(logger.setTagLevel("hardware", LOG_LEVEL_DEBUG));
+
+    TEST_ASSERT_TRUE(logger.isEnabled(LOG_LEVEL_DEBUG, "hardware"));
+    TEST_ASSERT_FALSE(logger.isEnabled(LOG_LEVEL_INFO, "ocpp"));
+    TEST_ASSERT_FALSE(logger.isEnabled(LOG_LEVEL_INFO));
+
+#undef LOG_TAG
+#define LOG_TAG "hardware"
+    LOG_DEBUG("hardware debug");
+#undef LOG_TAG
+#define LOG_TAG "ocpp"
+    LOG_INFO("ocpp info");
+    LOG_WARN("ocpp warn");
+#undef LOG_TAG
+#define LOG_TAG nullptr
+
+    TEST_ASSERT_EQUAL(2, logger.getHistoryCount());
+    TEST_ASSERT_TRUE(strstr(logger.getHistoryEntry(logger.getHistoryHead()).message, "hardware debug") != nullptr);
+
+    logger.clearTagLevel("hardware");
+    TEST_ASSERT_FALSE(logger.isEnabled(LOG_LEVEL_DEBUG, "hardware"));
+    logger.setLevel(LOG_LEVEL_INFO);
+}
+
+static int evaluatedArgs = 0;
+static int countEvaluation() { return ++evaluatedArgs; }
+
+// Sous le plancher de compilation du module, l'appel disparaît : arguments non évalués
+void test_log_compile_time_floor() {
+    Logger& logger = Logger::getInstance();
+    logger.clearHistory();
+    logger.setLevel(LOG_LEVEL_DEBUG);
+    evaluatedArgs = 0;
+
+#undef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_LEVEL_WARNING
+    LOG_DEBUG("eliminated %d", countEvaluation());
+    LOG_INFO("eliminated %d", countEvaluation());
+    LOG_WARN("kept %d", countEvaluation());
+#undef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_COMPILE_LEVEL
+
+    TEST_ASSERT_EQUAL(1, evaluatedArgs);
+    TEST_ASSERT_EQUAL(1, logger.getHistoryCount());
+}
+
+// Anneau RTC : les WARN/ERROR d'avant un reset sont rejoués au démarrage suivant
+void test_log_crash_ring_recovery() {
+    Logger& logger = Logger::getInstance();
+    logger.setLevel(LOG_LEVEL_INFO);
+    LogCrashRing::simulateReboot();
+    LogCrashRing::clear();   // Part d'un anneau vide
+
+    LOG_INFO("not kept in RTC");
+    for (int i = 0; i < LOG_CRASH_RING_SLOTS + 4; ++i) {
+        LOG_ERROR("before reset %d", i);
+    }
+    TEST_ASSERT_EQUAL(0, LogCrashRing::pending());   // Records of this boot are not "previous run"
+
+    uint32_t boot = LogCrashRing::getBootCount();
+    LogCrashRing::simulateReboot();
+    TEST_ASSERT_EQUAL(boot + 1, LogCrashRing::getBootCount());
+    TEST_ASSERT_EQUAL(LOG_CRASH_RING_SLOTS, LogCrashRing::pending());
+
+    logger.clearHistory();
+    logger.begin(false);
+    TEST_ASSERT_EQUAL(0, LogCrashRing::pending());
+    TEST_ASSERT_EQUAL(LOG_CRASH_RING_SLOTS + 1, logger.getHistoryCount());
+
+    size_t head = logger.getHistoryHead();
+    TEST_ASSERT_TRUE(strstr(logger.getHistoryEntry(head).message, "records recovered") != nullptr);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "before reset %d", 4);   // Les 4 plus anciens sont écrasés
+    TEST_ASSERT_TRUE(strstr(logger.getHistoryEntry((head + 1) % Logger::LOG_HISTORY_SIZE).message, expected) != nullptr);
+}
+
+// Horloge UTC : formatage en cache (préfixe par minute) identique au formatage complet, et plus rapide
+void test_log_utc_timestamp_formatter() {
+    LogClock::reset();
+    LogTimestampFormatter formatter;
+    char text[LOG_TIMESTAMP_SIZE];
+
+    formatter.format(text, sizeof(text), 3723004);
+    TEST_ASSERT_EQUAL_STRING("0000-00-00T01:02:03.004Z", text);
+
+    // Passage d'une minute, d'un jour et d'un 29 février
+    TEST_ASSERT_TRUE(LogClock::setFromIso8601("2024-02-28T23:59:59.500Z", 1000));
+    formatter.format(text, sizeof(text), 1000);
+    TEST_ASSERT_EQUAL_STRING("2024-02-28T23:59:59.500Z", text);
+    formatter.format(text, sizeof(text), 1600);
+    TEST_ASSERT_EQUAL_STRING("2024-02-29T00:00:00.100Z", text);
+    formatter.format(text, sizeof(text), 1500 + 86400000);
+    TEST_ASSERT_EQUAL_STRING("2024-03-01T00:00:00.000Z", text);
+    formatter.format(text, sizeof(text), 1599);   // Retour en arrière : reconstruit
+    TEST_ASSERT_EQUAL_STRING("2024-02-29T00:00:00.099Z", text);
+
+    // Fuseau explicite (HeartbeatResponse de certains serveurs)
+    TEST_ASSERT_TRUE(LogClock::setFromIso8601("2025-01-01T02:00:00+02:00", 0));
+    formatter.format(text, sizeof(text), 61001);
+    TEST_ASSERT_EQUAL_STRING("2025-01-01T00:01:01.001Z", text);
+    TEST_ASSERT_FALSE(LogClock::setFromIso8601("not a date", 0));
+
+    // Référence : conversion complète à chaque appel (ancien coût)
+    auto reference = [](char* buf, size_t size, uint32_t uptimeMs) {
+        uint64_t unixMs = LogClock::toUnixMs(uptimeMs);
+        uint32_t msOfDay = (uint32_t)(unixMs % 86400000ULL);
+        int32_t year;
+        uint32_t month, day;
+        LogClock::civilFromDays((int32_t)(unixMs / 86400000ULL), year, month, day);
+        snprintf(buf, size, "%04ld-%02lu-%02luT%02lu:%02lu:%02lu.%03luZ", (long)year, (unsigned long)month,
+                 (unsigned long)day, (unsigned long)(msOfDay / 3600000), (unsigned long)(msOfDay / 60000 % 60),
+                 (unsigned long)(msOfDay / 1000 % 60), (unsigned long)(msOfDay % 1000));
+    };
+
+    const int N = 1000;
+    char expected[LOG_TIMESTAMP_SIZE];
+    uint32_t uptime = 0;
+    for (int i = 0; i < N; ++i) {
+        uptime += 37 + (i % 7) * 211;   // Franchit plusieurs minutes
+        formatter.format(text, sizeof(text), uptime);
+        reference(expected, sizeof(expected), uptime);
+        TEST_ASSERT_EQUAL_STRING(expected, text);
+    }
+
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        reference(expected, sizeof(expected), uptime + i * 13);
+    }
+    uint32_t referenceCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        formatter.format(text, sizeof(text), uptime + i * 13);
+    }
+    uint32_t cachedCycles = ESP.getCycleCount() - start;
+
+    char report[128];
+    snprintf(report, sizeof(report), "Timestamp: full %lu cycles/call, cached %lu cycles/call",
+             (unsigned long)(referenceCycles / N), (unsigned long)(cachedCycles / N));
+    TEST_MESSAGE(report);
+    TEST_ASSERT_TRUE(cachedCycles * 4 < referenceCycles);
+
+    // Les entrées du logger portent l'heure UTC
+    Logger& logger = Logger::getInstance();
+    logger.setLevel(LOG_LEVEL_INFO);
+    LOG_INFO("utc timestamp");
+    const LogEntry& last = logger.getHistoryEntry((logger.getHistoryHead() + logger.getHistoryCount() - 1) % Logger::LOG_HISTORY_SIZE);
+    TEST_ASSERT_EQUAL(0, strncmp(last.timestamp, "2025-01-01T", 11));
+    LogClock::reset();
+}
+
+// Champs structurés : empaquetés sans formatage, rendus par chaque sink (texte, JSON, anneau binaire)
+void test_log_structured_fields() {
+    struct Capture : Print {
+        std::string text;
+        size_t write(uint8_t c) override { text += (char)c; return 1; }
+        size_t write(const uint8_t* buf, size_t size) override {
+            text.append(reinterpret_cast<const char*>(buf), size);
+            return size;
+        }
+    } textOut, jsonOut;
+
+    Logger& logger = Logger::getInstance();
+    logger.setLevel(LOG_LEVEL_INFO);
+    logger.setSerialEnabled(false);
+    LogTextSink textSink(textOut);
+    LogJsonSink jsonSink(jsonOut);
+    LogBinaryRingSink<8> binarySink;
+    TEST_ASSERT_TRUE(logger.addSink(textSink));
+    TEST_ASSERT_TRUE(logger.addSink(jsonSink));
+    TEST_ASSERT_TRUE(logger.addSink(binarySink));
+
+    LOG_INFO_KV("tx_start", "connectorId", 1, "transactionId", 42u, "power", 7.5);
+    LOG_DEBUG_KV("filtered", "connectorId", 1);
+
+    const LogEntry& last = logger.getHistoryEntry((logger.getHistoryHead() + logger.getHistoryCount() - 1) % Logger::LOG_HISTORY_SIZE);
+    TEST_ASSERT_EQUAL_STRING("tx_start", last.message);
+    TEST_ASSERT_TRUE(last.fieldsLength > 0);
+
+    TEST_ASSERT_TRUE(textOut.text.find(": tx_start connectorId=1 transactionId=42 power=7.5\n") != std::string::npos);
+
+    // Membres JSON typés : nombres non quotés, chaînes échappées
+    const std::string& json = jsonOut.text;
+    TEST_ASSERT_EQUAL(0, json.find("{\"ts\":\""));
+    TEST_ASSERT_TRUE(json.find("\"lvl\":\"INFO\"") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"msg\":\"tx_start\",\"connectorId\":1,\"transactionId\":42,\"power\":7.5}\n") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("filtered") == std::string::npos);
+
+    LogBinaryRecord record;
+    TEST_ASSERT_TRUE(binarySink.pop(record));
+    TEST_ASSERT_EQUAL(LOG_FORMAT_ID_FIELDS, record.formatId);
+    char rendered[LOG_MESSAGE_SIZE];
+    LogFormatRegistry::render(record, rendered, sizeof(rendered));
+    // L'événement partage les LOG_BINARY_PAYLOAD_SIZE octets : la dernière paire ne tient plus, écartée entière
+    TEST_ASSERT_EQUAL_STRING("tx_start connectorId=1 transactionId=42", rendered);
+
+    // Chaînes échappées ; les paires au-delà de LOG_BINARY_PAYLOAD_SIZE sont écartées entières
+    jsonOut.text.clear();
+    LOG_INFO_KV("authorize", "idTag", "AB\"C\n", "accepted", true, "reason", "0123456789012345678901234567890",
+                "dropped", 1);
+    TEST_ASSERT_TRUE(jsonOut.text.find("\"idTag\":\"AB\\\"C\\n\",\"accepted\":1,\"reason\":\"0123") != std::string::npos);
+    TEST_ASSERT_TRUE(jsonOut.text.find("dropped") == std::string::npos);
+
+    // Message trop long : coupé, la ligne JSON reste complète et valide
+    jsonOut.text.clear();
+    char longMessage[LOG_MESSAGE_SIZE];
+    memset(longMessage, '"', sizeof(longMessage) - 1);
+    longMessage[sizeof(longMessage) - 1] = '\0';
+    LOG_WARN_KV(longMessage, "connectorId", 2);
+    TEST_ASSERT_TRUE(jsonOut.text.size() < LOG_LINE_SIZE);
+    TEST_ASSERT_TRUE(jsonOut.text.find(",\"connectorId\":2}\n") != std::string::npos);
+    TEST_ASSERT_TRUE(jsonOut.text.find("\\\",\"connectorId\"") == std::string::npos);   // Pas d'échappement coupé
+
+    // Chemin de source Windows, guillemets dans le nom de fonction : échappés
+    LogEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    strcpy(entry.timestamp, "2025-01-01T00:00:00.000Z");
+    strcpy(entry.message, "path");
+    entry.level = LOG_LEVEL_INFO;
+    entry.file = "C:\\fw\\src\\main.cpp";
+    entry.line = 12;
+    entry.function = "op\"q\"";
+    char line[LOG_LINE_SIZE];
+    LogJsonSink::format(entry, line, sizeof(line));
+    TEST_ASSERT_TRUE(strstr(line, ",\"src\":\"C:\\\\fw\\\\src\\\\main.cpp:12\",\"fn\":\"op\\\"q\\\"\",") != nullptr);
+
+    logger.removeSink(textSink);
+    logger.removeSink(jsonSink);
+    logger.removeSink(binarySink);
+    logger.setSerialEnabled(true);
+}
+
+// Tempête de logs : débit borné par le seau à jetons, répétitions identiques regroupées
+void test_log_storm_rate_limit() {
+    // Seau seul : 3 jetons, puis un toutes les 100 ms
+    LogRateLimiter limiter(100, 3);
+    uint32_t suppressed = 0;
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(limiter.allow(1000, suppressed));
+    }
+    TEST_ASSERT_FALSE(limiter.allow(1050, suppressed));
+    TEST_ASSERT_FALSE(limiter.allow(1099, suppressed));
+    TEST_ASSERT_TRUE(limiter.allow(1100, suppressed));
+    TEST_ASSERT_EQUAL(2, suppressed);
+    for (int i = 0; i < 3; ++i) {   // Longue pause : le seau est plein, sans plus
+        TEST_ASSERT_TRUE(limiter.allow(500000, suppressed));
+    }
+    TEST_ASSERT_FALSE(limiter.allow(500000, suppressed));
+
+    // Compte ce qui sortirait sur Serial/SPIFFS
+    struct ByteCounter : LogSink {
+        uint32_t records = 0;
+        uint32_t bytes = 0;
+        void write(const LogEntry& entry) override {
+            char line[LOG_LINE_SIZE];
+            records++;
+            bytes += Logger::formatEntry(entry, line, sizeof(line));
+        }
+    } counter;
+
+    Logger& logger = Logger::getInstance();
+    logger.clearHistory();
+    logger.setLevel(LOG_LEVEL_INFO);
+    logger.setSerialEnabled(false);
+    TEST_ASSERT_TRUE(logger.addSink(counter));
+    LogSuppressionStats before = logger.getSuppressionStats();
+
+    const int N = 5000;
+    uint32_t start = millis();
+    for (int i = 0; i < N; ++i) {
+        LOG_WARN_RATE(100, 5, "storm %d", i);   // Textes tous différents : seau à jetons seul
+    }
+    uint32_t elapsed = millis() - start;
+    uint32_t allowed = 5 + elapsed / 100 + 1;
+    LogSuppressionStats after = logger.getSuppressionStats();
+    TEST_ASSERT_TRUE(counter.records <= 2 * allowed);   // Chaque passage peut annoncer les appels écartés
+    TEST_ASSERT_TRUE(after.rateLimited - before.rateLimited >= N - allowed);
+    uint32_t rateRecords = counter.records;
+    uint32_t rateBytes = counter.bytes;
+
+    // Même message en boucle : une ligne, puis un résumé au message suivant
+    counter.records = 0;
+    for (int i = 0; i < 1000; ++i) {
+        LOG_WARN("same storm message");
+    }
+    LOG_INFO("storm over");
+    after = logger.getSuppressionStats();
+    TEST_ASSERT_EQUAL(3, counter.records);
+    TEST_ASSERT_EQUAL(999, after.coalesced - before.coalesced);
+
+    size_t last = (logger.getHistoryHead() + logger.getHistoryCount() - 1) % Logger::LOG_HISTORY_SIZE;
+    TEST_ASSERT_EQUAL_STRING("storm over", logger.getHistoryEntry(last).message);
+    const LogEntry& summary = logger.getHistoryEntry((last + Logger::LOG_HISTORY_SIZE - 1) % Logger::LOG_HISTORY_SIZE);
+    TEST_ASSERT_EQUAL_STRING("last message repeated 999 times", summary.message);
+    TEST_ASSERT_EQUAL(LOG_LEVEL_WARNING, summary.level);
+
+    char report[160];
+    snprintf(report, sizeof(report), "Storm: %d rate-limited calls in %lu ms -> %lu records, %lu bytes; 1000 repeats -> 1 line + summary",
+             N, (unsigned long)elapsed, (unsigned long)rateRecords, (unsigned long)rateBytes);
+    TEST_MESSAGE(report);
+
+    logger.removeSink(counter);
+    logger.setSerialEnabled(true);
+}
+
+// --- Stress multi-cœur : 4 tâches productrices sur les 2 cœurs ---
+static const int STRESS_PRODUCERS = 4;
+static const int STRESS_MESSAGES = 500;
+static std::atomic<int> stressDone{0};
+
+static uint32_t stressChecksum(int producer, int seq) {
+    return (static_cast<uint32_t>(producer) * 100003u + static_cast<uint32_t>(seq)) * 2654435761u;
+}
+
+// Vérifie chaque ligne reçue : somme de contrôle et ordre par producteur
+struct StressSink : LogSink {
+    uint32_t received = 0;
+    uint32_t corrupted = 0;
+    uint32_t reordered = 0;
+    uint32_t gaps = 0;
+    int lastSeq[STRESS_PRODUCERS];
+    void reset() {
+        received = corrupted = reordered = gaps = 0;
+        for (int i = 0; i < STRESS_PRODUCERS; ++i) lastSeq[i] = -1;
+    }
+    void write(const LogEntry& entry) override {
+        int producer = -1;
+        int seq = -1;
+        unsigned long chk = 0;
+        if (sscanf(entry.message, "P%d #%d chk=%lx", &producer, &seq, &chk) != 3) return;
+        received++;
+        if (producer < 0 || producer >= STRESS_PRODUCERS || chk != stressChecksum(producer, seq)) {
+            corrupted++;
+            return;
+        }
+        if (seq <= lastSeq[producer]) reordered++;
+        if (seq != lastSeq[producer] + 1) gaps++;
+        lastSeq[producer] = seq;
+    }
+};
+
+static void stressProducer(void* arg) {
+    int producer = static_cast<int>(reinterpret_cast<intptr_t>(arg));
+    for (int i = 0; i < STRESS_MESSAGES; ++i) {
+        LOG_INFO("P%d #%d chk=%08lx", producer, i, static_cast<unsigned long>(stressChecksum(producer, i)));
+        if ((i & 31) == 0) taskYIELD();
+    }
+    stressDone++;
+    vTaskDelete(nullptr);
+}
+
+static void runStressProducers() {
+    stressDone = 0;
+    for (int p = 0; p < STRESS_PRODUCERS; ++p) {
+        xTaskCreatePinnedToCore(stressProducer, "logstress", 4096, reinterpret_cast<void*>(static_cast<intptr_t>(p)), 1,
+                                nullptr, p % 2);
+    }
+    while (stressDone < STRESS_PRODUCERS) {
+        vTaskDelay(1);
+    }
+}
+
+void test_log_multicore_stress() {
+    static StressSink sink;
+    Logger& logger = Logger::getInstance();
+    logger.setLevel(LOG_LEVEL_INFO);
+    logger.setSerialEnabled(false);
+    TEST_ASSERT_TRUE(logger.addSink(sink));
+    const uint32_t produced = STRESS_PRODUCERS * STRESS_MESSAGES;
+
+    // Synchrone : aucune perte, aucune ligne mélangée, ordre de chaque producteur conservé
+    sink.reset();
+    uint32_t start = millis();
+    runStressProducers();
+    logger.flushRepeats();
+    uint32_t syncMs = millis() - start;
+    TEST_ASSERT_EQUAL(produced, sink.received);
+    TEST_ASSERT_EQUAL(0, sink.corrupted);
+    TEST_ASSERT_EQUAL(0, sink.reordered);
+    TEST_ASSERT_EQUAL(0, sink.gaps);
+
+    // Asynchrone : les pertes éventuelles sont toutes comptées
+    sink.reset();
+    TEST_ASSERT_TRUE(logger.startAsync(LOG_OVERFLOW_DROP_OLDEST));
+    LogAsyncStats before = logger.getAsyncStats();
+    start = millis();
+    runStressProducers();
+    logger.stopAsync();
+    uint32_t asyncMs = millis() - start;
+    LogAsyncStats after = logger.getAsyncStats();
+    uint32_t dropped = (after.droppedNewest - before.droppedNewest) + (after.droppedOldest - before.droppedOldest) +
+                       (after.droppedBusy - before.droppedBusy);
+    TEST_ASSERT_EQUAL(produced, sink.received + dropped);
+    TEST_ASSERT_EQUAL(0, sink.corrupted);
+    TEST_ASSERT_EQUAL(0, sink.reordered);
+
+    char report[160];
+    snprintf(report, sizeof(report), "Multicore: %lu records, sync %lu ms; async %lu ms, %lu dropped",
+             (unsigned long)produced, (unsigned long)syncMs, (unsigned long)asyncMs, (unsigned long)dropped);
+    TEST_MESSAGE(report);
+
+    logger.removeSink(sink);
+    logger.setSerialEnabled(true);
+}
+
 void test_logger_spiffs() {
     TEST_ASSERT_TRUE(SPIFFS.begin(true));
     File f = SPIFFS.open("/unittest.txt", FILE_WRITE);
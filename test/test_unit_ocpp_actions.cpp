@@ -0,0 +1,216 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string.h>
+
+#include "feature_profiles.h"
+#include "ocpp_actions.h"
+#include "ocpp_dispatch.h"
+
+namespace {
+
+// Recherche par strcmp sur la liste des noms : ce que la table remplace
+ocpp_action_t findLinear(const char* name) {
+    for (uint8_t i = 0; i < OCPP_ACTION_COUNT; ++i) {
+        if (strcmp(OCPP_ACTIONS[i].name, name) == 0) return static_cast<ocpp_action_t>(i);
+    }
+    return OCPP_ACTION_UNKNOWN;
+}
+
+ocpp_frame_t parseFrame(const char* text) {
+    ocpp_frame_t frame;
+    TEST_ASSERT_TRUE(OcppFrame::parse(text, strlen(text), frame));
+    return frame;
+}
+
+int handledCalls = 0;
+
+bool countCall(void* context, const ocpp_frame_t& frame, JsonObjectConst payload) {
+    (void)frame;
+    TEST_ASSERT_EQUAL_STRING("Soft", payload["type"].as<const char*>());
+    handledCalls++;
+    return context != nullptr;
+}
+
+bool nullPayload = false;
+
+bool refuseOversized(void* context, const ocpp_frame_t& frame, JsonObjectConst payload) {
+    (void)context;
+    (void)frame;
+    nullPayload = payload.isNull();
+    return nullPayload;
+}
+
+// SendLocalList de n entrées complètes, identifiants de longueur maximale
+char localListFrame[8192];
+
+ocpp_frame_t buildLocalList(int entries) {
+    size_t len = snprintf(localListFrame, sizeof(localListFrame),
+                          "[2,\"s5\",\"SendLocalList\",{\"listVersion\":2,\"updateType\":\"Differential\","
+                          "\"localAuthorizationList\":[");
+    for (int i = 0; i < entries; ++i) {
+        len += snprintf(localListFrame + len, sizeof(localListFrame) - len,
+                        "%s{\"idTag\":\"TAG%017d\",\"idTagInfo\":{\"status\":\"ConcurrentTx\","
+                        "\"expiryDate\":\"2024-01-01T00:00:00.000+00:00\",\"parentIdTag\":\"PARENT%014d\"}}",
+                        i ? "," : "", i, i);
+        TEST_ASSERT_TRUE(len < sizeof(localListFrame));
+    }
+    len += snprintf(localListFrame + len, sizeof(localListFrame) - len, "]}]");
+    TEST_ASSERT_TRUE(len < sizeof(localListFrame));
+    return parseFrame(localListFrame);
+}
+
+} // namespace
+
+// Table générée : chaque action retrouvée, les autres noms refusés
+void test_ocpp_action_lookup() {
+    for (uint8_t i = 0; i < OCPP_ACTION_COUNT; ++i) {
+        const ocpp_action_info_t& info = OCPP_ACTIONS[i];
+        TEST_ASSERT_EQUAL(strlen(info.name), info.len);
+        TEST_ASSERT_EQUAL(i, ocppActionFind(info.name, info.len));
+        if (i > 0) TEST_ASSERT_TRUE(strcmp(OCPP_ACTIONS[i - 1].name, info.name) < 0);
+    }
+
+    // Recherche à la compilation
+    static_assert(ocppActionFind("RemoteStartTransaction", 22) == OCPP_ACTION_REMOTE_START_TRANSACTION, "");
+    TEST_ASSERT_EQUAL(FEATURE_PROFILE_SMART_CHARGING_ID, OCPP_ACTIONS[OCPP_ACTION_SET_CHARGING_PROFILE].profile);
+    TEST_ASSERT_EQUAL(SMART_CHARGING_MSG_SET_CHARGING_PROFILE, OCPP_ACTIONS[OCPP_ACTION_SET_CHARGING_PROFILE].message);
+    TEST_ASSERT_EQUAL(OCPP_ACTION_CP_TO_CS | OCPP_ACTION_CS_TO_CP, OCPP_ACTIONS[OCPP_ACTION_DATA_TRANSFER].direction);
+
+    const char* const unknown[] = { "", "Reset2", "Rese", "reset", "RESET", "GetConfig", "Authorizee",
+                                    "StartTransactionRequest", "Unknown", "Reserve Now" };
+    for (const char* name : unknown) {
+        TEST_ASSERT_EQUAL(OCPP_ACTION_UNKNOWN, ocppActionFind(name, strlen(name)));
+    }
+    // Vue non terminée : seule la longueur compte
+    TEST_ASSERT_EQUAL(OCPP_ACTION_RESET, ocppActionFind("ResetX", 5));
+}
+
+// Feature Profiles : Core obligatoire, messages validés selon le profil
+void test_feature_profiles_validate() {
+    feature_profiles_config_t* config = FeatureProfiles_init();
+    TEST_ASSERT_NOT_NULL(config);
+    size_t total = 0;
+    for (const feature_profile_config_t& profile : config->profiles) {
+        total += profile.message_count;
+        for (size_t i = 0; i < profile.message_count; ++i) {
+            ocpp_action_t action = ocppActionFind(profile.message_names[i], strlen(profile.message_names[i]));
+            TEST_ASSERT_EQUAL(profile.id, OCPP_ACTIONS[action].profile);
+        }
+    }
+    TEST_ASSERT_EQUAL(OCPP_ACTION_COUNT, total);
+
+    TEST_ASSERT_FALSE(FeatureProfiles_setEnabled(FEATURE_PROFILE_CORE_ID, false));
+    TEST_ASSERT_TRUE(FeatureProfiles_validateMessage("Heartbeat"));
+    TEST_ASSERT_FALSE(FeatureProfiles_validateMessage("Heartbeet"));
+    TEST_ASSERT_FALSE(FeatureProfiles_validateMessage(nullptr));
+
+    bool wasEnabled = FeatureProfiles_isEnabled(FEATURE_PROFILE_RESERVATION_ID);
+    TEST_ASSERT_TRUE(FeatureProfiles_setEnabled(FEATURE_PROFILE_RESERVATION_ID, false));
+    TEST_ASSERT_FALSE(FeatureProfiles_validateMessage("ReserveNow"));
+
+    char list[128];
+    FeatureProfiles_getSupportedList(list, sizeof(list));
+    TEST_ASSERT_NULL(strstr(list, "Reservation"));
+    TEST_ASSERT_EQUAL(0, strncmp(list, "Core", 4));
+
+    TEST_ASSERT_TRUE(FeatureProfiles_setEnabled(FEATURE_PROFILE_RESERVATION_ID, true));
+    TEST_ASSERT_TRUE(FeatureProfiles_validateMessage("ReserveNow"));
+    FeatureProfiles_setEnabled(FEATURE_PROFILE_RESERVATION_ID, wasEnabled);
+}
+
+// Aiguillage des CALL du serveur : gestionnaire, transmission, CALLERROR
+void test_ocpp_action_dispatch() {
+    OcppDispatcher dispatcher;
+    ocpp_action_t action = OCPP_ACTION_UNKNOWN;
+    int context = 0;
+    handledCalls = 0;
+
+    ocpp_frame_t reset = parseFrame("[2,\"s1\",\"Reset\",{\"type\":\"Soft\"}]");
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_FORWARD, dispatcher.dispatch(reset, &action));
+    TEST_ASSERT_EQUAL(OCPP_ACTION_RESET, action);
+
+    dispatcher.setHandler(OCPP_ACTION_RESET, countCall, &context);
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_HANDLED, dispatcher.dispatch(reset));
+    dispatcher.setHandler(OCPP_ACTION_RESET, countCall, nullptr);
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_FORWARD, dispatcher.dispatch(reset));
+    TEST_ASSERT_EQUAL(2, handledCalls);
+
+    char error[OCPP_DISPATCH_ERROR_SIZE];
+    TEST_ASSERT_EQUAL(0, dispatcher.writeError(error, sizeof(error), reset, OCPP_DISPATCH_FORWARD));
+
+    ocpp_frame_t unknown = parseFrame("[2,\"s2\",\"Reboot\",{}]");
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_NOT_IMPLEMENTED, dispatcher.dispatch(unknown, &action));
+    TEST_ASSERT_EQUAL(OCPP_ACTION_UNKNOWN, action);
+    size_t len = dispatcher.writeError(error, sizeof(error), unknown, OCPP_DISPATCH_NOT_IMPLEMENTED);
+    TEST_ASSERT_EQUAL(strlen(error), len);
+    TEST_ASSERT_EQUAL_STRING("[4,\"s2\",\"NotImplemented\",\"Unknown action\",{}]", error);
+
+    // Le serveur n'émet pas BootNotification
+    ocpp_frame_t boot = parseFrame("[2,\"s3\",\"BootNotification\",{}]");
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_NOT_SUPPORTED, dispatcher.dispatch(boot));
+
+    ocpp_frame_t profile = parseFrame(
+        "[2,\"s4\",\"SetChargingProfile\",{\"connectorId\":1,\"csChargingProfiles\":{\"chargingProfileId\":7,"
+        "\"stackLevel\":0,\"chargingProfilePurpose\":\"TxDefaultProfile\",\"chargingProfileKind\":\"Absolute\","
+        "\"chargingSchedule\":{\"chargingRateUnit\":\"A\","
+        "\"chargingSchedulePeriod\":[{\"startPeriod\":0,\"limit\":16.0}]}}}]");
+    bool wasEnabled = FeatureProfiles_isEnabled(FEATURE_PROFILE_SMART_CHARGING_ID);
+    FeatureProfiles_setEnabled(FEATURE_PROFILE_SMART_CHARGING_ID, false);
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_NOT_SUPPORTED, dispatcher.dispatch(profile));
+    dispatcher.writeError(error, sizeof(error), profile, OCPP_DISPATCH_NOT_SUPPORTED);
+    TEST_ASSERT_EQUAL_STRING("[4,\"s4\",\"NotSupported\",\"Action not supported\",{}]", error);
+    FeatureProfiles_setEnabled(FEATURE_PROFILE_SMART_CHARGING_ID, true);
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_FORWARD, dispatcher.dispatch(profile));
+    FeatureProfiles_setEnabled(FEATURE_PROFILE_SMART_CHARGING_ID, wasEnabled);
+
+    // Tampon trop petit : pas de trame tronquée
+    TEST_ASSERT_EQUAL(0, dispatcher.writeError(error, 16, unknown, OCPP_DISPATCH_NOT_IMPLEMENTED));
+}
+
+// SendLocalList : SendLocalListMaxLength entrées tiennent dans le document, au-delà le gestionnaire
+// reçoit une charge utile nulle et la trame n'est jamais transmise à MicroOCPP
+void test_ocpp_dispatch_oversized_local_list() {
+    OcppDispatcher dispatcher;
+    dispatcher.setHandler(OCPP_ACTION_SEND_LOCAL_LIST, refuseOversized, nullptr);
+
+    ocpp_frame_t fits = buildLocalList(OCPP_SEND_LOCAL_LIST_MAX_LENGTH);
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_FORWARD, dispatcher.dispatch(fits));
+    TEST_ASSERT_FALSE(nullPayload);
+
+    ocpp_frame_t oversized = buildLocalList(OCPP_DISPATCH_DOC_SIZE / 64 + 1);
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_HANDLED, dispatcher.dispatch(oversized));
+    TEST_ASSERT_TRUE(nullPayload);
+}
+
+// Benchmark : strcmp sur la liste contre hachage + comparaison, sur toutes les actions et des inconnues
+void test_ocpp_action_lookup_benchmark() {
+    const int N = 200;
+    const char* const unknown[] = { "Rebooot", "GetLog", "SetVariables", "NotifyEvent" };
+    volatile uint32_t sink = 0;
+
+    uint32_t start = ESP.getCycleCount();
+    for (int n = 0; n < N; ++n) {
+        for (const ocpp_action_info_t& info : OCPP_ACTIONS) sink += findLinear(info.name);
+        for (const char* name : unknown) sink += findLinear(name);
+    }
+    uint32_t linearCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int n = 0; n < N; ++n) {
+        for (const ocpp_action_info_t& info : OCPP_ACTIONS) sink += ocppActionFind(info.name, strlen(info.name));
+        for (const char* name : unknown) sink += ocppActionFind(name, strlen(name));
+    }
+    uint32_t hashCycles = ESP.getCycleCount() - start;
+    (void)sink;
+
+    TEST_ASSERT_TRUE(hashCycles < linearCycles);
+
+    const uint32_t lookups = N * (OCPP_ACTION_COUNT + sizeof(unknown) / sizeof(unknown[0]));
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[128];
+    snprintf(report, sizeof(report), "OCPP action lookup: strcmp %lu ns, hash %lu ns (%u actions)",
+             static_cast<unsigned long>(static_cast<uint64_t>(linearCycles) * 1000 / mhz / lookups),
+             static_cast<unsigned long>(static_cast<uint64_t>(hashCycles) * 1000 / mhz / lookups),
+             static_cast<unsigned>(OCPP_ACTION_COUNT));
+    TEST_MESSAGE(report);
+}
@@ -0,0 +1,260 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <SPIFFS.h>
+
+#include "ocpp_auth_store.h"
+
+namespace {
+
+const char* const AUTH_TEST_FILE = "/test_ocpp_auth.bin";
+
+ocpp_auth_entry_t makeEntry(const char* idTag, ocpp_auth_status_t status, uint32_t expiryUnixS = 0,
+                            const char* parentIdTag = "") {
+    ocpp_auth_entry_t entry = {};
+    memcpy(entry.idTag, idTag, strnlen(idTag, ID_TAG_MAX_LENGTH));
+    memcpy(entry.parentIdTag, parentIdTag, strnlen(parentIdTag, ID_TAG_MAX_LENGTH));
+    entry.expiryUnixS = expiryUnixS;
+    entry.status = status;
+    return entry;
+}
+
+} // namespace
+
+// Recherche : casse ignorée, expiration, priorité de la liste sur le cache, remplacement du cache
+void test_ocpp_auth_store_lookup() {
+    SPIFFS.remove(AUTH_TEST_FILE);
+    OcppAuthStore store(AUTH_TEST_FILE, SPIFFS);
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_EQUAL(0, store.getListVersion());
+    const uint32_t now = 1700000000;
+
+    ocpp_auth_entry_t found;
+    TEST_ASSERT_FALSE(store.lookup("04A2B3C4", now, found));
+    TEST_ASSERT_TRUE(store.cache(makeEntry("04a2b3c4", OCPP_AUTH_ACCEPTED, now + 3600, "GROUP1")));
+    TEST_ASSERT_TRUE(store.lookup("04A2B3C4", now, found));
+    TEST_ASSERT_EQUAL(OCPP_AUTH_ACCEPTED, found.status);
+    TEST_ASSERT_EQUAL_STRING("GROUP1", found.parentIdTag);
+    TEST_ASSERT_FALSE(found.localList);
+
+    // Échu : Expired ; heure inconnue : expiration non vérifiée
+    TEST_ASSERT_TRUE(store.lookup("04A2B3C4", now + 3600, found));
+    TEST_ASSERT_EQUAL(OCPP_AUTH_EXPIRED, found.status);
+    TEST_ASSERT_TRUE(store.lookup("04A2B3C4", 0, found));
+    TEST_ASSERT_EQUAL(OCPP_AUTH_ACCEPTED, found.status);
+
+    // La liste remplace l'entrée du cache, et le cache ne la remplace plus
+    TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.beginListUpdate(1, false));
+    TEST_ASSERT_TRUE(store.putListEntry(makeEntry("04A2B3C4", OCPP_AUTH_BLOCKED)));
+    TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.endListUpdate(true));
+    TEST_ASSERT_FALSE(store.cache(makeEntry("04A2B3C4", OCPP_AUTH_ACCEPTED)));
+    TEST_ASSERT_TRUE(store.lookup("04a2b3c4", now, found));
+    TEST_ASSERT_EQUAL(OCPP_AUTH_BLOCKED, found.status);
+    TEST_ASSERT_TRUE(found.localList);
+
+    // idTag trop long ou statut invalide : refusés
+    TEST_ASSERT_FALSE(store.lookup("0123456789ABCDEF01234", now, found));
+    TEST_ASSERT_FALSE(store.cache(makeEntry("BADSTATUS", OCPP_AUTH_STATUS_COUNT)));
+
+    // Cache plein : remplacement à tour de rôle, la liste n'est pas touchée
+    char tag[ID_TAG_MAX_LENGTH + 1];
+    for (uint32_t i = 0; i < OCPP_AUTH_CACHE_MAX_ENTRIES + 10; ++i) {
+        snprintf(tag, sizeof(tag), "CACHE%05lu", static_cast<unsigned long>(i));
+        TEST_ASSERT_TRUE(store.cache(makeEntry(tag, OCPP_AUTH_ACCEPTED)));
+    }
+    ocpp_auth_store_stats_t stats = store.getStats();
+    TEST_ASSERT_EQUAL(OCPP_AUTH_CACHE_MAX_ENTRIES, stats.cacheEntries);
+    TEST_ASSERT_EQUAL(10, stats.evictions);
+    TEST_ASSERT_EQUAL(1, stats.listEntries);
+    TEST_ASSERT_TRUE(store.lookup("04A2B3C4", now, found));
+
+    TEST_ASSERT_TRUE(store.clearCache());
+    TEST_ASSERT_EQUAL(0, store.getStats().cacheEntries);
+    TEST_ASSERT_FALSE(store.lookup("CACHE00600", now, found));
+    TEST_ASSERT_TRUE(store.lookup("04A2B3C4", now, found));
+
+    TEST_ASSERT_EQUAL(OCPP_AUTH_CONCURRENT_TX, OcppAuthStore::parseStatus("ConcurrentTx"));
+    TEST_ASSERT_EQUAL(OCPP_AUTH_STATUS_COUNT, OcppAuthStore::parseStatus("accepted"));
+    store.end();
+    SPIFFS.remove(AUTH_TEST_FILE);
+}
+
+// Local List : versions, mise à jour complète et différentielle, reprise après coupure
+void test_ocpp_auth_store_list_update() {
+    SPIFFS.remove(AUTH_TEST_FILE);
+    ocpp_auth_entry_t found;
+    {
+        OcppAuthStore store(AUTH_TEST_FILE, SPIFFS);
+        TEST_ASSERT_TRUE(store.begin());
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.beginListUpdate(5, true));
+        TEST_ASSERT_TRUE(store.putListEntry(makeEntry("TAG-A", OCPP_AUTH_ACCEPTED)));
+        TEST_ASSERT_TRUE(store.putListEntry(makeEntry("TAG-B", OCPP_AUTH_ACCEPTED)));
+        TEST_ASSERT_TRUE(store.putListEntry(makeEntry("TAG-C", OCPP_AUTH_BLOCKED)));
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.endListUpdate(true));
+        TEST_ASSERT_EQUAL(5, store.getListVersion());
+        TEST_ASSERT_TRUE(store.cache(makeEntry("TAG-D", OCPP_AUTH_INVALID)));
+
+        // Différentielle : version déjà reçue refusée ; entrée sans IdTagInfo retirée
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_VERSION_MISMATCH, store.beginListUpdate(5, false));
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.beginListUpdate(6, false));
+        TEST_ASSERT_TRUE(store.removeListEntry("tag-b"));
+        TEST_ASSERT_TRUE(store.putListEntry(makeEntry("TAG-C", OCPP_AUTH_ACCEPTED)));
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.endListUpdate(true));
+        TEST_ASSERT_FALSE(store.lookup("TAG-B", 0, found));
+        TEST_ASSERT_TRUE(store.lookup("TAG-C", 0, found));
+        TEST_ASSERT_EQUAL(OCPP_AUTH_ACCEPTED, found.status);
+        TEST_ASSERT_FALSE(store.putListEntry(makeEntry("TAG-E", OCPP_AUTH_ACCEPTED)));   // Hors mise à jour
+        store.end();
+    }
+    {
+        // Redémarrage : liste, version et cache relus du fichier
+        OcppAuthStore store(AUTH_TEST_FILE, SPIFFS);
+        TEST_ASSERT_TRUE(store.begin());
+        TEST_ASSERT_EQUAL(6, store.getListVersion());
+        TEST_ASSERT_EQUAL(2, store.getStats().listEntries);
+        TEST_ASSERT_EQUAL(1, store.getStats().cacheEntries);
+        TEST_ASSERT_TRUE(store.lookup("TAG-A", 0, found));
+        TEST_ASSERT_TRUE(store.lookup("TAG-D", 0, found));
+        TEST_ASSERT_EQUAL(OCPP_AUTH_INVALID, found.status);
+
+        // Coupure pendant une mise à jour complète : version 0, le serveur renverra la liste
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.beginListUpdate(7, true));
+        TEST_ASSERT_TRUE(store.putListEntry(makeEntry("TAG-F", OCPP_AUTH_ACCEPTED)));
+        store.end();
+    }
+    {
+        OcppAuthStore store(AUTH_TEST_FILE, SPIFFS);
+        TEST_ASSERT_TRUE(store.begin());
+        TEST_ASSERT_EQUAL(0, store.getListVersion());
+        TEST_ASSERT_FALSE(store.lookup("TAG-A", 0, found));
+        TEST_ASSERT_TRUE(store.lookup("TAG-F", 0, found));
+
+        // Échec signalé par l'appelant : la version reste 0
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.beginListUpdate(8, true));
+        TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_FAILED, store.endListUpdate(false));
+        TEST_ASSERT_EQUAL(0, store.getListVersion());
+        store.end();
+    }
+
+    // Enregistrement à moitié écrit : ignoré, les autres restent lisibles
+    File file = SPIFFS.open(AUTH_TEST_FILE, "r+");
+    uint8_t record[48];
+    size_t recordOffset = 0;
+    for (size_t offset = 16; offset < file.size(); offset += sizeof(record)) {
+        file.seek(offset);
+        file.read(record, sizeof(record));
+        if (record[0] != 0) {
+            recordOffset = offset;
+            break;
+        }
+    }
+    TEST_ASSERT_NOT_EQUAL(0, recordOffset);
+    record[30] ^= 0xFF;
+    file.seek(recordOffset);
+    file.write(record, sizeof(record));
+    file.close();
+    {
+        OcppAuthStore store(AUTH_TEST_FILE, SPIFFS);
+        TEST_ASSERT_TRUE(store.begin());
+        TEST_ASSERT_EQUAL(1, store.getStats().discarded);
+        store.end();
+    }
+    SPIFFS.remove(AUTH_TEST_FILE);
+}
+
+// LocalAuthListEnabled / AuthorizationCacheEnabled : entrées ignorées sans être effacées
+void test_ocpp_auth_store_enabled() {
+    SPIFFS.remove(AUTH_TEST_FILE);
+    OcppAuthStore store(AUTH_TEST_FILE, SPIFFS);
+    TEST_ASSERT_TRUE(store.begin());
+    const uint32_t now = 1700000000;
+    TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.beginListUpdate(1, true));
+    TEST_ASSERT_TRUE(store.putListEntry(makeEntry("LIST-1", OCPP_AUTH_ACCEPTED)));
+    TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.endListUpdate(true));
+    TEST_ASSERT_TRUE(store.cache(makeEntry("CACHE-1", OCPP_AUTH_BLOCKED)));
+
+    ocpp_auth_entry_t found;
+    store.setEnabled(false, true);
+    TEST_ASSERT_FALSE(store.lookup("LIST-1", now, found));
+    TEST_ASSERT_TRUE(store.lookup("CACHE-1", now, found));
+    // La liste reste prioritaire : son idTag n'entre pas dans le cache
+    TEST_ASSERT_FALSE(store.cache(makeEntry("LIST-1", OCPP_AUTH_ACCEPTED)));
+
+    store.setEnabled(true, false);
+    TEST_ASSERT_TRUE(store.lookup("LIST-1", now, found));
+    TEST_ASSERT_FALSE(store.lookup("CACHE-1", now, found));
+    TEST_ASSERT_FALSE(store.cache(makeEntry("CACHE-2", OCPP_AUTH_ACCEPTED)));
+
+    uint32_t flashReads = store.getStats().flashReads;
+    store.setEnabled(false, false);
+    TEST_ASSERT_FALSE(store.lookup("LIST-1", now, found));
+    TEST_ASSERT_EQUAL(flashReads, store.getStats().flashReads);
+
+    // Réactivées : rien n'a été perdu
+    store.setEnabled(true, true);
+    TEST_ASSERT_TRUE(store.lookup("CACHE-1", now, found));
+    TEST_ASSERT_EQUAL(OCPP_AUTH_BLOCKED, found.status);
+    TEST_ASSERT_FALSE(store.lookup("CACHE-2", now, found));
+    ocpp_auth_store_stats_t stats = store.getStats();
+    TEST_ASSERT_EQUAL(1, stats.listEntries);
+    TEST_ASSERT_EQUAL(1, stats.cacheEntries);
+    store.end();
+    SPIFFS.remove(AUTH_TEST_FILE);
+}
+
+// Benchmark : recherche dans une liste de LocalAuthListMaxLength badges, flash lue par recherche.
+// Sur la cible seulement : la durée est celle des lectures SPIFFS, sans équivalent sur hôte
+void test_ocpp_auth_store_benchmark() {
+    SPIFFS.remove(AUTH_TEST_FILE);
+    OcppAuthStore store(AUTH_TEST_FILE, SPIFFS);
+    TEST_ASSERT_TRUE(store.begin());
+    char tag[ID_TAG_MAX_LENGTH + 1];
+
+    TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.beginListUpdate(1, true));
+    for (uint32_t i = 0; i < OCPP_LOCAL_LIST_MAX_LENGTH; ++i) {
+        snprintf(tag, sizeof(tag), "04%08lX", static_cast<unsigned long>(i * 2654435761u));
+        TEST_ASSERT_TRUE(store.putListEntry(makeEntry(tag, OCPP_AUTH_ACCEPTED)));
+    }
+    TEST_ASSERT_EQUAL(OCPP_LIST_UPDATE_ACCEPTED, store.endListUpdate(true));
+    TEST_ASSERT_FALSE(store.putListEntry(makeEntry("FULL", OCPP_AUTH_ACCEPTED)));
+
+    // Badges connus puis inconnus
+    const uint32_t LOOKUPS = 2000;
+    ocpp_auth_entry_t found;
+    ocpp_auth_store_stats_t before = store.getStats();
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < LOOKUPS; ++i) {
+        uint32_t n = i % OCPP_LOCAL_LIST_MAX_LENGTH;
+        snprintf(tag, sizeof(tag), "04%08lX", static_cast<unsigned long>(n * 2654435761u));
+        TEST_ASSERT_TRUE(store.lookup(tag, 0, found));
+    }
+    uint32_t knownCycles = ESP.getCycleCount() - start;
+    ocpp_auth_store_stats_t known = store.getStats();
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < LOOKUPS; ++i) {
+        snprintf(tag, sizeof(tag), "UNKNOWN%06lu", static_cast<unsigned long>(i));
+        TEST_ASSERT_FALSE(store.lookup(tag, 0, found));
+    }
+    uint32_t unknownCycles = ESP.getCycleCount() - start;
+    ocpp_auth_store_stats_t after = store.getStats();
+
+    uint32_t knownReads = known.flashReads - before.flashReads;
+    uint32_t unknownReads = after.flashReads - known.flashReads;
+    TEST_ASSERT_EQUAL(LOOKUPS, known.hits - before.hits);
+    // Empreintes de 15 bits : presque aucune lecture inutile
+    TEST_ASSERT_TRUE(knownReads < LOOKUPS + LOOKUPS / 50);
+    TEST_ASSERT_TRUE(unknownReads < LOOKUPS / 50);
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[200];
+    snprintf(report, sizeof(report),
+             "OCPP auth store: %u tags, known %lu ns/lookup (%lu reads/1000), unknown %lu ns/lookup "
+             "(%lu reads/1000), max probe %u",
+             static_cast<unsigned>(after.listEntries),
+             static_cast<unsigned long>(static_cast<uint64_t>(knownCycles) * 1000 / mhz / LOOKUPS),
+             static_cast<unsigned long>(knownReads * 1000 / LOOKUPS),
+             static_cast<unsigned long>(static_cast<uint64_t>(unknownCycles) * 1000 / mhz / LOOKUPS),
+             static_cast<unsigned long>(unknownReads * 1000 / LOOKUPS), static_cast<unsigned>(after.maxProbe));
+    TEST_MESSAGE(report);
+    store.end();
+    SPIFFS.remove(AUTH_TEST_FILE);
+}
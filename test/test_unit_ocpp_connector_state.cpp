@@ -0,0 +1,158 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+
+#include "ocpp_connector_state.h"
+
+namespace {
+
+struct StatusLog {
+    std::string sent;           // "<connecteur>:<statut> " par StatusNotification
+    size_t count = 0;
+    bool full = false;          // File pleine simulée
+};
+
+StatusLog statusLog;
+
+bool collectStatus(void*, uint8_t connectorId, ocpp_connector_status_t status) {
+    if (statusLog.full) return false;
+    statusLog.sent += std::to_string(connectorId) + ":" + OCPP_CONNECTOR_STATUS_NAMES[status] + " ";
+    statusLog.count++;
+    return true;
+}
+
+// Une session de charge, câble branché avant l'autorisation, avec une pause du véhicule
+const ocpp_connector_event_t SESSION[] = {
+    OCPP_EVENT_PLUG_IN, OCPP_EVENT_AUTHORIZE, OCPP_EVENT_TX_START, OCPP_EVENT_EV_SUSPEND,
+    OCPP_EVENT_ENERGY_FLOW, OCPP_EVENT_TX_STOP, OCPP_EVENT_UNPLUG
+};
+
+} // namespace
+
+// Table de transitions : session complète, événements refusés, connecteur 0
+void test_ocpp_connector_state_transitions() {
+    OcppConnectorStateMachine states;
+    const uint32_t now = 1000;
+
+    const ocpp_connector_status_t expected[] = {
+        OCPP_STATUS_PREPARING, OCPP_STATUS_PREPARING, OCPP_STATUS_CHARGING, OCPP_STATUS_SUSPENDED_EV,
+        OCPP_STATUS_CHARGING, OCPP_STATUS_FINISHING, OCPP_STATUS_AVAILABLE
+    };
+    for (size_t i = 0; i < sizeof(SESSION) / sizeof(SESSION[0]); ++i) {
+        TEST_ASSERT_TRUE(states.handle(1, SESSION[i], now));
+        TEST_ASSERT_EQUAL(expected[i], states.getStatus(1));
+    }
+    TEST_ASSERT_EQUAL(6, states.getStats().transitions);
+
+    // Non prévus : rien ne change
+    TEST_ASSERT_FALSE(states.handle(1, OCPP_EVENT_TX_STOP, now));
+    TEST_ASSERT_FALSE(states.handle(1, OCPP_EVENT_FAULT_CLEARED, now));
+    TEST_ASSERT_EQUAL(OCPP_STATUS_AVAILABLE, states.getStatus(1));
+
+    // Réservation, indisponibilité, défaut
+    TEST_ASSERT_TRUE(states.handle(2, OCPP_EVENT_RESERVE, now));
+    TEST_ASSERT_TRUE(states.handle(2, OCPP_EVENT_RESERVATION_END, now));
+    TEST_ASSERT_TRUE(states.handle(2, OCPP_EVENT_DISABLE, now));
+    TEST_ASSERT_FALSE(states.handle(2, OCPP_EVENT_PLUG_IN, now));
+    TEST_ASSERT_TRUE(states.handle(2, OCPP_EVENT_FAULT, now));
+    TEST_ASSERT_EQUAL(OCPP_STATUS_FAULTED, states.getStatus(2));
+    TEST_ASSERT_TRUE(states.handle(2, OCPP_EVENT_FAULT_CLEARED, now));
+    TEST_ASSERT_EQUAL(OCPP_STATUS_AVAILABLE, states.getStatus(2));
+
+    // Connecteur 0 : disponibilité et défauts seulement ; connecteur hors bornes
+    TEST_ASSERT_FALSE(states.handle(0, OCPP_EVENT_PLUG_IN, now));
+    TEST_ASSERT_TRUE(states.handle(0, OCPP_EVENT_DISABLE, now));
+    TEST_ASSERT_FALSE(states.set(0, OCPP_STATUS_CHARGING, now));
+    TEST_ASSERT_TRUE(states.set(0, OCPP_STATUS_AVAILABLE, now));
+    TEST_ASSERT_FALSE(states.handle(MAX_CONNECTORS + 1, OCPP_EVENT_FAULT, now));
+    TEST_ASSERT_EQUAL(OCPP_STATUS_COUNT, states.getStatus(MAX_CONNECTORS + 1));
+    TEST_ASSERT_EQUAL(5, states.getStats().refused);
+
+    TEST_ASSERT_EQUAL(OCPP_STATUS_COUNT, OcppConnectorStateMachine::next(OCPP_STATUS_COUNT, OCPP_EVENT_FAULT));
+    TEST_ASSERT_EQUAL_STRING("SuspendedEVSE", OCPP_CONNECTOR_STATUS_NAMES[OCPP_STATUS_SUSPENDED_EVSE]);
+}
+
+// StatusNotification : un message par statut stable, Faulted sans attendre, file pleine retentée
+void test_ocpp_connector_status_debounce() {
+    OcppConnectorStateMachine states;
+    statusLog = StatusLog();
+    states.setSink(collectStatus, nullptr);
+    uint32_t now = 1000;
+
+    // BootNotification accepté : tous les connecteurs signalés
+    states.reportAll(now);
+    TEST_ASSERT_EQUAL(MAX_CONNECTORS + 1, states.poll(now));
+
+    // Rafale : Preparing puis Charging en 300 ms, un seul message après le délai
+    statusLog = StatusLog();
+    states.handle(1, OCPP_EVENT_PLUG_IN, now);
+    states.handle(1, OCPP_EVENT_TX_START, now + 300);
+    TEST_ASSERT_EQUAL(0, states.poll(now + 300 + STATUS_NOTIFICATION_DEBOUNCE - 1));
+    TEST_ASSERT_EQUAL(1, states.poll(now + 300 + STATUS_NOTIFICATION_DEBOUNCE));
+    TEST_ASSERT_EQUAL_STRING("1:Charging ", statusLog.sent.c_str());
+
+    // Aller-retour vers le statut signalé : aucun message
+    now += 10000;
+    states.handle(1, OCPP_EVENT_EV_SUSPEND, now);
+    states.handle(1, OCPP_EVENT_ENERGY_FLOW, now + 200);
+    TEST_ASSERT_EQUAL(0, states.poll(now + 5000));
+
+    // Faulted : signalé au poll suivant
+    states.handle(2, OCPP_EVENT_FAULT, now);
+    TEST_ASSERT_EQUAL(1, states.poll(now));
+    TEST_ASSERT_EQUAL_STRING("1:Charging 2:Faulted ", statusLog.sent.c_str());
+
+    // File pleine : le statut reste en attente jusqu'à ce que la file l'accepte
+    statusLog.full = true;
+    states.handle(1, OCPP_EVENT_TX_STOP, now);
+    TEST_ASSERT_EQUAL(0, states.poll(now + STATUS_NOTIFICATION_DEBOUNCE));
+    statusLog.full = false;
+    TEST_ASSERT_EQUAL(1, states.poll(now + STATUS_NOTIFICATION_DEBOUNCE + 100));
+    TEST_ASSERT_EQUAL_STRING("1:Charging 2:Faulted 1:Finishing ", statusLog.sent.c_str());
+
+    ocpp_connector_state_stats_t stats = states.getStats();
+    TEST_ASSERT_EQUAL(2, stats.collapsed);
+    TEST_ASSERT_EQUAL(1, stats.deferred);
+    TEST_ASSERT_EQUAL(MAX_CONNECTORS + 4, stats.notifications);
+}
+
+// Benchmark : coût d'une transition, StatusNotification avec et sans délai
+void test_ocpp_connector_state_benchmark() {
+    const uint32_t SESSIONS = 2000;
+    const size_t STEPS = sizeof(SESSION) / sizeof(SESSION[0]);
+    OcppConnectorStateMachine states;
+    statusLog = StatusLog();
+    states.setSink(collectStatus, nullptr);
+
+    // Sessions de quelques secondes entre deux changements, rafales de moins d'une seconde au
+    // branchement (Preparing, Charging) et à la fin (Finishing, Available)
+    const uint32_t STEP_MS[] = { 0, 400, 300, 5000, 4000, 60000, 500 };
+    uint32_t now = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t s = 0; s < SESSIONS; ++s) {
+        for (size_t i = 0; i < STEPS; ++i) {
+            now += STEP_MS[i];
+            states.poll(now);          // loop() entre deux événements
+            states.handle(1, SESSION[i], now);
+        }
+        now += 60000;
+        states.poll(now);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    ocpp_connector_state_stats_t stats = states.getStats();
+    TEST_ASSERT_EQUAL(SESSIONS * (STEPS - 1), stats.transitions);
+    TEST_ASSERT_EQUAL(0, stats.refused);
+    TEST_ASSERT_EQUAL(stats.notifications, statusLog.count);
+    TEST_ASSERT_TRUE(stats.notifications < stats.transitions);
+    TEST_ASSERT_EQUAL(stats.transitions, stats.notifications + stats.collapsed);
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[160];
+    snprintf(report, sizeof(report),
+             "OCPP connector states: %lu transitions, %lu ns/event, %lu StatusNotification (%lu without debounce)",
+             static_cast<unsigned long>(stats.transitions),
+             static_cast<unsigned long>(static_cast<uint64_t>(cycles) * 1000 / mhz / (SESSIONS * STEPS)),
+             static_cast<unsigned long>(stats.notifications), static_cast<unsigned long>(stats.transitions));
+    TEST_MESSAGE(report);
+}
@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include <string>
+
+#include "ocpp_frame.h"
+
+namespace {
+
+std::string text(const ocpp_text_t& view) {
+    return std::string(view.data ? view.data : "", view.len);
+}
+
+// Trames types reçues du serveur : réponses à nos CALL, CALL du serveur, CALLERROR
+const char* const RECORDED_FRAMES[] = {
+    "[3,\"8f1e2b2c-4a1e-4a8e-9b1f-6f3c1d2e4a10\",{\"status\":\"Accepted\",\"currentTime\":"
+    "\"2025-01-31T12:00:00.000Z\",\"interval\":300}]",
+    "[3,\"q0000002a\",{\"currentTime\":\"2025-01-31T12:05:00.000Z\"}]",
+    "[3,\"q0000002b\",{\"transactionId\":1842,\"idTagInfo\":{\"status\":\"Accepted\",\"expiryDate\":"
+    "\"2025-02-28T00:00:00.000Z\",\"parentIdTag\":\"FLEET-01\"}}]",
+    "[2,\"srv-19\",\"RemoteStartTransaction\",{\"connectorId\":1,\"idTag\":\"CAFE01\",\"chargingProfile\":"
+    "{\"chargingProfileId\":7,\"stackLevel\":0,\"chargingProfilePurpose\":\"TxProfile\",\"chargingProfileKind\":"
+    "\"Absolute\",\"chargingSchedule\":{\"chargingRateUnit\":\"A\",\"chargingSchedulePeriod\":"
+    "[{\"startPeriod\":0,\"limit\":16.0},{\"startPeriod\":1800,\"limit\":10.0}]}}}]",
+    "[2,\"srv-20\",\"ChangeConfiguration\",{\"key\":\"MeterValueSampleInterval\",\"value\":\"30\"}]",
+    "[4,\"q0000002c\",\"FormationViolation\",\"Payload is syntactically incorrect\",{}]",
+};
+const size_t RECORDED_FRAME_COUNT = sizeof(RECORDED_FRAMES) / sizeof(RECORDED_FRAMES[0]);
+
+// Lecture actuelle (BootNotificationHandler) : trame entière en DynamicJsonDocument, champs en String
+size_t parseWithDocument(const char* raw, int32_t* heapBlocks) {
+    multi_heap_info_t before, during;
+    if (heapBlocks) heap_caps_get_info(&before, MALLOC_CAP_8BIT);
+    DynamicJsonDocument doc(1024);
+    deserializeJson(doc, raw);
+    int type = doc[0];
+    String id = doc[1].as<String>();
+    String action = type == OCPP_MESSAGE_CALL ? doc[2].as<String>() : String();
+    JsonObject payload = doc[type == OCPP_MESSAGE_CALL ? 3 : 2];
+    String status = payload["status"].as<String>();
+    if (heapBlocks) {
+        heap_caps_get_info(&during, MALLOC_CAP_8BIT);
+        *heapBlocks += static_cast<int32_t>(during.allocated_blocks - before.allocated_blocks);
+    }
+    return id.length() + action.length() + status.length();
+}
+
+// Enveloppe sur place, charge utile seule dans un document de taille fixe
+size_t parseInPlace(const char* raw, int32_t* heapBlocks) {
+    multi_heap_info_t before, during;
+    if (heapBlocks) heap_caps_get_info(&before, MALLOC_CAP_8BIT);
+    ocpp_frame_t frame;
+    if (!OcppFrame::parse(raw, strlen(raw), frame)) return 0;
+    StaticJsonDocument<512> doc;
+    if (deserializeJson(doc, frame.payload.data, frame.payload.len) != DeserializationError::Ok) return 0;
+    const char* status = doc["status"] | "";
+    if (heapBlocks) {
+        heap_caps_get_info(&during, MALLOC_CAP_8BIT);
+        *heapBlocks += static_cast<int32_t>(during.allocated_blocks - before.allocated_blocks);
+    }
+    return frame.uniqueId.len + frame.action.len + strlen(status);
+}
+
+} // namespace
+
+// Découpage de l'enveloppe : vues exactes sur la trame, trames invalides refusées
+void test_ocpp_frame_envelope() {
+    ocpp_frame_t frame;
+
+    const char call[] = " [ 2 , \"id \\\" 1\" ,\"Reset\", {\"type\":\"So]ft\",\"n\":[{\"a\":\"}\"}]} ] \r\n";
+    TEST_ASSERT_TRUE(OcppFrame::parse(call, strlen(call), frame));
+    TEST_ASSERT_EQUAL(OCPP_MESSAGE_CALL, frame.type);
+    TEST_ASSERT_EQUAL_STRING("id \\\" 1", text(frame.uniqueId).c_str());
+    TEST_ASSERT_TRUE(OcppFrame::equals(frame.action, "Reset"));
+    TEST_ASSERT_FALSE(OcppFrame::equals(frame.action, "ResetX"));
+    TEST_ASSERT_EQUAL_STRING("{\"type\":\"So]ft\",\"n\":[{\"a\":\"}\"}]}", text(frame.payload).c_str());
+    // Sans copie : les vues pointent dans la trame
+    TEST_ASSERT_TRUE(frame.payload.data > call && frame.payload.data < call + sizeof(call));
+
+    const char result[] = "[3,\"q0000002a\",{}]";
+    TEST_ASSERT_TRUE(OcppFrame::parse(result, strlen(result), frame));
+    TEST_ASSERT_EQUAL(OCPP_MESSAGE_CALL_RESULT, frame.type);
+    TEST_ASSERT_EQUAL(0, frame.action.len);
+    TEST_ASSERT_EQUAL_STRING("{}", text(frame.payload).c_str());
+
+    const char error[] = "[4,\"q1\",\"NotImplemented\",\"Unknown \\\"action\\\"\",{\"hint\":1}]";
+    TEST_ASSERT_TRUE(OcppFrame::parse(error, strlen(error), frame));
+    TEST_ASSERT_EQUAL(OCPP_MESSAGE_CALL_ERROR, frame.type);
+    TEST_ASSERT_TRUE(OcppFrame::equals(frame.errorCode, "NotImplemented"));
+    TEST_ASSERT_EQUAL_STRING("Unknown \\\"action\\\"", text(frame.errorDescription).c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"hint\":1}", text(frame.payload).c_str());
+    TEST_ASSERT_EQUAL_STRING("\"NotImplemented\",\"Unknown \\\"action\\\"\",{\"hint\":1}", text(frame.body).c_str());
+
+    char id[4];
+    TEST_ASSERT_EQUAL(2, OcppFrame::copy(frame.uniqueId, id, sizeof(id)));
+    TEST_ASSERT_EQUAL_STRING("q1", id);
+
+    const char* const invalid[] = {
+        "",
+        "[5,\"a\",{}]",                     // Type inconnu
+        "[22,\"a\",{}]",
+        "[3,\"a\"]",                        // Charge utile manquante
+        "[3,\"a\",{\"x\":1}",               // Crochet fermant manquant
+        "[3,\"a\",{\"x\":\"}]",             // Chaîne non fermée
+        "[2,\"a\",{}]",                     // CALL sans action
+        "[4,\"a\",\"Code\",{}]",            // CALLERROR sans description
+        "[3,\"a\",[]]",                     // Charge utile non objet
+        "[3,\"a\",{}] x",                   // Texte après la trame
+    };
+    for (const char* frameText : invalid) {
+        TEST_ASSERT_FALSE(OcppFrame::parse(frameText, strlen(frameText), frame));
+    }
+    // La longueur fait foi : une trame tronquée n'est pas lue au-delà
+    TEST_ASSERT_FALSE(OcppFrame::parse(result, strlen(result) - 1, frame));
+
+    for (size_t i = 0; i < RECORDED_FRAME_COUNT; ++i) {
+        TEST_ASSERT_TRUE(OcppFrame::parse(RECORDED_FRAMES[i], strlen(RECORDED_FRAMES[i]), frame));
+    }
+}
+
+// Benchmark sur les trames enregistrées : lecture actuelle contre enveloppe sur place
+void test_ocpp_frame_parse_benchmark() {
+    const int N = 200;
+    volatile size_t sink = 0;
+
+    // Blocs heap vivants pendant la lecture de chaque trame
+    int32_t documentBlocks = 0;
+    int32_t inPlaceBlocks = 0;
+    for (size_t i = 0; i < RECORDED_FRAME_COUNT; ++i) {
+        sink += parseWithDocument(RECORDED_FRAMES[i], &documentBlocks);
+        TEST_ASSERT_TRUE(parseInPlace(RECORDED_FRAMES[i], &inPlaceBlocks) > 0);
+    }
+
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        sink += parseWithDocument(RECORDED_FRAMES[i % RECORDED_FRAME_COUNT], nullptr);
+    }
+    uint32_t documentCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        sink += parseInPlace(RECORDED_FRAMES[i % RECORDED_FRAME_COUNT], nullptr);
+    }
+    uint32_t inPlaceCycles = ESP.getCycleCount() - start;
+    (void)sink;
+
+    TEST_ASSERT_EQUAL(0, inPlaceBlocks);
+    TEST_ASSERT_TRUE(documentBlocks > 0);
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[160];
+    snprintf(report, sizeof(report),
+             "OCPP frame parse: document+String %lu ns/frame, %ld heap blocks; in-place %lu ns/frame, %ld",
+             static_cast<unsigned long>(static_cast<uint64_t>(documentCycles) * 1000 / mhz / N),
+             static_cast<long>(documentBlocks),
+             static_cast<unsigned long>(static_cast<uint64_t>(inPlaceCycles) * 1000 / mhz / N),
+             static_cast<long>(inPlaceBlocks));
+    TEST_MESSAGE(report);
+}
@@ -0,0 +1,244 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <SPIFFS.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ocpp_journal.h"
+
+// ============================================================================
+// SERVEUR SIMULÉ : reçoit nos CALL par la file, attribue les transactionId
+// ============================================================================
+
+namespace {
+
+const char* const JOURNAL_TEST_FILE = "/test_ocpp_journal.bin";
+
+struct FakeServer {
+    bool online = false;             // WebSocket connecté
+    bool answering = true;           // false : serveur muet, les CALL expirent
+    std::string pendingId;           // uniqueId du CALL sans réponse
+    std::string pendingReply;
+    int32_t nextTransactionId = 100;
+    std::map<uint16_t, int32_t> transactionIds;   // txRef → transactionId attribué
+    std::map<uint32_t, uint32_t> deliveries;      // seq du journal → nombre de réceptions
+    std::map<uint16_t, bool> stopped;
+    std::map<uint16_t, unsigned> stopReasons;     // txRef → ocpp_stop_reason_t reçu
+    uint32_t wrongStopIds = 0;
+    uint32_t afterStop = 0;          // Messages reçus après le StopTransaction de leur transaction
+};
+
+FakeServer server;
+OcppJournal* activeJournal = nullptr;
+
+bool fakeSend(void*, char* frame, size_t len) {
+    if (!server.online) return false;
+    std::string text(frame, len);
+    size_t idStart = text.find('"') + 1;
+    std::string id = text.substr(idStart, text.find('"', idStart) - idStart);
+    unsigned seq = 0, type = 0, txRef = 0, reason = 0;
+    long transactionId = -1;
+    sscanf(strchr(frame, '{'), "{\"seq\":%u,\"type\":%u,\"tx\":%u,\"id\":%ld,\"reason\":%u}", &seq, &type, &txRef,
+           &transactionId, &reason);
+
+    server.deliveries[seq]++;
+    if (server.stopped[static_cast<uint16_t>(txRef)]) server.afterStop++;
+    char reply[48] = "{}";
+    if (type == OCPP_CALL_START_TRANSACTION) {
+        // Un StartTransaction rejoué garde sa transaction côté serveur
+        auto known = server.transactionIds.find(static_cast<uint16_t>(txRef));
+        int32_t assigned = known != server.transactionIds.end() ? known->second : server.nextTransactionId++;
+        server.transactionIds[static_cast<uint16_t>(txRef)] = assigned;
+        snprintf(reply, sizeof(reply), "{\"transactionId\":%ld}", static_cast<long>(assigned));
+    } else if (type == OCPP_CALL_STOP_TRANSACTION) {
+        if (transactionId != server.transactionIds[static_cast<uint16_t>(txRef)]) server.wrongStopIds++;
+        server.stopped[static_cast<uint16_t>(txRef)] = true;
+        server.stopReasons[static_cast<uint16_t>(txRef)] = reason;
+    }
+    server.pendingId = id;
+    server.pendingReply = reply;
+    return true;
+}
+
+// Charge utile de test : seq, type, txRef, transactionId et raison d'arrêt, lus par le serveur simulé
+size_t fakePayload(void*, const ocpp_call_t* const* calls, size_t, char* out, size_t size) {
+    const ocpp_call_t& call = *calls[0];
+    int32_t transactionId = -1;
+    if (call.type != OCPP_CALL_START_TRANSACTION &&
+        (!activeJournal->findTransactionId(call.txRef, transactionId) || transactionId < 0)) {
+        return 0;
+    }
+    int len = snprintf(out, size, "{\"seq\":%lu,\"type\":%u,\"tx\":%u,\"id\":%ld,\"reason\":%u}",
+                       static_cast<unsigned long>(call.journalSeq), static_cast<unsigned>(call.type),
+                       static_cast<unsigned>(call.txRef), static_cast<long>(transactionId),
+                       static_cast<unsigned>(call.stopReason));
+    return len > 0 ? static_cast<size_t>(len) : 0;
+}
+
+void fakeResult(void*, const ocpp_call_t& call, ocpp_call_result_t result, const char* payload, size_t len) {
+    long transactionId = -1;
+    std::string text(payload, len);
+    sscanf(text.c_str(), "{\"transactionId\":%ld}", &transactionId);
+    activeJournal->onResult(call, result, static_cast<int32_t>(transactionId), 0);
+}
+
+// Boucle de la tâche OCPP pendant durationMs, par pas de 100 ms
+void pump(OcppJournal& journal, OcppCallQueue& queue, uint32_t& now, uint32_t durationMs) {
+    for (uint32_t end = now + durationMs; now != end; now += 100) {
+        journal.commitIfDue(now);
+        journal.feed(queue, now);
+        queue.poll(now, server.online);
+        if (!server.pendingId.empty() && server.answering) {
+            std::string frame = "[3,\"" + server.pendingId + "\"," + server.pendingReply + "]";
+            server.pendingId.clear();
+            queue.handleIncoming(frame.c_str(), frame.size(), now);
+        }
+    }
+}
+
+void attach(OcppJournal& journal, OcppCallQueue& queue) {
+    activeJournal = &journal;
+    OcppCallQueue::Handlers handlers = { fakeSend, fakePayload, fakeResult, nullptr };
+    queue.setHandlers(handlers);
+}
+
+uint32_t append(OcppJournal& journal, ocpp_call_type_t type, uint16_t txRef, uint32_t now,
+                ocpp_stop_reason_t reason = OCPP_STOP_LOCAL) {
+    ocpp_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.type = type;
+    call.connectorId = 1;
+    call.txRef = txRef;
+    call.timestampMs = now;
+    call.stopReason = static_cast<uint8_t>(reason);
+    strcpy(call.idTag, "CAFE01");
+    TEST_ASSERT_TRUE(journal.append(call, now));
+    return call.journalSeq;
+}
+
+// Coupure d'alimentation : le bloc en mémoire et la file sont perdus, rien n'est fermé proprement
+void powerCut(OcppJournal& journal, OcppCallQueue& queue) {
+    journal.end(false);
+    queue.clear();
+    server.pendingId.clear();
+}
+
+} // namespace
+
+// Coupures pendant une session hors ligne, serveur muet puis reconnexion : aucun message durable perdu
+void test_ocpp_journal_power_cut_replay() {
+    SPIFFS.remove(JOURNAL_TEST_FILE);
+    server = FakeServer();
+    std::vector<uint32_t> mustDeliver;
+    uint32_t now = 0;
+    uint32_t commits = 0;
+
+    // 1. Hors ligne : début de transaction et mesures, puis coupure
+    {
+        OcppJournal journal(JOURNAL_TEST_FILE, SPIFFS);
+        OcppCallQueue queue(1);
+        attach(journal, queue);
+        TEST_ASSERT_TRUE(journal.begin(now));
+        uint32_t startSeq = append(journal, OCPP_CALL_START_TRANSACTION, 1, now);
+        TEST_ASSERT_EQUAL(startSeq, journal.getDurableSeq());   // Début durable dès append()
+        for (int i = 0; i < 12; ++i) {
+            pump(journal, queue, now, 700);
+            append(journal, OCPP_CALL_METER_VALUES, 1, now);
+        }
+        TEST_ASSERT_TRUE(journal.getDurableSeq() < 13);          // Dernières mesures encore en mémoire
+        for (uint32_t seq = 1; seq <= journal.getDurableSeq(); ++seq) mustDeliver.push_back(seq);
+        commits += journal.getStats().commits;
+        powerCut(journal, queue);
+    }
+
+    // Écriture interrompue en fin de fichier
+    File torn = SPIFFS.open(JOURNAL_TEST_FILE, FILE_APPEND);
+    const uint8_t garbage[] = { 0xA5, 0x01, 0x2D, 0x00, 0x0E };
+    torn.write(garbage, sizeof(garbage));
+    torn.close();
+
+    // 2. Redémarrage, serveur muet : les messages expirent et sont redonnés à la file
+    {
+        OcppJournal journal(JOURNAL_TEST_FILE, SPIFFS);
+        OcppCallQueue queue(2);
+        attach(journal, queue);
+        TEST_ASSERT_TRUE(journal.begin(now));
+        ocpp_journal_stats_t stats = journal.getStats();
+        TEST_ASSERT_EQUAL(sizeof(garbage), stats.discardedBytes);
+        TEST_ASSERT_EQUAL(mustDeliver.size(), stats.recovered);
+        TEST_ASSERT_EQUAL(1, journal.getLastTxRef());
+
+        server.online = true;
+        server.answering = false;
+        pump(journal, queue, now, 4 * OCPP_MESSAGE_TIMEOUT_MS + 3 * TRANSACTION_MESSAGE_RETRY_INTERVAL);
+        TEST_ASSERT_TRUE(journal.getStats().deferred > 0);
+        TEST_ASSERT_EQUAL(mustDeliver.size(), journal.getPending());
+
+        // Le serveur répond : le StartTransaction est confirmé, puis coupure en pleine transaction
+        server.answering = true;
+        pump(journal, queue, now, 2 * TRANSACTION_MESSAGE_RETRY_INTERVAL);
+        TEST_ASSERT_EQUAL(0, journal.getPending());
+        server.online = false;
+        append(journal, OCPP_CALL_METER_VALUES, 1, now);
+        uint32_t stopSeq = append(journal, OCPP_CALL_STOP_TRANSACTION, 1, now, OCPP_STOP_DEAUTHORIZED);
+        mustDeliver.push_back(stopSeq - 1);
+        mustDeliver.push_back(stopSeq);
+        commits += journal.getStats().commits;
+        powerCut(journal, queue);
+    }
+
+    // 3. Redémarrage en ligne : le StopTransaction part avec le transactionId et la raison d'avant la
+    //    coupure, puis une longue transaction fait compacter le journal
+    {
+        OcppJournal journal(JOURNAL_TEST_FILE, SPIFFS);
+        OcppCallQueue queue(3);
+        attach(journal, queue);
+        TEST_ASSERT_TRUE(journal.begin(now));
+        int32_t transactionId = -1;
+        TEST_ASSERT_TRUE(journal.findTransactionId(1, transactionId));
+        TEST_ASSERT_EQUAL(server.transactionIds[1], transactionId);
+
+        server.online = true;
+        pump(journal, queue, now, 2000);
+        TEST_ASSERT_EQUAL(0, journal.getPending());
+        TEST_ASSERT_FALSE(journal.findTransactionId(1, transactionId));
+        TEST_ASSERT_EQUAL(OCPP_STOP_DEAUTHORIZED, server.stopReasons[1]);
+
+        uint16_t txRef = static_cast<uint16_t>(journal.getLastTxRef() + 1);
+        mustDeliver.push_back(append(journal, OCPP_CALL_START_TRANSACTION, txRef, now));
+        for (int i = 0; i < 150; ++i) {
+            pump(journal, queue, now, 500);
+            mustDeliver.push_back(append(journal, OCPP_CALL_METER_VALUES, txRef, now));
+        }
+        mustDeliver.push_back(append(journal, OCPP_CALL_STOP_TRANSACTION, txRef, now, OCPP_STOP_REMOTE));
+        pump(journal, queue, now, 5000);
+        TEST_ASSERT_EQUAL(OCPP_STOP_REMOTE, server.stopReasons[txRef]);
+
+        ocpp_journal_stats_t stats = journal.getStats();
+        TEST_ASSERT_EQUAL(0, stats.pending);
+        TEST_ASSERT_TRUE(stats.compactions > 0);
+        TEST_ASSERT_TRUE(stats.fileSize <= OCPP_JOURNAL_COMPACT_SIZE);
+        commits += stats.commits;
+        journal.end();
+    }
+
+    uint32_t duplicates = 0;
+    for (uint32_t seq : mustDeliver) {
+        TEST_ASSERT_TRUE(server.deliveries[seq] > 0);   // Message durable perdu
+    }
+    for (const auto& delivery : server.deliveries) {
+        duplicates += delivery.second - 1;
+    }
+    TEST_ASSERT_EQUAL(0, server.wrongStopIds);
+    TEST_ASSERT_EQUAL(0, server.afterStop);
+    TEST_ASSERT_EQUAL(2, server.transactionIds.size());
+
+    char report[160];
+    snprintf(report, sizeof(report),
+             "OCPP journal: %u messages delivered across 2 power cuts, %lu duplicates, %lu block commits",
+             static_cast<unsigned>(server.deliveries.size()), static_cast<unsigned long>(duplicates),
+             static_cast<unsigned long>(commits));
+    TEST_MESSAGE(report);
+    SPIFFS.remove(JOURNAL_TEST_FILE);
+}
@@ -0,0 +1,155 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+#include "ocpp_json_writer.h"
+
+namespace {
+
+const char* const TIMESTAMP = "2025-01-31T12:00:00.000Z";
+
+// Écriture précédente : document, valeurs via snprintf("%.1f"), puis sérialisation en String
+size_t writeWithDocument(int32_t meterWh, float powerW, String& out) {
+    DynamicJsonDocument doc(384);
+    doc["connectorId"] = 1;
+    doc["transactionId"] = 1842;
+    JsonObject meterValue = doc.createNestedArray("meterValue").createNestedObject();
+    meterValue["timestamp"] = TIMESTAMP;
+    JsonArray sampledValue = meterValue.createNestedArray("sampledValue");
+    char value[16];
+    JsonObject energy = sampledValue.createNestedObject();
+    snprintf(value, sizeof(value), "%ld", static_cast<long>(meterWh));
+    energy["value"] = value;
+    energy["measurand"] = "Energy.Active.Import.Register";
+    energy["unit"] = "Wh";
+    JsonObject power = sampledValue.createNestedObject();
+    snprintf(value, sizeof(value), "%.1f", powerW);
+    power["value"] = value;
+    power["measurand"] = "Power.Active.Import";
+    power["unit"] = "W";
+    out = "";
+    return serializeJson(doc, out);
+}
+
+// Même charge utile, écrite en flux dans le tampon de la trame
+size_t writeStreamed(int32_t meterWh, float powerW, char* out, size_t size) {
+    OcppJsonWriter json(out, size);
+    json.beginObject()
+        .add("connectorId", 1)
+        .add("transactionId", 1842)
+        .beginArray("meterValue").beginObject()
+            .add("timestamp", TIMESTAMP)
+            .beginArray("sampledValue")
+                .beginObject()
+                    .addDecimal("value", meterWh, 0)
+                    .add("measurand", "Energy.Active.Import.Register")
+                    .add("unit", "Wh")
+                .endObject()
+                .beginObject()
+                    .addDecimal("value", powerW, 1)
+                    .add("measurand", "Power.Active.Import")
+                    .add("unit", "W")
+                .endObject()
+            .endArray()
+        .endObject().endArray()
+    .endObject();
+    return json.finish();
+}
+
+int32_t heapBlocks() {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    return static_cast<int32_t>(info.allocated_blocks);
+}
+
+} // namespace
+
+// Sortie exacte : virgules, échappement, virgule fixe, débordement sans écriture hors tampon
+void test_ocpp_json_writer_output() {
+    char out[128];
+    OcppJsonWriter json(out, sizeof(out));
+    json.beginObject()
+        .add("a", "x\"y\\z\n")
+        .add("n", -42)
+        .beginArray("v").add(nullptr, 1).add(nullptr, 2).beginObject().endObject().endArray()
+        .beginArray("e").endArray()
+        .addDecimal("p", 7399.96f, 1)
+        .addDecimal("q", -0.04f, 1)
+        .addDecimal("r", static_cast<int32_t>(-1234), 2)
+        .addDecimal("s", static_cast<int32_t>(5), 3)
+    .endObject();
+    size_t len = json.finish();
+    const char* expected = "{\"a\":\"x\\\"y\\\\z\\u000a\",\"n\":-42,\"v\":[1,2,{}],\"e\":[],"
+                           "\"p\":\"7400.0\",\"q\":\"0.0\",\"r\":\"-12.34\",\"s\":\"0.005\"}";
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+    TEST_ASSERT_EQUAL(strlen(expected), len);
+
+    // Valeurs extrêmes
+    OcppJsonWriter limits(out, sizeof(out));
+    limits.beginArray().add(nullptr, INT32_MIN).addDecimal(nullptr, INT32_MAX, 0).addDecimal(nullptr, 0.5f, 0)
+        .endArray();
+    TEST_ASSERT_TRUE(limits.finish() > 0);
+    TEST_ASSERT_EQUAL_STRING("[-2147483648,\"2147483647\",\"1\"]", out);
+
+    // Tampon trop petit : 0, et rien au-delà de la taille donnée
+    memset(out, '#', sizeof(out));
+    OcppJsonWriter small(out, 8);
+    small.beginObject().add("connectorId", 1).endObject();
+    TEST_ASSERT_TRUE(small.overflowed());
+    TEST_ASSERT_EQUAL(0, small.finish());
+    TEST_ASSERT_EQUAL('\0', out[7]);
+    TEST_ASSERT_EQUAL('#', out[8]);
+
+    // Conteneur non fermé, fermeture en trop, profondeur maximale
+    OcppJsonWriter open(out, sizeof(out));
+    open.beginObject().beginArray("x");
+    TEST_ASSERT_EQUAL(0, open.finish());
+    OcppJsonWriter extra(out, sizeof(out));
+    extra.beginObject().endObject().endObject();
+    TEST_ASSERT_EQUAL(0, extra.finish());
+    OcppJsonWriter deep(out, sizeof(out));
+    for (int i = 0; i < OCPP_JSON_MAX_DEPTH; ++i) deep.beginArray();
+    TEST_ASSERT_TRUE(deep.overflowed());
+}
+
+// Benchmark MeterValues : document + String contre écriture en flux
+void test_ocpp_meter_values_stream_benchmark() {
+    const int N = 200;
+    char out[512];
+    String serialized;
+
+    // Même texte des deux côtés
+    size_t documentLen = writeWithDocument(12345, 7360.0f, serialized);
+    size_t streamedLen = writeStreamed(12345, 7360.0f, out, sizeof(out));
+    TEST_ASSERT_EQUAL(documentLen, streamedLen);
+    TEST_ASSERT_EQUAL_STRING(serialized.c_str(), out);
+
+    // Blocs heap vivants pendant l'écriture d'un message
+    int32_t before = heapBlocks();
+    writeStreamed(12346, 7361.5f, out, sizeof(out));
+    int32_t streamedBlocks = heapBlocks() - before;
+    TEST_ASSERT_EQUAL(0, streamedBlocks);
+
+    size_t bytes = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) bytes += writeWithDocument(12345 + i, 7360.0f + i * 0.1f, serialized);
+    uint32_t documentCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) bytes += writeStreamed(12345 + i, 7360.0f + i * 0.1f, out, sizeof(out));
+    uint32_t streamedCycles = ESP.getCycleCount() - start;
+
+    TEST_ASSERT_TRUE(streamedCycles < documentCycles);
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    uint64_t messageBytes = static_cast<uint64_t>(bytes) / 2;
+    char report[160];
+    snprintf(report, sizeof(report),
+             "OCPP MeterValues write: document+String %lu kB/s, streamed %lu kB/s, %ld heap blocks (%u bytes)",
+             static_cast<unsigned long>(messageBytes * mhz * 1000 / (documentCycles ? documentCycles : 1)),
+             static_cast<unsigned long>(messageBytes * mhz * 1000 / (streamedCycles ? streamedCycles : 1)),
+             static_cast<long>(streamedBlocks), static_cast<unsigned>(streamedLen));
+    TEST_MESSAGE(report);
+}
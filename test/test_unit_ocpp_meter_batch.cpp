@@ -0,0 +1,249 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+
+#include "ocpp_call_queue.h"
+
+// ============================================================================
+// TRANSPORT SIMULÉ : trames émises, relevés portés par chaque MeterValues, issues des CALL
+// ============================================================================
+
+namespace {
+
+struct BatchLink {
+    std::string lastFrame;
+    std::string actions;        // Actions émises, dans l'ordre
+    std::string results;        // "<action>:<C|R|D> " par issue
+    size_t frames = 0;
+    size_t bytes = 0;
+    size_t maxReadings = OCPP_MESSAGE_QUEUE_SIZE;   // Au-delà, la charge utile « ne tient pas »
+};
+
+BatchLink link;
+
+bool batchSend(void*, char* frame, size_t len) {
+    link.lastFrame.assign(frame, len);
+    size_t start = link.lastFrame.find("\",\"") + 3;
+    link.actions += link.lastFrame.substr(start, link.lastFrame.find('"', start) - start) + " ";
+    link.frames++;
+    link.bytes += len;
+    return true;
+}
+
+// Un élément de "v" par relevé : sa valeur d'énergie
+size_t batchPayload(void*, const ocpp_call_t* const* calls, size_t count, char* out, size_t size) {
+    if (count > link.maxReadings) return 0;
+    std::string payload = "{\"tx\":" + std::to_string(calls[0]->txRef) + ",\"v\":[";
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) payload += ",";
+        payload += std::to_string(calls[i]->values[OCPP_MEASURAND_ENERGY_REGISTER]);
+    }
+    payload += "]}";
+    if (payload.size() >= size) return 0;
+    memcpy(out, payload.c_str(), payload.size() + 1);
+    return payload.size();
+}
+
+void batchResult(void*, const ocpp_call_t& call, ocpp_call_result_t result, const char*, size_t) {
+    static const char codes[] = { 'C', 'R', 'D' };
+    link.results += std::string(OcppCallQueue::actionName(call.type)) + ":" + codes[result] + " ";
+}
+
+void resetBatchLink(OcppCallQueue& queue) {
+    link = BatchLink();
+    OcppCallQueue::Handlers handlers = { batchSend, batchPayload, batchResult, nullptr };
+    queue.setHandlers(handlers);
+}
+
+ocpp_call_t makeReading(uint8_t connectorId, uint16_t txRef, int32_t energyWh) {
+    ocpp_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.type = OCPP_CALL_METER_VALUES;
+    call.connectorId = connectorId;
+    call.txRef = txRef;
+    call.measurands = static_cast<uint8_t>(OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_REGISTER));
+    call.values[OCPP_MEASURAND_ENERGY_REGISTER] = energyWh;
+    return call;
+}
+
+ocpp_call_t makeTransactionCall(ocpp_call_type_t type, uint8_t connectorId, uint16_t txRef) {
+    ocpp_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.type = type;
+    call.connectorId = connectorId;
+    call.txRef = txRef;
+    return call;
+}
+
+// Charge utile de la dernière trame
+std::string lastPayload() {
+    size_t start = link.lastFrame.find("{");
+    return link.lastFrame.substr(start, link.lastFrame.size() - start - 1);
+}
+
+void replyLast(OcppCallQueue& queue, uint32_t nowMs) {
+    size_t start = link.lastFrame.find('"') + 1;
+    std::string frame = "[3,\"" + link.lastFrame.substr(start, link.lastFrame.find('"', start) - start) + "\",{}]";
+    queue.handleIncoming(frame.c_str(), frame.size(), nowMs);
+}
+
+// Une heure de relevés toutes les 60 s (Sample.Periodic) : CALL émis, serveur qui répond aussitôt
+size_t hourOfReadings(OcppCallQueue& queue, uint32_t& nowMs) {
+    size_t before = link.frames;
+    for (int32_t i = 0; i < 60; ++i) {
+        nowMs += 60000;
+        queue.enqueue(makeReading(1, 3, 1000 + i), nowMs);
+        queue.poll(nowMs, true);
+        if (queue.getInFlight() > 0) replyLast(queue, nowMs + 50);
+    }
+    return link.frames - before;
+}
+
+} // namespace
+
+// Regroupement : taille, délai, message de transaction, réponse et échec valant pour chaque relevé
+void test_ocpp_meter_batch_flush() {
+    OcppCallQueue queue(0x10);
+    resetBatchLink(queue);
+    queue.setMeterValuesBatch(3, 60000);
+    uint32_t now = 1000;
+
+    queue.enqueue(makeTransactionCall(OCPP_CALL_START_TRANSACTION, 1, 7), now);
+    queue.poll(now, true);
+    replyLast(queue, now + 20);
+
+    // Lot complet à 3 relevés : un seul CALL, un meterValue par relevé, une issue par relevé
+    queue.enqueue(makeReading(1, 7, 100), now + 1000);
+    queue.enqueue(makeReading(1, 7, 101), now + 2000);
+    queue.poll(now + 2000, true);
+    TEST_ASSERT_EQUAL(1, link.frames);
+    queue.enqueue(makeReading(1, 7, 102), now + 3000);
+    queue.poll(now + 3000, true);
+    TEST_ASSERT_EQUAL(2, link.frames);
+    TEST_ASSERT_EQUAL_STRING("{\"tx\":7,\"v\":[100,101,102]}", lastPayload().c_str());
+    TEST_ASSERT_EQUAL(1, queue.getInFlight());
+    TEST_ASSERT_EQUAL(0, queue.getDepth());
+    replyLast(queue, now + 3040);
+    TEST_ASSERT_EQUAL_STRING("StartTransaction:C MeterValues:C MeterValues:C MeterValues:C ", link.results.c_str());
+    TEST_ASSERT_EQUAL(0, queue.getInFlight());
+
+    // Délai : un relevé seul part quand il a attendu la fenêtre
+    now = 10000;
+    queue.enqueue(makeReading(1, 7, 200), now);
+    queue.poll(now + 59999, true);
+    TEST_ASSERT_EQUAL(2, link.frames);
+    queue.poll(now + 60000, true);
+    TEST_ASSERT_EQUAL_STRING("{\"tx\":7,\"v\":[200]}", lastPayload().c_str());
+    replyLast(queue, now + 60050);
+
+    // Les relevés d'un autre connecteur ne comptent pas dans le lot
+    now = 100000;
+    queue.enqueue(makeReading(1, 7, 300), now);
+    queue.enqueue(makeReading(2, 0, 900), now);
+    queue.enqueue(makeReading(1, 7, 301), now);
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL(3, link.frames);
+
+    // StopTransaction : le lot part aussitôt, avant lui
+    queue.enqueue(makeTransactionCall(OCPP_CALL_STOP_TRANSACTION, 1, 7), now + 10);
+    queue.poll(now + 10, true);
+    TEST_ASSERT_EQUAL_STRING("{\"tx\":7,\"v\":[300,301]}", lastPayload().c_str());
+    replyLast(queue, now + 30);
+    queue.poll(now + 30, true);
+    TEST_ASSERT_TRUE(link.lastFrame.find("StopTransaction") != std::string::npos);
+    replyLast(queue, now + 50);
+    TEST_ASSERT_EQUAL(1, queue.getDepth());   // Relevé du connecteur 2, toujours en attente
+
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(3, stats.meterCalls);
+    TEST_ASSERT_EQUAL(6, stats.meterReadings);
+}
+
+void test_ocpp_meter_batch_failure() {
+    OcppCallQueue queue(0x20);
+    resetBatchLink(queue);
+    queue.setMeterValuesBatch(2, 60000);
+    uint32_t now = 1000;
+
+    queue.enqueue(makeTransactionCall(OCPP_CALL_START_TRANSACTION, 1, 4), now);
+    queue.poll(now, true);
+    replyLast(queue, now + 20);
+    queue.enqueue(makeReading(1, 4, 10), now + 100);
+    queue.enqueue(makeReading(1, 4, 11), now + 200);
+    queue.poll(now + 200, true);
+    TEST_ASSERT_EQUAL_STRING("{\"tx\":4,\"v\":[10,11]}", lastPayload().c_str());
+    std::string firstFrame = link.lastFrame;
+
+    // Sans réponse : chaque relevé du lot reste en file pour un nouvel envoi, sans issue
+    now += 200 + OCPP_MESSAGE_TIMEOUT_MS;
+    queue.poll(now, false);
+    TEST_ASSERT_EQUAL(0, queue.getInFlight());
+    TEST_ASSERT_EQUAL(2, queue.getDepth());
+    TEST_ASSERT_EQUAL_STRING("StartTransaction:C ", link.results.c_str());
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(1, stats.timeouts);
+    TEST_ASSERT_EQUAL(2, stats.retries);
+
+    // Renvoi du lot entier sous un nouvel uniqueId, sans attendre la fenêtre
+    now += TRANSACTION_MESSAGE_RETRY_INTERVAL;
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL_STRING("{\"tx\":4,\"v\":[10,11]}", lastPayload().c_str());
+    TEST_ASSERT_TRUE(link.lastFrame != firstFrame);
+
+    // CALLERROR : même traitement ; la réponse suivante confirme les deux relevés
+    size_t start = link.lastFrame.find('"') + 1;
+    std::string error = "[4,\"" + link.lastFrame.substr(start, link.lastFrame.find('"', start) - start) +
+                        "\",\"InternalError\",\"\",{}]";
+    queue.handleIncoming(error.c_str(), error.size(), now + 10);
+    TEST_ASSERT_EQUAL(2, queue.getDepth());
+    now += 10 + 2 * TRANSACTION_MESSAGE_RETRY_INTERVAL;
+    queue.poll(now, true);
+    replyLast(queue, now + 10);
+    TEST_ASSERT_EQUAL_STRING("StartTransaction:C MeterValues:C MeterValues:C ", link.results.c_str());
+
+    // Lot trop grand pour la trame : les derniers relevés partent dans le CALL suivant
+    link.maxReadings = 1;
+    queue.enqueue(makeReading(1, 4, 20), now + 100);
+    queue.enqueue(makeReading(1, 4, 21), now + 100);
+    queue.poll(now + 100, true);
+    TEST_ASSERT_EQUAL_STRING("{\"tx\":4,\"v\":[20]}", lastPayload().c_str());
+    replyLast(queue, now + 110);
+    queue.poll(now + 110, true);
+    TEST_ASSERT_EQUAL_STRING("{\"tx\":4,\"v\":[21]}", lastPayload().c_str());
+    replyLast(queue, now + 120);
+    TEST_ASSERT_EQUAL(0, queue.getDepth());
+    TEST_ASSERT_EQUAL(0, queue.getStats().dropped);
+}
+
+// Benchmark : MeterValues par heure, un CALL par relevé contre des lots de METER_VALUES_BATCH_MAX
+void test_ocpp_meter_batch_benchmark() {
+    OcppCallQueue queue;
+    resetBatchLink(queue);
+    uint32_t now = 0;
+
+    size_t singleCalls = hourOfReadings(queue, now);
+    size_t singleBytes = link.bytes;
+
+    resetBatchLink(queue);
+    queue.setMeterValuesBatch(METER_VALUES_BATCH_MAX, METER_VALUES_BATCH_WINDOW_MS);
+    uint32_t start = ESP.getCycleCount();
+    size_t batchedCalls = hourOfReadings(queue, now);
+    uint32_t cycles = ESP.getCycleCount() - start;
+    size_t batchedBytes = link.bytes;
+
+    TEST_ASSERT_EQUAL(60, singleCalls);
+    TEST_ASSERT_EQUAL(60 / METER_VALUES_BATCH_MAX, batchedCalls);
+    TEST_ASSERT_TRUE(batchedBytes < singleBytes);
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(120, stats.meterReadings);
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[160];
+    snprintf(report, sizeof(report),
+             "OCPP MeterValues batching: 60 readings/h -> %u CALL/h (%u bytes), batched %u CALL/h (%u bytes), "
+             "%lu us/h",
+             static_cast<unsigned>(singleCalls), static_cast<unsigned>(singleBytes),
+             static_cast<unsigned>(batchedCalls), static_cast<unsigned>(batchedBytes),
+             static_cast<unsigned long>(cycles / mhz));
+    TEST_MESSAGE(report);
+}
@@ -0,0 +1,138 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string.h>
+
+#include "ocpp_meter_sampler.h"
+
+namespace {
+
+const uint32_t SAMPLE_MS = 5000;                         // MEASUREMENT_INTERVAL
+const uint64_t CLOCK_START_MS = 1738325690000ULL;        // 2025-01-31T12:14:50Z
+
+struct ReadingLog {
+    ocpp_meter_reading_t readings[8];
+    size_t count;
+    size_t total;
+};
+
+void collect(void* ctx, const ocpp_meter_reading_t& reading) {
+    ReadingLog* log = static_cast<ReadingLog*>(ctx);
+    if (log->count < 8) log->readings[log->count++] = reading;
+    log->total++;
+}
+
+ocpp_meter_sample_t makeSample(uint32_t timestampMs, float energyWh, float powerW) {
+    ocpp_meter_sample_t sample;
+    sample.timestampMs = timestampMs;
+    sample.energyWh = energyWh;
+    sample.powerW = powerW;
+    sample.currentA = powerW / 230.0f;
+    sample.voltageV = 230.0f;
+    sample.temperatureC = 25.0f;
+    return sample;
+}
+
+} // namespace
+
+// Agrégats et relevés : moyenne, min/max, intégrale, fenêtres périodique et alignée
+void test_ocpp_meter_sampler_aggregates() {
+    OcppMeterSampler sampler;
+    ReadingLog log;
+    memset(&log, 0, sizeof(log));
+    sampler.setSink(collect, &log);
+    sampler.setIntervals(60, 900);
+
+    TEST_ASSERT_FALSE(sampler.addSample(MAX_CONNECTORS + 1, makeSample(0, 0, 0), 0));
+
+    // 7,2 kW puis 3,6 kW en alternance, 5 s entre deux mesures, heure du serveur connue
+    float energyWh = 1000.0f;
+    for (uint32_t i = 0; i <= 12; ++i) {
+        float powerW = (i % 2) ? 3600.0f : 7200.0f;
+        energyWh += 7.5f;
+        sampler.addSample(1, makeSample(1000 + i * SAMPLE_MS, energyWh, powerW), CLOCK_START_MS + i * SAMPLE_MS);
+        if (i == 6) {
+            const ocpp_meter_aggregate_t* power =
+                sampler.getAggregate(1, OCPP_READING_PERIODIC, OCPP_MEASURAND_POWER);
+            TEST_ASSERT_NOT_NULL(power);
+            TEST_ASSERT_EQUAL(7, power->count);
+            TEST_ASSERT_EQUAL_FLOAT(3600.0f, power->min);
+            TEST_ASSERT_EQUAL_FLOAT(7200.0f, power->max);
+            TEST_ASSERT_EQUAL_FLOAT(7200.0f, power->last);
+        }
+    }
+
+    // 12:15:00 franchi à la 3e mesure : relevé aligné ; 60 s écoulées à la 13e : relevé périodique
+    TEST_ASSERT_EQUAL(2, log.count);
+    const ocpp_meter_reading_t& clock = log.readings[0];
+    TEST_ASSERT_EQUAL(OCPP_READING_CLOCK, clock.context);
+    TEST_ASSERT_EQUAL(1, clock.connectorId);
+    TEST_ASSERT_TRUE(clock.unixMs == 1738325700000ULL);
+    TEST_ASSERT_EQUAL(OCPP_METER_ALIGNED_DATA, clock.measurands);
+    TEST_ASSERT_EQUAL(1023, clock.values[OCPP_MEASURAND_ENERGY_REGISTER]);
+    // Deux pas de 5 s à (7200 + 3600) / 2 W : 15 Wh
+    TEST_ASSERT_EQUAL(15, clock.values[OCPP_MEASURAND_ENERGY_INTERVAL]);
+
+    const ocpp_meter_reading_t& periodic = log.readings[1];
+    TEST_ASSERT_EQUAL(OCPP_READING_PERIODIC, periodic.context);
+    TEST_ASSERT_EQUAL(1000 + 12 * SAMPLE_MS, periodic.timestampMs);
+    TEST_ASSERT_TRUE(periodic.unixMs == 0);
+    TEST_ASSERT_EQUAL(OCPP_METER_SAMPLED_DATA, periodic.measurands);
+    TEST_ASSERT_EQUAL(1098, periodic.values[OCPP_MEASURAND_ENERGY_REGISTER]);
+    // 7 mesures à 7200 W, 6 à 3600 W
+    TEST_ASSERT_EQUAL(55385, periodic.values[OCPP_MEASURAND_POWER]);
+    TEST_ASSERT_EQUAL(2300, periodic.values[OCPP_MEASURAND_VOLTAGE]);
+
+    // Fenêtre périodique vidée, fenêtre alignée toujours ouverte
+    TEST_ASSERT_EQUAL(0, sampler.getAggregate(1, OCPP_READING_PERIODIC, OCPP_MEASURAND_POWER)->count);
+    TEST_ASSERT_EQUAL(10, sampler.getAggregate(1, OCPP_READING_CLOCK, OCPP_MEASURAND_POWER)->count);
+
+    // Heure inconnue : pas de relevé aligné ; intervalle à 0 : fenêtre désactivée
+    sampler.setIntervals(0, 900);
+    for (uint32_t i = 0; i < 400; ++i) sampler.addSample(2, makeSample(i * SAMPLE_MS, 0, 1000.0f), 0);
+    TEST_ASSERT_EQUAL(2, log.total);
+    TEST_ASSERT_EQUAL(0, sampler.getAggregate(2, OCPP_READING_CLOCK, OCPP_MEASURAND_POWER)->count);
+
+    // Listes de grandeurs OCPP
+    TEST_ASSERT_EQUAL(OCPP_MEASURAND_BIT(OCPP_MEASURAND_ENERGY_REGISTER) | OCPP_MEASURAND_BIT(OCPP_MEASURAND_VOLTAGE),
+                      OcppMeterSampler::parseMeasurands("Energy.Active.Import.Register, Voltage,SoC,Voltage"));
+    TEST_ASSERT_EQUAL(0, OcppMeterSampler::parseMeasurands(""));
+    TEST_ASSERT_EQUAL(0, OcppMeterSampler::parseMeasurands("Power.Active"));
+}
+
+// Une heure de mesures : messages émis avec l'échantillonnage contre un message par mesure
+void test_ocpp_meter_sampler_packing() {
+    const uint32_t HOUR_SAMPLES = 3600000UL / SAMPLE_MS;
+    OcppMeterSampler sampler;
+    ReadingLog log;
+    memset(&log, 0, sizeof(log));
+    sampler.setSink(collect, &log);
+    sampler.setIntervals(METER_VALUES_INTERVAL, CLOCK_ALIGNED_DATA_INTERVAL);
+
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 1; i <= HOUR_SAMPLES; ++i) {
+        sampler.addSample(1, makeSample(i * SAMPLE_MS, i * 10.0f, 7200.0f), CLOCK_START_MS + i * SAMPLE_MS);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    ocpp_meter_sampler_stats_t stats = sampler.getStats();
+    TEST_ASSERT_EQUAL(HOUR_SAMPLES, stats.samples);
+    TEST_ASSERT_EQUAL(3600 / METER_VALUES_INTERVAL - 1, stats.readings[OCPP_READING_PERIODIC]);
+    TEST_ASSERT_EQUAL(3600 / CLOCK_ALIGNED_DATA_INTERVAL, stats.readings[OCPP_READING_CLOCK]);
+    TEST_ASSERT_EQUAL(stats.readings[OCPP_READING_PERIODIC] + stats.readings[OCPP_READING_CLOCK], log.total);
+
+    // Valeurs par message : toutes les grandeurs du relevé dans un seul MeterValues
+    uint32_t values = 0;
+    for (uint8_t m = 0; m < OCPP_MEASURAND_COUNT; ++m) {
+        if (OCPP_METER_SAMPLED_DATA & OCPP_MEASURAND_BIT(m)) values += stats.readings[OCPP_READING_PERIODIC];
+        if (OCPP_METER_ALIGNED_DATA & OCPP_MEASURAND_BIT(m)) values += stats.readings[OCPP_READING_CLOCK];
+    }
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[160];
+    snprintf(report, sizeof(report),
+             "OCPP meter sampling: %lu samples/h -> %lu MeterValues/h (%lu sampled values), %lu ns/sample",
+             static_cast<unsigned long>(HOUR_SAMPLES), static_cast<unsigned long>(log.total),
+             static_cast<unsigned long>(values),
+             static_cast<unsigned long>(static_cast<uint64_t>(cycles) * 1000 / mhz / HOUR_SAMPLES));
+    TEST_MESSAGE(report);
+}
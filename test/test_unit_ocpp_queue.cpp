@@ -0,0 +1,329 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+
+#include "ocpp_call_queue.h"
+
+// ============================================================================
+// TRANSPORT SIMULÉ : mémorise les trames émises et les issues des CALL
+// ============================================================================
+
+namespace {
+
+struct FakeLink {
+    bool online = true;
+    std::string actions;        // Actions émises, dans l'ordre
+    std::string lastFrame;
+    std::string results;        // "<action>:<C|R|D> " par issue
+    std::string lastPayload;
+};
+
+FakeLink link;
+
+bool fakeSend(void*, char* frame, size_t len) {
+    if (!link.online) return false;
+    link.lastFrame.assign(frame, len);
+    size_t start = link.lastFrame.find("\",\"") + 3;
+    link.actions += link.lastFrame.substr(start, link.lastFrame.find('"', start) - start) + " ";
+    return true;
+}
+
+size_t fakePayload(void*, const ocpp_call_t* const* calls, size_t, char* out, size_t size) {
+    const ocpp_call_t& call = *calls[0];
+    int len = snprintf(out, size, "{\"c\":%u,\"tx\":%u,\"s\":\"%s\"}", call.connectorId, call.txRef, call.status);
+    return len > 0 ? static_cast<size_t>(len) : 0;
+}
+
+void fakeResult(void*, const ocpp_call_t& call, ocpp_call_result_t result, const char* payload, size_t len) {
+    static const char codes[] = { 'C', 'R', 'D' };
+    link.results += std::string(OcppCallQueue::actionName(call.type)) + ":" + codes[result] + " ";
+    link.lastPayload.assign(payload, len);
+}
+
+void resetLink(OcppCallQueue& queue) {
+    link = FakeLink();
+    OcppCallQueue::Handlers handlers = { fakeSend, fakePayload, fakeResult, nullptr };
+    queue.setHandlers(handlers);
+}
+
+// Comme WebSocketsClient::sendTXT(payload, len, true) : en-tête client (masqué) écrit à la fin de la
+// réserve qui commence à `payload`, trame masquée sur place, puis un seul envoi de l'en-tête et de la trame
+std::string wire;
+
+bool wireSend(void*, char* frame, size_t len) {
+    static const uint8_t maskKey[4] = { 0x37, 0xfa, 0x21, 0x3d };
+    uint8_t* payload = OcppCallQueue::headroom(frame);
+    size_t headerSize = (len > 125 ? 4 : 2) + sizeof(maskKey);
+    uint8_t* header = payload + OCPP_FRAME_HEADROOM - headerSize;
+    header[0] = 0x81;
+    if (len > 125) {
+        header[1] = 0x80 | 126;
+        header[2] = static_cast<uint8_t>(len >> 8);
+        header[3] = static_cast<uint8_t>(len);
+    } else {
+        header[1] = 0x80 | static_cast<uint8_t>(len);
+    }
+    memcpy(header + headerSize - sizeof(maskKey), maskKey, sizeof(maskKey));
+    for (size_t i = 0; i < len; ++i) payload[OCPP_FRAME_HEADROOM + i] ^= maskKey[i % 4];
+    wire.assign(reinterpret_cast<const char*>(header), headerSize + len);
+    return true;
+}
+
+// Trame reçue par le serveur : en-tête vérifié, charge utile démasquée
+std::string unmaskWire() {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(wire.data());
+    if (wire.size() < 6 || bytes[0] != 0x81 || !(bytes[1] & 0x80)) return "";
+    size_t len = bytes[1] & 0x7f;
+    size_t pos = 2;
+    if (len == 126) {
+        len = (static_cast<size_t>(bytes[2]) << 8) | bytes[3];
+        pos = 4;
+    }
+    const uint8_t* maskKey = bytes + pos;
+    pos += 4;
+    if (wire.size() != pos + len) return "";
+    std::string frame;
+    for (size_t i = 0; i < len; ++i) frame += static_cast<char>(bytes[pos + i] ^ maskKey[i % 4]);
+    return frame;
+}
+
+ocpp_call_t makeCall(ocpp_call_type_t type, uint8_t connectorId, uint16_t txRef, const char* status = "") {
+    ocpp_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.type = type;
+    call.connectorId = connectorId;
+    call.txRef = txRef;
+    strncpy(call.status, status, sizeof(call.status) - 1);
+    return call;
+}
+
+// uniqueId de la dernière trame émise
+std::string lastId() {
+    size_t start = link.lastFrame.find('"') + 1;
+    return link.lastFrame.substr(start, link.lastFrame.find('"', start) - start);
+}
+
+// Réponse du serveur au dernier CALL émis
+ocpp_frame_kind_t reply(OcppCallQueue& queue, uint32_t nowMs, const char* payload = "{}") {
+    std::string frame = "[3,\"" + lastId() + "\"," + payload + "]";
+    return queue.handleIncoming(frame.c_str(), frame.size(), nowMs);
+}
+
+} // namespace
+
+void test_ocpp_queue_priority_order() {
+    OcppCallQueue queue(0x2a);
+    resetLink(queue);
+    uint32_t now = 1000;
+
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_STATUS_NOTIFICATION, 1, 0, "Preparing"), now));
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_METER_VALUES, 1, 0), now));
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_START_TRANSACTION, 1, 7), now));
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_METER_VALUES, 1, 7), now));
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_STOP_TRANSACTION, 1, 7), now));
+    // Le nouveau statut remplace celui en attente, à sa place
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_STATUS_NOTIFICATION, 1, 0, "Finishing"), now));
+    TEST_ASSERT_EQUAL(5, queue.getDepth());
+
+    // Un seul CALL en vol : rien ne part tant que le précédent n'a pas de réponse
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL_STRING("StartTransaction ", link.actions.c_str());
+    TEST_ASSERT_EQUAL_STRING("q0000002a", lastId().c_str());
+    queue.poll(now + 10, true);
+    TEST_ASSERT_EQUAL(1, queue.getInFlight());
+
+    for (int i = 0; i < 5; ++i) {
+        now += 40;
+        reply(queue, now);
+        queue.poll(now, true);
+    }
+    // Le StopTransaction, prioritaire, attend le MeterValues plus ancien de sa transaction
+    TEST_ASSERT_EQUAL_STRING("StartTransaction MeterValues MeterValues StopTransaction StatusNotification ",
+                             link.actions.c_str());
+    TEST_ASSERT_TRUE(link.lastFrame.find("Finishing") != std::string::npos);
+    TEST_ASSERT_EQUAL_STRING("StartTransaction:C MeterValues:C MeterValues:C StopTransaction:C StatusNotification:C ",
+                             link.results.c_str());
+
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(0, stats.depth);
+    TEST_ASSERT_EQUAL(5, stats.depthMax);
+    TEST_ASSERT_EQUAL(6, stats.enqueued);
+    TEST_ASSERT_EQUAL(1, stats.evicted);
+    TEST_ASSERT_EQUAL(5, stats.sent);
+    TEST_ASSERT_EQUAL(5, stats.confirmed);
+    TEST_ASSERT_EQUAL(40, stats.rttAvgMs);
+}
+
+void test_ocpp_queue_backpressure() {
+    OcppCallQueue queue;
+    resetLink(queue);
+    link.online = false;
+
+    for (uint8_t connector = 0; connector < OCPP_MESSAGE_QUEUE_SIZE; ++connector) {
+        TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_STATUS_NOTIFICATION, connector, 0, "Available"), 0));
+    }
+    // File pleine : un statut de plus est refusé, un MeterValues évince le statut le plus récent
+    TEST_ASSERT_FALSE(queue.enqueue(makeCall(OCPP_CALL_STATUS_NOTIFICATION, 42, 0, "Available"), 0));
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_METER_VALUES, 1, 0), 0));
+    TEST_ASSERT_EQUAL_STRING("StatusNotification:D ", link.results.c_str());
+
+    // Les messages de transaction évincent le reste, jamais d'autres messages de transaction
+    size_t accepted = 0;
+    while (queue.enqueue(makeCall(OCPP_CALL_START_TRANSACTION, 1, static_cast<uint16_t>(accepted + 1)), 0)) {
+        accepted++;
+    }
+    TEST_ASSERT_EQUAL(OCPP_MESSAGE_QUEUE_SIZE, accepted);
+    TEST_ASSERT_FALSE(queue.enqueue(makeCall(OCPP_CALL_STOP_TRANSACTION, 1, 1), 0));
+
+    // Transport hors ligne : rien n'est émis, la file reste pleine
+    queue.poll(0, true);
+    TEST_ASSERT_EQUAL(0, queue.getInFlight());
+    TEST_ASSERT_EQUAL(OCPP_MESSAGE_QUEUE_SIZE, queue.getDepth());
+
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(3, stats.rejected);   // Statut, StartTransaction de trop, StopTransaction
+    TEST_ASSERT_EQUAL(OCPP_MESSAGE_QUEUE_SIZE + 1, stats.evicted);
+
+    // Reconnecté : la file se vide dans l'ordre de création
+    link.online = true;
+    for (size_t i = 0; i < OCPP_MESSAGE_QUEUE_SIZE; ++i) {
+        queue.poll(100, true);
+        TEST_ASSERT_TRUE(link.lastFrame.find("\"tx\":" + std::to_string(i + 1) + ",") != std::string::npos);
+        reply(queue, 100, "{\"transactionId\":1}");
+    }
+    TEST_ASSERT_EQUAL(0, queue.getDepth());
+}
+
+void test_ocpp_queue_in_flight_timeout() {
+    OcppCallQueue queue;
+    resetLink(queue);
+    uint32_t now = 0xFFFFFFFFu - 20000u;   // À cheval sur le débordement de millis()
+
+    // Transaction : renvoyée sous un nouvel uniqueId, espacée de TRANSACTION_MESSAGE_RETRY_INTERVAL × tentatives
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_START_TRANSACTION, 1, 3), now));
+    queue.poll(now, true);
+    std::string firstId = lastId();
+    queue.poll(now + OCPP_MESSAGE_TIMEOUT_MS - 1, true);
+    TEST_ASSERT_EQUAL(1, queue.getInFlight());
+    now += OCPP_MESSAGE_TIMEOUT_MS;
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL(0, queue.getInFlight());
+    queue.poll(now + TRANSACTION_MESSAGE_RETRY_INTERVAL - 1, true);
+    TEST_ASSERT_EQUAL(0, queue.getInFlight());
+    now += TRANSACTION_MESSAGE_RETRY_INTERVAL;
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL(1, queue.getInFlight());
+    TEST_ASSERT_TRUE(lastId() != firstId);
+
+    // Réponse tardive au premier envoi : inconnue, transmise telle quelle
+    std::string late = "[3,\"" + firstId + "\",{}]";
+    TEST_ASSERT_EQUAL(OCPP_FRAME_OTHER, queue.handleIncoming(late.c_str(), late.size(), now));
+
+    // CALLERROR : renvoi, puis abandon après TRANSACTION_MESSAGE_ATTEMPTS envois
+    std::string error = "[4,\"" + lastId() + "\",\"InternalError\",\"busy\",{}]";
+    TEST_ASSERT_EQUAL(OCPP_FRAME_OWN, queue.handleIncoming(error.c_str(), error.size(), now + 5));
+    now += 5 + 2 * TRANSACTION_MESSAGE_RETRY_INTERVAL;
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL(1, queue.getInFlight());
+    now += OCPP_MESSAGE_TIMEOUT_MS;
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL_STRING("StartTransaction:D ", link.results.c_str());
+
+    // Hors transaction : abandonné dès la première expiration
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_STATUS_NOTIFICATION, 1, 0, "Faulted"), now));
+    queue.poll(now, true);
+    now += OCPP_MESSAGE_TIMEOUT_MS;
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL_STRING("StartTransaction:D StatusNotification:D ", link.results.c_str());
+
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(4, stats.sent);
+    TEST_ASSERT_EQUAL(3, stats.timeouts);
+    TEST_ASSERT_EQUAL(1, stats.callErrors);
+    TEST_ASSERT_EQUAL(2, stats.retries);
+    TEST_ASSERT_EQUAL(2, stats.dropped);
+    TEST_ASSERT_EQUAL(0, queue.getInFlight());
+}
+
+void test_ocpp_queue_shared_window() {
+    OcppCallQueue queue;
+    resetLink(queue);
+    uint32_t now = 5000;
+
+    // Notre CALL en vol : l'autre pile (MicroOcpp) doit différer le sien
+    const char heartbeat[] = "[2,\"912\",\"Heartbeat\",{}]";
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_METER_VALUES, 1, 0), now));
+    queue.poll(now, true);
+    TEST_ASSERT_FALSE(queue.trackOutgoing(heartbeat, strlen(heartbeat), now));
+    // Les réponses aux CALL du serveur passent toujours
+    const char confirmation[] = "[3,\"srv-1\",{\"status\":\"Accepted\"}]";
+    TEST_ASSERT_TRUE(queue.trackOutgoing(confirmation, strlen(confirmation), now));
+
+    TEST_ASSERT_EQUAL(OCPP_FRAME_OWN, reply(queue, now + 120, "{}"));
+    TEST_ASSERT_TRUE(queue.trackOutgoing(heartbeat, strlen(heartbeat), now + 130));
+
+    // Son CALL en vol : le nôtre attend
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_STOP_TRANSACTION, 1, 9), now));
+    queue.poll(now + 140, true);
+    TEST_ASSERT_EQUAL_STRING("MeterValues ", link.actions.c_str());
+
+    const char serverCall[] = "[2,\"srv-2\",\"Reset\",{\"type\":\"Soft\"}]";
+    TEST_ASSERT_EQUAL(OCPP_FRAME_OTHER, queue.handleIncoming(serverCall, strlen(serverCall), now + 150));
+
+    char action[OCPP_ACTION_NAME_SIZE];
+    const char answer[] = "[3, \"912\", {\"currentTime\":\"2025-01-31T12:00:00Z\"}]";
+    TEST_ASSERT_EQUAL(OCPP_FRAME_FOREIGN,
+                      queue.handleIncoming(answer, strlen(answer), now + 190, action, sizeof(action)));
+    TEST_ASSERT_EQUAL_STRING("Heartbeat", action);
+
+    queue.poll(now + 200, true);
+    TEST_ASSERT_EQUAL_STRING("MeterValues StopTransaction ", link.actions.c_str());
+    TEST_ASSERT_EQUAL(OCPP_FRAME_OWN, reply(queue, now + 210, "{\"idTagInfo\":{\"status\":\"Accepted\"}}"));
+    TEST_ASSERT_EQUAL_STRING("{\"idTagInfo\":{\"status\":\"Accepted\"}}", link.lastPayload.c_str());
+
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(1, stats.foreignDeferred);
+    TEST_ASSERT_EQUAL(10, stats.rttMinMs);
+    TEST_ASSERT_EQUAL(120, stats.rttMaxMs);
+    TEST_ASSERT_EQUAL(10, stats.rttLastMs);
+    TEST_ASSERT_EQUAL(63, stats.rttAvgMs);
+
+    char report[128];
+    snprintf(report, sizeof(report), "OCPP queue: RTT min %lu / avg %lu / max %lu ms, %lu deferred foreign CALL",
+             static_cast<unsigned long>(stats.rttMinMs), static_cast<unsigned long>(stats.rttAvgMs),
+             static_cast<unsigned long>(stats.rttMaxMs), static_cast<unsigned long>(stats.foreignDeferred));
+    TEST_MESSAGE(report);
+}
+
+void test_ocpp_queue_frame_headroom() {
+    OcppCallQueue queue(0x2a);
+    resetLink(queue);
+    OcppCallQueue::Handlers handlers = { wireSend, fakePayload, fakeResult, nullptr };
+    queue.setHandlers(handlers);
+    wire.clear();
+    uint32_t now = 1000;
+
+    // Octets exacts sur le réseau : en-tête de 6 octets (longueur 62, masque) puis la trame masquée
+    TEST_ASSERT_TRUE(queue.enqueue(makeCall(OCPP_CALL_START_TRANSACTION, 1, 3), now));
+    queue.poll(now, true);
+    const char expected[] = "[2,\"q0000002a\",\"StartTransaction\",{\"c\":1,\"tx\":3,\"s\":\"\"}]";
+    const uint8_t header[] = { 0x81, 0x80 | (sizeof(expected) - 1), 0x37, 0xfa, 0x21, 0x3d };
+    TEST_ASSERT_EQUAL(sizeof(header) + sizeof(expected) - 1, wire.size());
+    TEST_ASSERT_EQUAL_MEMORY(header, wire.data(), sizeof(header));
+    TEST_ASSERT_EQUAL_STRING(expected, unmaskWire().c_str());
+
+    // Renvoi après expiration : la trame masquée au premier envoi est réécrite, pas masquée une seconde fois
+    now += OCPP_MESSAGE_TIMEOUT_MS;
+    queue.poll(now, true);
+    now += TRANSACTION_MESSAGE_RETRY_INTERVAL;
+    queue.poll(now, true);
+    TEST_ASSERT_EQUAL(1, queue.getInFlight());
+    TEST_ASSERT_EQUAL_STRING("[2,\"q0000002b\",\"StartTransaction\",{\"c\":1,\"tx\":3,\"s\":\"\"}]",
+                             unmaskWire().c_str());
+
+    // L'écriture de l'en-tête dans la réserve n'a rien altéré d'autre dans la file
+    TEST_ASSERT_EQUAL(0, queue.getDepth());
+    ocpp_queue_stats_t stats = queue.getStats();
+    TEST_ASSERT_EQUAL(2, stats.sent);
+    TEST_ASSERT_EQUAL(1, stats.timeouts);
+}
@@ -0,0 +1,170 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+#include "ocpp_dispatch.h"
+#include "ocpp_validator.h"
+
+namespace {
+
+struct SchemaCase {
+    ocpp_action_t action;
+    ocpp_schema_kind_t kind;
+    const char* payload;
+    ocpp_validation_error_t error;
+    const char* field;          // Propriété attendue dans le résultat (nullptr : non vérifiée)
+};
+
+const char BOOT_REQUEST[] = "{\"chargePointVendor\":\"Vendor\",\"chargePointModel\":\"Model\"}";
+const char METER_VALUES[] =
+    "{\"connectorId\":1,\"transactionId\":42,\"meterValue\":[{\"timestamp\":\"2025-01-31T12:00:00.000Z\","
+    "\"sampledValue\":[{\"value\":\"1234\",\"measurand\":\"Energy.Active.Import.Register\",\"unit\":\"Wh\"},"
+    "{\"value\":\"7.4\",\"measurand\":\"Power.Active.Import\",\"unit\":\"kW\",\"context\":\"Sample.Periodic\"}]}]}";
+
+const SchemaCase CASES[] = {
+    // Conformes
+    { OCPP_ACTION_BOOT_NOTIFICATION, OCPP_SCHEMA_REQUEST, BOOT_REQUEST, OCPP_VALID, nullptr },
+    { OCPP_ACTION_BOOT_NOTIFICATION, OCPP_SCHEMA_RESPONSE,
+      "{\"status\":\"Accepted\",\"currentTime\":\"2025-01-31T12:00:00Z\",\"interval\":300}", OCPP_VALID, nullptr },
+    { OCPP_ACTION_METER_VALUES, OCPP_SCHEMA_REQUEST, METER_VALUES, OCPP_VALID, nullptr },
+    { OCPP_ACTION_HEARTBEAT, OCPP_SCHEMA_REQUEST, "{}", OCPP_VALID, nullptr },
+    { OCPP_ACTION_GET_CONFIGURATION, OCPP_SCHEMA_REQUEST, "{\"key\":[\"HeartbeatInterval\",\"MeterValueSampleInterval\"]}",
+      OCPP_VALID, nullptr },
+    { OCPP_ACTION_GET_DIAGNOSTICS, OCPP_SCHEMA_REQUEST, "{\"location\":\"ftp://diag.example/upload\",\"retries\":2}",
+      OCPP_VALID, nullptr },
+    { OCPP_ACTION_DATA_TRANSFER, OCPP_SCHEMA_REQUEST, "{\"vendorId\":\"Véhicule\",\"data\":\"x\"}", OCPP_VALID, nullptr },
+    // additionalProperties: false
+    { OCPP_ACTION_RESET, OCPP_SCHEMA_REQUEST, "{\"type\":\"Soft\",\"delay\":5}", OCPP_INVALID_FORMATION, "delay" },
+    // required
+    { OCPP_ACTION_BOOT_NOTIFICATION, OCPP_SCHEMA_REQUEST, "{\"chargePointVendor\":\"Vendor\"}",
+      OCPP_INVALID_OCCURRENCE, "chargePointModel" },
+    { OCPP_ACTION_REMOTE_START_TRANSACTION, OCPP_SCHEMA_REQUEST, "{\"connectorId\":1,\"idTag\":null}",
+      OCPP_INVALID_OCCURRENCE, "idTag" },
+    // Types
+    { OCPP_ACTION_CHANGE_AVAILABILITY, OCPP_SCHEMA_REQUEST, "{\"connectorId\":\"1\",\"type\":\"Operative\"}",
+      OCPP_INVALID_TYPE, "connectorId" },
+    { OCPP_ACTION_CHANGE_AVAILABILITY, OCPP_SCHEMA_REQUEST, "{\"connectorId\":1.5,\"type\":\"Operative\"}",
+      OCPP_INVALID_TYPE, "connectorId" },
+    { OCPP_ACTION_GET_CONFIGURATION, OCPP_SCHEMA_REQUEST, "{\"key\":\"HeartbeatInterval\"}", OCPP_INVALID_TYPE, "key" },
+    { OCPP_ACTION_GET_CONFIGURATION, OCPP_SCHEMA_REQUEST, "{\"key\":[\"HeartbeatInterval\",3]}", OCPP_INVALID_TYPE, "key" },
+    // maxLength (en caractères), enum, date-time, uri, multipleOf
+    { OCPP_ACTION_BOOT_NOTIFICATION, OCPP_SCHEMA_REQUEST,
+      "{\"chargePointVendor\":\"ThisStringIsWayTooLong\",\"chargePointModel\":\"Model\"}",
+      OCPP_INVALID_PROPERTY, "chargePointVendor" },
+    { OCPP_ACTION_AUTHORIZE, OCPP_SCHEMA_REQUEST, "{\"idTag\":\"ééééééééééééééééééé\"}", OCPP_VALID, nullptr },
+    { OCPP_ACTION_RESET, OCPP_SCHEMA_REQUEST, "{\"type\":\"Warm\"}", OCPP_INVALID_PROPERTY, "type" },
+    { OCPP_ACTION_RESET, OCPP_SCHEMA_REQUEST, "{\"type\":\"soft\"}", OCPP_INVALID_PROPERTY, "type" },
+    { OCPP_ACTION_RESERVE_NOW, OCPP_SCHEMA_REQUEST,
+      "{\"connectorId\":1,\"expiryDate\":\"demain\",\"idTag\":\"CAFE01\",\"reservationId\":3}",
+      OCPP_INVALID_PROPERTY, "expiryDate" },
+    { OCPP_ACTION_GET_DIAGNOSTICS, OCPP_SCHEMA_REQUEST, "{\"location\":\"/upload\"}", OCPP_INVALID_PROPERTY, "location" },
+    { OCPP_ACTION_METER_VALUES, OCPP_SCHEMA_REQUEST,
+      "{\"connectorId\":1,\"meterValue\":[{\"timestamp\":\"2025-01-31T12:00:00Z\",\"sampledValue\":"
+      "[{\"value\":\"1\",\"unit\":\"kWH\"}]}]}",
+      OCPP_INVALID_PROPERTY, "unit" },
+    { OCPP_ACTION_SET_CHARGING_PROFILE, OCPP_SCHEMA_REQUEST,
+      "{\"connectorId\":1,\"csChargingProfiles\":{\"chargingProfileId\":7,\"stackLevel\":0,"
+      "\"chargingProfilePurpose\":\"TxDefaultProfile\",\"chargingProfileKind\":\"Absolute\",\"chargingSchedule\":"
+      "{\"chargingRateUnit\":\"A\",\"chargingSchedulePeriod\":[{\"startPeriod\":0,\"limit\":16.05}]}}}",
+      OCPP_INVALID_PROPERTY, "limit" },
+};
+
+// Document relu à chaque cas : validate() ne voit que la variante
+ocpp_validation_t validateText(ocpp_action_t action, ocpp_schema_kind_t kind, const char* text,
+                               StaticJsonDocument<1024>& doc) {
+    TEST_ASSERT_TRUE(deserializeJson(doc, text, strlen(text)) == DeserializationError::Ok);
+    return OcppValidator::validate(action, kind, doc.as<JsonVariantConst>());
+}
+
+} // namespace
+
+// Tables générées : contraintes des schémas appliquées, première propriété fautive nommée
+void test_ocpp_schema_validation() {
+    StaticJsonDocument<1024> doc;
+    for (const SchemaCase& c : CASES) {
+        ocpp_validation_t result = validateText(c.action, c.kind, c.payload, doc);
+        TEST_ASSERT_EQUAL_MESSAGE(c.error, result.error, c.payload);
+        if (c.field) TEST_ASSERT_EQUAL_STRING_MESSAGE(c.field, result.field, c.payload);
+    }
+
+    // Chaque action a une racine objet pour sa requête et sa réponse
+    for (uint8_t i = 0; i < OCPP_ACTION_COUNT; ++i) {
+        for (int kind = 0; kind < OCPP_SCHEMA_KIND_COUNT; ++kind) {
+            const ocpp_schema_node_t& root = OCPP_SCHEMA_NODES[OCPP_SCHEMA_ROOTS[i][kind]];
+            TEST_ASSERT_EQUAL(OCPP_SCHEMA_OBJECT, root.type);
+            TEST_ASSERT_NULL(root.name);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_STRING("PropertyConstraintViolation", OcppValidator::errorCode(OCPP_INVALID_PROPERTY));
+    TEST_ASSERT_NULL(OcppValidator::errorCode(OCPP_VALID));
+}
+
+// CALL du serveur non conforme : CALLERROR avant MicroOCPP
+void test_ocpp_schema_dispatch_errors() {
+    OcppDispatcher dispatcher;
+    char error[OCPP_DISPATCH_ERROR_SIZE];
+    ocpp_frame_t frame;
+
+    const char missing[] = "[2,\"s1\",\"ChangeConfiguration\",{\"key\":\"HeartbeatInterval\"}]";
+    TEST_ASSERT_TRUE(OcppFrame::parse(missing, strlen(missing), frame));
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_INVALID, dispatcher.dispatch(frame));
+    dispatcher.writeError(error, sizeof(error), frame, OCPP_DISPATCH_INVALID);
+    TEST_ASSERT_EQUAL_STRING("[4,\"s1\",\"OccurenceConstraintViolation\",\"Missing property value\",{}]", error);
+
+    // Clé reçue recopiée sans ses caractères spéciaux
+    const char unknown[] = "[2,\"s2\",\"ClearCache\",{\"x\\\"y\":1}]";
+    TEST_ASSERT_TRUE(OcppFrame::parse(unknown, strlen(unknown), frame));
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_INVALID, dispatcher.dispatch(frame));
+    TEST_ASSERT_EQUAL(OCPP_INVALID_FORMATION, dispatcher.getValidation().error);
+    dispatcher.writeError(error, sizeof(error), frame, OCPP_DISPATCH_INVALID);
+    TEST_ASSERT_EQUAL_STRING("[4,\"s2\",\"FormationViolation\",\"Unexpected property xy\",{}]", error);
+
+    // Objet fermé mais JSON invalide à l'intérieur
+    const char malformed[] = "[2,\"s3\",\"Reset\",{\"type\":Soft}]";
+    TEST_ASSERT_TRUE(OcppFrame::parse(malformed, strlen(malformed), frame));
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_INVALID, dispatcher.dispatch(frame));
+    dispatcher.writeError(error, sizeof(error), frame, OCPP_DISPATCH_INVALID);
+    TEST_ASSERT_EQUAL_STRING("[4,\"s3\",\"FormationViolation\",\"Malformed payload\",{}]", error);
+
+    const char typed[] = "[2,\"s4\",\"UnlockConnector\",{\"connectorId\":true}]";
+    TEST_ASSERT_TRUE(OcppFrame::parse(typed, strlen(typed), frame));
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_INVALID, dispatcher.dispatch(frame));
+    dispatcher.writeError(error, sizeof(error), frame, OCPP_DISPATCH_INVALID);
+    TEST_ASSERT_EQUAL_STRING("[4,\"s4\",\"TypeConstraintViolation\",\"Wrong type for connectorId\",{}]", error);
+
+    const char valid[] = "[2,\"s5\",\"ChangeConfiguration\",{\"key\":\"HeartbeatInterval\",\"value\":\"300\"}]";
+    TEST_ASSERT_TRUE(OcppFrame::parse(valid, strlen(valid), frame));
+    TEST_ASSERT_EQUAL(OCPP_DISPATCH_FORWARD, dispatcher.dispatch(frame));
+    TEST_ASSERT_EQUAL(0, dispatcher.writeError(error, sizeof(error), frame, OCPP_DISPATCH_FORWARD));
+}
+
+// Validation sans allocation, et son coût par message
+void test_ocpp_schema_validation_benchmark() {
+    const int N = 200;
+    StaticJsonDocument<1024> doc;
+    TEST_ASSERT_TRUE(deserializeJson(doc, METER_VALUES, strlen(METER_VALUES)) == DeserializationError::Ok);
+    JsonVariantConst payload = doc.as<JsonVariantConst>();
+
+    multi_heap_info_t before, after;
+    heap_caps_get_info(&before, MALLOC_CAP_8BIT);
+    ocpp_validation_t result = OcppValidator::validate(OCPP_ACTION_METER_VALUES, OCPP_SCHEMA_REQUEST, payload);
+    heap_caps_get_info(&after, MALLOC_CAP_8BIT);
+    TEST_ASSERT_EQUAL(OCPP_VALID, result.error);
+    TEST_ASSERT_EQUAL(before.allocated_blocks, after.allocated_blocks);
+
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+        result = OcppValidator::validate(OCPP_ACTION_METER_VALUES, OCPP_SCHEMA_REQUEST, payload);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    TEST_ASSERT_EQUAL(OCPP_VALID, result.error);
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    char report[128];
+    snprintf(report, sizeof(report), "OCPP schema validation: MeterValues.req (2 samples) %lu ns, 0 heap blocks",
+             static_cast<unsigned long>(static_cast<uint64_t>(cycles) * 1000 / mhz / N));
+    TEST_MESSAGE(report);
+}
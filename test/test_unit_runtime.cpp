@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+
+#include "SystemRuntime.h"
+#include "Logger.h"
+
+// ============================================================================
+// COMPTEUR SIMULÉ : chaque mesure porte un numéro de séquence (champ energy)
+// ============================================================================
+
+namespace {
+
+struct FakeMeter {
+    std::atomic<uint32_t> taken{0};
+    std::atomic<uint32_t> received{0};
+    std::atomic<uint32_t> ocppCycles{0};
+    uint32_t lastSequence = 0;
+    bool ordered = true;
+};
+
+FakeMeter meter;
+
+bool fakeMeasure(void* ctx, hardware_measurements_t& out) {
+    FakeMeter* fake = static_cast<FakeMeter*>(ctx);
+    memset(&out, 0, sizeof(out));
+    out.timestamp = millis();
+    out.energy = static_cast<float>(fake->taken.fetch_add(1) + 1);
+    return true;
+}
+
+void fakeSample(void* ctx, const hardware_measurements_t& sample) {
+    FakeMeter* fake = static_cast<FakeMeter*>(ctx);
+    uint32_t sequence = static_cast<uint32_t>(sample.energy);
+    if (sequence != fake->lastSequence + 1) fake->ordered = false;
+    fake->lastSequence = sequence;
+    fake->received++;
+}
+
+void fakeOcppLoop(void* ctx) {
+    static_cast<FakeMeter*>(ctx)->ocppCycles++;
+}
+
+} // namespace
+
+void test_runtime_task_topology() {
+    meter.taken = 0;
+    meter.received = 0;
+    meter.ocppCycles = 0;
+    meter.lastSequence = 0;
+    meter.ordered = true;
+
+    SystemRuntime runtime;
+    SystemRuntime::Hooks hooks = { fakeOcppLoop, fakeMeasure, fakeSample, &meter };
+    TEST_ASSERT_TRUE(runtime.begin(hooks, 20, nullptr));
+    TEST_ASSERT_TRUE(Logger::getInstance().isAsync());
+
+    // Cadence de comptage : ~10 mesures en 230 ms, toutes livrées à la tâche OCPP, dans l'ordre
+    delay(230);
+    TEST_ASSERT_TRUE(meter.received >= 8 && meter.received <= 12);
+    TEST_ASSERT_TRUE(meter.ocppCycles >= 10);
+
+    // Mesure à la demande : immédiate, même avec un intervalle long
+    TEST_ASSERT_TRUE(runtime.setMeteringInterval(10000));
+    delay(30);
+    uint32_t before = meter.received;
+    uint32_t start = millis();
+    TEST_ASSERT_TRUE(runtime.requestSample());
+    while (meter.received == before && millis() - start < 500) {
+        delay(1);
+    }
+    uint32_t latency = millis() - start;
+    TEST_ASSERT_EQUAL(before + 1, meter.received.load());
+    TEST_ASSERT_TRUE(latency < 50);
+
+    char report[160];
+    RuntimeTaskStats stats[RUNTIME_TASK_COUNT];
+    for (int i = 0; i < RUNTIME_TASK_COUNT; ++i) {
+        TEST_ASSERT_TRUE(runtime.getTaskStats(static_cast<RuntimeTaskId>(i), stats[i]));
+        TEST_ASSERT_TRUE(stats[i].running);
+        TEST_ASSERT_TRUE(stats[i].stackFree > 0);
+        TEST_ASSERT_TRUE(stats[i].cycles > 0);
+        TEST_ASSERT_TRUE(stats[i].cpuPercent >= 0.0f && stats[i].cpuPercent <= 100.0f);
+    }
+    TEST_ASSERT_EQUAL(RUNTIME_OCPP_CORE, stats[RUNTIME_TASK_OCPP].core);
+    TEST_ASSERT_EQUAL(RUNTIME_METERING_CORE, stats[RUNTIME_TASK_METERING].core);
+    TEST_ASSERT_TRUE(stats[RUNTIME_TASK_METERING].priority > stats[RUNTIME_TASK_LOGGER].priority);
+
+    runtime.end();
+    TEST_ASSERT_FALSE(Logger::getInstance().isAsync());
+    RuntimeTaskStats stopped;
+    runtime.getTaskStats(RUNTIME_TASK_METERING, stopped);
+    TEST_ASSERT_FALSE(stopped.running);
+
+    RuntimeQueueStats queues = runtime.getQueueStats();
+    TEST_ASSERT_TRUE(meter.ordered);
+    TEST_ASSERT_EQUAL(0, queues.samplesDropped);
+    TEST_ASSERT_EQUAL(meter.taken.load(), meter.received.load());
+
+    snprintf(report, sizeof(report),
+             "Runtime: on-demand sample in %lu ms, CPU ocpp %.2f%% metering %.2f%% logger %.2f%%, stack free %lu/%lu/%lu",
+             static_cast<unsigned long>(latency), stats[0].cpuPercent, stats[1].cpuPercent, stats[2].cpuPercent,
+             static_cast<unsigned long>(stats[0].stackFree), static_cast<unsigned long>(stats[1].stackFree),
+             static_cast<unsigned long>(stats[2].stackFree));
+    TEST_MESSAGE(report);
+}
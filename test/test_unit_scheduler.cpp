@@ -0,0 +1,136 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+
+#include "TaskScheduler.h"
+
+// ============================================================================
+// HORLOGE VIRTUELLE : le test avance le temps lui-même
+// ============================================================================
+
+namespace {
+
+uint32_t virtualNow = 0;
+
+uint32_t virtualClock() {
+    return virtualNow;
+}
+
+struct Trace {
+    std::string events;
+    TaskScheduler* scheduler = nullptr;
+    int oneShot = SCHEDULER_INVALID_TASK;
+    int fast = SCHEDULER_INVALID_TASK;
+    bool rearmed = false;
+};
+
+Trace trace;
+
+void record(const char* name) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%s@%lu ", name, static_cast<unsigned long>(virtualNow));
+    trace.events += buffer;
+}
+
+void taskA(void*) { record("A"); }
+void taskB(void*) { record("B"); }
+void taskD(void*) { record("D"); }
+
+// Tâche ponctuelle qui se réarme une fois et coupe la tâche rapide
+void taskOnce(void*) {
+    record("O");
+    if (!trace.rearmed) {
+        trace.rearmed = true;
+        trace.scheduler->runIn(trace.oneShot, 50);
+    }
+    trace.scheduler->setEnabled(trace.fast, false);
+}
+
+// Saute directement à chaque échéance, comme idle() sur la cible
+void runUntil(TaskScheduler& scheduler, uint32_t end) {
+    for (;;) {
+        uint32_t wait = scheduler.runDue();
+        if (virtualNow + wait > end) break;
+        virtualNow += wait;
+    }
+    virtualNow = end;
+}
+
+uint32_t periodicRuns = 0;
+uint32_t lastRunAt = 0;
+
+void periodicTask(void*) {
+    periodicRuns++;
+    lastRunAt = virtualNow;
+}
+
+} // namespace
+
+void test_scheduler_deadline_order() {
+    virtualNow = 1000;
+    TaskScheduler scheduler(virtualClock);
+    trace = Trace();
+    trace.scheduler = &scheduler;
+
+    TEST_ASSERT_EQUAL(0, scheduler.addTask("A", 30, taskA, nullptr, 30));
+    TEST_ASSERT_EQUAL(1, scheduler.addTask("B", 20, taskB, nullptr, 20));
+    trace.oneShot = scheduler.addTask("O", 0, taskOnce, nullptr, 25);
+    trace.fast = scheduler.addTask("D", 20, taskD, nullptr, 20);   // Même échéances que B : toujours après B
+    TEST_ASSERT_EQUAL(20, scheduler.msUntilNext());
+
+    runUntil(scheduler, 1120);
+    TEST_ASSERT_EQUAL_STRING("B@1020 D@1020 O@1025 A@1030 B@1040 A@1060 B@1060 O@1075 B@1080 A@1090 B@1100 "
+                             "A@1120 B@1120 ",
+                             trace.events.c_str());
+
+    // Désarmée : aucune exécution, statistiques conservées ; réarmée : une période plus tard
+    ScheduledTaskStats stats;
+    TEST_ASSERT_TRUE(scheduler.getTaskStats(trace.fast, stats));
+    TEST_ASSERT_FALSE(stats.armed);
+    TEST_ASSERT_EQUAL(1, stats.runs);
+    TEST_ASSERT_TRUE(scheduler.getTaskStats(trace.oneShot, stats));
+    TEST_ASSERT_FALSE(stats.armed);
+    TEST_ASSERT_EQUAL(2, stats.runs);
+
+    trace.events.clear();
+    TEST_ASSERT_TRUE(scheduler.setPeriod(trace.fast, 15));
+    runUntil(scheduler, 1150);
+    TEST_ASSERT_EQUAL_STRING("D@1135 B@1140 A@1150 D@1150 ", trace.events.c_str());
+    TEST_ASSERT_FALSE(scheduler.setEnabled(42, true));
+}
+
+void test_scheduler_drift() {
+    // Une heure de réveils en retard de 0 à 7 ms, à cheval sur le débordement de millis()
+    const uint32_t start = 0xFFFFFFFFu - 1800000u;
+    virtualNow = start;
+    periodicRuns = 0;
+    TaskScheduler scheduler(virtualClock);
+    int id = scheduler.addTask("tick", 1000, periodicTask, nullptr, 1000);
+
+    uint32_t jitter = 12345;
+    for (int i = 0; i < 3600; ++i) {
+        jitter = jitter * 1103515245u + 12345u;
+        virtualNow += scheduler.msUntilNext() + (jitter >> 16) % 8;
+        scheduler.runDue();
+    }
+    ScheduledTaskStats stats;
+    TEST_ASSERT_TRUE(scheduler.getTaskStats(id, stats));
+    TEST_ASSERT_EQUAL(3600, periodicRuns);
+    TEST_ASSERT_EQUAL(0, stats.missed);
+    TEST_ASSERT_TRUE(stats.maxLateMs <= 7);
+    // Aucune dérive : la 3600e exécution a lieu au plus 7 ms après start + 3600 s
+    TEST_ASSERT_TRUE(lastRunAt - (start + 3600000u) <= 7);
+    TEST_ASSERT_EQUAL(1000 - (lastRunAt - (start + 3600000u)), scheduler.msUntilNext());
+    char report[96];
+    snprintf(report, sizeof(report), "Scheduler: %lu runs over 1 h, max late %lu ms, no drift",
+             static_cast<unsigned long>(stats.runs), static_cast<unsigned long>(stats.maxLateMs));
+
+    // Blocage de 3,5 s : une seule exécution de rattrapage, 3 périodes sautées, phase conservée
+    virtualNow = start + 3600000u + 4500u;
+    scheduler.runDue();
+    TEST_ASSERT_TRUE(scheduler.getTaskStats(id, stats));
+    TEST_ASSERT_EQUAL(3601, periodicRuns);
+    TEST_ASSERT_EQUAL(3, stats.missed);
+    TEST_ASSERT_EQUAL(500, scheduler.msUntilNext());
+    TEST_MESSAGE(report);
+}